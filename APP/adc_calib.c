@@ -0,0 +1,134 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : adc_calib.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : ADC 粗调偏差管理: 按芯片温度变化和最长间隔重新校准, 保存在 data flash
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "HAL.h"
+#include "adc_calib.h"
+
+// 芯片温度变化超过此值时重新校准
+#define ADC_CALIB_TEMP_DELTA 5                          // 5°C
+// 偏差的最长使用时间, TMOS 时钟单位 625us (1600 = 1s); 不用 MS1_TO_SYSTEM_TIME(),
+// 24h 的毫秒数乘 1000 会超出 32 位
+#define ADC_CALIB_MAX_AGE    (24UL * 3600 * 1600)                      // 24h
+// 统计输出间隔
+#define ADC_CALIB_REPORT     (3600UL * 1600)                           // 1h
+// ADC_DataCalib_Rough() 的转换次数 (丢弃1次 + 平均16次)
+#define ADC_CALIB_CONVERSIONS 17
+// 偏差在 data flash 中的保存地址 (加密计数器之前的一页)
+#define ADC_CALIB_ADDR       (0x77C00 - FLASH_ROM_MAX_SIZE)
+
+typedef struct {
+    int16_t offset;
+    int16_t temp;           // 校准时的芯片温度 (°C)
+    uint8_t valid;
+    uint32_t time;          // 校准时间 (TMOS 时钟)
+
+    // 统计
+    uint32_t start;         // 开始统计的时间
+    uint32_t report;        // 上次输出统计的时间
+    uint32_t calls;
+    uint32_t calibs;
+    uint32_t conversions;   // 实际用于校准及测温的转换次数
+    uint32_t legacy;        // 原来每256次调用中后128次都校准时的转换次数
+    uint8_t legacy_count;
+} adc_calib_t;
+
+static adc_calib_t adc_calib;
+
+/**
+ * @brief 保存偏差及校准温度, 两个字互为反码用于校验
+ */
+static void adc_calib_store(void)
+{
+    uint32_t stored[2];
+
+    stored[0] = (uint16_t)adc_calib.offset | ((uint32_t)(uint16_t)adc_calib.temp << 16);
+    stored[1] = ~stored[0];
+    EEPROM_ERASE(ADC_CALIB_ADDR, EEPROM_PAGE_SIZE);
+    EEPROM_WRITE(ADC_CALIB_ADDR, stored, sizeof(stored));
+}
+
+/**
+ * @brief 从 data flash 恢复偏差
+ */
+void adc_calib_init(void)
+{
+    uint32_t stored[2];
+
+    tmos_memset(&adc_calib, 0, sizeof(adc_calib));
+    adc_calib.start = adc_calib.report = TMOS_GetSystemClock();
+
+    EEPROM_READ(ADC_CALIB_ADDR, stored, sizeof(stored));
+    if (stored[0] == ~stored[1]) {
+        adc_calib.offset = (int16_t)(stored[0] & 0xFFFF);
+        adc_calib.temp = (int16_t)(stored[0] >> 16);
+        adc_calib.time = adc_calib.start;
+        adc_calib.valid = TRUE;
+    }
+    PRINT("ADC calib: %s offset %d at %d C\n", adc_calib.valid ? "restored" : "no",
+          adc_calib.offset, adc_calib.temp);
+}
+
+/**
+ * @brief 获取偏差, 温度变化或超时后重新校准
+ * @return 偏差
+ */
+int16_t adc_calib_offset(void)
+{
+    uint32_t now = TMOS_GetSystemClock();
+    int temp = adc_to_temperature_celsius(HAL_GetInterTempValue());
+    int drift = temp - adc_calib.temp;
+
+    adc_calib.calls++;
+    adc_calib.conversions++;
+    if (++adc_calib.legacy_count >> 7) {
+        adc_calib.legacy += ADC_CALIB_CONVERSIONS;
+    }
+
+    if (!adc_calib.valid || drift >= ADC_CALIB_TEMP_DELTA || drift <= -ADC_CALIB_TEMP_DELTA ||
+        now - adc_calib.time >= ADC_CALIB_MAX_AGE) {
+        int16_t offset = ADC_DataCalib_Rough();
+
+        adc_calib.calibs++;
+        adc_calib.conversions += ADC_CALIB_CONVERSIONS;
+        adc_calib.temp = (int16_t)temp;
+        adc_calib.time = now;
+        // 只在偏差变化时写 flash, 减少擦写次数
+        if (!adc_calib.valid || offset != adc_calib.offset) {
+            adc_calib.offset = offset;
+            adc_calib_store();
+        }
+        adc_calib.valid = TRUE;
+        PRINT("ADC calib: offset %d at %d C\n", adc_calib.offset, temp);
+    }
+
+    if (now - adc_calib.report >= ADC_CALIB_REPORT) {
+        adc_calib.report = now;
+        adc_calib_print();
+    }
+    return adc_calib.offset;
+}
+
+/**
+ * @brief 打印校准统计, 按运行时间折算为每小时
+ */
+void adc_calib_print(void)
+{
+#ifdef DEBUG
+    // TMOS 时钟单位 625us, 1600 = 1s
+    uint32_t secs = (TMOS_GetSystemClock() - adc_calib.start) / 1600;
+    int32_t saved = (int32_t)(adc_calib.legacy - adc_calib.conversions);
+
+    if (secs == 0) {
+        secs = 1;
+    }
+    PRINT("ADC calib: %d calls, %d calibrations, %d conversions, %d saved (%d/h)\n",
+          (int)adc_calib.calls, (int)adc_calib.calibs, (int)adc_calib.conversions, (int)saved,
+          (int)((int64_t)saved * 3600 / secs));
+#endif
+}
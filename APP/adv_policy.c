@@ -0,0 +1,175 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : adv_policy.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : 根据数据变化和电池电量调整广播间隔及采样周期
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "HAL.h"
+#include "adv_policy.h"
+
+// 连续多少次采样无变化后延长一级
+#define ADV_POLICY_STABLE_SAMPLES 3
+// 低电量时的最低级别
+#define ADV_POLICY_LOW_BAT 20           // 20%
+#define ADV_POLICY_LOW_BAT_LEVEL 2
+#define ADV_POLICY_CRITICAL_BAT 10      // 10%
+#define ADV_POLICY_CRITICAL_BAT_LEVEL 3
+// 默认级别 (与原固定的 2s 广播 / 20s 采样一致), 用于计算节能比例
+#define ADV_POLICY_DEFAULT_LEVEL 1
+
+typedef struct {
+    uint16_t adv_interval;      // 广播间隔 (units of 625us, 最大 16384)
+    uint32_t sample_period;     // 采样周期 (units of 625us)
+} adv_policy_level_t;
+
+// 级别越高间隔越长
+static const adv_policy_level_t adv_policy_levels[] = {
+    { 1600 * 1,  1600 * 10 },   // 数据变化: 1s 广播 / 10s 采样
+    { 1600 * 2,  1600 * 20 },   // 默认: 2s / 20s
+    { 1600 * 5,  1600 * 60 },   // 稳定: 5s / 60s
+    { 1600 * 10, 1600 * 120 },  // 长期稳定或低电量: 10s / 120s
+};
+
+#define ADV_POLICY_LEVELS ((uint8_t)(sizeof(adv_policy_levels) / sizeof(adv_policy_levels[0])))
+
+static uint8_t adv_policy_level;
+static uint8_t adv_policy_stable;
+// 已停止广播, 等待 GAPROLE_WAITING 后以新间隔重新开始
+static uint8_t adv_policy_pending;
+
+/**
+ * @brief 初始化为默认级别
+ */
+void adv_policy_init(void)
+{
+    adv_policy_level = ADV_POLICY_DEFAULT_LEVEL;
+    adv_policy_stable = 0;
+    adv_policy_pending = FALSE;
+}
+
+/**
+ * @brief 获取当前广播间隔
+ * @return 广播间隔 (units of 625us)
+ */
+uint16_t adv_policy_adv_interval(void)
+{
+    return adv_policy_levels[adv_policy_level].adv_interval;
+}
+
+/**
+ * @brief 获取当前采样周期
+ * @return 采样周期 (units of 625us)
+ */
+uint32_t adv_policy_sample_period(void)
+{
+    return adv_policy_levels[adv_policy_level].sample_period;
+}
+
+/**
+ * @brief 计算某一级别的平均电流模型
+ * @param level 级别
+ * @param awake_us 单次采样唤醒时间 (us)
+ * @return 平均电流 (nA)
+ */
+uint32_t adv_policy_model_na(uint8_t level, uint32_t awake_us)
+{
+    const adv_policy_level_t *l = &adv_policy_levels[level];
+    // 周期换算为微秒: 1 unit = 625us
+    uint64_t adv_us = (uint64_t)l->adv_interval * 625;
+    uint64_t sample_us = (uint64_t)l->sample_period * 625;
+
+    return HAL_ENERGY_SLEEP_NA
+         + (uint32_t)((uint64_t)HAL_ENERGY_RADIO_NA * HAL_ENERGY_RADIO_EVENT_US / adv_us)
+         + (uint32_t)((uint64_t)HAL_ENERGY_SENSOR_NA * awake_us / sample_us);
+}
+
+/**
+ * @brief 应用新的广播间隔: 先停止广播, 进入 GAPROLE_WAITING 后由 adv_policy_resume() 重新开始
+ */
+static void adv_policy_apply(void)
+{
+    uint8_t enable = FALSE;
+
+    // 停止尚未完成时重复停止无害, 恢复时使用最新的间隔
+    adv_policy_pending = TRUE;
+    GAPRole_SetParameter(GAPROLE_ADVERT_ENABLED, sizeof(uint8_t), &enable);
+}
+
+/**
+ * @brief 广播已停止: 设置新的广播间隔并重新开始广播
+ * @return TRUE表示已重新开始
+ */
+uint8_t adv_policy_resume(void)
+{
+    uint16_t interval = adv_policy_adv_interval();
+    uint8_t enable = TRUE;
+
+    if (!adv_policy_pending) {
+        return FALSE;
+    }
+    adv_policy_pending = FALSE;
+
+    GAP_SetParamValue(TGAP_DISC_ADV_INT_MIN, interval);
+    GAP_SetParamValue(TGAP_DISC_ADV_INT_MAX, interval);
+    GAPRole_SetParameter(GAPROLE_ADVERT_ENABLED, sizeof(uint8_t), &enable);
+
+#if (defined(HAL_ENERGY)) && (HAL_ENERGY == TRUE)
+    HAL_EnergySetAdvInterval(interval);
+#endif
+    return TRUE;
+}
+
+/**
+ * @brief 根据本次采样结果调整级别
+ * @param changed 数据是否超出死区
+ * @param battery 电池电量 (%)
+ * @param awake_us 本次采样唤醒时间 (us)
+ * @return TRUE表示级别已改变
+ */
+uint8_t adv_policy_update(uint8_t changed, uint8_t battery, uint32_t awake_us)
+{
+    uint8_t min_level = 0;
+    uint8_t level = adv_policy_level;
+
+    if (battery < ADV_POLICY_CRITICAL_BAT) {
+        min_level = ADV_POLICY_CRITICAL_BAT_LEVEL;
+    } else if (battery < ADV_POLICY_LOW_BAT) {
+        min_level = ADV_POLICY_LOW_BAT_LEVEL;
+    }
+
+    // 数据变化时立即回到最短间隔, 连续稳定时逐级延长
+    if (changed) {
+        adv_policy_stable = 0;
+        level = 0;
+    } else if (++adv_policy_stable >= ADV_POLICY_STABLE_SAMPLES) {
+        adv_policy_stable = 0;
+        if (level + 1 < ADV_POLICY_LEVELS) {
+            level++;
+        }
+    }
+    if (level < min_level) {
+        level = min_level;
+    }
+
+    if (level == adv_policy_level) {
+        return FALSE;
+    }
+    adv_policy_level = level;
+    adv_policy_apply();
+
+#ifdef DEBUG
+    {
+        uint32_t model = adv_policy_model_na(level, awake_us);
+        uint32_t base = adv_policy_model_na(ADV_POLICY_DEFAULT_LEVEL, awake_us);
+
+        PRINT("Adv policy level %d: adv %d ms, sample %d s, model %d nA (default %d nA, saving %d%%)\n",
+              level, (int)(adv_policy_adv_interval() * 5 / 8),
+              (int)(adv_policy_sample_period() / 1600), (int)model, (int)base,
+              (int)(((int64_t)base - model) * 100 / base));
+    }
+#endif
+    return TRUE;
+}
@@ -0,0 +1,158 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : aes_ccm.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : AES-128 加密及 CCM 模式 (用于 BTHome 加密广播)
+ *******************************************************************************/
+
+#include "aes_ccm.h"
+#include <string.h>
+
+static const uint8_t aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+#define AES_XTIME(x)    ((uint8_t)(((x) << 1) ^ (((x) & 0x80) ? 0x1b : 0x00)))
+
+void aes128_init(aes128_ctx_t *ctx, const uint8_t *key)
+{
+    uint8_t *rk = ctx->round_key;
+    uint8_t rcon = 0x01;
+
+    memcpy(rk, key, AES_BLOCK_SIZE);
+
+    for (uint32_t i = AES_BLOCK_SIZE; i < sizeof(ctx->round_key); i += 4) {
+        uint8_t t0 = rk[i - 4], t1 = rk[i - 3], t2 = rk[i - 2], t3 = rk[i - 1];
+
+        if ((i % AES_BLOCK_SIZE) == 0) {
+            /* RotWord, SubWord, Rcon */
+            uint8_t tmp = t0;
+            t0 = aes_sbox[t1] ^ rcon;
+            t1 = aes_sbox[t2];
+            t2 = aes_sbox[t3];
+            t3 = aes_sbox[tmp];
+            rcon = AES_XTIME(rcon);
+        }
+
+        rk[i]     = rk[i - 16] ^ t0;
+        rk[i + 1] = rk[i - 15] ^ t1;
+        rk[i + 2] = rk[i - 14] ^ t2;
+        rk[i + 3] = rk[i - 13] ^ t3;
+    }
+}
+
+void aes128_encrypt(const aes128_ctx_t *ctx, const uint8_t *in, uint8_t *out)
+{
+    const uint8_t *rk = ctx->round_key;
+    uint8_t s[AES_BLOCK_SIZE];
+    uint8_t t[AES_BLOCK_SIZE];
+
+    for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+        s[i] = in[i] ^ rk[i];
+    }
+
+    for (int round = 1; round <= AES128_ROUNDS; round++) {
+        rk += AES_BLOCK_SIZE;
+
+        /* SubBytes and ShiftRows, state is column major */
+        for (int c = 0; c < 4; c++) {
+            t[4 * c]     = aes_sbox[s[4 * c]];
+            t[4 * c + 1] = aes_sbox[s[(4 * c + 5) & 15]];
+            t[4 * c + 2] = aes_sbox[s[(4 * c + 10) & 15]];
+            t[4 * c + 3] = aes_sbox[s[(4 * c + 15) & 15]];
+        }
+
+        if (round == AES128_ROUNDS) {
+            for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+                s[i] = t[i] ^ rk[i];
+            }
+            break;
+        }
+
+        /* MixColumns and AddRoundKey */
+        for (int c = 0; c < 4; c++) {
+            uint8_t a0 = t[4 * c], a1 = t[4 * c + 1], a2 = t[4 * c + 2], a3 = t[4 * c + 3];
+            uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+
+            s[4 * c]     = a0 ^ all ^ AES_XTIME(a0 ^ a1) ^ rk[4 * c];
+            s[4 * c + 1] = a1 ^ all ^ AES_XTIME(a1 ^ a2) ^ rk[4 * c + 1];
+            s[4 * c + 2] = a2 ^ all ^ AES_XTIME(a2 ^ a3) ^ rk[4 * c + 2];
+            s[4 * c + 3] = a3 ^ all ^ AES_XTIME(a3 ^ a0) ^ rk[4 * c + 3];
+        }
+    }
+
+    memcpy(out, s, AES_BLOCK_SIZE);
+}
+
+/**
+ * @brief   Build a CCM B0 / Ai block: flags | nonce | big endian counter.
+ */
+static void ccm_format_block(uint8_t *blk, uint8_t flags, const uint8_t *nonce,
+        uint8_t nonce_len, uint16_t value)
+{
+    memset(blk, 0, AES_BLOCK_SIZE);
+    blk[0] = flags;
+    memcpy(&blk[1], nonce, nonce_len);
+    blk[AES_BLOCK_SIZE - 2] = (uint8_t)(value >> 8);
+    blk[AES_BLOCK_SIZE - 1] = (uint8_t)value;
+}
+
+int aes_ccm_encrypt(const aes128_ctx_t *ctx, const uint8_t *nonce, uint8_t nonce_len,
+        const uint8_t *in, uint8_t len, uint8_t *out, uint8_t *mic, uint8_t mic_len)
+{
+    uint8_t l = AES_BLOCK_SIZE - 1 - nonce_len;    /* length field size */
+    uint8_t x[AES_BLOCK_SIZE];
+    uint8_t blk[AES_BLOCK_SIZE];
+
+    if (nonce_len < 7 || nonce_len > 13 || mic_len < 4 || mic_len > 16 || (mic_len & 1)) {
+        return -1;
+    }
+
+    /* CBC-MAC over B0 and the zero padded plain text */
+    ccm_format_block(x, (((mic_len - 2) / 2) << 3) | (l - 1), nonce, nonce_len, len);
+    aes128_encrypt(ctx, x, x);
+
+    for (uint8_t off = 0; off < len; off += AES_BLOCK_SIZE) {
+        uint8_t n = (len - off < AES_BLOCK_SIZE) ? (len - off) : AES_BLOCK_SIZE;
+
+        for (uint8_t i = 0; i < n; i++) {
+            x[i] ^= in[off + i];
+        }
+        aes128_encrypt(ctx, x, x);
+    }
+
+    /* CTR: A0 encrypts the MIC, A1.. encrypt the payload */
+    ccm_format_block(blk, l - 1, nonce, nonce_len, 0);
+    aes128_encrypt(ctx, blk, blk);
+    for (uint8_t i = 0; i < mic_len; i++) {
+        mic[i] = x[i] ^ blk[i];
+    }
+
+    for (uint8_t off = 0, ctr = 1; off < len; off += AES_BLOCK_SIZE, ctr++) {
+        uint8_t n = (len - off < AES_BLOCK_SIZE) ? (len - off) : AES_BLOCK_SIZE;
+
+        ccm_format_block(blk, l - 1, nonce, nonce_len, ctr);
+        aes128_encrypt(ctx, blk, blk);
+        for (uint8_t i = 0; i < n; i++) {
+            out[off + i] = in[off + i] ^ blk[i];
+        }
+    }
+
+    return 0;
+}
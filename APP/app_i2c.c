@@ -11,7 +11,7 @@
  *******************************************************************************/
 
 #include "app_i2c.h"
-#include "CH59x_common.h"
+#include "HAL.h"
 
 
 #ifdef CONFIG_I2C_DEBUG
@@ -19,14 +19,54 @@
 #else
 #define I2C_DBG(...)
 #endif
+
+#ifdef CONFIG_I2C_PROFILE
+#define I2C_PATH(p)     (i2c_isr_path = (p))
+#else
+#define I2C_PATH(p)
+#endif
+/* I2C task events */
+#define I2C_XFER_DONE_EVT   0x0001      // transfers completed, send the completion messages
+#define I2C_TIMEOUT_EVT     0x0002      // check the deadline of the transfer on the bus
+#define I2C_IDLE_EVT        0x0004      // queue drained, gate the peripheral clock
+#define I2C_SLAVE_WAKE_EVT  0x0008      // SDA edge woke the core for a host access
+#define I2C_SLAVE_IDLE_EVT  0x0010      // end of the host access window
+
+/* Time the core stays out of sleep after a host access starts (units of 625us) */
+#define I2C_EXPORT_WAKE_WINDOW  MS1_TO_SYSTEM_TIME(20)
+
+/* Transfer deadline: fixed part plus a clock stretching allowance per byte */
+#define I2C_TIMEOUT_BASE_US     1000
+#define I2C_TIMEOUT_BYTE_US     100
+#define I2C_TIMEOUT_RTC(bytes)  \
+    ((I2C_TIMEOUT_BASE_US + (uint32_t)(bytes) * I2C_TIMEOUT_BYTE_US) * (FREQ_RTC / 64) / (1000000 / 64))
+/* Deadline check period while async transfers are pending (units of 625us) */
+#define I2C_TIMEOUT_CHECK_PERIOD    2
+/* Retry of the clock gating while the bus is still busy (units of 625us) */
+#define I2C_IDLE_RETRY_PERIOD   2
+#define I2C_IDLE_RETRY_MAX      8
+/* Wake on the host START only in sleep builds that export registers
+ * (SBP_I2C_EXPORT), GPIOB_IRQHandler is left to the application otherwise */
+#if (defined(HAL_SLEEP)) && (HAL_SLEEP == TRUE) && (SBP_I2C_EXPORT == TRUE)
+#define I2C_EXPORT_WAKE         TRUE
+#else
+#define I2C_EXPORT_WAKE         FALSE
+#endif
+/* I2C clock gate of PWR_PeriphClkCfg(): RB_SLP_CLK_I2C is a bit of
+ * R8_SLP_CLK_OFF1, the second byte of R32_SLEEP_CONTROL */
+#define I2C_SLP_CLK_BIT         ((uint16_t)RB_SLP_CLK_I2C << 8)
+
 static volatile uint8_t i2c_state;
 static volatile uint8_t i2c_slave_addr_rw;
 static volatile uint8_t i2c_send_stop;  // should the transaction end with a stop
 static volatile uint8_t i2c_in_repstart;     // in the middle of a repeated start
+static volatile uint8_t i2c_wait_sb;    // async message START sent, SB not seen yet
+static uint8_t i2c_idle_retries;     // I2C_IDLE_EVT retries left
 
 static uint8_t i2c_master_buffer[I2C_BUFFER_LENGTH];
-static volatile uint8_t i2c_master_buffer_index;
-static uint8_t i2c_master_buffer_length;
+static uint8_t *i2c_master_data;    // i2c_master_buffer, or the caller buffer of an async transfer
+static volatile uint16_t i2c_master_buffer_index;
+static uint16_t i2c_master_buffer_length;
 
 static uint8_t i2c_slave_txbuffer[I2C_BUFFER_LENGTH];
 static volatile uint8_t i2c_slave_txbuffer_index;
@@ -38,19 +78,65 @@ static volatile uint8_t i2c_slave_rxbuffer_index;
 static uint8_t is_nack_sent = false;
 
 static volatile uint8_t i2c_error;
+static uint16_t i2c_error_count[I2C_ERROR_MAX];
+static uint16_t i2c_recover_count;
+
+/* RTC deadline of the transaction on the bus */
+static volatile uint32_t i2c_deadline_start;
+static volatile uint32_t i2c_deadline_ticks;
+
+static uint8_t i2c_own_addr;
+
+/* Peripheral clock gating and bring-up cost */
+static uint8_t i2c_configured;
+static uint8_t i2c_clk_on;
+static uint32_t i2c_clk_on_stamp;
+static i2c_power_stats_t i2c_power;
 
 static struct i2c_slave_cb *slave_cb = NULL;
 
-void i2c_app_init(uint8_t address)
+/* Register mode export: register pointer and the snapshot latched by a read */
+static i2c_export_t *i2c_export;
+static uint8_t i2c_export_reg;
+static const uint8_t *i2c_export_src;
+
+#ifdef CONFIG_I2C_PROFILE
+static i2c_isr_profile_t i2c_profile;
+static uint8_t i2c_isr_path;            // last path taken by the current interrupt
+
+#ifdef DEBUG
+static const char *const i2c_path_name[I2C_PATH_MAX] = {
+    "none", "m start", "m tx data", "m tx stop", "m tx restart", "m tx nack",
+    "m rx addr", "m rx data", "m rx stop", "m rx restart", "m rx nack",
+    "s tx addr", "s tx data", "s tx nack", "s rx addr", "s rx data", "s rx stop",
+    "error",
+};
+#endif
+#endif
+
+static tmosTaskID i2c_task_id = INVALID_TASK_ID;
+static i2c_xfer_t *volatile i2c_xfer_active;    // async transfer on the bus
+static uint8_t i2c_xfer_msg;            // index of its message on the bus
+static i2c_xfer_t *i2c_xfer_head;       // pending async transfers
+static i2c_xfer_t *i2c_xfer_tail;
+static i2c_xfer_t *i2c_done_head;       // finished, completion message not sent yet
+static i2c_xfer_t *i2c_done_tail;
+
+static tmosEvents i2c_process_event(tmosTaskID task_id, tmosEvents events);
+
+/* Program the peripheral and its interrupt */
+static void i2c_hw_init(void)
 {
     i2c_state = I2C_READY;
     i2c_send_stop = true;
     i2c_in_repstart = false;
+    i2c_wait_sb = false;
+    is_nack_sent = false;
 
     // GPIOB_ModeCfg(GPIO_Pin_14 | GPIO_Pin_15, GPIO_ModeIN_PU);
 
-    I2C_Init(I2C_Mode_I2C, 400000, I2C_DutyCycle_16_9, I2C_Ack_Enable,
-            I2C_AckAddr_7bit, address);
+    I2C_Init(I2C_Mode_I2C, I2C_CLOCK_SPEED, I2C_DutyCycle_16_9, I2C_Ack_Enable,
+            I2C_AckAddr_7bit, i2c_own_addr);
 
     I2C_ITConfig(I2C_IT_BUF, ENABLE);
     I2C_ITConfig(I2C_IT_EVT, ENABLE);
@@ -59,9 +145,277 @@ void i2c_app_init(uint8_t address)
     PFIC_EnableIRQ(I2C_IRQn);
 }
 
+__HIGH_CODE
+static void i2c_set_error(uint8_t error)
+{
+    i2c_error = error;
+    if (i2c_error_count[error] < 0xffff) {
+        i2c_error_count[error]++;
+    }
+}
+
+__HIGH_CODE
+static void i2c_deadline_set(uint16_t bytes)
+{
+    i2c_deadline_start = RTC_GetCycle32k();
+    i2c_deadline_ticks = I2C_TIMEOUT_RTC(bytes);
+}
+
+static uint32_t rtc_ticks_since(uint32_t start)
+{
+    uint32_t now = RTC_GetCycle32k();
+
+    if (now < start) {
+        now += RTC_MAX_COUNT;
+    }
+    return now - start;
+}
+
+static uint8_t i2c_deadline_expired(void)
+{
+    return rtc_ticks_since(i2c_deadline_start) >= i2c_deadline_ticks;
+}
+
+/*
+ * Free a bus held by a slave: with the peripheral off, clock out up to 9
+ * SCL pulses as GPIO until SDA is released, send STOP, then reset and
+ * re-init the peripheral. SCL/SDA are driven low as outputs and released
+ * as pulled up inputs, so they behave like open drain.
+ */
+static void i2c_bus_recover(void)
+{
+    uint8_t i;
+
+    PFIC_DisableIRQ(I2C_IRQn);
+    I2C_Cmd(DISABLE);
+
+    GPIOB_ResetBits(bSCL | bSDA);
+    GPIOB_ModeCfg(bSCL | bSDA, GPIO_ModeIN_PU);
+    mDelayuS(5);
+
+    for (i = 0; i < 9 && !GPIOB_ReadPortPin(bSDA); i++) {
+        GPIOB_ModeCfg(bSCL, GPIO_ModeOut_PP_5mA);
+        mDelayuS(5);
+        GPIOB_ModeCfg(bSCL, GPIO_ModeIN_PU);
+        mDelayuS(5);
+    }
+
+    /* STOP: SDA rises while SCL is high */
+    GPIOB_ModeCfg(bSCL, GPIO_ModeOut_PP_5mA);
+    mDelayuS(5);
+    GPIOB_ModeCfg(bSDA, GPIO_ModeOut_PP_5mA);
+    mDelayuS(5);
+    GPIOB_ModeCfg(bSCL, GPIO_ModeIN_PU);
+    mDelayuS(5);
+    GPIOB_ModeCfg(bSDA, GPIO_ModeIN_PU);
+    mDelayuS(5);
+
+    I2C_SoftwareResetCmd(ENABLE);
+    I2C_SoftwareResetCmd(DISABLE);
+    i2c_hw_init();
+
+    if (i2c_recover_count < 0xffff) {
+        i2c_recover_count++;
+    }
+    PRINT("I2C bus recovered, SDA released after %d clocks\n", i);
+}
+
+/* Whether the configuration did not survive, checked with the clock running */
+static uint8_t i2c_config_lost(void)
+{
+    return !(R16_I2C_CTRL1 & RB_I2C_PE)
+        || (R16_I2C_CTRL2 & RB_I2C_FREQ) != (GetSysClock() / 1000000)
+        || (R16_I2C_CTRL2 & (I2C_IT_BUF | I2C_IT_EVT | I2C_IT_ERR))
+            != (I2C_IT_BUF | I2C_IT_EVT | I2C_IT_ERR);
+}
+
+/*
+ * Ungate the peripheral clock and re-apply only what was lost: normally
+ * the registers survive sleep and only the interrupt is re-enabled.
+ */
+static void i2c_resume(void)
+{
+    uint32_t start;
+
+    if (i2c_clk_on) {
+        return;
+    }
+    start = SYS_GetSysTickCnt();
+
+    PWR_PeriphClkCfg(ENABLE, I2C_SLP_CLK_BIT);
+    i2c_clk_on = true;
+    i2c_clk_on_stamp = RTC_GetCycle32k();
+
+    if (i2c_config_lost()) {
+        i2c_hw_init();
+        i2c_power.reinits++;
+    } else {
+        PFIC_EnableIRQ(I2C_IRQn);
+    }
+    i2c_power.resumes++;
+    i2c_power.resume_cycles = SYS_GetSysTickCnt() - start;
+}
+
+static void i2c_master_done(void);
+
+/* The transaction on the bus missed its deadline: recover and move on */
+static void i2c_timeout_abort(void)
+{
+    uint32_t irq_status;
+
+    i2c_set_error(I2C_TIMEOUT);
+    i2c_bus_recover();
+
+    SYS_DisableAllIrq(&irq_status);
+    i2c_master_done();
+    SYS_RecoverIrq(irq_status);
+}
+
+void i2c_app_init(uint8_t address)
+{
+    uint32_t start;
+
+    if (i2c_configured && address == i2c_own_addr) {
+        i2c_resume();
+        return;
+    }
+
+    start = SYS_GetSysTickCnt();
+    if (!i2c_clk_on) {
+        PWR_PeriphClkCfg(ENABLE, I2C_SLP_CLK_BIT);
+        i2c_clk_on = true;
+        i2c_clk_on_stamp = RTC_GetCycle32k();
+    }
+    i2c_own_addr = address;
+    i2c_hw_init();
+    i2c_configured = true;
+    i2c_power.init_cycles = SYS_GetSysTickCnt() - start;
+
+    if (i2c_task_id == INVALID_TASK_ID) {
+        i2c_task_id = TMOS_ProcessEventRegister(i2c_process_event);
+    }
+}
+
 void i2c_slave_cb_register(struct i2c_slave_cb *cb)
 {
    slave_cb = cb;
+   if (cb) {
+       i2c_resume();
+   }
+}
+
+int i2c_app_suspend(void)
+{
+    uint32_t irq_status;
+
+    SYS_DisableAllIrq(&irq_status);
+    if (!i2c_clk_on || slave_cb || i2c_export || i2c_xfer_active || i2c_xfer_head) {
+        SYS_RecoverIrq(irq_status);
+        return 0;
+    }
+    /* STOP still on the wire, or another master on the bus */
+    if (i2c_state != I2C_READY || i2c_in_repstart || (R16_I2C_STAR2 & RB_I2C_BUSY)) {
+        SYS_RecoverIrq(irq_status);
+        return -I2C_STATE;
+    }
+    PFIC_DisableIRQ(I2C_IRQn);
+    PWR_PeriphClkCfg(DISABLE, I2C_SLP_CLK_BIT);
+    i2c_clk_on = false;
+    SYS_RecoverIrq(irq_status);
+
+    i2c_power.clk_on_ticks += rtc_ticks_since(i2c_clk_on_stamp);
+    return 0;
+}
+
+/*
+ * While exporting with sleep enabled, a falling edge on SDA (the host's
+ * START) wakes the core. Disarmed while we are master on the bus, our
+ * own transfers would trigger it too.
+ */
+static void i2c_export_arm(void)
+{
+#if (I2C_EXPORT_WAKE == TRUE)
+    if (i2c_export) {
+        GPIOB_ITModeCfg(bSDA, GPIO_ITMode_FallEdge);
+    }
+#endif
+}
+
+static void i2c_export_disarm(void)
+{
+#if (I2C_EXPORT_WAKE == TRUE)
+    R16_PB_INT_EN &= ~bSDA;
+#endif
+}
+
+int i2c_export_enable(i2c_export_t *exp)
+{
+    if (exp && (!exp->buf[0] || !exp->buf[1] || !exp->len)) {
+        return -I2C_NO_MEM;
+    }
+    if (!i2c_configured) {
+        return -I2C_STATE;
+    }
+
+    i2c_export_disarm();
+    if (exp) {
+        exp->front = 0;
+        exp->reading = I2C_EXPORT_NONE;
+    }
+    i2c_export_reg = 0;
+    i2c_export = exp;
+
+    if (exp) {
+        i2c_resume();
+#if (I2C_EXPORT_WAKE == TRUE)
+        sys_safe_access_enable();
+        R8_SLP_WAKE_CTRL |= RB_SLP_GPIO_WAKE;
+        sys_safe_access_disable();
+        PFIC_EnableIRQ(GPIO_B_IRQn);
+#endif
+        i2c_export_arm();
+    }
+    return 0;
+}
+
+uint8_t *i2c_export_begin(void)
+{
+    uint8_t back = i2c_export->front ^ 1;
+
+    /* still being read by the host from before the last publish */
+    if (i2c_export->reading == back) {
+        return NULL;
+    }
+    return i2c_export->buf[back];
+}
+
+void i2c_export_publish(void)
+{
+    i2c_export->front ^= 1;
+}
+
+/*
+ * Start the prepared transaction: send START, or finish the repeated start
+ * left pending by the ISR by sending the address and enabling the
+ * interrupts again.
+ */
+static void i2c_master_begin(void)
+{
+    i2c_export_disarm();
+    I2C_GenerateSTOP(DISABLE);
+
+    if (i2c_in_repstart == true) {
+        i2c_in_repstart = false;
+
+        do {
+            I2C_SendData(i2c_slave_addr_rw);
+        } while(R16_I2C_CTRL1 & RB_I2C_BTF);
+
+        /* Disabled in IRS */
+        I2C_ITConfig(I2C_IT_BUF | I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+    } else {
+        I2C_GenerateSTART(ENABLE);
+    }
 }
 
 int i2c_write_to(uint8_t addr_7bit, const uint8_t *data, uint8_t length,
@@ -79,6 +433,7 @@ int i2c_write_to(uint8_t addr_7bit, const uint8_t *data, uint8_t length,
         return 0;
     }
 
+    i2c_resume();
     i2c_state = I2C_MTX;
     i2c_send_stop = send_stop;
 
@@ -89,29 +444,19 @@ int i2c_write_to(uint8_t addr_7bit, const uint8_t *data, uint8_t length,
     i2c_master_buffer_length = length;
 
     memcpy(i2c_master_buffer, data, length);
+    i2c_master_data = i2c_master_buffer;
 
     i2c_slave_addr_rw = I2C_WRITE;
     i2c_slave_addr_rw |= addr_7bit << 1;
 
-    I2C_GenerateSTOP(DISABLE);
-
-    if (i2c_in_repstart == true) {
-        i2c_in_repstart = false;
-
-        do {
-            I2C_SendData(i2c_slave_addr_rw);
-        } while(R16_I2C_CTRL1 & RB_I2C_BTF);
-
-        /* Disabled in IRS */
-        I2C_ITConfig(I2C_IT_BUF, ENABLE);
-        I2C_ITConfig(I2C_IT_EVT, ENABLE);
-        I2C_ITConfig(I2C_IT_ERR, ENABLE);
-    } else {
-        I2C_GenerateSTART(ENABLE);
-    }
+    i2c_deadline_set(length);
+    i2c_master_begin();
 
     while(wait && (i2c_state == I2C_MTX)) {
-        continue;
+        if (i2c_deadline_expired()) {
+            i2c_timeout_abort();
+            break;
+        }
     }
 
     if (i2c_error) {
@@ -124,7 +469,6 @@ int i2c_write_to(uint8_t addr_7bit, const uint8_t *data, uint8_t length,
 int i2c_read_from(uint8_t addr_7bit, uint8_t *data, uint8_t length,
         uint8_t send_stop, int timeout)
 {
-    int to = 0;
     uint8_t forever = (timeout == -1);
 
     if (length > I2C_BUFFER_LENGTH) {
@@ -139,6 +483,7 @@ int i2c_read_from(uint8_t addr_7bit, uint8_t *data, uint8_t length,
         return 0;
     }
 
+    i2c_resume();
     i2c_state = I2C_MRX;
     i2c_send_stop = send_stop;
 
@@ -147,33 +492,21 @@ int i2c_read_from(uint8_t addr_7bit, uint8_t *data, uint8_t length,
     // initialize buffer iteration vars
     i2c_master_buffer_index = 0;
     i2c_master_buffer_length = length - 1;
+    i2c_master_data = i2c_master_buffer;
 
     i2c_slave_addr_rw = I2C_READ;
     i2c_slave_addr_rw |= addr_7bit << 1;
 
-    I2C_GenerateSTOP(DISABLE);
-
-    if (i2c_in_repstart == true) {
-        i2c_in_repstart = false;
-
-        do {
-            I2C_SendData(i2c_slave_addr_rw);
-        } while(R16_I2C_CTRL1 & RB_I2C_BTF);
-
-        /* Disabled in IRS */
-        I2C_ITConfig(I2C_IT_BUF, ENABLE);
-        I2C_ITConfig(I2C_IT_EVT, ENABLE);
-        I2C_ITConfig(I2C_IT_ERR, ENABLE);
-    } else {
-        I2C_GenerateSTART(ENABLE);
-    }
+    /* timeout in ms replaces the byte based deadline */
+    i2c_deadline_start = RTC_GetCycle32k();
+    i2c_deadline_ticks = (uint32_t)timeout * (FREQ_RTC / 8) / 125;
+    i2c_master_begin();
 
     // wait for read operation to complete
     while (i2c_state == I2C_MRX) {
-        mDelaymS(1);
-        to++;
-        if (!forever && (to >= timeout)) {
-            break;
+        if (!forever && i2c_deadline_expired()) {
+            i2c_timeout_abort();
+            return -I2C_TIMEOUT;
         }
     }
 
@@ -186,6 +519,357 @@ int i2c_read_from(uint8_t addr_7bit, uint8_t *data, uint8_t length,
     return length;
 }
 
+/* Load one message of the active transfer into the master state machine */
+__HIGH_CODE
+static void i2c_xfer_load_msg(void)
+{
+    struct i2c_msg *msg = &i2c_xfer_active->msgs[i2c_xfer_msg];
+
+    i2c_error = 0;
+    is_nack_sent = false;
+    /* STOP only after the last message, repeated START in between */
+    i2c_send_stop = (i2c_xfer_msg + 1 >= i2c_xfer_active->num);
+
+    i2c_master_data = msg->buf;
+    i2c_master_buffer_index = 0;
+
+    if (msg->flags & I2C_M_RD) {
+        i2c_state = I2C_MRX;
+        i2c_master_buffer_length = msg->len - 1;
+        i2c_slave_addr_rw = I2C_READ | (msg->addr << 1);
+    } else {
+        i2c_state = I2C_MTX;
+        i2c_master_buffer_length = msg->len;
+        i2c_slave_addr_rw = I2C_WRITE | (msg->addr << 1);
+    }
+}
+
+/*
+ * Master addressed the bus: send the address and let the event and buffer
+ * interrupts carry the message from here on.
+ */
+__HIGH_CODE
+static void i2c_master_sb(void)
+{
+    i2c_wait_sb = false;
+    I2C_SendData(i2c_slave_addr_rw);
+    I2C_ITConfig(I2C_IT_BUF, ENABLE);
+}
+
+/*
+ * Send START for the loaded message and return, the SB interrupt sends
+ * the address. The buffer interrupt stays off until then: TxE of a
+ * finished write stays set until the START goes out and must not reach
+ * the handlers ahead of SB. If SB never comes, the transfer deadline
+ * recovers the bus and re-enables it.
+ */
+__HIGH_CODE
+static void i2c_master_start(void)
+{
+    I2C_ITConfig(I2C_IT_BUF, DISABLE);
+    i2c_wait_sb = true;
+    I2C_GenerateSTART(ENABLE);
+}
+
+/* Make an async transfer active and send START for its first message */
+__HIGH_CODE
+static void i2c_xfer_start(i2c_xfer_t *xfer)
+{
+    uint16_t bytes = 0;
+
+    for (uint8_t i = 0; i < xfer->num; i++) {
+        bytes += xfer->msgs[i].len + 1;
+    }
+    i2c_deadline_set(bytes);
+
+    i2c_xfer_active = xfer;
+    i2c_xfer_msg = 0;
+    i2c_xfer_load_msg();
+
+    i2c_master_start();
+}
+
+/*
+ * Called from the ISR at the end of a message sent without STOP. An async
+ * transfer goes on with its next message from the SB interrupt. A blocking
+ * caller gets the bus back with START pending and sends the address itself.
+ */
+__HIGH_CODE
+static void i2c_master_restart(void)
+{
+    if (i2c_xfer_active) {
+        i2c_xfer_active->done++;
+        i2c_xfer_msg++;
+        i2c_xfer_load_msg();
+        i2c_master_start();
+        return;
+    }
+
+    i2c_in_repstart = true;
+    /* we're gonna send the START, don't enable the interrupt. */
+    I2C_ITConfig(I2C_IT_BUF | I2C_IT_EVT | I2C_IT_ERR, DISABLE);
+    I2C_GenerateSTART(ENABLE);
+    i2c_state = I2C_READY;
+}
+
+/* Start the next queued async transfer, returns false if there is none */
+__HIGH_CODE
+static uint8_t i2c_xfer_next(void)
+{
+    i2c_xfer_t *xfer = i2c_xfer_head;
+
+    if (!xfer) {
+        return false;
+    }
+    i2c_xfer_head = xfer->next;
+    if (!i2c_xfer_head) {
+        i2c_xfer_tail = NULL;
+    }
+    i2c_xfer_start(xfer);
+    return true;
+}
+
+/*
+ * Called from the ISR when a master transaction ended with STOP: retire the
+ * async transfer, if any, and start the next queued one right away so that
+ * back to back transfers need no task in between.
+ */
+__HIGH_CODE
+static void i2c_master_done(void)
+{
+    i2c_xfer_t *xfer = i2c_xfer_active;
+
+    /* a read ends with ACK off, which would NACK our own slave address */
+    I2C_AcknowledgeConfig(ENABLE);
+
+    if (xfer) {
+        i2c_xfer_active = NULL;
+        xfer->status = i2c_error;
+        xfer->actual = i2c_master_buffer_index;
+        if (!i2c_error) {
+            xfer->done++;
+        }
+        xfer->next = NULL;
+
+        if (xfer->task_id == INVALID_TASK_ID) {
+            /* i2c_transfer() is polling */
+            xfer->busy = false;
+        } else {
+            if (i2c_done_tail) {
+                i2c_done_tail->next = xfer;
+            } else {
+                i2c_done_head = xfer;
+            }
+            i2c_done_tail = xfer;
+            tmos_set_event(i2c_task_id, I2C_XFER_DONE_EVT);
+        }
+    }
+
+    if (!i2c_xfer_next()) {
+        /* a START that never got its SB left the slave without TxE/RxNE */
+        i2c_wait_sb = false;
+        I2C_ITConfig(I2C_IT_BUF, ENABLE);
+        HAL_SleepRelease(HAL_SLEEP_HOLD_I2C);
+        i2c_idle_retries = I2C_IDLE_RETRY_MAX;
+        tmos_set_event(i2c_task_id, I2C_IDLE_EVT);
+    }
+}
+
+int i2c_submit(i2c_xfer_t *xfer)
+{
+    uint32_t irq_status;
+
+    for (uint8_t i = 0; i < xfer->num; i++) {
+        if (!xfer->msgs[i].len || !xfer->msgs[i].buf) {
+            return -I2C_NO_MEM;
+        }
+    }
+    if (!xfer->num) {
+        return -I2C_NO_MEM;
+    }
+    if (i2c_task_id == INVALID_TASK_ID) {
+        return -I2C_STATE;
+    }
+
+    xfer->next = NULL;
+    xfer->status = 0;
+    xfer->actual = 0;
+    xfer->done = 0;
+    xfer->busy = true;
+
+    i2c_resume();
+    i2c_export_disarm();
+    SYS_DisableAllIrq(&irq_status);
+    HAL_SleepHold(HAL_SLEEP_HOLD_I2C);
+    if (i2c_state == I2C_READY && !i2c_in_repstart && !i2c_xfer_active) {
+        I2C_GenerateSTOP(DISABLE);
+        i2c_xfer_start(xfer);
+    } else {
+        /* started by the ISR when the bus is released */
+        if (i2c_xfer_tail) {
+            i2c_xfer_tail->next = xfer;
+        } else {
+            i2c_xfer_head = xfer;
+        }
+        i2c_xfer_tail = xfer;
+    }
+    SYS_RecoverIrq(irq_status);
+
+    /* async transfers are checked against their deadline by the task */
+    if (xfer->task_id != INVALID_TASK_ID) {
+        tmos_start_task(i2c_task_id, I2C_TIMEOUT_EVT, I2C_TIMEOUT_CHECK_PERIOD);
+    }
+
+    return 0;
+}
+
+int i2c_transfer(struct i2c_msg *msgs, uint8_t num)
+{
+    i2c_xfer_t xfer;
+    int ret;
+
+    /* the repeated start pending for a blocking caller is only finished by it */
+    if (i2c_in_repstart) {
+        return -I2C_STATE;
+    }
+
+    xfer.msgs = msgs;
+    xfer.num = num;
+    xfer.task_id = INVALID_TASK_ID;
+
+    ret = i2c_submit(&xfer);
+    if (ret != 0) {
+        return ret;
+    }
+    /* the deadline is set when a transfer starts: queued behind a host
+     * access nothing is on the bus yet, behind an async transfer that one
+     * is held to its own deadline, ours starts when it is done */
+    while (xfer.busy) {
+        if (i2c_xfer_active && i2c_deadline_expired()) {
+            i2c_timeout_abort();
+        }
+    }
+
+    if (xfer.status) {
+        return -xfer.status;
+    }
+    return xfer.done;
+}
+
+/* Deliver the completion messages of finished transfers to their tasks */
+static tmosEvents i2c_process_event(tmosTaskID task_id, tmosEvents events)
+{
+    if (events & SYS_EVENT_MSG) {
+        uint8_t *msg;
+
+        if ((msg = tmos_msg_receive(task_id)) != NULL) {
+            tmos_msg_deallocate(msg);
+        }
+        return (events ^ SYS_EVENT_MSG);
+    }
+
+    if (events & I2C_XFER_DONE_EVT) {
+        uint32_t irq_status;
+        i2c_xfer_t *xfer;
+        i2c_done_msg_t *msg;
+
+        while (i2c_done_head) {
+            msg = (i2c_done_msg_t *)tmos_msg_allocate(sizeof(i2c_done_msg_t));
+            if (msg == NULL) {
+                /* out of message memory, retry on the next tick */
+                tmos_start_task(task_id, I2C_XFER_DONE_EVT, 1);
+                break;
+            }
+
+            SYS_DisableAllIrq(&irq_status);
+            xfer = i2c_done_head;
+            i2c_done_head = xfer->next;
+            if (!i2c_done_head) {
+                i2c_done_tail = NULL;
+            }
+            SYS_RecoverIrq(irq_status);
+
+            msg->hdr.event = I2C_XFER_DONE_MSG;
+            msg->hdr.status = xfer->status;
+            msg->xfer = xfer;
+            tmos_msg_send(xfer->task_id, (uint8_t *)msg);
+        }
+        return (events ^ I2C_XFER_DONE_EVT);
+    }
+
+    if (events & I2C_TIMEOUT_EVT) {
+        if ((i2c_state == I2C_MTX || i2c_state == I2C_MRX) && i2c_deadline_expired()) {
+            PRINT("I2C transfer timeout\n");
+            i2c_timeout_abort();
+        }
+        if (i2c_xfer_active || i2c_xfer_head) {
+            tmos_start_task(task_id, I2C_TIMEOUT_EVT, I2C_TIMEOUT_CHECK_PERIOD);
+        }
+        return (events ^ I2C_TIMEOUT_EVT);
+    }
+
+    if (events & I2C_IDLE_EVT) {
+        /* bus not released yet: try again shortly instead of leaving the clock on */
+        if (i2c_app_suspend() == -I2C_STATE && i2c_idle_retries) {
+            i2c_idle_retries--;
+            tmos_start_task(task_id, I2C_IDLE_EVT, I2C_IDLE_RETRY_PERIOD);
+        }
+        i2c_export_arm();
+        return (events ^ I2C_IDLE_EVT);
+    }
+
+    if (events & I2C_SLAVE_WAKE_EVT) {
+        tmos_start_task(task_id, I2C_SLAVE_IDLE_EVT, I2C_EXPORT_WAKE_WINDOW);
+        return (events ^ I2C_SLAVE_WAKE_EVT);
+    }
+
+    if (events & I2C_SLAVE_IDLE_EVT) {
+        if (i2c_state == I2C_SRX || i2c_state == I2C_STX || (R16_I2C_STAR2 & RB_I2C_BUSY)) {
+            tmos_start_task(task_id, I2C_SLAVE_IDLE_EVT, I2C_EXPORT_WAKE_WINDOW);
+        } else {
+            HAL_SleepRelease(HAL_SLEEP_HOLD_I2C_SLAVE);
+            if (!i2c_xfer_active && !i2c_xfer_head) {
+                i2c_export_arm();
+            }
+        }
+        return (events ^ I2C_SLAVE_IDLE_EVT);
+    }
+
+    return 0;
+}
+
+void i2c_stats_get(i2c_stats_t *stats)
+{
+    memcpy(stats->errors, i2c_error_count, sizeof(stats->errors));
+    stats->recoveries = i2c_recover_count;
+}
+
+void i2c_stats_print(void)
+{
+    PRINT("I2C errors: nack %d, arb %d, bus %d, ovr %d, timeout %d, recover %d\n",
+          i2c_error_count[I2C_MT_NACK], i2c_error_count[I2C_ARB_LOST],
+          i2c_error_count[I2C_BUS_ERROR], i2c_error_count[I2C_OVR],
+          i2c_error_count[I2C_TIMEOUT], i2c_recover_count);
+}
+
+void i2c_power_stats_get(i2c_power_stats_t *stats)
+{
+    *stats = i2c_power;
+    if (i2c_clk_on) {
+        stats->clk_on_ticks += rtc_ticks_since(i2c_clk_on_stamp);
+    }
+}
+
+void i2c_power_stats_print(void)
+{
+    i2c_power_stats_t stats;
+
+    i2c_power_stats_get(&stats);
+    PRINT("I2C power: init %d cycles, resume %d cycles (%d resumes, %d re-inits), clock on %d ms\n",
+          (int)stats.init_cycles, (int)stats.resume_cycles, (int)stats.resumes,
+          (int)stats.reinits, (int)(stats.clk_on_ticks * 1000 / FREQ_RTC));
+}
+
 #ifdef CONFIG_I2C_DEBUG
 static void print_i2c_irq_sta(uint32_t state)
 {
@@ -243,380 +927,417 @@ static inline void print_i2c_irq_sta(uint32_t state)
 }
 #endif
 
-__INTERRUPT
-__HIGH_CODE
-void I2C_IRQHandler(void)
+#ifdef CONFIG_I2C_PROFILE
+void i2c_isr_profile_get(i2c_isr_profile_t *profile)
 {
-    uint32_t event = I2C_GetLastEvent();
-    print_i2c_irq_sta(event);
+    uint32_t irq_status;
 
-    /* I2C Master */
-    if (event & (RB_I2C_MSL << 16)) {
-        if (event & RB_I2C_SB) {
-            /* Start condition sent, send address */
-            I2C_SendData(i2c_slave_addr_rw);
-            I2C_DBG("Master selected, send address\n");
+    SYS_DisableAllIrq(&irq_status);
+    *profile = i2c_profile;
+    SYS_RecoverIrq(irq_status);
+}
+
+void i2c_isr_profile_reset(void)
+{
+    uint32_t irq_status;
+
+    SYS_DisableAllIrq(&irq_status);
+    memset(&i2c_profile, 0, sizeof(i2c_profile));
+    SYS_RecoverIrq(irq_status);
+}
+
+void i2c_isr_profile_print(void)
+{
+#ifdef DEBUG
+    i2c_isr_profile_t profile;
+
+    i2c_isr_profile_get(&profile);
+    PRINT("I2C ISR paths (cycles):\n");
+    for (uint8_t i = 0; i < I2C_PATH_MAX; i++) {
+        if (profile.hits[i]) {
+            PRINT("  %-12s %6d hits, avg %d, max %d\n", i2c_path_name[i],
+                  (int)profile.hits[i], (int)(profile.cycles_total[i] / profile.hits[i]),
+                  (int)profile.cycles_max[i]);
         }
+    }
+#endif
+}
 
-        /* I2C Master transmitter */
-        if (event & (RB_I2C_TRA << 16)) {
-            I2C_DBG("Master transmitter:\n");
-            /* Slave receiver acked address or sent bit */
-            if (event & (RB_I2C_ADDR | RB_I2C_BTF | RB_I2C_TxE | (RB_I2C_TRA << 16))) {
-                /* if there is data to send, send it, otherwise stop */
-                if (i2c_master_buffer_index < i2c_master_buffer_length) {
-                    I2C_SendData(i2c_master_buffer[i2c_master_buffer_index++]);
-                    I2C_DBG("  send (%#x)\n", 
-                            i2c_master_buffer[i2c_master_buffer_index - 1]);
-                } else {
-                    if (i2c_send_stop) {
-                        i2c_state = I2C_READY;
-                        I2C_GenerateSTOP(ENABLE);
-                        I2C_DBG("  send STOP\n");
-                    } else {
-                        i2c_in_repstart = true;
-                        /* we're gonna send the START, don't enable the interrupt. */
-                        I2C_ITConfig(I2C_IT_BUF, DISABLE);
-                        I2C_ITConfig(I2C_IT_EVT, DISABLE);
-                        I2C_ITConfig(I2C_IT_ERR, DISABLE);
-                        I2C_GenerateSTART(ENABLE);
-                        i2c_state = I2C_READY;
-                        I2C_DBG("  restart\n");
-                    }
-                }
-            }
+/* Charge one interrupt to the last path it took */
+__HIGH_CODE
+static void i2c_profile_record(uint8_t path, uint32_t start)
+{
+    uint32_t cycles = *(volatile uint32_t *)&SysTick->CNT - start;
 
-            /* Address or data sent, nack received */
-            if (event & RB_I2C_AF) {
-                I2C_ClearFlag(I2C_FLAG_AF);
+    i2c_profile.hits[path]++;
+    i2c_profile.cycles_total[path] += cycles;
+    if (cycles > i2c_profile.cycles_max[path]) {
+        i2c_profile.cycles_max[path] = cycles;
+    }
+}
+#endif
 
-                i2c_error = I2C_MT_NACK;
-                i2c_state = I2C_READY;
-                I2C_GenerateSTOP(ENABLE);
-                I2C_DBG("  NACK received, sent stop\n");
-            }
-        } else {
-        /* I2C Master reveiver */
-            I2C_DBG("Master receiver:\n");
-
-            /* address sent, ack received */
-            if(event & RB_I2C_ADDR) { 
-                /* ack if more bytes are expected, otherwise nack */
-                if (i2c_master_buffer_length) {
-                    I2C_AcknowledgeConfig(ENABLE);
-                    I2C_DBG("  address sent\n");
-                    I2C_DBG("  ACK next\n");
-                } else {
-                    //XXX: Should not delay too match before NACK 
-                    I2C_AcknowledgeConfig(DISABLE);
-                    is_nack_sent = true;
-                    I2C_DBG("  address sent\n");
-                    I2C_DBG("  NACK next\n");
-                }
-            }
+/*
+ * The last byte of a master message went out or came in: end with STOP,
+ * or continue with the next message through a repeated start.
+ */
+__HIGH_CODE
+static void i2c_master_finish(void)
+{
+    if (i2c_send_stop) {
+        i2c_state = I2C_READY;
+        I2C_GenerateSTOP(ENABLE);
+        I2C_DBG("  send STOP\n");
+        i2c_master_done();
+    } else {
+        i2c_master_restart();
+        I2C_DBG("  restart\n");
+    }
+}
 
-            /* data reveived */
-            if (event & (RB_I2C_RxNE)) {
-                /* put byte into buffer */ 
-                i2c_master_buffer[i2c_master_buffer_index++] = I2C_ReceiveData();
-
-                if (i2c_master_buffer_index < i2c_master_buffer_length) {
-                    I2C_AcknowledgeConfig(ENABLE);
-                    I2C_DBG("  ACK next\n");
-                } else {
-                    //XXX: Should not delay too match before NACK 
-                    I2C_AcknowledgeConfig(DISABLE);
-                    I2C_DBG("  NACK next\n");
-
-                    if (is_nack_sent) {
-                        is_nack_sent = false;
-                        if (i2c_send_stop) {
-                            I2C_GenerateSTOP(ENABLE);
-                            i2c_state = I2C_READY;
-                            I2C_DBG("  send STOP\n");
-                        } else {
-                            i2c_in_repstart = true;
-                            /* we're gonna send the START, don't enable the interrupt. */
-                            I2C_ITConfig(I2C_IT_BUF, DISABLE);
-                            I2C_ITConfig(I2C_IT_EVT, DISABLE);
-                            I2C_ITConfig(I2C_IT_ERR, DISABLE);
-                            I2C_GenerateSTART(ENABLE);
-                            i2c_state = I2C_READY;
-                            I2C_DBG("  restart\n");
-
-                        }
-                    } else {
-                        is_nack_sent = true;
-                    }
-                }
-
-                I2C_DBG("  received data (%#x)\n", 
-                        i2c_master_buffer[i2c_master_buffer_index - 1]);
+/* Address or data not acknowledged: abort the rest of the sequence */
+__HIGH_CODE
+static void i2c_master_nack(void)
+{
+    I2C_ClearFlag(I2C_FLAG_AF);
 
-            }
+    i2c_set_error(I2C_MT_NACK);
+    i2c_state = I2C_READY;
+    I2C_GenerateSTOP(ENABLE);
+    I2C_DBG("  NACK received, send STOP\n");
+    i2c_master_done();
+}
 
-            /* nack received */
-            if (event & RB_I2C_AF) {
-                I2C_ClearFlag(I2C_FLAG_AF);
-                /* put final byte into buffer */
-                i2c_master_buffer[i2c_master_buffer_index++] = I2C_ReceiveData();
-
-                if (i2c_send_stop) {
-                    i2c_state = I2C_READY;
-                    I2C_GenerateSTOP(ENABLE);
-                    I2C_DBG("  NACK received, send STOP\n");
-                } else {
-                    i2c_in_repstart = true;
-                    /* we're gonna send the START, don't enable the interrupt. */
-                    I2C_ITConfig(I2C_IT_BUF, DISABLE);
-                    I2C_ITConfig(I2C_IT_EVT, DISABLE);
-                    I2C_ITConfig(I2C_IT_ERR, DISABLE);
-                    I2C_GenerateSTART(ENABLE);
-                    i2c_state = I2C_READY;
-                    I2C_DBG("  restart\n");
-                }
-            }
+/*
+ * START of an async message sent: only SB moves on, a BTF left by the
+ * previous message is dropped until the START clears it.
+ */
+__HIGH_CODE
+static void i2c_isr_master_sb(uint32_t event)
+{
+    if (event & RB_I2C_SB) {
+        i2c_master_sb();
+        I2C_PATH(I2C_PATH_M_START);
+        I2C_DBG("Master selected, send address\n");
+    }
+}
+
+/*
+ * Master transmitter. SB is handled on its own, TRA may still be set
+ * from the previous message after a repeated start.
+ */
+__HIGH_CODE
+static void i2c_isr_master_tx(uint32_t event)
+{
+    if (event & RB_I2C_SB) {
+        i2c_master_sb();
+        I2C_PATH(I2C_PATH_M_START);
+        I2C_DBG("Master selected, send address\n");
+        return;
+    }
+    if (event & RB_I2C_AF) {
+        I2C_PATH(I2C_PATH_M_TX_NACK);
+        i2c_master_nack();
+        return;
+    }
+    /* Slave receiver acked address or sent bit */
+    if (event & (RB_I2C_ADDR | RB_I2C_BTF | RB_I2C_TxE)) {
+        /* if there is data to send, send it, otherwise stop */
+        if (i2c_master_buffer_index < i2c_master_buffer_length) {
+            I2C_SendData(i2c_master_data[i2c_master_buffer_index++]);
+            I2C_PATH(I2C_PATH_M_TX_DATA);
+            I2C_DBG("  send (%#x)\n", 
+                    i2c_master_data[i2c_master_buffer_index - 1]);
+        } else {
+            I2C_PATH(i2c_send_stop ? I2C_PATH_M_TX_STOP : I2C_PATH_M_TX_RESTART);
+            i2c_master_finish();
         }
+    }
+}
 
-    } else {
-    /* I2C slave */
-        /* addressed, returned ack */
-        if (event & RB_I2C_ADDR) {
-
-            if (event & ((RB_I2C_TRA << 16) | RB_I2C_TxE)) {
-                I2C_DBG("Slave transmitter address matched\n");
-                
-                i2c_state = I2C_STX;
-                i2c_slave_txbuffer_index = 0;
-                i2c_slave_txbuffer_length = 0;
-
-                if (slave_cb && slave_cb->on_transmit) {
-                    slave_cb->on_transmit(i2c_slave_txbuffer, &i2c_slave_txbuffer_length);
-                }
-            } else {
-                I2C_DBG("Slave reveiver address matched\n");
+/* Master receiver */
+__HIGH_CODE
+static void i2c_isr_master_rx(uint32_t event)
+{
+    if (event & RB_I2C_SB) {
+        i2c_master_sb();
+        I2C_PATH(I2C_PATH_M_START);
+        I2C_DBG("Master selected, send address\n");
+        return;
+    }
 
-                i2c_state = I2C_SRX;
-                i2c_slave_rxbuffer_index = 0;
-            }
+    /* nack received, address not acknowledged: no data byte came in */
+    if (event & RB_I2C_AF) {
+        I2C_PATH(I2C_PATH_M_RX_NACK);
+        i2c_master_nack();
+        return;
+    }
+
+    /* address sent, ack received */
+    if (event & RB_I2C_ADDR) {
+        /* ack if more bytes are expected, otherwise nack */
+        //XXX: Should not delay too match before NACK 
+        I2C_AcknowledgeConfig(i2c_master_buffer_length ? ENABLE : DISABLE);
+        if (!i2c_master_buffer_length) {
+            is_nack_sent = true;
         }
+        I2C_PATH(I2C_PATH_M_RX_ADDR);
+        I2C_DBG("  address sent, %s next\n", i2c_master_buffer_length ? "ACK" : "NACK");
+    }
 
-        if (event & (RB_I2C_TRA << 16)) { //TODO: STOP?
-            /* Slave transmintter */
+    /* data reveived */
+    if (event & RB_I2C_RxNE) {
+        /* put byte into buffer */ 
+        i2c_master_data[i2c_master_buffer_index++] = I2C_ReceiveData();
+        I2C_PATH(I2C_PATH_M_RX_DATA);
+        I2C_DBG("  received data (%#x)\n", 
+                i2c_master_data[i2c_master_buffer_index - 1]);
+
+        if (i2c_master_buffer_index < i2c_master_buffer_length) {
             I2C_AcknowledgeConfig(ENABLE);
-            I2C_DBG("Slave transmitter:\n");
-
-            if (event & RB_I2C_AF) {
-                /* Nack received */
-                I2C_ClearFlag(I2C_FLAG_AF);
-                I2C_AcknowledgeConfig(ENABLE);
-                I2C_DBG("  Nack received\n");
-
-                /* leave slave receiver state */
-                i2c_state = I2C_READY;
-                /* clear status */
-                event = 0;
+        } else {
+            //XXX: Should not delay too match before NACK 
+            I2C_AcknowledgeConfig(DISABLE);
+
+            if (is_nack_sent) {
+                is_nack_sent = false;
+                I2C_PATH(i2c_send_stop ? I2C_PATH_M_RX_STOP : I2C_PATH_M_RX_RESTART);
+                i2c_master_finish();
+            } else {
+                is_nack_sent = true;
             }
+        }
+    }
+}
+
+/* Slave, addressed or in the middle of a transfer */
+__HIGH_CODE
+static void i2c_isr_slave(uint32_t event)
+{
+    /* late event of a master transaction that already sent STOP */
+    if (event & (RB_I2C_MSL << 16)) {
+        return;
+    }
 
-            if (event & (RB_I2C_BTF | RB_I2C_TxE)) {
-                /* if there is more to send, ack, otherwise send 0xff */
-                if (i2c_slave_txbuffer_index < i2c_slave_txbuffer_length) {
-                    /* copy data to output register */
-                    I2C_SendData(i2c_slave_txbuffer[i2c_slave_txbuffer_index++]);
-                    I2C_DBG("  send (%#x)\n", 
-                        i2c_slave_txbuffer[i2c_slave_txbuffer_index - 1]);
-                } else {
-                    I2C_SendData(0xff);
-                    I2C_DBG("  no more data, send 0xff\n");
-                }
+    /* addressed, returned ack */
+    if (event & RB_I2C_ADDR) {
+        if (event & ((RB_I2C_TRA << 16) | RB_I2C_TxE)) {
+            I2C_PATH(I2C_PATH_S_TX_ADDR);
+            I2C_DBG("Slave transmitter address matched\n");
+            
+            i2c_state = I2C_STX;
+            i2c_slave_txbuffer_index = 0;
+            i2c_slave_txbuffer_length = 0;
+
+            if (i2c_export) {
+                /* latch the published snapshot for the whole read */
+                uint8_t front = i2c_export->front;
+
+                i2c_export->reading = front;
+                i2c_export_src = i2c_export->buf[front];
+            } else if (slave_cb && slave_cb->on_transmit) {
+                slave_cb->on_transmit(i2c_slave_txbuffer, &i2c_slave_txbuffer_length);
             }
         } else {
-            /* Slave receiver */
-            I2C_DBG("Slave receiver:\n");
-
-            if (event & RB_I2C_RxNE) {
-                /* if there is still room in the rx buffer */
-                if (i2c_slave_rxbuffer_index < I2C_BUFFER_LENGTH) {
-                    /* put byte in buffer and ack */
-                    i2c_slave_rxbuffer[i2c_slave_rxbuffer_index++] = I2C_ReceiveData();
-                    I2C_AcknowledgeConfig(ENABLE);
-                    I2C_DBG("  received (%#x)\n", 
-                            i2c_slave_rxbuffer[i2c_slave_rxbuffer_index - 1]);
-                } else {
-                    // otherwise nack
-                    I2C_AcknowledgeConfig(DISABLE);
-                }
-            }
+            I2C_PATH(I2C_PATH_S_RX_ADDR);
+            I2C_DBG("Slave reveiver address matched\n");
 
-            if (event & RB_I2C_STOPF) {
-                /* ack future responses and leave slave receiver state */
-                R16_I2C_CTRL1 |= RB_I2C_PE; //clear flag
+            i2c_state = I2C_SRX;
+            i2c_slave_rxbuffer_index = 0;
+        }
+    }
 
-                I2C_DBG("  reveive stop\n");
+    if (event & (RB_I2C_TRA << 16)) { //TODO: STOP?
+        /* Slave transmintter */
+        I2C_AcknowledgeConfig(ENABLE);
 
-                /* callback to user defined callback */
-                if (slave_cb && slave_cb->on_receive) {
-                    slave_cb->on_receive(i2c_slave_rxbuffer, i2c_slave_rxbuffer_index);
-                }
-                /* since we submit rx buffer , we can reset it */
-                i2c_slave_rxbuffer_index = 0;
-            }
+        if (event & RB_I2C_AF) {
+            /* Nack received */
+            I2C_ClearFlag(I2C_FLAG_AF);
+            I2C_PATH(I2C_PATH_S_TX_NACK);
+            I2C_DBG("  Nack received\n");
 
-            if (event & RB_I2C_AF) {  
-                I2C_ClearFlag(I2C_FLAG_AF);
+            /* leave slave receiver state */
+            i2c_state = I2C_READY;
+            if (i2c_export) {
+                i2c_export->reading = I2C_EXPORT_NONE;
+            }
+            /* transfers queued during the access, START waits for the STOP */
+            i2c_xfer_next();
+            return;
+        }
 
-                /* ack future responses */
-                I2C_AcknowledgeConfig(ENABLE);
+        if (event & (RB_I2C_BTF | RB_I2C_TxE)) {
+            I2C_PATH(I2C_PATH_S_TX_DATA);
+            if (i2c_export) {
+                /* straight from the snapshot, auto increment */
+                I2C_SendData(i2c_export_reg < i2c_export->len ?
+                             i2c_export_src[i2c_export_reg++] : 0xff);
+                return;
+            }
+            /* if there is more to send, ack, otherwise send 0xff */
+            if (i2c_slave_txbuffer_index < i2c_slave_txbuffer_length) {
+                /* copy data to output register */
+                I2C_SendData(i2c_slave_txbuffer[i2c_slave_txbuffer_index++]);
+                I2C_DBG("  send (%#x)\n", 
+                    i2c_slave_txbuffer[i2c_slave_txbuffer_index - 1]);
+            } else {
+                I2C_SendData(0xff);
+                I2C_DBG("  no more data, send 0xff\n");
             }
         }
+        return;
     }
 
-    if (event & RB_I2C_BERR) {
-        I2C_ClearFlag(RB_I2C_BERR);
-        I2C_GenerateSTOP(ENABLE);
+    /* Slave receiver */
+    if (event & RB_I2C_RxNE) {
+        I2C_PATH(I2C_PATH_S_RX_DATA);
+        if (i2c_export) {
+            /* first byte selects the register, the map is read only */
+            uint8_t data = I2C_ReceiveData();
 
-        i2c_error = I2C_BUS_ERROR;
-        I2C_DBG("RB_I2C_BERR\n");
+            if (!i2c_slave_rxbuffer_index) {
+                i2c_export_reg = data;
+                i2c_slave_rxbuffer_index = 1;
+            }
+            I2C_AcknowledgeConfig(ENABLE);
+        }
+        /* if there is still room in the rx buffer */
+        else if (i2c_slave_rxbuffer_index < I2C_BUFFER_LENGTH) {
+            /* put byte in buffer and ack */
+            i2c_slave_rxbuffer[i2c_slave_rxbuffer_index++] = I2C_ReceiveData();
+            I2C_AcknowledgeConfig(ENABLE);
+            I2C_DBG("  received (%#x)\n", 
+                    i2c_slave_rxbuffer[i2c_slave_rxbuffer_index - 1]);
+        } else {
+            // otherwise nack
+            I2C_AcknowledgeConfig(DISABLE);
+        }
     }
 
-    if (event & RB_I2C_ARLO) {
-        I2C_ClearFlag(RB_I2C_ARLO);
-        
-        i2c_error = I2C_ARB_LOST;
-        I2C_DBG("RB_I2C_ARLO\n");
-    }
+    if (event & RB_I2C_STOPF) {
+        /* ack future responses and leave slave receiver state */
+        R16_I2C_CTRL1 |= RB_I2C_PE; //clear flag
+        I2C_PATH(I2C_PATH_S_RX_STOP);
+        I2C_DBG("  reveive stop\n");
 
-    if (event & RB_I2C_OVR) {
-        I2C_ClearFlag(RB_I2C_OVR);
-        
-        i2c_error = I2C_OVR;
-        I2C_DBG("RB_I2C_OVR\n");
-    }
+        i2c_state = I2C_READY;
 
-    if (event & RB_I2C_PECERR) {
-        I2C_ClearFlag(RB_I2C_PECERR);
-        
-        i2c_error = I2C_PECERR;
-        I2C_DBG("RB_I2C_PECERR\n");
+        if (i2c_export) {
+            i2c_export->reading = I2C_EXPORT_NONE;
+        }
+        /* callback to user defined callback */
+        else if (slave_cb && slave_cb->on_receive) {
+            slave_cb->on_receive(i2c_slave_rxbuffer, i2c_slave_rxbuffer_index);
+        }
+        /* since we submit rx buffer , we can reset it */
+        i2c_slave_rxbuffer_index = 0;
+        /* transfers queued during the access */
+        i2c_xfer_next();
     }
 
-    if (event & RB_I2C_TIMEOUT) {
-        I2C_ClearFlag(RB_I2C_TIMEOUT);
-        
-        i2c_error = I2C_TIMEOUT;
-        I2C_DBG("RB_I2C_TIMEOUT\n");
-    }
+    if (event & RB_I2C_AF) {  
+        I2C_ClearFlag(I2C_FLAG_AF);
 
-    if (event & RB_I2C_SMBALERT) {
-        I2C_ClearFlag(RB_I2C_SMBALERT);
-        
-        i2c_error = I2C_SMBALERT;
-        I2C_DBG("RB_I2C_SMBALERT\n");
+        /* ack future responses */
+        I2C_AcknowledgeConfig(ENABLE);
     }
-
-    I2C_DBG("\n");
 }
-// =============================================================================
-// SHT20 温湿度传感器相关代码
-// =============================================================================
-
-// SHT20 I2C地址
-#define SHT20_I2C_ADDR  0x40
 
-// SHT20命令
-#define SHT20_TRIG_TEMP_MEASURE_HOLD   0xE3
-#define SHT20_TRIG_HUMI_MEASURE_HOLD   0xE5
+/* Error flags, the matching i2c_error_t and the flag to clear, in reporting order */
+#define I2C_ERR_FLAGS   (RB_I2C_BERR | RB_I2C_ARLO | RB_I2C_OVR | RB_I2C_PECERR | \
+                         RB_I2C_TIMEOUT | RB_I2C_SMBALERT)
+
+static const struct {
+    uint16_t flag;
+    uint8_t error;
+} i2c_err_tab[] = {
+    { RB_I2C_BERR,     I2C_BUS_ERROR },
+    { RB_I2C_ARLO,     I2C_ARB_LOST  },
+    { RB_I2C_OVR,      I2C_OVR       },
+    { RB_I2C_PECERR,   I2C_PECERR    },
+    { RB_I2C_TIMEOUT,  I2C_TIMEOUT   },
+    { RB_I2C_SMBALERT, I2C_SMBALERT  },
+};
+
+/* Rare path, kept out of the handler so the common case stays short */
+__attribute__((noinline))
+__HIGH_CODE
+static void i2c_isr_error(uint32_t event)
+{
+    I2C_PATH(I2C_PATH_ERROR);
 
-/**
- * @brief CRC8校验计算
- * @param data 数据指针
- * @param len 数据长度
- * @return CRC8校验值
- */
-static uint8_t _crc8(const uint8_t *data, int len)
-{
-    uint8_t crc = 0x00;
-    for (int i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (int j = 0; j < 8; j++) {
-            if (crc & 0x80)
-                crc = (crc << 1) ^ 0x131;
-            else
-                crc <<= 1;
+    for (uint8_t i = 0; i < sizeof(i2c_err_tab) / sizeof(i2c_err_tab[0]); i++) {
+        if (event & i2c_err_tab[i].flag) {
+            I2C_ClearFlag(i2c_err_tab[i].flag);
+            i2c_set_error(i2c_err_tab[i].error);
+            I2C_DBG("I2C error %d\n", i2c_err_tab[i].error);
         }
     }
-    return crc;
+
+    if (event & RB_I2C_BERR) {
+        I2C_GenerateSTOP(ENABLE);
+    }
+
+    /* Bus error or lost arbitration aborts the master transaction */
+    if ((event & (RB_I2C_BERR | RB_I2C_ARLO)) &&
+        (i2c_state == I2C_MTX || i2c_state == I2C_MRX)) {
+        i2c_state = I2C_READY;
+        i2c_master_done();
+    }
 }
 
-/**
- * @brief 读取SHT20温度和湿度
- * @param temp 温度指针 (单位0.01°C)
- * @param humi 湿度指针 (单位0.01%RH)
- * @return 0表示成功，负值表示错误代码
- */
-int sht20_read_temp_humi(int16_t *temp, int16_t *humi)
+/* Event dispatch by driver state, in i2c_state_t order */
+static void (*const i2c_isr_tab[])(uint32_t event) = {
+    i2c_isr_slave,          // I2C_READY: only a slave address match is expected
+    i2c_isr_master_rx,      // I2C_MRX
+    i2c_isr_master_tx,      // I2C_MTX
+    i2c_isr_slave,          // I2C_SRX
+    i2c_isr_slave,          // I2C_STX
+};
+
+__INTERRUPT
+__HIGH_CODE
+void I2C_IRQHandler(void)
 {
-    uint8_t buf[3];
-    uint8_t cmd;
-    int ret = 0;
+    TRACE_BEGIN(TRACE_ID_I2C_IRQ);
+#ifdef CONFIG_I2C_PROFILE
+    uint32_t start = *(volatile uint32_t *)&SysTick->CNT;
+    i2c_isr_path = I2C_PATH_NONE;
+#endif
 
-    // 读取温度
-    cmd = SHT20_TRIG_TEMP_MEASURE_HOLD;
-    ret = i2c_write_to(SHT20_I2C_ADDR, &cmd, 1, true, true);
-    if (ret != 0) {
-        PRINT("SHT20 temp write failed: %d\n", ret);
-        return -1;
-    }
-    
-    // 等待测量完成 (SHT20温度测量需要85ms)
-    mDelaymS(85);
-    
-    ret = i2c_read_from(SHT20_I2C_ADDR, buf, 3, true, 100);
-    if (ret != 3) {
-        PRINT("SHT20 temp read failed: %d\n", ret);
-        return -2;
-    }
-    if (_crc8(buf, 2) != buf[2]) {
-        PRINT("SHT20 temp CRC failed\n");
-        return -3;
-    }
-    
-    uint16_t raw_temp = ((uint16_t)buf[0] << 8) | buf[1];
-    raw_temp &= ~0x0003; // 清除状态位
-    // SHT20温度转换公式: T = -46.85 + 175.72 * raw / 2^16
-    // 转换为0.01°C单位: T = -4685 + 17572 * raw / 2^16
-    *temp = (int16_t)((((int32_t)raw_temp * 17572) >> 16) - 4685);
-    
-    PRINT("SHT20 temp raw: 0x%04X, converted: %d (%.2f°C)\n", raw_temp, *temp, *temp/100.0f);
+    uint32_t event = I2C_GetLastEvent();
+    print_i2c_irq_sta(event);
 
-    // 读取湿度
-    cmd = SHT20_TRIG_HUMI_MEASURE_HOLD;
-    ret = i2c_write_to(SHT20_I2C_ADDR, &cmd, 1, true, true);
-    if (ret != 0) {
-        PRINT("SHT20 humid write failed: %d\n", ret);
-        return -4;
-    }
-    
-    // 等待测量完成 (SHT20湿度测量需要29ms)
-    mDelaymS(29);
-    
-    ret = i2c_read_from(SHT20_I2C_ADDR, buf, 3, true, 100);
-    if (ret != 3) {
-        PRINT("SHT20 humid read failed: %d\n", ret);
-        return -5;
+    /* the state is sampled once, errors below see the updated one */
+    if (i2c_wait_sb) {
+        i2c_isr_master_sb(event);
+    } else {
+        i2c_isr_tab[i2c_state](event);
     }
-    if (_crc8(buf, 2) != buf[2]) {
-        PRINT("SHT20 humid CRC failed\n");
-        return -6;
+
+    if (event & I2C_ERR_FLAGS) {
+        i2c_isr_error(event);
     }
-    
-    uint16_t raw_humi = ((uint16_t)buf[0] << 8) | buf[1];
-    raw_humi &= ~0x0003;
-    // SHT20湿度转换公式: RH = -6 + 125 * raw / 2^16
-    // 转换为0.01%RH单位: RH = -600 + 12500 * raw / 2^16
-    *humi = (int16_t)((((int32_t)raw_humi * 12500) >> 16) - 600);
-    
-    PRINT("SHT20 humid raw: 0x%04X, converted: %d (%.2f%%)\n", raw_humi, *humi, *humi/100.0f);
 
-    return 0;
+    I2C_DBG("\n");
+
+#ifdef CONFIG_I2C_PROFILE
+    i2c_profile_record(i2c_isr_path, start);
+#endif
+    TRACE_END(TRACE_ID_I2C_IRQ);
 }
+#if (I2C_EXPORT_WAKE == TRUE)
+/* SDA fell while exporting: a host START, stay awake for its access */
+__INTERRUPT
+__HIGH_CODE
+void GPIOB_IRQHandler(void)
+{
+    if (GPIOB_ReadITFlagBit(bSDA)) {
+        GPIOB_ClearITFlagBit(bSDA);
+        i2c_export_disarm();
+        HAL_SleepHold(HAL_SLEEP_HOLD_I2C_SLAVE);
+        tmos_set_event(i2c_task_id, I2C_SLAVE_WAKE_EVT);
+    }
+}
+#endif
@@ -12,9 +12,15 @@
  *******************************************************************************/
 
 #include "CONFIG.h"
+#include "HAL.h"
 #include "devinfoservice.h"
 #include "broadcaster.h"
 #include "app_i2c.h"
+#include "bthome.h"
+#include "aes_ccm.h"
+#include "adv_policy.h"
+#include "sensor.h"
+#include "adc_calib.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -22,63 +28,191 @@
 // 配置参数
 // =============================================================================
 
-// 广播间隔 (units of 625us, min is 160=100ms)
-#define DEFAULT_ADVERTISING_INTERVAL 1600 * 2
-// 数据采集间隔
-#define SBP_PERIODIC_EVT_PERIOD 1600 * 20
+// 广播间隔及数据采集间隔由 adv_policy 根据数据变化和电池电量调整
+// 传感器驱动及广播的传感器对象见 sensor_cfg.h
+
+// 变化检测死区: 所有字段变化都小于死区时不更新广播 (传感器对象的死区见 sensor_cfg.h)
+#define BTH_BAT_DEADBAND 1      // 1%
+
+// BTHome 加密广播 (AES-CCM), 可在工程预定义中修改
+#ifndef BTHOME_ENCRYPTION
+#define BTHOME_ENCRYPTION FALSE
+#endif
+// 加密密钥 (bindkey), 需与接收端配置一致, 每个设备单独生成, 不提供默认值
+// 例如 BTHOME_BINDKEY={0x23,0x1D,0x39,0xC1,0xD7,0xCC,0x1A,0xB1,0xAE,0xE2,0x24,0xCD,0x09,0x6D,0xB9,0x32}
+#if (BTHOME_ENCRYPTION == TRUE) && !defined(BTHOME_BINDKEY)
+#error "BTHOME_BINDKEY must be defined when BTHOME_ENCRYPTION is enabled"
+#endif
+// 在广播中附带平均电流估计 (需开启 HAL_ENERGY), 以 count 对象发送, 单位 0.1uA
+#ifndef BTH_ADVERT_ENERGY
+#define BTH_ADVERT_ENERGY FALSE
+#endif
+#if (BTH_ADVERT_ENERGY == TRUE) && (HAL_ENERGY != TRUE)
+#error "BTH_ADVERT_ENERGY requires HAL_ENERGY"
+#endif
+// 通过 I2C 从机寄存器导出最新采样结果: SBP_I2C_EXPORT, 默认值见 CONFIG.h (寄存器定义见 broadcaster.h)
+// 电池电压过采样: ADC 按固定间隔自动转换, DMA 写入 RAM, 等待期间 CPU 空闲, 剔除离群值后平均
+#ifndef BAT_OVERSAMPLE
+#define BAT_OVERSAMPLE TRUE
+#endif
+#define BAT_OVERSAMPLE_N      32    // 每次测量的转换次数
+#define BAT_OVERSAMPLE_CYCLE  192   // 转换间隔 (256-192)*16 个系统时钟, 60MHz 时约 17us
+#define BAT_OVERSAMPLE_TMO    (BAT_OVERSAMPLE_N * (256 - BAT_OVERSAMPLE_CYCLE) * 16 * 4)   // 系统时钟
+#define BAT_OUTLIER_LSB       8     // 偏离均值超过此值 (约16mV) 的转换结果被剔除
+// 加密计数器在 data flash 中的保存地址, 每 BTHOME_COUNTER_STEP 个数据包预留写入一次
+#define BTHOME_COUNTER_ADDR (0x77D00 - FLASH_ROM_MAX_SIZE)
+#define BTHOME_COUNTER_STEP 1024
+
+// RTC 周期数转换为微秒 (仅用于调试输出, 避免浮点运算)
+#define RTC_TICKS_TO_US(t) ((t) * (1000000 / 64) / (FREQ_RTC / 64))
 
 // =============================================================================
 // 全局变量
 // =============================================================================
 
-// ADC 校准值的偏移值
-static signed short RoughCalib_Value = 0;
 // 电池电压
 static uint16_t bat = 0;
 // Task ID for internal task/event processing
 static uint8_t Broadcaster_TaskID;
 
+// 最近一次广播的数据, 用于变化检测
+static uint8_t adv_valid = FALSE;
+static uint8_t adv_packet_id = 0;
+static uint8_t adv_last_bat;
+// 因数据无变化而跳过的广播更新次数
+static uint32_t adv_skip_count = 0;
+
+#if (BAT_OVERSAMPLE == TRUE)
+// 电池电压 DMA 缓冲区及完成标志
+static uint16_t bat_dma_buf[BAT_OVERSAMPLE_N];
+static volatile uint8_t bat_dma_done;
+#endif
+
+// 本次采样在各阶段唤醒的 RTC 周期数
+static uint32_t sensor_awake_rtc;
+static uint32_t sensor_stage_start;
+
+#if (SBP_I2C_EXPORT == TRUE)
+// I2C 从机导出的双缓冲寄存器映射
+static uint8_t export_buf[2][SBP_REG_MAP_LEN];
+static i2c_export_t export_map = { { export_buf[0], export_buf[1] }, SBP_REG_MAP_LEN };
+static uint8_t export_seq;
+#endif
+
 // =============================================================================
 // 广播数据结构定义
 // =============================================================================
 
-// 广播数据包结构分析：
-// [0-2]   - Flags (3字节)
-// [3-15]  - 设备名称 (13字节)
-// [16-28] - BTHome 传感器数据 (13字节)
+// 广播数据包结构 (各字段偏移在编译期由下面的定义生成)：
+// 明文: Flags (3字节) | 设备名称 (2字节头 + 剩余空间) | BTHome 服务数据 (5字节头 + 对象列表)
+// 加密: Flags (3字节) | BTHome 服务数据 (5字节头 + 加密对象列表 + 计数器 + MIC)
+// 加密时不广播设备名称, 避免以明文泄露读数
+
+// 可选对象
+#if (BTH_ADVERT_ENERGY == TRUE)
+#define BTH_OBJECTS_ENERGY(X) X(CURRENT, BTHOME_ID_COUNT_U16, 2)
+#else
+#define BTH_OBJECTS_ENERGY(X)
+#endif
+
+// BTHome 对象列表: X(名称, 对象ID, 数据宽度), 按对象ID升序排列
+#define BTH_OBJECTS(X)                          \
+    X(PID,   BTHOME_ID_PACKET_ID,   1)          \
+    X(BAT,   BTHOME_ID_BATTERY,     1)          \
+    SENSOR_OBJECTS(X)                           \
+    BTH_OBJECTS_ENERGY(X)
+
+// 设备名称长度: 31字节中 Flags, 名称头, BTHome 头和对象列表之外的剩余空间
+// (默认对象时为11字节, 附带电流估计时8字节, 附带气压时再缩短4字节), 超出时截断
+#define BTH_OBJ_SIZE(name, id, width) + 1 + (width)
+#define NAME_PKG_DATA_LEN (B_MAX_ADV_LEN - 3 - 2 - 5 - (0 BTH_OBJECTS(BTH_OBJ_SIZE)))
+
+// 写入/打印一个传感器对象, 无效值按对象的宽度和符号写入 BTHome 的无效值
+#define BTH_PUT_SENSOR(name, id, width)         \
+    bthome_put_le(BTH_OBJ_PTR(name), bth_sensor_raw(SENSOR_OBJ_##name, id, width), width);
+#define BTH_PRINT_SENSOR(name, id, width)       \
+    PRINT(", " #name "=%d", (int)sensor_value(SENSOR_OBJ_##name));
+
+// 数据包索引定义
+enum {
+    FLAGS_LEN_IDX,
+    FLAGS_TYPE_IDX,
+    FLAGS_DATA_IDX,
+
+#if (BTHOME_ENCRYPTION == FALSE)
+    NAME_PKG_LEN_IDX,
+    NAME_PKG_TYPE_IDX,
+    NAME_PKG_DATA_IDX,
+    NAME_PKG_END_IDX = NAME_PKG_DATA_IDX + NAME_PKG_DATA_LEN - 1,
+#endif
+
+    BTH_PKG_LEN_IDX,
+    BTH_PKG_TYPE_IDX,
+    BTH_PKG_UUID_IDX,
+    BTH_PKG_UUID_END_IDX = BTH_PKG_UUID_IDX + 1,
+    BTH_PKG_VERSION_IDX,
+    BTH_OBJECTS(BTHOME_OBJ_INDEX)
+    BTH_PKG_OBJ_LIMIT_IDX,
+
+#if (BTHOME_ENCRYPTION == TRUE)
+    BTH_PKG_COUNTER_IDX = BTH_PKG_OBJ_LIMIT_IDX,
+    BTH_PKG_MIC_IDX = BTH_PKG_COUNTER_IDX + BTHOME_COUNTER_LEN,
+    ADVERT_DATA_LEN = BTH_PKG_MIC_IDX + BTHOME_MIC_LEN
+#else
+    ADVERT_DATA_LEN = BTH_PKG_OBJ_LIMIT_IDX
+#endif
+};
+
+// BTHome 对象列表的起始位置和长度
+#define BTH_PKG_OBJ_IDX (BTH_PKG_VERSION_IDX + 1)
+#define BTH_PKG_OBJ_LEN (BTH_PKG_OBJ_LIMIT_IDX - BTH_PKG_OBJ_IDX)
 
 static uint8_t advertData[] = {
-    0x02, // 长度 0
-    GAP_ADTYPE_FLAGS, // AD类型 1
-    GAP_ADTYPE_FLAGS_GENERAL | GAP_ADTYPE_FLAGS_BREDR_NOT_SUPPORTED, // 2
-    0x0D, // 长度 3 (13字节设备名称)
-    0x09, // AD类型 设备名称 4
-    '1', '9', '%', '/', '1', '1', 'C', '/', 'H', ':', '1', '1', '%', // 设备名称 (13字节) 5-17
-    0x0D, // 长度 18 (13字节BTHome数据)
-    0x16, // AD类型 19
-    0xD2, 0xFC, // UUID (BTHome UUID FCD2) 20-21
-    0x40,                   // BTHome v2 无加密，定期广播 22
-    0x01, 0x00,             // 电量 (占位符) 23-24
-    0x02, 0x00, 0x00,       // 温度 (占位符) 25-27
-    0x03, 0x00, 0x00,       // 湿度 (占位符) 28
+    0x02, // 长度
+    GAP_ADTYPE_FLAGS, // AD类型
+    GAP_ADTYPE_FLAGS_GENERAL | GAP_ADTYPE_FLAGS_BREDR_NOT_SUPPORTED,
+#if (BTHOME_ENCRYPTION == FALSE)
+    NAME_PKG_DATA_LEN + 1, // 长度
+    GAP_ADTYPE_LOCAL_NAME_COMPLETE, // AD类型 设备名称
+    [NAME_PKG_DATA_IDX ... NAME_PKG_END_IDX] = ' ', // 设备名称 (占位符)
+#endif
+    ADVERT_DATA_LEN - BTH_PKG_LEN_IDX - 1, // 长度
+    GAP_ADTYPE_SERVICE_DATA, // AD类型
+    BTHOME_UUID_LO, BTHOME_UUID_HI, // UUID (BTHome UUID FCD2)
+#if (BTHOME_ENCRYPTION == TRUE)
+    BTHOME_DEVICE_INFO_ENCRYPT, // BTHome v2 加密，定期广播
+    BTH_OBJECTS(BTHOME_OBJ_TEMPLATE) // 传感器数据 (发送前加密)
+    BTHOME_FILL_4, // 计数器
+    BTHOME_FILL_4, // MIC
+#else
+    BTHOME_DEVICE_INFO_PLAIN, // BTHome v2 无加密，定期广播
+    BTH_OBJECTS(BTHOME_OBJ_TEMPLATE) // 传感器数据 (占位符)
+#endif
 };
 
-// 数据包索引定义
-#define FLAGS_LEN_IDX 0
-#define FLAGS_TYPE_IDX 1
-#define FLAGS_DATA_IDX 2
-
-#define NAME_PKG_LEN_IDX 3
-#define NAME_PKG_TYPE_IDX 4
-#define NAME_PKG_DATA_IDX 5
-
-#define BTH_PKG_LEN_IDX 18
-#define BTH_PKG_TYPE_IDX 19
-#define BTH_PKG_UUID_IDX 20
-#define BTH_PKG_VERSION_IDX 22
-#define BTH_PKG_BAT_IDX 23
-#define BTH_PKG_TEMP_IDX 25
-#define BTH_PKG_HUMID_IDX 27
+_Static_assert(sizeof(advertData) == ADVERT_DATA_LEN, "advert template does not match layout");
+_Static_assert(ADVERT_DATA_LEN <= B_MAX_ADV_LEN, "advert data exceeds legacy advertising limit");
+#if (BTHOME_ENCRYPTION == FALSE)
+_Static_assert(NAME_PKG_DATA_LEN >= 4, "no room left for the device name");
+#endif
+
+#if (BTHOME_ENCRYPTION == TRUE)
+// 明文对象列表, 编码后加密写入 advertData
+static uint8_t bth_plain_data[BTH_PKG_OBJ_LEN] = {
+    BTH_OBJECTS(BTHOME_OBJ_TEMPLATE)
+};
+// 对象数据位置 (编译期常量偏移)
+#define BTH_OBJ_PTR(name) (&bth_plain_data[BTH_PKG_##name##_IDX - BTH_PKG_OBJ_IDX])
+
+// 初始化时展开的密钥和固定的 nonce 前缀 (MAC | UUID | 设备信息)
+static aes128_ctx_t bth_aes_ctx;
+static uint8_t bth_nonce[BTHOME_NONCE_LEN];
+// 下一个数据包的计数值及 data flash 中已预留的上限
+static uint32_t bth_counter;
+static uint32_t bth_counter_limit;
+#else
+#define BTH_OBJ_PTR(name) (&advertData[BTH_PKG_##name##_IDX])
+#endif
 
 // =============================================================================
 // 函数声明
@@ -101,6 +235,85 @@ static gapRolesBroadcasterCBs_t Broadcaster_BroadcasterCBs = {
 // 传感器数据读取函数
 // =============================================================================
 
+#if (BAT_OVERSAMPLE == TRUE)
+/**
+ * @brief DMA 完成中断: 停止自动转换并唤醒等待的 CPU
+ */
+__INTERRUPT
+__HIGH_CODE
+void ADC_IRQHandler(void)
+{
+    if (ADC_GetDMAStatus()) {
+        ADC_StopAutoDMA();
+        ADC_ClearDMAFlag();
+        bat_dma_done = TRUE;
+    }
+}
+
+/**
+ * @brief 过采样电池通道: DMA 采集 BAT_OVERSAMPLE_N 次转换, 剔除离群值后平均
+ * @return 平均转换结果 (单位 1/16 LSB), 超时返回-1
+ */
+__HIGH_CODE
+static int32_t bat_sample_dma(void)
+{
+    uint32_t sum = 0, kept = 0, mean;
+    uint32_t start, mie;
+    uint8_t i;
+
+    bat_dma_done = FALSE;
+    ADC_AutoConverCycle(BAT_OVERSAMPLE_CYCLE);
+    ADC_DMACfg(ENABLE, (uint32_t)(uintptr_t)&bat_dma_buf[0], (uint32_t)(uintptr_t)&bat_dma_buf[BAT_OVERSAMPLE_N],
+               ADC_Mode_Single);
+    PFIC_EnableIRQ(ADC_IRQn);
+    start = SYS_GetSysTickCnt();
+    ADC_StartAutoDMA();
+
+    // 空闲模式等待: 只停 CPU 时钟, ADC/DMA 及 flash 保持运行
+    // 只关全局中断 (mstatus.MIE) 后检查标志再 WFI: ADC_IRQn 在 PFIC 中保持使能,
+    // 挂起时唤醒内核, 开中断后立即进入处理函数, 不会错过完成中断.
+    // 不能用 SYS_DisableAllIrq, 它关闭 PFIC 中的所有中断, 没有唤醒源
+    mie = __risc_v_disable_irq();
+    while (!bat_dma_done && SYS_GetSysTickCnt() - start < BAT_OVERSAMPLE_TMO) {
+        PFIC->SCTLR &= ~(1 << 2);   // WFI 进入空闲模式
+        __WFI();
+        __risc_v_enable_irq(mie);
+        mie = __risc_v_disable_irq();
+    }
+    __risc_v_enable_irq(mie);
+
+    ADC_DMACfg(DISABLE, 0, 0, ADC_Mode_Single);
+    PFIC_DisableIRQ(ADC_IRQn);
+    if (!bat_dma_done) {
+        ADC_StopAutoDMA();
+        return -1;
+    }
+
+    for (i = 0; i < BAT_OVERSAMPLE_N; i++) {
+        bat_dma_buf[i] &= RB_ADC_DATA;
+        sum += bat_dma_buf[i];
+    }
+    mean = sum / BAT_OVERSAMPLE_N;
+
+    // 剔除偏离均值的转换 (射频干扰等), 剩余不足一半时使用全部结果
+    sum = 0;
+    for (i = 0; i < BAT_OVERSAMPLE_N; i++) {
+        uint32_t v = bat_dma_buf[i];
+
+        if (v + BAT_OUTLIER_LSB >= mean && v <= mean + BAT_OUTLIER_LSB) {
+            sum += v;
+            kept++;
+        }
+    }
+    if (kept < BAT_OVERSAMPLE_N / 2) {
+        sum = mean * BAT_OVERSAMPLE_N;
+        kept = BAT_OVERSAMPLE_N;
+    }
+
+    return (int32_t)((sum * 16 + kept / 2) / kept);
+}
+#endif
+
 /**
  * @brief 电池电压采样
  * @return 电池电压值 (mV)
@@ -110,114 +323,404 @@ uint16_t sample_battery_voltage()
 {
     // VINA 实际电压值 1050±15mV
     const int vref = 1050;
+    uint16_t voltage;
+    int16_t calib;
 
+    TRACE_BEGIN(TRACE_ID_BAT_SAMPLE);
     ADC_InterBATSampInit();
 
-    // 每256次进行一次粗略校准
-    static uint8_t calib_count = 0;
-    if (++calib_count >> 7) {
-        RoughCalib_Value = ADC_DataCalib_Rough();
-    }
+    // 芯片温度变化或超过最长间隔时才重新粗略校准
+    calib = adc_calib_offset();
 
     ADC_ChannelCfg(CH_INTE_VBAT);
-    return (ADC_ExcutSingleConver() + RoughCalib_Value) * vref / 512 - 3 * vref;
+#if (BAT_OVERSAMPLE == TRUE)
+    {
+        // 平均值保留 1/16 LSB, 换算后的分辨率由约 2mV 提高到 1mV
+        int32_t raw = bat_sample_dma();
+
+        if (raw < 0) {
+            raw = ADC_ExcutSingleConver() * 16;
+        }
+        voltage = ((raw + calib * 16) * vref / 512 + 8) / 16 - 3 * vref;
+    }
+#else
+    voltage = (ADC_ExcutSingleConver() + calib) * vref / 512 - 3 * vref;
+#endif
+    TRACE_END(TRACE_ID_BAT_SAMPLE);
+
+    return voltage;
 }
 
+// =============================================================================
+// 广播数据更新函数
+// =============================================================================
+
+#if (BTHOME_ENCRYPTION == FALSE)
 /**
- * @brief 读取SHT20温湿度传感器数据
- * @param temperature 温度指针 (输出)
- * @param humidity 湿度指针 (输出)
- * @return 1表示成功，0表示失败
+ * @brief 写入十进制整数 (超出 end 的部分截断)
+ * @param p 写入位置
+ * @param end 缓冲区结束位置
+ * @param value 整数值
+ * @return 写入后的位置
  */
 __HIGH_CODE
-int read_sht20_data(uint16_t* temperature, uint16_t* humidity)
+static uint8_t* name_put_dec(uint8_t* p, uint8_t* end, int32_t value)
 {
-    i2c_app_init(0x01);
-    
-    int ret = sht20_read_temp_humi(temperature, humidity);
-    
-    if (ret != 0) {
-        PRINT("SHT20 read failed: %d\n", ret);
-        return 0;
+    uint8_t digits[10];
+    int n = 0;
+
+    if (value < 0) {
+        if (p < end) *p++ = '-';
+        value = -value;
+    }
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    while (n && p < end) {
+        *p++ = digits[--n];
     }
-    return 1;
+    return p;
 }
 
-// =============================================================================
-// 广播数据更新函数
-// =============================================================================
+/**
+ * @brief 写入一个字符 (超出 end 时丢弃)
+ */
+__HIGH_CODE
+static uint8_t* name_put_char(uint8_t* p, uint8_t* end, uint8_t c)
+{
+    if (p < end) *p++ = c;
+    return p;
+}
+
+/**
+ * @brief 0.01 单位的定点数四舍五入到整数 (远离零取整)
+ */
+__HIGH_CODE
+static int32_t centi_round(int32_t value)
+{
+    return (value >= 0) ? (value + 50) / 100 : -((50 - value) / 100);
+}
+
+/**
+ * @brief 写入一个 0.01 单位的传感器对象 (未广播或无效的对象写入 '-')
+ */
+__HIGH_CODE
+static uint8_t* name_put_sensor(uint8_t* p, uint8_t* end, uint8_t id)
+{
+    int32_t value;
+
+    if (sensor_get(id, &value) != 0 || value == SENSOR_VALUE_INVALID) {
+        return name_put_char(p, end, '-');
+    }
+    return name_put_dec(p, end, centi_round(value));
+}
 
 /**
  * @brief 更新广播数据中的设备名称
  * @param battery_percent 电池百分比
- * @param temperature 温度值
- * @param humidity 湿度值
  */
 __HIGH_CODE
-void update_advert_device_name(uint8_t battery_percent, uint16_t temperature, uint16_t humidity)
+void update_advert_device_name(uint8_t battery_percent)
 {
-    char name_buffer[22];
-    
-    snprintf(name_buffer, sizeof(name_buffer), "%d%%/%.0fC/%.0f%%", 
-             battery_percent, temperature / 100.0, humidity / 100.0);
-    
-    // 更新广播数据中的设备名称字段
-    int name_len = strlen(name_buffer);
-    if (name_len > 13) name_len = 13; // 限制长度为13字节 (5-17位置)
-    
-    // 更新广播数据
-    advertData[NAME_PKG_LEN_IDX] = 13; // 更新长度字段 (13字节设备名称)
-    advertData[NAME_PKG_TYPE_IDX] = 0x09; // 设备名称类型
-    memcpy(&advertData[NAME_PKG_DATA_IDX], name_buffer, name_len);
+    // 直接在广播数据中格式化 "B%/TC/H%", 超出字段长度时截断
+    uint8_t* p = &advertData[NAME_PKG_DATA_IDX];
+    uint8_t* end = p + NAME_PKG_DATA_LEN;
+
+    p = name_put_dec(p, end, battery_percent);
+    p = name_put_char(p, end, '%');
+    p = name_put_char(p, end, '/');
+    p = name_put_sensor(p, end, BTHOME_ID_TEMPERATURE);
+    p = name_put_char(p, end, 'C');
+    p = name_put_char(p, end, '/');
+    p = name_put_sensor(p, end, BTHOME_ID_HUMIDITY);
+    p = name_put_char(p, end, '%');
+
     // 用空格填充剩余字节
-    for (int i = name_len; i < 13; i++) {
-        advertData[NAME_PKG_DATA_IDX + i] = ' ';
+    while (p < end) {
+        *p++ = ' ';
     }
+}
+#endif /* BTHOME_ENCRYPTION == FALSE */
 
-    // 更新电池电量
-    advertData[BTH_PKG_BAT_IDX] = battery_percent;
-    
-    advertData[BTH_PKG_TEMP_IDX] = temperature & 0xFF; // 温度低字节
-    advertData[BTH_PKG_TEMP_IDX + 1] = (temperature >> 8) & 0xFF; // 温度高字节
+#if (BTHOME_ENCRYPTION == TRUE)
+/**
+ * @brief 在 data flash 中预留下一段计数值, 复位后从预留上限继续计数, 保证 nonce 不重复
+ */
+static void bthome_counter_reserve(void)
+{
+    uint32_t stored[2];
+
+    bth_counter_limit = bth_counter + BTHOME_COUNTER_STEP;
+    stored[0] = bth_counter_limit;
+    stored[1] = ~bth_counter_limit;
+    EEPROM_ERASE(BTHOME_COUNTER_ADDR, EEPROM_PAGE_SIZE);
+    EEPROM_WRITE(BTHOME_COUNTER_ADDR, stored, sizeof(stored));
+}
+
+/**
+ * @brief 加密初始化: 展开密钥, 生成 nonce 前缀, 恢复计数器
+ */
+static void bthome_crypto_init(void)
+{
+    static const uint8_t key[16] = BTHOME_BINDKEY;
+    uint32_t stored[2];
+    uint8_t i;
+
+    aes128_init(&bth_aes_ctx, key);
+
+#if (defined(BLE_MAC)) && (BLE_MAC == TRUE)
+    for (i = 0; i < 6; i++) {
+        bth_nonce[i] = MacAddr[i];
+    }
+#else
+    {
+        uint8_t mac[6];
+        GetMACAddress(mac); // 芯片MAC地址为小端, nonce 使用大端
+        for (i = 0; i < 6; i++) {
+            bth_nonce[i] = mac[5 - i];
+        }
+    }
+#endif
+    bth_nonce[6] = BTHOME_UUID_LO;
+    bth_nonce[7] = BTHOME_UUID_HI;
+    bth_nonce[8] = BTHOME_DEVICE_INFO_ENCRYPT;
+
+    EEPROM_READ(BTHOME_COUNTER_ADDR, stored, sizeof(stored));
+    bth_counter = (stored[0] == ~stored[1]) ? stored[0] : 0;
+    bthome_counter_reserve();
+}
+
+/**
+ * @brief 加密明文对象列表, 写入密文, 计数器和 MIC
+ */
+static void bthome_encrypt_payload(void)
+{
+    uint32_t start = SYS_GetSysTickCnt();
+
+    if (bth_counter >= bth_counter_limit) {
+        bthome_counter_reserve();
+    }
+
+    bthome_put_u32(&bth_nonce[9], bth_counter);
+    memcpy(&advertData[BTH_PKG_COUNTER_IDX], &bth_nonce[9], BTHOME_COUNTER_LEN);
+
+    aes_ccm_encrypt(&bth_aes_ctx, bth_nonce, BTHOME_NONCE_LEN,
+                    bth_plain_data, BTH_PKG_OBJ_LEN, &advertData[BTH_PKG_OBJ_IDX],
+                    &advertData[BTH_PKG_MIC_IDX], BTHOME_MIC_LEN);
+    bth_counter++;
+
+    PRINT("BTHome encrypt: counter %d, %d cycles\n",
+          (int)(bth_counter - 1), (int)(SYS_GetSysTickCnt() - start));
+}
+#endif /* BTHOME_ENCRYPTION == TRUE */
+
+/**
+ * @brief 判断数值相对上次广播值的变化是否超出死区
+ */
+__HIGH_CODE
+static uint8_t deadband_exceeded(int32_t value, int32_t last, int32_t deadband)
+{
+    int32_t diff = value - last;
 
-    advertData[BTH_PKG_HUMID_IDX] = humidity & 0xFF; // 湿度低字节
-    advertData[BTH_PKG_HUMID_IDX + 1] = (humidity >> 8) & 0xFF; // 湿度高字节
+    return (diff >= deadband) || (diff <= -deadband);
 }
 
 /**
- * @brief 更新广播数据
+ * @brief 传感器对象写入广播的原始值
+ * @param obj SENSOR_OBJ_<名称>
+ * @param id 对象ID
+ * @param width 数据宽度
+ * @return 原始值, 无效时为 BTHome 的无效值
  */
 __HIGH_CODE
-void update_advert_data() 
+static uint32_t bth_sensor_raw(uint8_t obj, uint8_t id, uint8_t width)
+{
+    int32_t value = sensor_value(obj);
+
+    return (value == SENSOR_VALUE_INVALID) ? bthome_invalid(id, width) : (uint32_t)value;
+}
+
+/**
+ * @brief 以最新的传感器结果更新广播数据
+ * @return TRUE表示数据有变化需要更新广播，FALSE表示无变化
+ */
+__HIGH_CODE
+uint8_t update_advert_data(void)
 {
-    // 读取传感器数据
-    uint16_t temp, humid;
     uint8_t battery_percent;
 
-    int sht20_ret = read_sht20_data(&temp, &humid);
-    if (!sht20_ret) {
-        temp = 0xffff;
-        humid = 0xffff;
-    }
+    TRACE_BEGIN(TRACE_ID_ADVERT_UPDATE);
 
     // 读取电池电压
     bat = sample_battery_voltage();
-    battery_percent = (uint8_t)((bat-3100)/8);
-    if (battery_percent > 100)
+    // 3100mV 以下为 0%, 先限幅再转换, 否则会回绕成很大的值
+    if (bat <= 3100)
+        battery_percent = 0;
+    else if (bat >= 3100 + 8 * 100)
         battery_percent = 100;
+    else
+        battery_percent = (uint8_t)((bat-3100)/8);
+
+    // 所有字段都在死区内时保持原广播数据不变
+    if (adv_valid &&
+        !deadband_exceeded(battery_percent, adv_last_bat, BTH_BAT_DEADBAND) &&
+        !sensor_changed()) {
+        adv_skip_count++;
+        PRINT("Advert unchanged (packet id %d), skipped %d updates\n",
+              adv_packet_id, (int)adv_skip_count);
+        TRACE_END(TRACE_ID_ADVERT_UPDATE);
+        return FALSE;
+    }
 
-    update_advert_device_name(battery_percent, temp, humid);
+    adv_valid = TRUE;
+    adv_last_bat = battery_percent;
+    sensor_commit();
+
+    // 更新 BTHome 对象 (小端)
+    // 仅在数据变化时递增 packet id, 接收端可据此丢弃重复数据包
+    bthome_put_u8(BTH_OBJ_PTR(PID), ++adv_packet_id);
+    bthome_put_u8(BTH_OBJ_PTR(BAT), battery_percent);
+    SENSOR_OBJECTS(BTH_PUT_SENSOR)
+#if (BTH_ADVERT_ENERGY == TRUE)
+    {
+        uint32_t current = (HAL_EnergyAverage() + 50) / 100;
+        bthome_put_u16(BTH_OBJ_PTR(CURRENT), current > 0xffff ? 0xffff : current);
+    }
+#endif
+
+#if (BTHOME_ENCRYPTION == TRUE)
+    bthome_encrypt_payload();
+#else
+    update_advert_device_name(battery_percent);
+#endif
     
     // 打印调试信息
-    PRINT("Updated advert data: BAT=%d%%, T=%d, H=%d\n", battery_percent, temp, humid);
-    PRINT("Advert data length: %d bytes\n", sizeof(advertData));
+    PRINT("Updated advert data: BAT=%d%%", battery_percent);
+    SENSOR_OBJECTS(BTH_PRINT_SENSOR)
+    PRINT("\n");
+    PRINT("Advert data length: %d bytes\n", (int)sizeof(advertData));
     
     // 打印数据包内容用于调试
     PRINT("Advert data: ");
-    for (int i = 0; i < sizeof(advertData); i++) {
+    for (uint8_t i = 0; i < sizeof(advertData); i++) {
         PRINT("%02X ", advertData[i]);
     }
     PRINT("\n");
+
+    TRACE_END(TRACE_ID_ADVERT_UPDATE);
+    return TRUE;
+}
+
+// =============================================================================
+// 传感器采样状态机
+// =============================================================================
+
+/**
+ * @brief 计算从 start 到当前经过的 RTC 周期数
+ * @param start 起始 RTC 计数值
+ * @return 经过的 RTC 周期数
+ */
+static uint32_t rtc_elapsed(uint32_t start)
+{
+    uint32_t now = RTC_GetCycle32k();
+
+    if (now < start) {
+        now += RTC_MAX_COUNT;
+    }
+    return now - start;
+}
+
+#if (SBP_I2C_EXPORT == TRUE)
+/**
+ * @brief 将采样结果写入后台缓冲区并发布给 I2C 主机
+ * @param ok 采样是否成功
+ */
+static void sensor_export(uint8_t ok)
+{
+    uint8_t *regs = i2c_export_begin();
+    int32_t temp = SENSOR_VALUE_INVALID, humid = SENSOR_VALUE_INVALID;
+
+    // 主机仍在读取后台缓冲区, 本次不更新
+    if (regs == NULL) {
+        return;
+    }
+    regs[SBP_REG_STATUS] = SBP_STATUS_VALID | (ok ? SBP_STATUS_SAMPLE_OK : 0);
+    regs[SBP_REG_SEQ] = ++export_seq;
+    sensor_get(BTHOME_ID_TEMPERATURE, &temp);
+    sensor_get(BTHOME_ID_HUMIDITY, &humid);
+    bthome_put_u16(&regs[SBP_REG_TEMP], temp == SENSOR_VALUE_INVALID ? SBP_REG_INVALID : temp);
+    bthome_put_u16(&regs[SBP_REG_HUMI], humid == SENSOR_VALUE_INVALID ? SBP_REG_INVALID : humid);
+    bthome_put_u16(&regs[SBP_REG_BAT_MV], bat);
+    regs[SBP_REG_BAT_PCT] = adv_last_bat;
+    i2c_export_publish();
+}
+#endif
+
+/**
+ * @brief 结束本次采样，更新广播数据
+ * @param ok 采样是否成功
+ */
+static void sensor_sample_finish(uint8_t ok)
+{
+    uint8_t changed;
+    uint32_t awake_us;
+
+    if (!ok) {
+        i2c_stats_print();
+    }
+
+    changed = update_advert_data();
+    if (changed) {
+        GAP_UpdateAdvertisingData(0, TRUE, sizeof(advertData), advertData);
+    }
+#if (SBP_I2C_EXPORT == TRUE)
+    sensor_export(ok);
+#endif
+
+    awake_us = RTC_TICKS_TO_US(sensor_awake_rtc + rtc_elapsed(sensor_stage_start));
+    ENERGY_ENTER(ENERGY_STATE_AWAKE);
+    PRINT("Sample awake time: %d us\n", (int)awake_us);
+#ifdef CONFIG_I2C_DEBUG
+    i2c_power_stats_print();
+#endif
+
+    // 根据数据变化和电池电量调整广播间隔及采样周期, 新的采样周期立即生效
+    if (adv_policy_update(changed, adv_last_bat, awake_us)) {
+        tmos_start_task(Broadcaster_TaskID, SBP_PERIODIC_EVT, adv_policy_sample_period());
+    }
+}
+
+/**
+ * @brief 开始采样: 由传感器注册表配置各驱动并交给 I2C 调度器触发和读取
+ */
+static void sensor_sample_start(void)
+{
+    int ret;
+
+    // 首次完整初始化, 之后只打开时钟并恢复丢失的配置
+    i2c_app_init(SBP_I2C_OWN_ADDR << 1);
+
+    // 驱动配置计入本阶段, 调度器记录之后各阶段的唤醒时间
+    ret = sensor_start(Broadcaster_TaskID);
+    sensor_awake_rtc = rtc_elapsed(sensor_stage_start);
+    if (ret != 0) {
+        sensor_stage_start = RTC_GetCycle32k();
+        sensor_fail();
+        sensor_sample_finish(FALSE);
+    }
+}
+
+/**
+ * @brief 调度周期完成: 校验并换算结果
+ * @param msg 完成消息
+ */
+static void sensor_sched_done(i2c_sched_done_msg_t* msg)
+{
+    sensor_stage_start = RTC_GetCycle32k();
+    sensor_awake_rtc += msg->sched->awake_rtc;
+    sensor_sample_finish(sensor_done(msg));
 }
 
 // =============================================================================
@@ -231,6 +734,21 @@ void update_advert_data()
 void Broadcaster_Init()
 {
     Broadcaster_TaskID = TMOS_ProcessEventRegister(Broadcaster_ProcessEvent);
+    adv_policy_init();
+    adc_calib_init();
+    sensor_init();
+
+#if (SBP_I2C_EXPORT == TRUE)
+    // 从机导出需要 I2C 始终可被寻址, 启动时完成初始化
+    i2c_app_init(SBP_I2C_OWN_ADDR << 1);
+    i2c_export_enable(&export_map);
+#endif
+
+#if (BTHOME_ENCRYPTION == TRUE)
+    // 密钥展开只在初始化时进行一次, 并加密初始广播数据
+    bthome_crypto_init();
+    bthome_encrypt_payload();
+#endif
 
     // 设置GAP广播角色参数
     {
@@ -244,16 +762,19 @@ void Broadcaster_Init()
 
     // 设置广播间隔
     {
-        uint16_t advInt = DEFAULT_ADVERTISING_INTERVAL;
+        uint16_t advInt = adv_policy_adv_interval();
         GAP_SetParamValue(TGAP_DISC_ADV_INT_MIN, advInt);
         GAP_SetParamValue(TGAP_DISC_ADV_INT_MAX, advInt);
+#if (defined(HAL_ENERGY)) && (HAL_ENERGY == TRUE)
+        HAL_EnergySetAdvInterval(advInt);
+#endif
     }
 
     // 启动设备
-    tmos_start_task(Broadcaster_TaskID, SBP_START_DEVICE_EVT, DEFAULT_ADVERTISING_INTERVAL);
+    tmos_start_task(Broadcaster_TaskID, SBP_START_DEVICE_EVT, adv_policy_adv_interval());
 
     // 设置定时器读取传感器数据并更新广播
-    tmos_start_task(Broadcaster_TaskID, SBP_PERIODIC_EVT, 2 * DEFAULT_ADVERTISING_INTERVAL - 320);
+    tmos_start_task(Broadcaster_TaskID, SBP_PERIODIC_EVT, 2 * adv_policy_adv_interval() - 320);
 }
 
 /**
@@ -282,11 +803,12 @@ uint16_t Broadcaster_ProcessEvent(uint8_t task_id, uint16_t events)
     }
 
     if (events & SBP_PERIODIC_EVT) {
-        tmos_start_task(Broadcaster_TaskID, SBP_PERIODIC_EVT, SBP_PERIODIC_EVT_PERIOD);
+        tmos_start_task(Broadcaster_TaskID, SBP_PERIODIC_EVT, adv_policy_sample_period());
 
-        // 数据采集并更新广播
-        update_advert_data();
-        GAP_UpdateAdvertisingData(0, TRUE, sizeof(advertData), advertData);
+        // 启动数据采集, 调度器完成所有转换和读取后更新广播
+        sensor_stage_start = RTC_GetCycle32k();
+        ENERGY_ENTER(ENERGY_STATE_SENSOR);
+        sensor_sample_start();
 
         return (events ^ SBP_PERIODIC_EVT);
     }
@@ -306,6 +828,10 @@ uint16_t Broadcaster_ProcessEvent(uint8_t task_id, uint16_t events)
 static void Broadcaster_ProcessTMOSMsg(tmos_event_hdr_t* pMsg)
 {
     switch (pMsg->event) {
+    case I2C_SCHED_DONE_MSG:
+        sensor_sched_done((i2c_sched_done_msg_t*)pMsg);
+        break;
+
     default:
         break;
     }
@@ -328,6 +854,10 @@ static void Broadcaster_StateNotificationCB(gapRole_States_t newState)
 
     case GAPROLE_WAITING:
         PRINT("Waiting for advertising..\n");
+        // 广播间隔调整时先停止广播, 停止完成后以新间隔重新开始
+        if (adv_policy_resume()) {
+            PRINT("Advertising restarted, interval %d\n", adv_policy_adv_interval());
+        }
         break;
 
     case GAPROLE_ERROR:
@@ -0,0 +1,594 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : i2c_sched.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : 多设备 I2C 测量调度, 不同设备的转换重叠进行
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "HAL.h"
+#include "i2c_sched.h"
+
+// 调度任务事件: 有转换完成, 读取结果
+#define I2C_SCHED_DUE_EVT   0x0001
+
+// 在此时间内先后完成的转换合并为一次唤醒读取 (ms)
+#define I2C_SCHED_MERGE_MS  2
+// 一次唤醒的额外开销估计: 等待 32M 晶振稳定及任务调度 (us)
+#define I2C_SCHED_WAKE_US   2000
+// 一次传输的总线时间估计: 地址 + 数据, 每字节 9 个时钟, 加中断处理开销 (us)
+#define I2C_SCHED_XFER_US(bytes) \
+    ((uint32_t)((bytes) + 1) * 9 * 1000 / (I2C_CLOCK_SPEED / 1000) + 30)
+
+// TMOS 时钟与 RTC 周期换算
+#define I2C_SCHED_MS_TO_TMOS(ms)    (MS1_TO_SYSTEM_TIME(ms) + 1)
+#define RTC_TICKS_TO_US(t)          ((t) * (1000000 / 64) / (FREQ_RTC / 64))
+
+static tmosTaskID i2c_sched_task_id = INVALID_TASK_ID;
+// 当前运行的调度 (同一时间只运行一个)
+static i2c_sched_t *i2c_sched_cur;
+
+static tmosEvents i2c_sched_process_event(tmosTaskID task_id, tmosEvents events);
+static void i2c_sched_read(i2c_sched_job_t *job, uint8_t idx);
+
+/**
+ * @brief 计算从 start 到当前经过的 RTC 周期数
+ */
+static uint32_t rtc_elapsed(uint32_t start)
+{
+    uint32_t now = RTC_GetCycle32k();
+
+    if (now < start) {
+        now += RTC_MAX_COUNT;
+    }
+    return now - start;
+}
+
+/**
+ * @brief 注册调度任务
+ */
+void i2c_sched_init(void)
+{
+    if (i2c_sched_task_id == INVALID_TASK_ID) {
+        i2c_sched_task_id = TMOS_ProcessEventRegister(i2c_sched_process_event);
+    }
+}
+
+// =============================================================================
+// 调度规则, 运行和规划共用; 状态和到期时间由调用者给出
+// =============================================================================
+
+/**
+ * @brief 从 from 开始找下一个设备空闲的等待任务 (同一设备的任务按列表顺序执行)
+ * @param jobs 任务列表
+ * @param state 各任务的状态 (i2c_sched_state_t)
+ * @param num 任务数
+ * @param from 开始的任务序号
+ * @return 任务序号, 没有时返回 num
+ */
+static uint8_t i2c_sched_ready(const i2c_sched_job_t *jobs, const uint8_t *state, uint8_t num,
+                               uint8_t from)
+{
+    for (uint8_t i = from; i < num; i++) {
+        uint8_t busy = FALSE;
+
+        if (state[i] != I2C_SCHED_WAIT) {
+            continue;
+        }
+        for (uint8_t j = 0; j < i && !busy; j++) {
+            busy = (jobs[j].addr == jobs[i].addr && state[j] != I2C_SCHED_DONE);
+        }
+        if (!busy) {
+            return i;
+        }
+    }
+    return num;
+}
+
+/**
+ * @brief 设备空闲后任务的第一步: 设备已在转换 (周期测量) 时直接读取,
+ *        有触发命令时先触发, 否则直接等待转换
+ * @return I2C_SCHED_READ, I2C_SCHED_TRIG 或 I2C_SCHED_CONV
+ */
+static uint8_t i2c_sched_first_step(const i2c_sched_job_t *job)
+{
+    if (job->flags & I2C_SCHED_FETCH) {
+        return I2C_SCHED_READ;
+    }
+    return job->cmd_len ? I2C_SCHED_TRIG : I2C_SCHED_CONV;
+}
+
+/**
+ * @brief 下一次唤醒: 最早完成的转换, 推迟到合并窗口内最晚完成的转换
+ * @param state 各任务的状态
+ * @param due 各任务转换完成的时间, 单位由调用者决定, 可回绕
+ * @param num 任务数
+ * @param merge 合并窗口, 与 due 单位相同
+ * @param wake 输出唤醒时间
+ * @return FALSE表示没有正在转换的任务
+ */
+static uint8_t i2c_sched_wake_time(const uint8_t *state, const uint32_t *due, uint8_t num,
+                                   uint32_t merge, uint32_t *wake)
+{
+    uint8_t found = FALSE;
+    uint32_t first = 0, target;
+
+    for (uint8_t i = 0; i < num; i++) {
+        if (state[i] == I2C_SCHED_CONV && (!found || (int32_t)(due[i] - first) < 0)) {
+            first = due[i];
+            found = TRUE;
+        }
+    }
+    if (!found) {
+        return FALSE;
+    }
+
+    target = first;
+    for (uint8_t i = 0; i < num; i++) {
+        if (state[i] == I2C_SCHED_CONV && (int32_t)(due[i] - first) <= (int32_t)merge &&
+            (int32_t)(due[i] - target) > 0) {
+            target = due[i];
+        }
+    }
+    *wake = target;
+    return TRUE;
+}
+
+/**
+ * @brief 读取结果需要的字节数, 不含读地址 (I2C_SCHED_XFER_US 已计入);
+ *        先写寄存器地址或读取命令时加上写地址和写入的字节
+ */
+static uint16_t i2c_sched_read_bytes(const i2c_sched_job_t *job)
+{
+    if (job->flags & I2C_SCHED_FETCH) {
+        return job->rx_len + 1 + job->cmd_len;
+    }
+    return (job->flags & I2C_SCHED_RD_REG) ? job->rx_len + 1 + 1 : job->rx_len;
+}
+
+/**
+ * @brief 任务是否有单独的触发命令
+ */
+static uint8_t i2c_sched_has_trigger(const i2c_sched_job_t *job)
+{
+    return job->cmd_len && !(job->flags & I2C_SCHED_FETCH);
+}
+
+// =============================================================================
+// 运行
+// =============================================================================
+
+/**
+ * @brief 任务失败, 结束该任务以释放设备
+ */
+static void i2c_sched_fail(i2c_sched_job_t *job, uint8_t status)
+{
+    job->status = status;
+    job->state = I2C_SCHED_DONE;
+    PRINT("I2C sched: job %d (0x%02x) failed: %d\n", job->tag, job->addr, status);
+}
+
+/**
+ * @brief 提交一个任务的一次传输
+ * @return 0表示成功, 负值表示错误代码
+ */
+static int i2c_sched_submit(i2c_sched_job_t *job, uint8_t idx, uint8_t num)
+{
+    job->xfer.msgs = job->msgs;
+    job->xfer.num = num;
+    job->xfer.task_id = i2c_sched_task_id;
+    job->xfer.tag = idx;
+
+    return i2c_submit(&job->xfer);
+}
+
+/**
+ * @brief 发送触发命令, 没有命令的任务直接进入转换等待
+ */
+static void i2c_sched_trigger(i2c_sched_job_t *job, uint8_t idx)
+{
+    int ret;
+
+    switch (i2c_sched_first_step(job)) {
+    case I2C_SCHED_READ:
+        i2c_sched_read(job, idx);
+        return;
+    case I2C_SCHED_CONV:
+        job->state = I2C_SCHED_CONV;
+        job->due = TMOS_GetSystemClock() + I2C_SCHED_MS_TO_TMOS(job->conv_ms);
+        return;
+    default:
+        break;
+    }
+
+    job->msgs[0].addr = job->addr;
+    job->msgs[0].flags = 0;
+    job->msgs[0].len = job->cmd_len;
+    job->msgs[0].buf = job->cmd;
+    job->state = I2C_SCHED_TRIG;
+
+    ret = i2c_sched_submit(job, idx, 1);
+    if (ret) {
+        i2c_sched_fail(job, -ret);
+    }
+}
+
+/**
+ * @brief 读取转换结果, 需要时先写寄存器地址或读取命令再重复起始读取
+ */
+static void i2c_sched_read(i2c_sched_job_t *job, uint8_t idx)
+{
+    uint8_t n = 0;
+    int ret;
+
+    if ((job->flags & I2C_SCHED_FETCH) && job->cmd_len) {
+        job->msgs[n].addr = job->addr;
+        job->msgs[n].flags = 0;
+        job->msgs[n].len = job->cmd_len;
+        job->msgs[n].buf = job->cmd;
+        n++;
+    } else if (job->flags & I2C_SCHED_RD_REG) {
+        job->msgs[n].addr = job->addr;
+        job->msgs[n].flags = 0;
+        job->msgs[n].len = 1;
+        job->msgs[n].buf = &job->rd_reg;
+        n++;
+    }
+    job->msgs[n].addr = job->addr;
+    job->msgs[n].flags = I2C_M_RD;
+    job->msgs[n].len = job->rx_len;
+    job->msgs[n].buf = job->rx;
+    n++;
+    job->state = I2C_SCHED_READ;
+
+    ret = i2c_sched_submit(job, idx, n);
+    if (ret) {
+        i2c_sched_fail(job, -ret);
+    }
+}
+
+/**
+ * @brief 取出各任务的状态和到期时间, 供调度规则使用
+ */
+static void i2c_sched_snapshot(const i2c_sched_t *sched, uint8_t *state, uint32_t *due)
+{
+    for (uint8_t i = 0; i < sched->num; i++) {
+        state[i] = sched->jobs[i].state;
+        due[i] = sched->jobs[i].due;
+    }
+}
+
+/**
+ * @brief 触发所有设备空闲的等待任务
+ */
+static void i2c_sched_kick(i2c_sched_t *sched)
+{
+    uint8_t state[I2C_SCHED_JOBS_MAX];
+    uint32_t due[I2C_SCHED_JOBS_MAX];
+
+    i2c_sched_snapshot(sched, state, due);
+    for (uint8_t i = i2c_sched_ready(sched->jobs, state, sched->num, 0); i < sched->num;
+         i = i2c_sched_ready(sched->jobs, state, sched->num, i + 1)) {
+        i2c_sched_trigger(&sched->jobs[i], i);
+        state[i] = sched->jobs[i].state;
+    }
+}
+
+/**
+ * @brief 设置下一次唤醒
+ */
+static void i2c_sched_arm(i2c_sched_t *sched)
+{
+    uint8_t state[I2C_SCHED_JOBS_MAX];
+    uint32_t due[I2C_SCHED_JOBS_MAX];
+    uint32_t now = TMOS_GetSystemClock();
+    uint32_t target;
+
+    i2c_sched_snapshot(sched, state, due);
+    if (!i2c_sched_wake_time(state, due, sched->num, MS1_TO_SYSTEM_TIME(I2C_SCHED_MERGE_MS),
+                             &target)) {
+        return;
+    }
+    tmos_start_task(i2c_sched_task_id, I2C_SCHED_DUE_EVT,
+                    (int32_t)(target - now) > 0 ? target - now : 1);
+}
+
+/**
+ * @brief 开始一个唤醒阶段
+ */
+static void i2c_sched_stage_begin(i2c_sched_t *sched)
+{
+    sched->stage_start = RTC_GetCycle32k();
+    sched->wakes++;
+    ENERGY_ENTER(ENERGY_STATE_SENSOR);
+}
+
+/**
+ * @brief 总线上没有传输时结束唤醒阶段, 全部完成时通知调用者
+ */
+static void i2c_sched_stage_check(i2c_sched_t *sched)
+{
+    uint8_t inflight = 0, done = 0, failed = 0;
+    i2c_sched_done_msg_t *msg;
+
+    for (uint8_t i = 0; i < sched->num; i++) {
+        switch (sched->jobs[i].state) {
+        case I2C_SCHED_TRIG:
+        case I2C_SCHED_READ:
+            inflight++;
+            break;
+        case I2C_SCHED_DONE:
+            done++;
+            failed |= (sched->jobs[i].status != 0);
+            break;
+        default:
+            break;
+        }
+    }
+    if (inflight) {
+        return;
+    }
+
+    sched->awake_rtc += rtc_elapsed(sched->stage_start);
+    ENERGY_ENTER(ENERGY_STATE_AWAKE);
+
+    if (done < sched->num) {
+        i2c_sched_arm(sched);
+        return;
+    }
+
+    sched->busy = FALSE;
+    i2c_sched_cur = NULL;
+
+    msg = (i2c_sched_done_msg_t *)tmos_msg_allocate(sizeof(i2c_sched_done_msg_t));
+    if (msg) {
+        msg->hdr.event = I2C_SCHED_DONE_MSG;
+        msg->hdr.status = failed;
+        msg->sched = sched;
+        tmos_msg_send(sched->task_id, (uint8_t *)msg);
+    }
+}
+
+/**
+ * @brief 开始一个测量周期
+ * @param sched 任务集合
+ * @param task_id 接收完成消息的任务
+ * @return 0表示成功, 负值表示错误代码
+ */
+int i2c_sched_run(i2c_sched_t *sched, uint8_t task_id)
+{
+    if (i2c_sched_cur || i2c_sched_task_id == INVALID_TASK_ID) {
+        return -I2C_STATE;
+    }
+    if (sched->num > I2C_SCHED_JOBS_MAX) {
+        return -I2C_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < sched->num; i++) {
+        sched->jobs[i].state = I2C_SCHED_WAIT;
+        sched->jobs[i].status = 0;
+        sched->jobs[i].t_trig = 0;
+        sched->jobs[i].t_read = 0;
+    }
+    sched->task_id = task_id;
+    sched->busy = TRUE;
+    sched->wakes = 0;
+    sched->awake_rtc = 0;
+    sched->start = RTC_GetCycle32k();
+    i2c_sched_cur = sched;
+
+    i2c_sched_stage_begin(sched);
+    i2c_sched_kick(sched);
+    i2c_sched_stage_check(sched);
+    return 0;
+}
+
+/**
+ * @brief 处理一次传输完成
+ * @param xfer 完成的传输
+ */
+static void i2c_sched_xfer_done(i2c_xfer_t *xfer)
+{
+    i2c_sched_t *sched = i2c_sched_cur;
+    i2c_sched_job_t *job;
+
+    if (!sched || xfer->tag >= sched->num) {
+        return;
+    }
+    job = &sched->jobs[xfer->tag];
+
+    if (xfer->status) {
+        i2c_sched_fail(job, xfer->status);
+    } else if (job->state == I2C_SCHED_TRIG) {
+        job->t_trig = rtc_elapsed(sched->start);
+        job->due = TMOS_GetSystemClock() + I2C_SCHED_MS_TO_TMOS(job->conv_ms);
+        job->state = I2C_SCHED_CONV;
+    } else {
+        job->t_read = rtc_elapsed(sched->start);
+        job->state = I2C_SCHED_DONE;
+    }
+
+    // 设备已空闲, 触发其下一个任务
+    if (job->state == I2C_SCHED_DONE) {
+        i2c_sched_kick(sched);
+    }
+    i2c_sched_stage_check(sched);
+}
+
+/**
+ * @brief 转换完成: 读取所有已到期的任务
+ */
+static void i2c_sched_due(i2c_sched_t *sched)
+{
+    uint32_t now = TMOS_GetSystemClock();
+    uint8_t n = 0;
+
+    i2c_sched_stage_begin(sched);
+    for (uint8_t i = 0; i < sched->num; i++) {
+        i2c_sched_job_t *job = &sched->jobs[i];
+
+        if (job->state == I2C_SCHED_CONV && (int32_t)(job->due - now) <= 0) {
+            i2c_sched_read(job, i);
+            n++;
+        }
+    }
+    if (!n) {
+        sched->wakes--;
+    }
+    // 提交失败的读取已释放设备
+    i2c_sched_kick(sched);
+    i2c_sched_stage_check(sched);
+}
+
+/**
+ * @brief 调度任务事件处理
+ */
+static tmosEvents i2c_sched_process_event(tmosTaskID task_id, tmosEvents events)
+{
+    if (events & SYS_EVENT_MSG) {
+        uint8_t *msg = tmos_msg_receive(task_id);
+
+        if (msg) {
+            if (((tmos_event_hdr_t *)msg)->event == I2C_XFER_DONE_MSG) {
+                i2c_sched_xfer_done(((i2c_done_msg_t *)msg)->xfer);
+            }
+            tmos_msg_deallocate(msg);
+        }
+        return (events ^ SYS_EVENT_MSG);
+    }
+
+    if (events & I2C_SCHED_DUE_EVT) {
+        if (i2c_sched_cur) {
+            i2c_sched_due(i2c_sched_cur);
+        }
+        return (events ^ I2C_SCHED_DUE_EVT);
+    }
+
+    return 0;
+}
+
+// =============================================================================
+// 规划与打印
+// =============================================================================
+
+/**
+ * @brief 按运行时相同的规则模拟一个周期, 总线时间按 I2C_CLOCK_SPEED 估计
+ * @param sched 任务集合
+ * @param plan 输出
+ */
+void i2c_sched_plan(const i2c_sched_t *sched, i2c_sched_plan_t *plan)
+{
+    uint8_t state[I2C_SCHED_JOBS_MAX];
+    uint32_t due[I2C_SCHED_JOBS_MAX];
+    // 总线上按提交顺序排队的操作
+    uint8_t queue[I2C_SCHED_JOBS_MAX];
+    uint8_t qlen = 0;
+    uint32_t t = 0, bus_us = 0;
+    uint8_t num = sched->num < I2C_SCHED_JOBS_MAX ? sched->num : I2C_SCHED_JOBS_MAX;
+    uint8_t done = 0;
+
+    memset(plan, 0, sizeof(*plan));
+
+    // 串行执行: 每个任务依次触发, 等待, 读取
+    for (uint8_t i = 0; i < num; i++) {
+        const i2c_sched_job_t *job = &sched->jobs[i];
+
+        plan->serial_us += (i2c_sched_has_trigger(job) ? I2C_SCHED_XFER_US(job->cmd_len) : 0)
+                         + (uint32_t)job->conv_ms * 1000
+                         + I2C_SCHED_XFER_US(i2c_sched_read_bytes(job));
+        state[i] = I2C_SCHED_WAIT;
+    }
+
+    plan->wakes = 1;
+    while (done < num) {
+        uint32_t target;
+
+        // 设备空闲的任务入队触发
+        for (uint8_t i = i2c_sched_ready(sched->jobs, state, num, 0); i < num;
+             i = i2c_sched_ready(sched->jobs, state, num, i + 1)) {
+            state[i] = i2c_sched_first_step(&sched->jobs[i]);
+            if (state[i] == I2C_SCHED_CONV) {
+                due[i] = t + (uint32_t)sched->jobs[i].conv_ms * 1000;
+            } else {
+                queue[qlen++] = i;
+            }
+        }
+
+        // 执行总线队列中的第一个操作
+        if (qlen) {
+            uint8_t i = queue[0];
+            uint32_t us = (state[i] == I2C_SCHED_TRIG) ? I2C_SCHED_XFER_US(sched->jobs[i].cmd_len)
+                                                      : I2C_SCHED_XFER_US(i2c_sched_read_bytes(&sched->jobs[i]));
+
+            memmove(queue, queue + 1, --qlen);
+            t += us;
+            bus_us += us;
+            if (plan->steps < I2C_SCHED_STEPS_MAX) {
+                plan->step[plan->steps].t_us = t;
+                plan->step[plan->steps].job = i;
+                plan->step[plan->steps].read = (state[i] == I2C_SCHED_READ);
+                plan->steps++;
+            }
+            if (state[i] == I2C_SCHED_TRIG) {
+                state[i] = I2C_SCHED_CONV;
+                due[i] = t + (uint32_t)sched->jobs[i].conv_ms * 1000;
+            } else {
+                state[i] = I2C_SCHED_DONE;
+                done++;
+            }
+            continue;
+        }
+
+        // 总线空闲: 睡眠到下一次唤醒
+        if (!i2c_sched_wake_time(state, due, num, I2C_SCHED_MERGE_MS * 1000, &target)) {
+            break;
+        }
+        if (target > t) {
+            t = target;
+        }
+        plan->wakes++;
+        for (uint8_t i = 0; i < num; i++) {
+            if (state[i] == I2C_SCHED_CONV && due[i] <= t) {
+                state[i] = I2C_SCHED_READ;
+                queue[qlen++] = i;
+            }
+        }
+    }
+
+    plan->cycle_us = t;
+    plan->awake_us = bus_us + plan->wakes * I2C_SCHED_WAKE_US;
+}
+
+/**
+ * @brief 打印计划的调度及上一周期的实际时间
+ * @param sched 任务集合
+ */
+void i2c_sched_print(const i2c_sched_t *sched)
+{
+#ifdef DEBUG
+    i2c_sched_plan_t plan;
+
+    i2c_sched_plan(sched, &plan);
+    PRINT("I2C schedule: cycle %d us (serial %d us), %d wakes, awake ~%d us\n",
+          (int)plan.cycle_us, (int)plan.serial_us, plan.wakes, (int)plan.awake_us);
+    for (uint8_t i = 0; i < plan.steps; i++) {
+        const i2c_sched_job_t *job = &sched->jobs[plan.step[i].job];
+
+        PRINT("  %7d us  %s job %d (0x%02x)\n", (int)plan.step[i].t_us,
+              plan.step[i].read ? "read   " : "trigger", job->tag, job->addr);
+    }
+
+    if (sched->busy || !sched->wakes) {
+        return;
+    }
+    PRINT("Last cycle: %d wakes, awake %d us\n", sched->wakes,
+          (int)RTC_TICKS_TO_US(sched->awake_rtc));
+    for (uint8_t i = 0; i < sched->num; i++) {
+        const i2c_sched_job_t *job = &sched->jobs[i];
+
+        PRINT("  job %d (0x%02x): trigger %d us, read %d us, status %d\n", job->tag, job->addr,
+              (int)RTC_TICKS_TO_US(job->t_trig), (int)RTC_TICKS_TO_US(job->t_read), job->status);
+    }
+#endif
+}
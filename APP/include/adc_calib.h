@@ -0,0 +1,47 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : adc_calib.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : ADC 粗调偏差管理: 按芯片温度变化和最长间隔重新校准, 保存在 data flash
+ *******************************************************************************/
+
+#ifndef ADC_CALIB_H
+#define ADC_CALIB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief   Restore the offset and the temperature it was taken at from
+ *          data flash. Without a valid record the first adc_calib_offset()
+ *          calibrates.
+ */
+void adc_calib_init(void);
+
+/**
+ * @brief   Offset for the channel being sampled. Reads the internal
+ *          temperature sensor (one conversion) and re-runs
+ *          ADC_DataCalib_Rough() (17 conversions) only when the
+ *          temperature drifted past the threshold or the offset is older
+ *          than the maximum age. The ADC must be set up for the channel.
+ *
+ * @return  Offset to add to the conversion result.
+ */
+int16_t adc_calib_offset(void);
+
+/**
+ * @brief   Print the calibration count and the conversions saved against
+ *          the previous fixed schedule, per hour of runtime. Prints
+ *          nothing without DEBUG.
+ */
+void adc_calib_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_CALIB_H */
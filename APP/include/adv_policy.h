@@ -0,0 +1,77 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : adv_policy.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : 根据数据变化和电池电量调整广播间隔及采样周期
+ *******************************************************************************/
+
+#ifndef ADV_POLICY_H
+#define ADV_POLICY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief   Reset the policy to the default level. Does not touch the GAP
+ *          parameters, the caller sets up advertising with
+ *          adv_policy_adv_interval() before starting the device.
+ */
+void adv_policy_init(void);
+
+/**
+ * @brief   Feed the result of one sample. Lengthens the intervals after
+ *          several stable samples or when the battery is low, shortens
+ *          them as soon as a reading moves. A new advertising interval
+ *          takes effect through adv_policy_resume().
+ *
+ * @param changed   Whether the reading moved past the deadband.
+ * @param battery   Battery level in percent.
+ * @param awake_us  Awake time of the sample, used by the energy model.
+ * @return          TRUE if the level changed.
+ */
+uint8_t adv_policy_update(uint8_t changed, uint8_t battery, uint32_t awake_us);
+
+/**
+ * @brief   Finish a level change. adv_policy_update() only stops
+ *          advertising; call this on GAPROLE_WAITING to apply the new
+ *          interval and enable advertising again, since an enable sent
+ *          while the role still reports advertising is dropped.
+ *
+ * @return  TRUE if advertising was re-enabled.
+ */
+uint8_t adv_policy_resume(void);
+
+/**
+ * @brief   Current advertising interval.
+ *
+ * @return  Interval in units of 625us.
+ */
+uint16_t adv_policy_adv_interval(void);
+
+/**
+ * @brief   Current sample period.
+ *
+ * @return  Period in units of 625us (TMOS ticks).
+ */
+uint32_t adv_policy_sample_period(void);
+
+/**
+ * @brief   Modelled average current of a level: sleep current plus the
+ *          charge of each advertising event and each sample spread over
+ *          their periods.
+ *
+ * @param level     Policy level.
+ * @param awake_us  Awake time of one sample.
+ * @return          Average current in nA.
+ */
+uint32_t adv_policy_model_na(uint8_t level, uint32_t awake_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADV_POLICY_H */
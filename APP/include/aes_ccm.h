@@ -0,0 +1,64 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : aes_ccm.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : AES-128 加密及 CCM 模式 (用于 BTHome 加密广播)
+ *******************************************************************************/
+
+#ifndef AES_CCM_H
+#define AES_CCM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define AES_BLOCK_SIZE      16
+#define AES128_ROUNDS       10
+
+/* AES-128 context holding the expanded key schedule */
+typedef struct {
+    uint8_t round_key[AES_BLOCK_SIZE * (AES128_ROUNDS + 1)];
+} aes128_ctx_t;
+
+/**
+ * @brief   Expand an AES-128 key into the context key schedule.
+ *          Only needs to run once per key.
+ *
+ * @param ctx   Pointer to context.
+ * @param key   128 bit key.
+ */
+void aes128_init(aes128_ctx_t *ctx, const uint8_t *key);
+
+/**
+ * @brief   Encrypt one block with the cached key schedule.
+ *
+ * @param ctx   Pointer to initialized context.
+ * @param in    Plain text block.
+ * @param out   Cipher text block, may be the same as in.
+ */
+void aes128_encrypt(const aes128_ctx_t *ctx, const uint8_t *in, uint8_t *out);
+
+/**
+ * @brief   AES-CCM authenticated encryption without additional data.
+ *
+ * @param ctx       Pointer to initialized context.
+ * @param nonce     Nonce.
+ * @param nonce_len Nonce length, 7 to 13 bytes.
+ * @param in        Plain text.
+ * @param len       Plain text length.
+ * @param out       Cipher text (len bytes), may be the same as in.
+ * @param mic       Message integrity check output.
+ * @param mic_len   MIC length, 4 to 16 bytes and even.
+ * @return          0 if successful, negative value on invalid parameters.
+ */
+int aes_ccm_encrypt(const aes128_ctx_t *ctx, const uint8_t *nonce, uint8_t nonce_len,
+        const uint8_t *in, uint8_t len, uint8_t *out, uint8_t *mic, uint8_t mic_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_CCM_H */
@@ -20,11 +20,24 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "CONFIG.h"
 
 #define I2C_BUFFER_LENGTH   32
+
+/* Bus clock in Hz. Above 400 kHz every device on the bus must support
+ * Fast-mode Plus, the SHT20 does not. */
+#ifndef I2C_CLOCK_SPEED
+#define I2C_CLOCK_SPEED     400000
+#endif
 #define I2C_READ      1
 #define I2C_WRITE     0
 
+/* i2c_msg flags */
+#define I2C_M_RD            0x01    // read from the slave, write otherwise
+
+/* TMOS message event of i2c_done_msg_t */
+#define I2C_XFER_DONE_MSG   0xE0
+
 typedef enum {
     I2C_READY,
     I2C_MRX,  
@@ -43,8 +56,71 @@ typedef enum {
     I2C_PECERR,
     I2C_TIMEOUT,
     I2C_SMBALERT,
+    I2C_ERROR_MAX,
 }i2c_error_t;
 
+/* Error statistics since reset */
+typedef struct {
+    uint16_t errors[I2C_ERROR_MAX];     // count per i2c_error_t
+    uint16_t recoveries;                // stuck bus recoveries
+} i2c_stats_t;
+
+/* Bring-up cost and clock gating statistics since reset */
+typedef struct {
+    uint32_t init_cycles;               // HCLK cycles of the last full init
+    uint32_t resume_cycles;             // HCLK cycles of the last resume
+    uint32_t resumes;                   // clock ungated
+    uint32_t reinits;                   // resumes that found the config lost
+    uint64_t clk_on_ticks;              // RTC ticks with the clock running
+} i2c_power_stats_t;
+
+/* Paths through I2C_IRQHandler, for the CONFIG_I2C_PROFILE counters */
+typedef enum {
+    I2C_PATH_NONE,          // no branch taken
+    I2C_PATH_M_START,       // START sent, address out
+    I2C_PATH_M_TX_DATA,
+    I2C_PATH_M_TX_STOP,
+    I2C_PATH_M_TX_RESTART,
+    I2C_PATH_M_TX_NACK,
+    I2C_PATH_M_RX_ADDR,
+    I2C_PATH_M_RX_DATA,
+    I2C_PATH_M_RX_STOP,
+    I2C_PATH_M_RX_RESTART,
+    I2C_PATH_M_RX_NACK,
+    I2C_PATH_S_TX_ADDR,
+    I2C_PATH_S_TX_DATA,
+    I2C_PATH_S_TX_NACK,
+    I2C_PATH_S_RX_ADDR,
+    I2C_PATH_S_RX_DATA,
+    I2C_PATH_S_RX_STOP,
+    I2C_PATH_ERROR,         // BERR, ARLO, OVR, PECERR, TIMEOUT or SMBALERT
+    I2C_PATH_MAX,
+}i2c_path_t;
+
+/* Interrupt count and SysTick cycles per path, charged to the last path taken */
+typedef struct {
+    uint32_t hits[I2C_PATH_MAX];
+    uint32_t cycles_total[I2C_PATH_MAX];
+    uint32_t cycles_max[I2C_PATH_MAX];
+} i2c_isr_profile_t;
+
+/* i2c_export_t.reading when no host read is in progress */
+#define I2C_EXPORT_NONE     0xFF
+
+/**
+ * @brief   Read only register map exported in slave mode. The host writes
+ *          one byte register address, then reads with a repeated START;
+ *          the address auto increments and reads past len return 0xff.
+ *          Bytes are sent straight from the published buffer in the ISR,
+ *          a read latches one buffer so it never sees a half update.
+ */
+typedef struct {
+    uint8_t *buf[2];            // two snapshots of len bytes, owned by the caller
+    uint8_t len;                // size of the register map
+    volatile uint8_t front;     // published buffer, used by the driver
+    volatile uint8_t reading;   // buffer latched by a host read, used by the driver
+} i2c_export_t;
+
 /**
  * @brief   User callback function on I2C slave transmitting.
  * 
@@ -68,13 +144,90 @@ struct i2c_slave_cb {
     i2c_on_slave_receive on_receive;
 };
 
+/**
+ * @brief   One segment of an I2C master transfer. The data goes directly
+ *          to and from the caller owned buffer, so the length is not
+ *          limited by I2C_BUFFER_LENGTH.
+ */
+struct i2c_msg {
+    uint8_t addr;           // I2C slave 7bit address
+    uint8_t flags;          // I2C_M_RD for a read
+    uint16_t len;           // bytes to transfer, at least 1
+    uint8_t *buf;           // caller owned data
+};
+
+/**
+ * @brief   Asynchronous I2C master transfer. The messages are joined with
+ *          repeated START and the last one ends with STOP.
+ *          The driver owns it from i2c_submit() until the completion
+ *          message is received, msgs and their buffers must stay valid
+ *          for the same time.
+ */
+typedef struct i2c_xfer {
+    struct i2c_xfer *next;  // queue link, used by the driver
+    struct i2c_msg *msgs;   // messages to run in one transaction
+    uint8_t num;            // number of messages
+    uint8_t done;           // messages completed
+    uint16_t actual;        // bytes transferred in the last message
+    uint8_t task_id;        // TMOS task receiving I2C_XFER_DONE_MSG
+    uint8_t status;         // 0 or i2c_error_t
+    uint8_t tag;            // free for the caller
+    volatile uint8_t busy;  // set from submit until completion
+} i2c_xfer_t;
+
+/* Completion message sent to xfer->task_id, hdr.status is xfer->status */
+typedef struct {
+    tmos_event_hdr_t hdr;
+    i2c_xfer_t *xfer;
+} i2c_done_msg_t;
+
 /**
  * @brief   I2C interrupt routine initialization.
+ *          The first call programs the peripheral. Later calls with the
+ *          same address only ungate the clock and re-apply what was lost,
+ *          so it is cheap to call before every use.
  * 
  * @param address I2C address.
  */
 void i2c_app_init(uint8_t address);
 
+/**
+ * @brief   Gate the I2C peripheral clock if the bus is idle, nothing is
+ *          queued and no slave callback is registered. Done automatically
+ *          when the async queue drains, retried for a few ms while the
+ *          bus is still busy; any transfer ungates it again.
+ *
+ * @return  0 if gated or kept on by a user, -I2C_STATE if the bus is busy.
+ */
+int i2c_app_suspend(void);
+
+/**
+ * @brief   Serve a register map in slave mode at the own address given to
+ *          i2c_app_init(), instead of the slave callbacks. Keeps the I2C
+ *          clock running. With HAL_SLEEP and SBP_I2C_EXPORT the host START
+ *          on SDA wakes the core: the access that wakes it is not acknowledged and must be
+ *          retried after the wake up time (about 2 ms).
+ * 
+ * @param exp   Register map, NULL to stop exporting.
+ * 
+ * @return  0 on success, -I2C_NO_MEM on a bad map, -I2C_STATE before init.
+ */
+int i2c_export_enable(i2c_export_t *exp);
+
+/**
+ * @brief   Get the back buffer to write the next snapshot into.
+ * 
+ * @return  Buffer of exp->len bytes, NULL while the host is still reading
+ *          it (skip this update).
+ */
+uint8_t *i2c_export_begin(void);
+
+/**
+ * @brief   Publish the buffer filled after i2c_export_begin(), new host
+ *          reads see it from now on.
+ */
+void i2c_export_publish(void);
+
 /**
  * @brief   I2C slave user callback function regiester.
  * 
@@ -109,13 +262,79 @@ int i2c_read_from(uint8_t addr_7bit, uint8_t *data, uint8_t length,
         uint8_t send_stop, int timeout);
 
 /**
- * @brief   Read temperature and humidity from SHT20 sensor.
+ * @brief   Queue an asynchronous I2C master transfer.
+ *          Transfers run back to back from the I2C interrupt, the core
+ *          stays out of sleep mode until the queue is empty. Each
+ *          transfer is reported by an I2C_XFER_DONE_MSG message
+ *          (i2c_done_msg_t) to xfer->task_id.
+ * 
+ * @param xfer  Transfer with msgs, num and task_id set.
+ * @return      0 if queued, negative value on error.
+ */
+int i2c_submit(i2c_xfer_t *xfer);
+
+/**
+ * @brief   Run a sequence of messages as one I2C transaction and wait for
+ *          it, e.g. write register address, repeated START, burst read.
+ *          The whole sequence is driven by the I2C interrupt. Queued
+ *          behind other transfers, its deadline starts with its START.
+ * 
+ * @param msgs  Messages, buffers are used in place.
+ * @param num   Number of messages.
+ * @return      Number of messages transferred, negative value on error,
+ *              -I2C_STATE while a blocking read or write holds the bus
+ *              for a repeated start.
+ */
+int i2c_transfer(struct i2c_msg *msgs, uint8_t num);
+
+/**
+ * @brief   Get the per error code counters.
+ *          Every transfer has an RTC deadline, a transfer that misses it
+ *          counts as I2C_TIMEOUT and triggers a bus recovery: 9 SCL pulses
+ *          as GPIO, STOP, then a peripheral reset and re-init.
+ * 
+ * @param stats Pointer to output.
+ */
+void i2c_stats_get(i2c_stats_t *stats);
+
+/**
+ * @brief   Print the error counters over the debug UART.
+ */
+void i2c_stats_print(void);
+
+/**
+ * @brief   Get the bring-up cost and clock gating statistics.
+ * 
+ * @param stats Pointer to output.
+ */
+void i2c_power_stats_get(i2c_power_stats_t *stats);
+
+/**
+ * @brief   Print the bring-up cost and clock gating statistics. The
+ *          broadcaster prints them after every sample only with
+ *          CONFIG_I2C_DEBUG.
+ */
+void i2c_power_stats_print(void);
+
+#ifdef CONFIG_I2C_PROFILE
+/**
+ * @brief   Get the per path interrupt counters. Paths with no hits were
+ *          never exercised since the last reset.
  * 
- * @param temp  Pointer to temperature value (unit: 0.01°C).
- * @param humi  Pointer to humidity value (unit: 0.01%RH).
- * @return      0 if successful, negative value on error.
+ * @param profile Pointer to output.
+ */
+void i2c_isr_profile_get(i2c_isr_profile_t *profile);
+
+/**
+ * @brief   Clear the per path interrupt counters.
  */
-int sht20_read_temp_humi(int16_t *temp, int16_t *humi);
+void i2c_isr_profile_reset(void);
+
+/**
+ * @brief   Print hits, average and worst case cycles of every exercised path.
+ */
+void i2c_isr_profile_print(void);
+#endif
 
 #ifdef __cplusplus
 }
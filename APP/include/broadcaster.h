@@ -30,6 +30,21 @@ extern "C" {
 #define SBP_PERIODIC_EVT             0x0002
 #define SBP_ADV_IN_CONNECTION_EVT    0x0004
 
+// I2C slave register map (SBP_I2C_EXPORT), multi-byte values little endian.
+// Write the register address, then read with a repeated START.
+#define SBP_I2C_OWN_ADDR             0x2A    // 7bit, OADDR1 takes it in bits 7:1
+#define SBP_REG_STATUS               0x00    // bit0: snapshot valid, bit1: last sample ok
+#define SBP_REG_SEQ                  0x01    // snapshot counter, changes with every publish
+#define SBP_REG_TEMP                 0x02    // int16, 0.01 C
+#define SBP_REG_HUMI                 0x04    // int16, 0.01 %RH
+#define SBP_REG_BAT_MV               0x06    // uint16, mV
+#define SBP_REG_BAT_PCT              0x08    // uint8, %
+#define SBP_REG_MAP_LEN              0x09
+#define SBP_REG_INVALID              0x8000  // int16 value of a failed sensor
+
+#define SBP_STATUS_VALID             0x01
+#define SBP_STATUS_SAMPLE_OK         0x02
+
 /*********************************************************************
  * MACROS
  */
@@ -0,0 +1,155 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : bthome.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : BTHome v2 广播数据对象及编译期数据包布局
+ *******************************************************************************/
+
+#ifndef BTHOME_H
+#define BTHOME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// BTHome service UUID 0xFCD2 (little endian)
+#define BTHOME_UUID_LO                  0xD2
+#define BTHOME_UUID_HI                  0xFC
+
+// BTHome device information byte
+#define BTHOME_DEVICE_INFO_PLAIN        0x40    // v2, no encryption, regular advertising
+#define BTHOME_DEVICE_INFO_ENCRYPT      0x41    // v2, AES-CCM encryption, regular advertising
+
+// Encrypted payload trailer: counter (uint32 little endian) and MIC
+#define BTHOME_COUNTER_LEN              4
+#define BTHOME_MIC_LEN                  4
+// Nonce: MAC (6) | UUID (2) | device information (1) | counter (4)
+#define BTHOME_NONCE_LEN                13
+
+// BTHome v2 object ids (objects must be sent in ascending id order)
+#define BTHOME_ID_PACKET_ID             0x00    // uint8,  increments on each new payload
+#define BTHOME_ID_BATTERY               0x01    // uint8,  1 %
+#define BTHOME_ID_TEMPERATURE           0x02    // sint16, 0.01 °C
+#define BTHOME_ID_HUMIDITY              0x03    // uint16, 0.01 %
+#define BTHOME_ID_PRESSURE              0x04    // uint24, 0.01 hPa
+#define BTHOME_ID_DEWPOINT              0x08    // sint16, 0.01 °C
+#define BTHOME_ID_COUNT_U16             0x3D    // uint16, generic count
+
+// Whether the value of an object id is signed
+#define BTHOME_ID_SIGNED(id)            ((id) == BTHOME_ID_TEMPERATURE || (id) == BTHOME_ID_DEWPOINT)
+
+/*********************************************************************
+ * MACROS
+ */
+
+/*
+ * A packet is described by an object list macro taking an X macro:
+ *
+ *   #define MY_OBJECTS(X)              \
+ *       X(BAT,  BTHOME_ID_BATTERY, 1)  \
+ *       X(TEMP, BTHOME_ID_TEMPERATURE, 2)
+ *
+ * MY_OBJECTS(BTHOME_OBJ_TEMPLATE) expands to the initializer bytes of the
+ * object block, and MY_OBJECTS(BTHOME_OBJ_INDEX) to enum entries
+ * BTH_PKG_<name>_ID_IDX / BTH_PKG_<name>_IDX / BTH_PKG_<name>_END_IDX that
+ * continue the enclosing enum, so every offset is a compile time constant.
+ */
+
+// Zero placeholder for an object value of the given width
+#define BTHOME_FILL_1                   0x00
+#define BTHOME_FILL_2                   0x00, 0x00
+#define BTHOME_FILL_3                   0x00, 0x00, 0x00
+#define BTHOME_FILL_4                   0x00, 0x00, 0x00, 0x00
+
+#define BTHOME_OBJ_TEMPLATE(name, id, width)                    \
+    (id), BTHOME_FILL_##width,
+
+#define BTHOME_OBJ_INDEX(name, id, width)                       \
+    BTH_PKG_##name##_ID_IDX,                                    \
+    BTH_PKG_##name##_IDX,                                       \
+    BTH_PKG_##name##_END_IDX = BTH_PKG_##name##_IDX + (width) - 1,
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/**
+ * @brief   Store a little endian 8 bit object value.
+ *
+ * @param p     Pointer to the object value in the packet.
+ * @param v     Value to store.
+ */
+__attribute__((always_inline)) static inline void bthome_put_u8(uint8_t *p, uint8_t v)
+{
+    p[0] = v;
+}
+
+/**
+ * @brief   Store a little endian 16 bit object value.
+ *
+ * @param p     Pointer to the object value in the packet.
+ * @param v     Value to store.
+ */
+__attribute__((always_inline)) static inline void bthome_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * @brief   Store a little endian 32 bit object value.
+ *
+ * @param p     Pointer to the object value in the packet.
+ * @param v     Value to store.
+ */
+__attribute__((always_inline)) static inline void bthome_put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief   Store a little endian object value of 1 to 4 bytes.
+ *
+ * @param p     Pointer to the object value in the packet.
+ * @param v     Value to store, truncated to width bytes.
+ * @param width Object width.
+ */
+__attribute__((always_inline)) static inline void bthome_put_le(uint8_t *p, uint32_t v, uint8_t width)
+{
+    for (uint8_t i = 0; i < width; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+/**
+ * @brief   Raw value marking an object as unavailable: the minimum of a
+ *          signed object (0x8000 for sint16), all ones for an unsigned one
+ *          (0xFFFF for uint16). Neither is a reading the sensors produce.
+ *
+ * @param id    Object id.
+ * @param width Object width.
+ *
+ * @return  Value for bthome_put_le().
+ */
+__attribute__((always_inline)) static inline uint32_t bthome_invalid(uint8_t id, uint8_t width)
+{
+    uint32_t ones = (width >= 4) ? 0xFFFFFFFFUL : (1UL << (8 * width)) - 1;
+
+    return BTHOME_ID_SIGNED(id) ? (ones >> 1) + 1 : ones;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTHOME_H */
@@ -0,0 +1,143 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : i2c_sched.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Multi-device I2C measurement scheduler
+ *******************************************************************************/
+
+#ifndef I2C_SCHED_H
+#define I2C_SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "app_i2c.h"
+
+/* TMOS message event of i2c_sched_done_msg_t */
+#define I2C_SCHED_DONE_MSG      0xE1
+
+#define I2C_SCHED_CMD_MAX       3       // trigger command bytes
+#define I2C_SCHED_JOBS_MAX      8       // jobs of a cycle
+#define I2C_SCHED_STEPS_MAX     (2 * I2C_SCHED_JOBS_MAX)
+
+/* i2c_sched_job_t flags */
+#define I2C_SCHED_RD_REG        0x01    // write rd_reg before the readout
+#define I2C_SCHED_FETCH         0x02    // no conversion to wait for: write cmd and read at once
+
+/* Job state, used by the scheduler */
+typedef enum {
+    I2C_SCHED_WAIT,         // device busy with an earlier job
+    I2C_SCHED_TRIG,         // trigger on the bus
+    I2C_SCHED_CONV,         // converting
+    I2C_SCHED_READ,         // readout on the bus
+    I2C_SCHED_DONE,
+}i2c_sched_state_t;
+
+/**
+ * @brief   One measurement: write a trigger command, wait for the
+ *          conversion, read the result. Jobs of the same device run in
+ *          list order, jobs of different devices overlap.
+ */
+typedef struct {
+    uint8_t addr;                       // I2C slave 7bit address
+    uint8_t flags;                      // I2C_SCHED_RD_REG / I2C_SCHED_FETCH
+    uint8_t cmd_len;                    // trigger length, 0: nothing to trigger
+    uint8_t cmd[I2C_SCHED_CMD_MAX];     // trigger command, read command with I2C_SCHED_FETCH
+    uint8_t rd_reg;                     // register to read from, with I2C_SCHED_RD_REG
+    uint8_t rx_len;                     // readout length, at least 1
+    uint16_t conv_ms;                   // worst case conversion time
+    uint8_t *rx;                        // readout buffer, caller owned
+    uint8_t tag;                        // free for the caller
+
+    /* used by the scheduler */
+    uint8_t state;                      // i2c_sched_state_t
+    uint8_t status;                     // 0 or i2c_error_t of the failed transfer
+    uint32_t due;                       // TMOS clock when the conversion ends
+    uint32_t t_trig;                    // RTC ticks from cycle start, trigger done
+    uint32_t t_read;                    // RTC ticks from cycle start, readout done
+    i2c_xfer_t xfer;
+    struct i2c_msg msgs[2];
+} i2c_sched_job_t;
+
+/* A set of jobs run as one measurement cycle */
+typedef struct {
+    i2c_sched_job_t *jobs;
+    uint8_t num;
+
+    /* used by the scheduler */
+    uint8_t task_id;                    // receives I2C_SCHED_DONE_MSG
+    uint8_t busy;                       // cycle running
+    uint8_t wakes;                      // wake ups of the last cycle
+    uint32_t start;                     // RTC count at cycle start
+    uint32_t awake_rtc;                 // RTC ticks awake in the last cycle
+    uint32_t stage_start;
+} i2c_sched_t;
+
+/* Completion message sent to sched->task_id, hdr.status is 0 if every job succeeded */
+typedef struct {
+    tmos_event_hdr_t hdr;
+    i2c_sched_t *sched;
+} i2c_sched_done_msg_t;
+
+/* One bus operation of a plan */
+typedef struct {
+    uint32_t t_us;                      // end of the operation from cycle start
+    uint8_t job;                        // index in sched->jobs
+    uint8_t read;                       // 0: trigger, 1: readout
+} i2c_sched_step_t;
+
+/* Estimated cycle of a job set */
+typedef struct {
+    uint32_t cycle_us;                  // until the last readout ends
+    uint32_t awake_us;                  // bus time plus wake up cost
+    uint32_t serial_us;                 // cycle when the jobs run one by one
+    uint8_t wakes;
+    uint8_t steps;
+    i2c_sched_step_t step[I2C_SCHED_STEPS_MAX];
+} i2c_sched_plan_t;
+
+/**
+ * @brief   Register the scheduler task, after i2c_app_init().
+ */
+void i2c_sched_init(void);
+
+/**
+ * @brief   Start a measurement cycle. Every job that can start triggers
+ *          at once, each readout is issued when its conversion ends and
+ *          frees the device for its next job. Readouts due within
+ *          I2C_SCHED_MERGE_MS share one wake up. Sends
+ *          I2C_SCHED_DONE_MSG to task_id when every job is done.
+ *
+ * @param sched     Jobs, owned by the scheduler until the message.
+ * @param task_id   TMOS task receiving the completion message.
+ *
+ * @return  0 on success, -I2C_STATE if a cycle is already running,
+ *          -I2C_NO_MEM with more than I2C_SCHED_JOBS_MAX jobs.
+ */
+int i2c_sched_run(i2c_sched_t *sched, uint8_t task_id);
+
+/**
+ * @brief   Compute the schedule i2c_sched_run() follows, with bus times
+ *          estimated at I2C_CLOCK_SPEED. Needs no hardware.
+ *
+ * @param sched Jobs.
+ * @param plan  Pointer to output.
+ */
+void i2c_sched_plan(const i2c_sched_t *sched, i2c_sched_plan_t *plan);
+
+/**
+ * @brief   Print the planned schedule and, after a cycle, the measured
+ *          trigger and readout times of each job. Called after every
+ *          sample only with CONFIG_I2C_DEBUG, prints nothing without DEBUG.
+ *
+ * @param sched Jobs.
+ */
+void i2c_sched_print(const i2c_sched_t *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* I2C_SCHED_H */
@@ -0,0 +1,176 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Sensor driver interface and registry
+ *******************************************************************************/
+
+#ifndef SENSOR_H
+#define SENSOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "i2c_sched.h"
+
+#define SENSOR_OBJECTS_MAX      3       // BTHome objects produced by one driver
+#define SENSOR_JOBS_MAX         I2C_SCHED_JOBS_MAX
+#define SENSOR_RX_MAX           8       // readout bytes of one job
+
+/* Value of an object whose sensor failed, outside the range of every
+ * object. Advertised as the BTHome invalid value, see bthome_invalid(). */
+#define SENSOR_VALUE_INVALID    INT32_MIN
+
+/* Resolution option of a driver */
+typedef struct {
+    uint16_t conv_ms;                   // worst case conversion time of one sample
+    uint16_t lsb[SENSOR_OBJECTS_MAX];   // resolution of each object (unit: 0.0001 of its BTHome unit)
+} sensor_res_t;
+
+/**
+ * @brief   Sensor driver descriptor. A sample is a fixed set of scheduler
+ *          jobs: the registry hands num_jobs cleared jobs with addr and rx
+ *          set to trigger(), runs them on the I2C scheduler and passes the
+ *          finished jobs to read().
+ */
+typedef struct {
+    const char *name;
+    uint8_t addr;                       // I2C 7bit address
+    uint8_t num_jobs;                   // scheduler jobs per sample
+    uint8_t num_objects;
+    uint8_t num_res;
+    uint16_t active_ua;                 // supply current while converting
+    uint16_t sleep_na;                  // supply current between samples
+    const uint8_t *objects;             // BTHome object ids produced, in read() order
+    const sensor_res_t *res;            // resolution options
+
+    /* Configure the device on the bus. Called before the first sample
+     * and again after a failed one. 0 if successful. */
+    int (*init)(void);
+    /* Fill cmd, rx_len, conv_ms and flags of the jobs. Must not touch
+     * the bus, the planner calls it too. */
+    void (*trigger)(i2c_sched_job_t *jobs);
+    /* Check and convert the readouts into num_objects values, in units
+     * of the BTHome objects. May issue short blocking transfers, e.g. to
+     * start the next conversion. 0 if successful, positive if the sample
+     * carries no values (previous values are kept). */
+    int (*read)(const i2c_sched_job_t *jobs, int32_t *values);
+    /* Index of the resolution option in use */
+    uint8_t (*resolution)(void);
+} sensor_driver_t;
+
+#include "sensor_cfg.h"
+
+#define SENSOR_OBJ_ENUM(name, id, width)    SENSOR_OBJ_##name,
+
+/* Index of each advertised sensor object */
+enum {
+    SENSOR_OBJECTS(SENSOR_OBJ_ENUM)
+    SENSOR_OBJ_MAX
+};
+
+/**
+ * @brief   Map the driver objects onto SENSOR_OBJECTS and register the
+ *          scheduler task. Every value starts as SENSOR_VALUE_INVALID.
+ */
+void sensor_init(void);
+
+/**
+ * @brief   Start a sample of every registered sensor, configuring the
+ *          ones not yet initialized. I2C_SCHED_DONE_MSG arrives at task_id
+ *          when every readout is done, pass it to sensor_done().
+ *
+ * @param task_id   TMOS task receiving the completion message.
+ *
+ * @return  0 if started, negative value if no sample is running.
+ */
+int sensor_start(uint8_t task_id);
+
+/**
+ * @brief   Convert the readouts of a finished sample. The objects of a
+ *          failed sensor become SENSOR_VALUE_INVALID and the sensor is
+ *          configured again before the next sample.
+ *
+ * @param msg   Completion message.
+ *
+ * @return  TRUE if every sensor succeeded.
+ */
+uint8_t sensor_done(const i2c_sched_done_msg_t *msg);
+
+/**
+ * @brief   Mark the objects of every sensor invalid, for a sample that
+ *          could not start.
+ */
+void sensor_fail(void);
+
+/**
+ * @brief   Latest value of an advertised object.
+ *
+ * @param obj   SENSOR_OBJ_<name>.
+ * @return      Value in units of the BTHome object.
+ */
+int32_t sensor_value(uint8_t obj);
+
+/**
+ * @brief   Look up the latest value by BTHome object id.
+ *
+ * @param id    BTHome object id.
+ * @param value Pointer to output.
+ * @return      0 if the object is advertised, -1 otherwise.
+ */
+int sensor_get(uint8_t id, int32_t *value);
+
+/**
+ * @brief   Whether any value moved past its deadband since sensor_commit().
+ */
+uint8_t sensor_changed(void);
+
+/**
+ * @brief   Remember the current values as advertised.
+ */
+void sensor_commit(void);
+
+/**
+ * @brief   CRC-8 with polynomial 0x31 (x^8 + x^5 + x^4 + 1), the check
+ *          byte of Sensirion sensors.
+ *
+ * @param data  Data.
+ * @param len   Data length.
+ * @param init  Initial value, 0x00 for SHT2x, 0xFF for SHT3x/SHT4x.
+ * @return      CRC.
+ */
+uint8_t sensor_crc8(const uint8_t *data, int len, uint8_t init);
+
+/**
+ * @brief   Select the fastest resolution option meeting an accuracy
+ *          target for every object.
+ *
+ * @param drv       Driver.
+ * @param target    Accuracy target of each object (unit: 0.01 of its BTHome unit).
+ * @return          Option index, the first option if none meets the targets.
+ */
+uint8_t sensor_select_res(const sensor_driver_t *drv, const uint16_t *target);
+
+/**
+ * @brief   Plan one sample of every registered sensor at the resolutions
+ *          in use, without touching the bus.
+ *
+ * @param plan      Pointer to output.
+ * @return          Sensor charge of the sample in nC (active current
+ *                  over each conversion).
+ */
+uint32_t sensor_plan(i2c_sched_plan_t *plan);
+
+/**
+ * @brief   Print the registered drivers, their resolution options and
+ *          the planned sample.
+ */
+void sensor_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_H */
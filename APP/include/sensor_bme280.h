@@ -0,0 +1,98 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_bme280.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : BME280/BMP280 temperature, humidity and pressure sensor driver
+ *******************************************************************************/
+
+#ifndef SENSOR_BME280_H
+#define SENSOR_BME280_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "sensor.h"
+
+#define BME280_CHIP_ID          0x60
+#define BMP280_CHIP_ID          0x58
+
+/* Oversampling of every channel, order of the resolution options */
+typedef enum {
+    BME280_OSR_16,
+    BME280_OSR_4,
+    BME280_OSR_2,
+    BME280_OSR_1,
+}bme280_osr_t;
+
+/* Trimming parameters from the calibration registers */
+typedef struct {
+    uint16_t t1;
+    int16_t t2;
+    int16_t t3;
+    uint16_t p1;
+    int16_t p2;
+    int16_t p3;
+    int16_t p4;
+    int16_t p5;
+    int16_t p6;
+    int16_t p7;
+    int16_t p8;
+    int16_t p9;
+    uint8_t h1;
+    int16_t h2;
+    uint8_t h3;
+    int16_t h4;
+    int16_t h5;
+    int8_t h6;
+} bme280_calib_t;
+
+/**
+ * @brief   Bosch 32 bit integer temperature compensation.
+ *
+ * @param c         Calibration.
+ * @param adc_t     20 bit raw temperature.
+ * @param t_fine    Pointer to the fine temperature used by the other channels.
+ * @return          Temperature (unit: 0.01°C).
+ */
+int32_t bme280_compensate_t(const bme280_calib_t *c, int32_t adc_t, int32_t *t_fine);
+
+/**
+ * @brief   Bosch 32 bit integer pressure compensation.
+ *
+ * @param c         Calibration.
+ * @param adc_p     20 bit raw pressure.
+ * @param t_fine    Fine temperature of the same sample.
+ * @return          Pressure (unit: Pa = 0.01 hPa), 0 on invalid calibration.
+ */
+uint32_t bme280_compensate_p(const bme280_calib_t *c, int32_t adc_p, int32_t t_fine);
+
+/**
+ * @brief   Bosch 32 bit integer humidity compensation (BME280 only).
+ *
+ * @param c         Calibration.
+ * @param adc_h     16 bit raw humidity.
+ * @param t_fine    Fine temperature of the same sample.
+ * @return          Humidity (unit: 1/1024 %RH).
+ */
+uint32_t bme280_compensate_h(const bme280_calib_t *c, int32_t adc_h, int32_t t_fine);
+
+/**
+ * @brief   Planned awake time of one sample: trigger and burst readout
+ *          plus two wake ups, at the oversampling in use.
+ *
+ * @return  Time in us.
+ */
+uint32_t bme280_awake_us(void);
+
+/* Driver descriptor: temperature, humidity and pressure from one forced
+ * mode conversion and one 8 byte burst read. A BMP280 is detected by its
+ * chip id, reads 6 bytes and reports humidity as SENSOR_VALUE_INVALID. */
+extern const sensor_driver_t bme280_sensor;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_BME280_H */
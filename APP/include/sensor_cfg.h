@@ -0,0 +1,114 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_cfg.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : 传感器驱动列表及广播的传感器对象
+ *******************************************************************************/
+
+#ifndef SENSOR_CFG_H
+#define SENSOR_CFG_H
+
+#include "bthome.h"
+
+// 使用 BME280/BMP280 代替 SHT20, 增加广播气压
+#ifndef SENSOR_BME280
+#define SENSOR_BME280 FALSE
+#endif
+
+// 使用 SHT3x 代替 SHT20, 测量方式见 SHT3X_MODE
+#ifndef SENSOR_SHT3X
+#define SENSOR_SHT3X FALSE
+#endif
+
+// 使用 SHT4x 代替 SHT20, 测量方式见 SHT4X_MODE
+#ifndef SENSOR_SHT4X
+#define SENSOR_SHT4X FALSE
+#endif
+
+#if ((SENSOR_BME280 == TRUE) + (SENSOR_SHT3X == TRUE) + (SENSOR_SHT4X == TRUE) > 1)
+#error "SENSOR_BME280, SENSOR_SHT3X and SENSOR_SHT4X are exclusive"
+#endif
+
+// 由温湿度计算并广播露点 (BTHome 0x08); 绝对湿度和饱和水汽压差没有对应的 BTHome 对象, 只打印
+#ifndef SENSOR_DEW_POINT
+#define SENSOR_DEW_POINT FALSE
+#endif
+
+// 驱动列表: X(驱动描述符), 按顺序初始化和触发, 描述符由各驱动文件定义
+#if (SENSOR_BME280 == TRUE)
+#define SENSOR_DRIVERS(X)                       \
+    X(bme280_sensor)
+#elif (SENSOR_SHT3X == TRUE)
+#define SENSOR_DRIVERS(X)                       \
+    X(sht3x_sensor)
+#elif (SENSOR_SHT4X == TRUE)
+#define SENSOR_DRIVERS(X)                       \
+    X(sht4x_sensor)
+#else
+#define SENSOR_DRIVERS(X)                       \
+    X(sht20_sensor)
+#endif
+
+// 可选对象
+#if (SENSOR_BME280 == TRUE)
+#define SENSOR_OBJECTS_PRES(X) X(PRES, BTHOME_ID_PRESSURE, 3)
+#else
+#define SENSOR_OBJECTS_PRES(X)
+#endif
+#if (SENSOR_DEW_POINT == TRUE)
+#define SENSOR_OBJECTS_DEW(X) X(DEW, BTHOME_ID_DEWPOINT, 2)
+#else
+#define SENSOR_OBJECTS_DEW(X)
+#endif
+
+// 广播的传感器对象: X(名称, 对象ID, 数据宽度)
+// 位于 packet id 和电池之后, 按对象ID升序排列; 驱动产生的其他对象不广播
+#define SENSOR_OBJECTS(X)                       \
+    X(TEMP,  BTHOME_ID_TEMPERATURE, 2)          \
+    X(HUMID, BTHOME_ID_HUMIDITY,    2)          \
+    SENSOR_OBJECTS_PRES(X)                      \
+    SENSOR_OBJECTS_DEW(X)
+
+// 变化检测死区: SENSOR_DEADBAND_<名称>, 单位同对象
+#define SENSOR_DEADBAND_TEMP  10    // 0.1°C
+#define SENSOR_DEADBAND_HUMID 50    // 0.5%RH
+#define SENSOR_DEADBAND_PRES  10    // 0.1hPa
+#define SENSOR_DEADBAND_DEW   10    // 0.1°C
+
+// 结果滤波: 每个对象先取最近 SENSOR_FILTER_MEDIAN 个样本的中值, 再做 alpha = 1/2^SENSOR_FILTER_EMA_SHIFT 的指数平均
+#ifndef SENSOR_FILTER
+#define SENSOR_FILTER TRUE
+#endif
+#define SENSOR_FILTER_MEDIAN    3   // 奇数, 1 表示不取中值
+#define SENSOR_FILTER_EMA_SHIFT 2   // 0 表示不平均
+
+// 只用于比较的驱动: X(驱动描述符), sensor_print() 打印其规划的采样周期, 唤醒时间及电荷
+// 例如 X(sht20_sensor) X(sht3x_sensor) X(sht4x_sensor)
+#define SENSOR_COMPARE(X)
+
+// 温湿度及气压精度目标 (单位 0.01), 用于选择分辨率
+#define SENSOR_TEMP_ACCURACY_TARGET 10  // 0.1°C
+#define SENSOR_HUMI_ACCURACY_TARGET 50  // 0.5%RH
+#define SENSOR_PRES_ACCURACY_TARGET 10  // 0.1hPa
+
+// SHT3x/SHT4x 测量方式
+#define SENSOR_MODE_SINGLE   0      // 每次唤醒触发一次测量, 转换结束后读取
+#define SENSOR_MODE_PERIODIC 1      // 传感器已有结果, 每次唤醒只读取一次
+
+// SHT3x: 地址 0x44 (ADDR 接地) 或 0x45
+#define SHT3X_I2C_ADDR 0x44
+#ifndef SHT3X_MODE
+#define SHT3X_MODE SENSOR_MODE_SINGLE
+#endif
+
+// SHT4x: 地址 0x44 (SHT40-AD1B) 或 0x45 (SHT40-BD1B)
+#define SHT4X_I2C_ADDR 0x44
+#ifndef SHT4X_MODE
+#define SHT4X_MODE SENSOR_MODE_SINGLE
+#endif
+
+// BME280/BMP280: 地址 0x76 (SDO 接地) 或 0x77
+#define BME280_I2C_ADDR 0x76
+
+#endif /* SENSOR_CFG_H */
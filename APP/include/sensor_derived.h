@@ -0,0 +1,56 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_derived.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Dew point, absolute humidity and vapour pressure deficit
+ *                      from temperature and relative humidity, fixed point
+ *******************************************************************************/
+
+#ifndef SENSOR_DERIVED_H
+#define SENSOR_DERIVED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Temperature range of the saturation vapour pressure table (unit: 0.01°C) */
+#define SENSOR_DERIVED_T_MIN    (-4000)
+#define SENSOR_DERIVED_T_MAX    8500
+
+/* Metrics derived from one temperature and humidity pair */
+typedef struct {
+    int32_t dew_point;      // 0.01°C, clamped to the table range
+    int32_t abs_humid;      // 0.01 g/m3
+    int32_t vpd;            // vapour pressure deficit, Pa (= 0.01 hPa)
+} sensor_derived_t;
+
+/**
+ * @brief   Saturation vapour pressure over water, Magnus formula
+ *          (611.2 Pa, 17.62, 243.12°C), from a 1°C table with linear
+ *          interpolation.
+ *
+ * @param temp  Temperature (unit: 0.01°C), within the table range.
+ *
+ * @return  Pressure (unit: 0.01 Pa).
+ */
+uint32_t sensor_svp(int32_t temp);
+
+/**
+ * @brief   Compute the derived metrics with integer arithmetic only.
+ *
+ * @param temp  Temperature (unit: 0.01°C).
+ * @param humid Relative humidity (unit: 0.01%).
+ * @param out   Pointer to output.
+ *
+ * @return  0 if successful, -1 if an input is out of range.
+ */
+int sensor_derive(int32_t temp, int32_t humid, sensor_derived_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_DERIVED_H */
@@ -0,0 +1,46 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_filter.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Per-channel fixed point sensor filter (median + EMA)
+ *******************************************************************************/
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "sensor_cfg.h"
+
+/* Fractional bits of the EMA state */
+#define SENSOR_FILTER_FRAC      8
+
+/**
+ * @brief   Forget the history of a channel, the next sample passes
+ *          through unfiltered and seeds the window and the average.
+ *
+ * @param ch    Channel, SENSOR_OBJ_<name>.
+ */
+void sensor_filter_reset(uint8_t ch);
+
+/**
+ * @brief   Run one sample through the median of the last
+ *          SENSOR_FILTER_MEDIAN samples and an EMA with
+ *          alpha = 1 / 2^SENSOR_FILTER_EMA_SHIFT. Integer only.
+ *
+ * @param ch    Channel, SENSOR_OBJ_<name>.
+ * @param value Sample, in the unit of the object.
+ *
+ * @return  Filtered value, same unit.
+ */
+int32_t sensor_filter_apply(uint8_t ch, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_FILTER_H */
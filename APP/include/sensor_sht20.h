@@ -0,0 +1,159 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_sht20.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT20 temperature and humidity sensor driver
+ *******************************************************************************/
+
+#ifndef SENSOR_SHT20_H
+#define SENSOR_SHT20_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "sensor.h"
+
+/* SHT20 I2C 7bit address */
+#define SHT20_I2C_ADDR      0x40
+
+typedef enum {
+    SHT20_MEAS_TEMP,
+    SHT20_MEAS_HUMI,
+}sht20_meas_t;
+
+/* SHT20 measurement resolution, value matches user register bit7/bit0 */
+typedef enum {
+    SHT20_RES_RH12_T14,
+    SHT20_RES_RH8_T12,
+    SHT20_RES_RH10_T13,
+    SHT20_RES_RH11_T11,
+}sht20_res_t;
+
+/**
+ * @brief   Select the fastest SHT20 resolution meeting the accuracy targets.
+ * 
+ * @param temp_target   Temperature accuracy target (unit: 0.01°C).
+ * @param humi_target   Humidity accuracy target (unit: 0.01%RH).
+ * @return              Selected resolution, RH12/T14 if no one meets the targets.
+ */
+sht20_res_t sht20_select_resolution(uint16_t temp_target, uint16_t humi_target);
+
+/**
+ * @brief   Read SHT20 user register.
+ * 
+ * @param reg   Pointer to register value.
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_read_user_reg(uint8_t *reg);
+
+/**
+ * @brief   Write SHT20 user register.
+ * 
+ * @param reg   Register value, reserved bits must keep the read value.
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_write_user_reg(uint8_t reg);
+
+/**
+ * @brief   Set SHT20 measurement resolution through the user register.
+ * 
+ * @param res   Resolution to set.
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_set_resolution(sht20_res_t res);
+
+/**
+ * @brief   Maximum conversion time at the current resolution.
+ * 
+ * @param meas  Measurement type.
+ * @return      Conversion time in ms.
+ */
+uint8_t sht20_conv_time_ms(sht20_meas_t meas);
+
+/**
+ * @brief   No hold master trigger command of a measurement, for callers
+ *          that run the transfers themselves (i2c_sched).
+ * 
+ * @param meas  Measurement type.
+ * @return      Command byte.
+ */
+uint8_t sht20_trigger_cmd(sht20_meas_t meas);
+
+/**
+ * @brief   Check the CRC of a 3 byte SHT20 readout and convert it.
+ * 
+ * @param meas  Measurement type.
+ * @param buf   Data MSB, data LSB, CRC.
+ * @param value Pointer to result value (unit: 0.01°C or 0.01%RH).
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_convert(sht20_meas_t meas, const uint8_t *buf, int16_t *value);
+
+/**
+ * @brief   Trigger a SHT20 measurement in no hold master mode.
+ *          The bus is released while the sensor converts, the result
+ *          should be fetched after sht20_conv_time_ms().
+ * 
+ * @param meas  Measurement to trigger.
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_start_measure(sht20_meas_t meas);
+
+/**
+ * @brief   Fetch the result of a triggered SHT20 measurement.
+ * 
+ * @param meas  Measurement triggered by sht20_start_measure().
+ * @param value Pointer to result value (unit: 0.01°C or 0.01%RH).
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_fetch_measure(sht20_meas_t meas, int16_t *value);
+
+/**
+ * @brief   Trigger a SHT20 measurement without blocking. The result of
+ *          the command write arrives as I2C_XFER_DONE_MSG.
+ * 
+ * @param meas      Measurement to trigger.
+ * @param task_id   TMOS task receiving the completion message.
+ * @return          0 if queued, negative value on error.
+ */
+int sht20_start_measure_async(sht20_meas_t meas, uint8_t task_id);
+
+/**
+ * @brief   Read the result of a triggered SHT20 measurement without
+ *          blocking, pass the completion message to sht20_fetch_measure_done().
+ * 
+ * @param meas      Measurement triggered by sht20_start_measure_async().
+ * @param task_id   TMOS task receiving the completion message.
+ * @return          0 if queued, negative value on error.
+ */
+int sht20_fetch_measure_async(sht20_meas_t meas, uint8_t task_id);
+
+/**
+ * @brief   Check and convert the data of a finished sht20_fetch_measure_async().
+ * 
+ * @param xfer  Transfer from the completion message.
+ * @param value Pointer to result value (unit: 0.01°C or 0.01%RH).
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_fetch_measure_done(const i2c_xfer_t *xfer, int16_t *value);
+
+/**
+ * @brief   Read temperature and humidity from SHT20 sensor.
+ *          Blocks for the whole conversion time.
+ * 
+ * @param temp  Pointer to temperature value (unit: 0.01°C).
+ * @param humi  Pointer to humidity value (unit: 0.01%RH).
+ * @return      0 if successful, negative value on error.
+ */
+int sht20_read_temp_humi(int16_t *temp, int16_t *humi);
+
+/* Driver descriptor: temperature and humidity, one job each */
+extern const sensor_driver_t sht20_sensor;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_SHT20_H */
@@ -0,0 +1,61 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_sht3x.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT3x (SHT30/SHT31/SHT35) temperature and humidity sensor driver
+ *******************************************************************************/
+
+#ifndef SENSOR_SHT3X_H
+#define SENSOR_SHT3X_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "sensor.h"
+
+/* Measurement repeatability, order of the resolution options */
+typedef enum {
+    SHT3X_REP_HIGH,
+    SHT3X_REP_MEDIUM,
+    SHT3X_REP_LOW,
+}sht3x_rep_t;
+
+/**
+ * @brief   Check the two CRCs of a 6 byte SHT3x/SHT4x readout and convert
+ *          the raw words.
+ *
+ * @param buf   T MSB, T LSB, CRC, RH MSB, RH LSB, CRC.
+ * @param temp  Pointer to raw temperature.
+ * @param humi  Pointer to raw humidity.
+ * @return      0 if successful, negative value on CRC error.
+ */
+int sht3x_unpack(const uint8_t *buf, uint16_t *temp, uint16_t *humi);
+
+/**
+ * @brief   Switch the internal heater. Readings are biased while it is on.
+ *
+ * @param on    Heater state.
+ * @return      0 if successful, negative value on error.
+ */
+int sht3x_set_heater(bool on);
+
+/**
+ * @brief   Read the status register.
+ *
+ * @param status    Pointer to output.
+ * @return          0 if successful, negative value on error.
+ */
+int sht3x_read_status(uint16_t *status);
+
+/* Driver descriptor: temperature and humidity from one 6 byte readout.
+ * With SHT3X_MODE == SENSOR_MODE_PERIODIC the sensor measures at 0.5 Hz
+ * and a sample is a single fetch, the sample period must be at least 2 s. */
+extern const sensor_driver_t sht3x_sensor;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_SHT3X_H */
@@ -0,0 +1,63 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_sht4x.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT4x (SHT40/SHT41/SHT45) temperature and humidity sensor driver
+ *******************************************************************************/
+
+#ifndef SENSOR_SHT4X_H
+#define SENSOR_SHT4X_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "sensor.h"
+
+/* Measurement precision, order of the resolution options */
+typedef enum {
+    SHT4X_PREC_HIGH,
+    SHT4X_PREC_MEDIUM,
+    SHT4X_PREC_LOW,
+}sht4x_prec_t;
+
+/* Heater pulse: power and duration */
+typedef enum {
+    SHT4X_HEATER_200MW_1S,
+    SHT4X_HEATER_200MW_100MS,
+    SHT4X_HEATER_110MW_1S,
+    SHT4X_HEATER_110MW_100MS,
+    SHT4X_HEATER_20MW_1S,
+    SHT4X_HEATER_20MW_100MS,
+}sht4x_heater_t;
+
+/**
+ * @brief   Read the 32 bit serial number.
+ *
+ * @param serial    Pointer to output.
+ * @return          0 if successful, negative value on error.
+ */
+int sht4x_read_serial(uint32_t *serial);
+
+/**
+ * @brief   Run a heater pulse in place of the next measurement, e.g. to
+ *          remove condensation. The scheduler sleeps through the pulse
+ *          and the heated readout is discarded, the sample keeps the
+ *          previous values.
+ *
+ * @param heater    Pulse power and duration.
+ */
+void sht4x_heater_request(sht4x_heater_t heater);
+
+/* Driver descriptor: temperature and humidity from one 6 byte readout.
+ * The SHT4x has no periodic mode, with SHT4X_MODE == SENSOR_MODE_PERIODIC
+ * every readout starts the next conversion, so a sample is a single fetch
+ * of the result converted at the end of the previous sample. */
+extern const sensor_driver_t sht4x_sensor;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_SHT4X_H */
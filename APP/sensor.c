@@ -0,0 +1,461 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : 传感器驱动注册表: 按驱动描述组织调度任务并保存最新结果
+ *******************************************************************************/
+
+#include "sensor.h"
+#include "sensor_filter.h"
+#include "sensor_derived.h"
+#include "HAL.h"
+
+#define SENSOR_DRIVER_DECL(drv)                 extern const sensor_driver_t drv;
+#define SENSOR_DRIVER_REF(drv)                  &drv,
+#define SENSOR_OBJ_ID(name, id, width)          id,
+#define SENSOR_OBJ_DEADBAND(name, id, width)    SENSOR_DEADBAND_##name,
+
+// 未广播的驱动对象
+#define SENSOR_SLOT_NONE 0xFF
+
+SENSOR_DRIVERS(SENSOR_DRIVER_DECL)
+SENSOR_COMPARE(SENSOR_DRIVER_DECL)
+
+static const sensor_driver_t *const sensor_drivers[] = {
+    SENSOR_DRIVERS(SENSOR_DRIVER_REF)
+};
+
+#define SENSOR_NUM_DRIVERS (sizeof(sensor_drivers) / sizeof(sensor_drivers[0]))
+
+static const uint8_t sensor_obj_id[SENSOR_OBJ_MAX] = {
+    SENSOR_OBJECTS(SENSOR_OBJ_ID)
+};
+static const int32_t sensor_deadband[SENSOR_OBJ_MAX] = {
+    SENSOR_OBJECTS(SENSOR_OBJ_DEADBAND)
+};
+
+// 最新结果及最近一次广播的结果
+static int32_t sensor_values[SENSOR_OBJ_MAX];
+static int32_t sensor_adv_values[SENSOR_OBJ_MAX];
+// 各驱动对象在 SENSOR_OBJECTS 中的位置
+static uint8_t sensor_slot[SENSOR_NUM_DRIVERS][SENSOR_OBJECTS_MAX];
+// 各驱动本次采样的第一个调度任务, SENSOR_SLOT_NONE 表示未参与
+static uint8_t sensor_first_job[SENSOR_NUM_DRIVERS];
+// 驱动是否已完成配置 (出错后重新配置)
+static uint8_t sensor_ready[SENSOR_NUM_DRIVERS];
+
+static uint8_t sensor_rx[SENSOR_JOBS_MAX][SENSOR_RX_MAX];
+static i2c_sched_job_t sensor_jobs[SENSOR_JOBS_MAX];
+static i2c_sched_t sensor_sched = { .jobs = sensor_jobs };
+
+/**
+ * @brief 将驱动的对象标记为无效
+ * @param d 驱动序号
+ */
+static void sensor_invalidate(uint8_t d)
+{
+    for (uint8_t i = 0; i < sensor_drivers[d]->num_objects; i++) {
+        if (sensor_slot[d][i] != SENSOR_SLOT_NONE) {
+            sensor_values[sensor_slot[d][i]] = SENSOR_VALUE_INVALID;
+#if (SENSOR_FILTER == TRUE)
+            sensor_filter_reset(sensor_slot[d][i]);
+#endif
+        }
+    }
+}
+
+#if (SENSOR_DEW_POINT == TRUE)
+/**
+ * @brief 由最新 (滤波后) 的温湿度更新计算得到的对象
+ */
+static void sensor_update_derived(void)
+{
+    int32_t temp = sensor_values[SENSOR_OBJ_TEMP];
+    int32_t humid = sensor_values[SENSOR_OBJ_HUMID];
+    sensor_derived_t d;
+
+    if (temp == SENSOR_VALUE_INVALID || humid == SENSOR_VALUE_INVALID ||
+        sensor_derive(temp, humid, &d) != 0) {
+        d.dew_point = d.vpd = d.abs_humid = SENSOR_VALUE_INVALID;
+    }
+    sensor_values[SENSOR_OBJ_DEW] = d.dew_point;
+    PRINT("derived: dew point %d, abs humidity %d, VPD %d\n", (int)d.dew_point, (int)d.abs_humid, (int)d.vpd);
+}
+#endif
+
+/**
+ * @brief 为驱动准备一次采样的调度任务
+ * @param jobs 任务起始位置
+ * @param drv 驱动
+ */
+static void sensor_prepare_jobs(i2c_sched_job_t *jobs, const sensor_driver_t *drv)
+{
+    for (uint8_t j = 0; j < drv->num_jobs; j++) {
+        uint8_t *rx = sensor_rx[&jobs[j] - sensor_jobs];
+
+        tmos_memset(&jobs[j], 0, sizeof(jobs[j]));
+        jobs[j].addr = drv->addr;
+        jobs[j].rx = rx;
+    }
+    drv->trigger(jobs);
+}
+
+/**
+ * @brief 初始化注册表, 建立驱动对象到广播对象的映射
+ */
+void sensor_init(void)
+{
+    uint8_t jobs = 0;
+
+    for (uint8_t d = 0; d < SENSOR_NUM_DRIVERS; d++) {
+        const sensor_driver_t *drv = sensor_drivers[d];
+
+        jobs += drv->num_jobs;
+        for (uint8_t i = 0; i < drv->num_objects; i++) {
+            sensor_slot[d][i] = SENSOR_SLOT_NONE;
+            for (uint8_t k = 0; k < SENSOR_OBJ_MAX; k++) {
+                if (sensor_obj_id[k] == drv->objects[i]) {
+                    sensor_slot[d][i] = k;
+                }
+            }
+        }
+        sensor_ready[d] = FALSE;
+        sensor_invalidate(d);
+    }
+#if (SENSOR_DEW_POINT == TRUE)
+    sensor_update_derived();
+#endif
+    if (jobs > SENSOR_JOBS_MAX) {
+        PRINT("sensor: %d jobs exceed SENSOR_JOBS_MAX\n", jobs);
+    }
+
+    i2c_sched_init();
+    sensor_print();
+}
+
+/**
+ * @brief 配置未就绪的驱动, 触发所有驱动的一次采样
+ * @param task_id 接收完成消息的任务
+ * @return 0表示成功，负值表示错误代码
+ */
+int sensor_start(uint8_t task_id)
+{
+    uint8_t num = 0;
+
+    for (uint8_t d = 0; d < SENSOR_NUM_DRIVERS; d++) {
+        const sensor_driver_t *drv = sensor_drivers[d];
+
+        sensor_first_job[d] = SENSOR_SLOT_NONE;
+        if (!sensor_ready[d]) {
+            sensor_ready[d] = (drv->init() == 0);
+        }
+        if (!sensor_ready[d] || num + drv->num_jobs > SENSOR_JOBS_MAX) {
+            sensor_invalidate(d);
+            continue;
+        }
+        sensor_prepare_jobs(&sensor_jobs[num], drv);
+        sensor_first_job[d] = num;
+        num += drv->num_jobs;
+    }
+
+    if (num == 0) {
+        return -1;
+    }
+    sensor_sched.num = num;
+    return i2c_sched_run(&sensor_sched, task_id);
+}
+
+/**
+ * @brief 换算完成的读出结果
+ * @param msg 完成消息
+ * @return TRUE表示所有传感器都成功
+ */
+uint8_t sensor_done(const i2c_sched_done_msg_t *msg)
+{
+    uint8_t ok = TRUE;
+
+#ifdef CONFIG_I2C_DEBUG
+    // 每次采样打印调度的规划和实测时间, 仅用于调试
+    i2c_sched_print(msg->sched);
+#endif
+
+    for (uint8_t d = 0; d < SENSOR_NUM_DRIVERS; d++) {
+        const sensor_driver_t *drv = sensor_drivers[d];
+        const i2c_sched_job_t *jobs;
+        int32_t values[SENSOR_OBJECTS_MAX];
+        uint8_t failed = FALSE;
+        int ret;
+
+        // 未参与本次采样 (配置失败)
+        if (sensor_first_job[d] == SENSOR_SLOT_NONE) {
+            ok = FALSE;
+            continue;
+        }
+
+        jobs = &sensor_jobs[sensor_first_job[d]];
+        for (uint8_t j = 0; j < drv->num_jobs; j++) {
+            if (jobs[j].status) {
+                failed = TRUE;
+            }
+        }
+        ret = failed ? -1 : drv->read(jobs, values);
+        if (ret < 0) {
+            PRINT("%s sample failed\n", drv->name);
+            sensor_ready[d] = FALSE;
+            sensor_invalidate(d);
+            ok = FALSE;
+            continue;
+        }
+        // 本次没有结果 (如加热脉冲), 保留上次的值
+        if (ret > 0) {
+            continue;
+        }
+
+        TRACE_BEGIN(TRACE_ID_SENSOR_FILTER);
+        for (uint8_t i = 0; i < drv->num_objects; i++) {
+            uint8_t k = sensor_slot[d][i];
+
+            if (k == SENSOR_SLOT_NONE) {
+                continue;
+            }
+#if (SENSOR_FILTER == TRUE)
+            // 无效值不进入滤波, 恢复后重新开始
+            if (values[i] == SENSOR_VALUE_INVALID) {
+                sensor_filter_reset(k);
+            } else {
+                values[i] = sensor_filter_apply(k, values[i]);
+            }
+#endif
+            sensor_values[k] = values[i];
+        }
+        TRACE_END(TRACE_ID_SENSOR_FILTER);
+    }
+#if (SENSOR_DEW_POINT == TRUE)
+    sensor_update_derived();
+#endif
+    return ok;
+}
+
+/**
+ * @brief 采样未能开始: 所有传感器在下次采样前重新配置
+ */
+void sensor_fail(void)
+{
+    for (uint8_t d = 0; d < SENSOR_NUM_DRIVERS; d++) {
+        sensor_ready[d] = FALSE;
+        sensor_invalidate(d);
+    }
+#if (SENSOR_DEW_POINT == TRUE)
+    sensor_update_derived();
+#endif
+}
+
+/**
+ * @brief 获取广播对象的最新值
+ * @param obj SENSOR_OBJ_<名称>
+ * @return 最新值
+ */
+int32_t sensor_value(uint8_t obj)
+{
+    return sensor_values[obj];
+}
+
+/**
+ * @brief 按 BTHome 对象ID获取最新值
+ * @param id 对象ID
+ * @param value 结果指针
+ * @return 0表示成功, -1表示该对象未广播
+ */
+int sensor_get(uint8_t id, int32_t *value)
+{
+    for (uint8_t k = 0; k < SENSOR_OBJ_MAX; k++) {
+        if (sensor_obj_id[k] == id) {
+            *value = sensor_values[k];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 判断是否有结果相对上次广播超出死区
+ */
+uint8_t sensor_changed(void)
+{
+    for (uint8_t k = 0; k < SENSOR_OBJ_MAX; k++) {
+        int32_t diff;
+
+        // 变为无效或从无效恢复
+        if (sensor_values[k] == SENSOR_VALUE_INVALID || sensor_adv_values[k] == SENSOR_VALUE_INVALID) {
+            if (sensor_values[k] != sensor_adv_values[k]) {
+                return TRUE;
+            }
+            continue;
+        }
+        diff = sensor_values[k] - sensor_adv_values[k];
+        if (diff >= sensor_deadband[k] || diff <= -sensor_deadband[k]) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * @brief 记录当前结果为已广播
+ */
+void sensor_commit(void)
+{
+    tmos_memcpy(sensor_adv_values, sensor_values, sizeof(sensor_values));
+}
+
+/**
+ * @brief CRC8校验计算 (多项式 0x31)
+ * @param data 数据指针
+ * @param len 数据长度
+ * @param init 初始值
+ * @return CRC8校验值
+ */
+uint8_t sensor_crc8(const uint8_t *data, int len, uint8_t init)
+{
+    uint8_t crc = init;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++) {
+            if (crc & 0x80)
+                crc = (crc << 1) ^ 0x131;
+            else
+                crc <<= 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief 选择满足精度目标且转换时间最短的分辨率选项
+ * @param drv 驱动
+ * @param target 各对象的精度目标 (单位 0.01)
+ * @return 选项序号, 无法满足时返回第一个选项
+ */
+uint8_t sensor_select_res(const sensor_driver_t *drv, const uint16_t *target)
+{
+    uint8_t best = 0;
+    uint16_t best_ms = 0xffff;
+
+    for (uint8_t r = 0; r < drv->num_res; r++) {
+        uint8_t fit = TRUE;
+
+        for (uint8_t i = 0; i < drv->num_objects; i++) {
+            fit &= (drv->res[r].lsb[i] <= (uint32_t)target[i] * 100);
+        }
+        if (fit && drv->res[r].conv_ms < best_ms) {
+            best = r;
+            best_ms = drv->res[r].conv_ms;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 按当前分辨率规划一次采样, 不访问总线
+ * @param plan 规划结果
+ * @return 本次采样的传感器电荷 (nC)
+ */
+uint32_t sensor_plan(i2c_sched_plan_t *plan)
+{
+    // 规划不影响进行中的采样, 使用单独的任务表
+    static i2c_sched_job_t jobs[SENSOR_JOBS_MAX];
+    i2c_sched_t sched = { .jobs = jobs };
+    uint32_t charge = 0;
+
+    for (uint8_t d = 0; d < SENSOR_NUM_DRIVERS; d++) {
+        const sensor_driver_t *drv = sensor_drivers[d];
+        i2c_sched_job_t *first = &jobs[sched.num];
+
+        if (sched.num + drv->num_jobs > SENSOR_JOBS_MAX) {
+            break;
+        }
+        for (uint8_t j = 0; j < drv->num_jobs; j++) {
+            tmos_memset(&first[j], 0, sizeof(first[j]));
+            first[j].addr = drv->addr;
+        }
+        drv->trigger(first);
+        // 每次采样转换一次 (周期测量时转换不在唤醒期间), uA * ms = nC
+        charge += (uint32_t)drv->active_ua * drv->res[drv->resolution()].conv_ms;
+        sched.num += drv->num_jobs;
+    }
+    i2c_sched_plan(&sched, plan);
+    return charge;
+}
+
+#ifdef DEBUG
+/**
+ * @brief 打印仅用于比较的驱动单独采样一次的规划
+ */
+static void sensor_print_compare(void)
+{
+    static const sensor_driver_t *const drivers[] = {
+        SENSOR_COMPARE(SENSOR_DRIVER_REF) NULL
+    };
+    static i2c_sched_job_t jobs[SENSOR_JOBS_MAX];
+    i2c_sched_t sched = { .jobs = jobs };
+    i2c_sched_plan_t plan;
+
+    for (uint8_t d = 0; drivers[d]; d++) {
+        const sensor_driver_t *drv = drivers[d];
+
+        if (drv->num_jobs > SENSOR_JOBS_MAX) {
+            continue;
+        }
+        tmos_memset(jobs, 0, sizeof(jobs[0]) * drv->num_jobs);
+        for (uint8_t j = 0; j < drv->num_jobs; j++) {
+            jobs[j].addr = drv->addr;
+        }
+        drv->trigger(jobs);
+        sched.num = drv->num_jobs;
+        i2c_sched_plan(&sched, &plan);
+        PRINT("compare %s: cycle %d us, awake %d us, %d wakes, %d nC, sleep %d nA\n",
+              drv->name, (int)plan.cycle_us, (int)plan.awake_us, plan.wakes,
+              (int)((uint32_t)drv->active_ua * drv->res[drv->resolution()].conv_ms), drv->sleep_na);
+    }
+}
+#endif
+
+/**
+ * @brief 打印已注册的驱动, 分辨率选项及规划的采样, 没有 DEBUG 时不输出
+ */
+void sensor_print(void)
+{
+#ifdef DEBUG
+    i2c_sched_plan_t plan;
+    uint32_t charge;
+
+    for (uint8_t d = 0; d < SENSOR_NUM_DRIVERS; d++) {
+        const sensor_driver_t *drv = sensor_drivers[d];
+
+        PRINT("sensor %s @0x%02X: %d uA active, %d nA sleep, objects",
+              drv->name, drv->addr, drv->active_ua, drv->sleep_na);
+        for (uint8_t i = 0; i < drv->num_objects; i++) {
+            PRINT(" 0x%02X%s", drv->objects[i], sensor_slot[d][i] == SENSOR_SLOT_NONE ? "(-)" : "");
+        }
+        PRINT("\n");
+        for (uint8_t r = 0; r < drv->num_res; r++) {
+            PRINT("  %c res %d: %d ms, %d nC, lsb",
+                  r == drv->resolution() ? '*' : ' ', r, drv->res[r].conv_ms,
+                  (int)((uint32_t)drv->active_ua * drv->res[r].conv_ms));
+            for (uint8_t i = 0; i < drv->num_objects; i++) {
+                PRINT(" %d", drv->res[r].lsb[i]);
+            }
+            PRINT("\n");
+        }
+    }
+
+    charge = sensor_plan(&plan);
+    PRINT("sensor plan: cycle %d us, awake %d us, %d wakes, %d nC\n",
+          (int)plan.cycle_us, (int)plan.awake_us, plan.wakes, (int)charge);
+#if (SENSOR_FILTER == TRUE)
+    PRINT("sensor filter: median %d, ema 1/%d\n", SENSOR_FILTER_MEDIAN, 1 << SENSOR_FILTER_EMA_SHIFT);
+#endif
+    sensor_print_compare();
+#endif
+}
@@ -0,0 +1,372 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_bme280.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : BME280/BMP280 温湿度气压传感器驱动 (强制模式, 整数补偿)
+ *******************************************************************************/
+
+#include "sensor_bme280.h"
+#include "HAL.h"
+
+// 寄存器
+#define BME280_REG_CALIB_TP            0x88    // T1..P9, 24字节, 0xA1 为 H1
+#define BME280_REG_CHIP_ID             0xD0
+#define BME280_REG_CALIB_H             0xE1    // H2..H6, 7字节
+#define BME280_REG_CTRL_HUM            0xF2
+#define BME280_REG_CTRL_MEAS           0xF4
+#define BME280_REG_CONFIG              0xF5
+#define BME280_REG_DATA                0xF7    // 气压, 温度, 湿度 共8字节
+
+#define BME280_CALIB_TP_LEN            26
+#define BME280_CALIB_H_LEN             7
+#define BME280_MODE_FORCED             0x01
+
+// 测量电流 (气压转换时最大) 及休眠电流 (典型值)
+#define BME280_ACTIVE_UA               714
+#define BME280_SLEEP_NA                100
+
+// RTC 周期数转换为微秒
+#define RTC_TICKS_TO_US(t) ((t) * (1000000 / 64) / (FREQ_RTC / 64))
+
+// 各过采样的寄存器值及倍数, 顺序与 bme280_osr_t 一致
+static const struct {
+    uint8_t osrs;
+    uint8_t times;
+} bme280_osr_tab[] = {
+    { 5, 16 },
+    { 3, 4  },
+    { 2, 2  },
+    { 1, 1  },
+};
+
+// 分辨率选项: BME280 最大转换时间, 分辨率 (单位 0.0001°C / 0.0001%RH / 0.0001hPa)
+static const sensor_res_t bme280_res_opts[] = {
+    { 113, { 3,  80, 16  } },
+    { 30,  { 12, 80, 66  } },
+    { 17,  { 25, 80, 131 } },
+    { 10,  { 50, 80, 262 } },
+};
+
+static const uint8_t bme280_objects[] = {
+    BTHOME_ID_TEMPERATURE,
+    BTHOME_ID_HUMIDITY,
+    BTHOME_ID_PRESSURE,
+};
+
+static bme280_calib_t bme280_calib;
+// 已读取校准数据的芯片 ID, 0 表示未读取
+static uint8_t bme280_chip;
+static bme280_osr_t bme280_osr = BME280_OSR_1;
+// 当前过采样下的转换时间及规划的唤醒时间
+static uint16_t bme280_conv_ms = 10;
+static uint32_t bme280_plan_us;
+
+/**
+ * @brief 读取连续寄存器
+ * @param reg 起始寄存器
+ * @param buf 缓冲区
+ * @param len 长度
+ * @return 0表示成功，负值表示错误代码
+ */
+static int bme280_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    struct i2c_msg msgs[2] = {
+        { BME280_I2C_ADDR, 0, 1, &reg },
+        { BME280_I2C_ADDR, I2C_M_RD, len, buf },
+    };
+
+    if (i2c_transfer(msgs, 2) != 2) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 写一个寄存器
+ * @param reg 寄存器
+ * @param val 值
+ * @return 0表示成功，负值表示错误代码
+ */
+static int bme280_write_reg(uint8_t reg, uint8_t val)
+{
+    uint8_t buf[2] = { reg, val };
+
+    if (i2c_write_to(BME280_I2C_ADDR, buf, 2, true, true) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 读取并解析校准数据
+ * @param chip 芯片 ID
+ * @return 0表示成功，负值表示错误代码
+ */
+static int bme280_read_calib(uint8_t chip)
+{
+    uint8_t tp[BME280_CALIB_TP_LEN];
+    uint8_t h[BME280_CALIB_H_LEN];
+    bme280_calib_t *c = &bme280_calib;
+
+    if (bme280_read_regs(BME280_REG_CALIB_TP, tp, sizeof(tp)) != 0) {
+        return -1;
+    }
+    c->t1 = (uint16_t)(tp[1] << 8 | tp[0]);
+    c->t2 = (int16_t)(tp[3] << 8 | tp[2]);
+    c->t3 = (int16_t)(tp[5] << 8 | tp[4]);
+    c->p1 = (uint16_t)(tp[7] << 8 | tp[6]);
+    c->p2 = (int16_t)(tp[9] << 8 | tp[8]);
+    c->p3 = (int16_t)(tp[11] << 8 | tp[10]);
+    c->p4 = (int16_t)(tp[13] << 8 | tp[12]);
+    c->p5 = (int16_t)(tp[15] << 8 | tp[14]);
+    c->p6 = (int16_t)(tp[17] << 8 | tp[16]);
+    c->p7 = (int16_t)(tp[19] << 8 | tp[18]);
+    c->p8 = (int16_t)(tp[21] << 8 | tp[20]);
+    c->p9 = (int16_t)(tp[23] << 8 | tp[22]);
+
+    if (chip == BME280_CHIP_ID) {
+        if (bme280_read_regs(BME280_REG_CALIB_H, h, sizeof(h)) != 0) {
+            return -1;
+        }
+        c->h1 = tp[25];
+        c->h2 = (int16_t)(h[1] << 8 | h[0]);
+        c->h3 = h[2];
+        // H4/H5 为12位有符号数, 共用 0xE5
+        c->h4 = (int16_t)((int8_t)h[3] * 16 | (h[4] & 0x0F));
+        c->h5 = (int16_t)((int8_t)h[5] * 16 | (h[4] >> 4));
+        c->h6 = (int8_t)h[6];
+    }
+    return 0;
+}
+
+/**
+ * @brief 温度补偿 (Bosch 32位整数算法)
+ * @param c 校准数据
+ * @param adc_t 温度原始值
+ * @param t_fine 供气压和湿度补偿使用的精细温度
+ * @return 温度 (单位0.01°C)
+ */
+int32_t bme280_compensate_t(const bme280_calib_t *c, int32_t adc_t, int32_t *t_fine)
+{
+    int32_t var1, var2;
+
+    var1 = ((((adc_t >> 3) - ((int32_t)c->t1 << 1))) * ((int32_t)c->t2)) >> 11;
+    var2 = (((((adc_t >> 4) - ((int32_t)c->t1)) * ((adc_t >> 4) - ((int32_t)c->t1))) >> 12) *
+            ((int32_t)c->t3)) >> 14;
+    *t_fine = var1 + var2;
+    return (*t_fine * 5 + 128) >> 8;
+}
+
+/**
+ * @brief 气压补偿 (Bosch 32位整数算法)
+ * @param c 校准数据
+ * @param adc_p 气压原始值
+ * @param t_fine 精细温度
+ * @return 气压 (单位Pa), 校准数据无效时返回0
+ */
+uint32_t bme280_compensate_p(const bme280_calib_t *c, int32_t adc_p, int32_t t_fine)
+{
+    int32_t var1, var2;
+    uint32_t p;
+
+    var1 = (t_fine >> 1) - (int32_t)64000;
+    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)c->p6);
+    var2 = var2 + ((var1 * ((int32_t)c->p5)) << 1);
+    var2 = (var2 >> 2) + (((int32_t)c->p4) << 16);
+    var1 = (((c->p3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)c->p2) * var1) >> 1)) >> 18;
+    var1 = ((((32768 + var1)) * ((int32_t)c->p1)) >> 15);
+    if (var1 == 0) {
+        return 0;   // 避免除零
+    }
+    p = (((uint32_t)(((int32_t)1048576) - adc_p) - (var2 >> 12))) * 3125;
+    if (p < 0x80000000) {
+        p = (p << 1) / ((uint32_t)var1);
+    } else {
+        p = (p / (uint32_t)var1) * 2;
+    }
+    var1 = (((int32_t)c->p9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+    var2 = (((int32_t)(p >> 2)) * ((int32_t)c->p8)) >> 13;
+    p = (uint32_t)((int32_t)p + ((var1 + var2 + c->p7) >> 4));
+    return p;
+}
+
+/**
+ * @brief 湿度补偿 (Bosch 32位整数算法)
+ * @param c 校准数据
+ * @param adc_h 湿度原始值
+ * @param t_fine 精细温度
+ * @return 湿度 (单位 1/1024 %RH)
+ */
+uint32_t bme280_compensate_h(const bme280_calib_t *c, int32_t adc_h, int32_t t_fine)
+{
+    int32_t v;
+
+    v = (t_fine - ((int32_t)76800));
+    v = (((((adc_h << 14) - (((int32_t)c->h4) << 20) - (((int32_t)c->h5) * v)) +
+           ((int32_t)16384)) >> 15) *
+         (((((((v * ((int32_t)c->h6)) >> 10) * (((v * ((int32_t)c->h3)) >> 11) +
+           ((int32_t)32768))) >> 10) + ((int32_t)2097152)) * ((int32_t)c->h2) + 8192) >> 14));
+    v = (v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)c->h1)) >> 4));
+    v = (v < 0) ? 0 : v;
+    v = (v > 419430400) ? 419430400 : v;
+    return (uint32_t)(v >> 12);
+}
+
+/**
+ * @brief 当前过采样下的最大转换时间 (数据手册附录 B)
+ * @return 转换时间 (ms)
+ */
+static uint16_t bme280_meas_ms(void)
+{
+    uint32_t n = bme280_osr_tab[bme280_osr].times;
+    uint32_t us = 1250 + 2300 * n + (2300 * n + 575);
+
+    if (bme280_chip == BME280_CHIP_ID) {
+        us += 2300 * n + 575;
+    }
+    return (uint16_t)((us + 999) / 1000);
+}
+
+/**
+ * @brief 规划的单次采样唤醒时间
+ * @return 唤醒时间 (us)
+ */
+uint32_t bme280_awake_us(void)
+{
+    // 规划不影响进行中的采样, 使用单独的任务
+    static i2c_sched_job_t job;
+    static i2c_sched_plan_t plan;
+    i2c_sched_t sched = { .jobs = &job, .num = 1 };
+
+    tmos_memset(&job, 0, sizeof(job));
+    job.addr = BME280_I2C_ADDR;
+    bme280_sensor.trigger(&job);
+    i2c_sched_plan(&sched, &plan);
+    return plan.awake_us;
+}
+
+// =============================================================================
+// 传感器驱动接口
+// =============================================================================
+
+/**
+ * @brief 识别芯片, 首次读取校准数据, 设置湿度过采样并关闭 IIR 滤波
+ * @return 0表示成功，负值表示错误代码
+ */
+static int bme280_drv_init(void)
+{
+    static const uint16_t target[3] = {
+        SENSOR_TEMP_ACCURACY_TARGET, SENSOR_HUMI_ACCURACY_TARGET, SENSOR_PRES_ACCURACY_TARGET
+    };
+    uint8_t chip;
+    int ret;
+
+    ret = bme280_read_regs(BME280_REG_CHIP_ID, &chip, 1);
+    if (ret != 0 || (chip != BME280_CHIP_ID && chip != BMP280_CHIP_ID)) {
+        PRINT("BME280 chip id read failed: %d (0x%02X)\n", ret, chip);
+        return -1;
+    }
+
+    // 校准数据只读取一次, 出错重新初始化时沿用
+    if (chip != bme280_chip) {
+        ret = bme280_read_calib(chip);
+        if (ret != 0) {
+            PRINT("BME280 calibration read failed: %d\n", ret);
+            return ret - 1;
+        }
+        bme280_chip = chip;
+    }
+
+    bme280_osr = (bme280_osr_t)sensor_select_res(&bme280_sensor, target);
+    // 湿度过采样在下一次写 ctrl_meas 时生效
+    if ((chip == BME280_CHIP_ID &&
+         bme280_write_reg(BME280_REG_CTRL_HUM, bme280_osr_tab[bme280_osr].osrs) != 0) ||
+        bme280_write_reg(BME280_REG_CONFIG, 0) != 0) {
+        PRINT("BME280 config failed\n");
+        return -3;
+    }
+    bme280_conv_ms = bme280_meas_ms();
+    bme280_plan_us = bme280_awake_us();
+
+    PRINT("%s oversampling x%d, conversion %d ms, planned awake %d us\n",
+          chip == BME280_CHIP_ID ? "BME280" : "BMP280", bme280_osr_tab[bme280_osr].times,
+          bme280_conv_ms, (int)bme280_plan_us);
+    return 0;
+}
+
+/**
+ * @brief 写 ctrl_meas 启动一次强制模式转换, 结束后从 0xF7 连续读取
+ * @param jobs 调度任务
+ */
+static void bme280_drv_trigger(i2c_sched_job_t *jobs)
+{
+    uint8_t osrs = bme280_osr_tab[bme280_osr].osrs;
+
+    jobs[0].cmd_len = 2;
+    jobs[0].cmd[0] = BME280_REG_CTRL_MEAS;
+    jobs[0].cmd[1] = (osrs << 5) | (osrs << 2) | BME280_MODE_FORCED;
+    jobs[0].flags = I2C_SCHED_RD_REG;
+    jobs[0].rd_reg = BME280_REG_DATA;
+    jobs[0].rx_len = (bme280_chip == BMP280_CHIP_ID) ? 6 : 8;
+    jobs[0].conv_ms = bme280_conv_ms;
+}
+
+/**
+ * @brief 补偿读出结果并报告本次采样的时间
+ * @param jobs 完成的调度任务
+ * @param values 结果 (温度0.01°C, 湿度0.01%RH, 气压0.01hPa)
+ * @return 0表示成功，负值表示错误代码
+ */
+static int bme280_drv_read(const i2c_sched_job_t *jobs, int32_t *values)
+{
+    const uint8_t *rx = jobs[0].rx;
+    int32_t adc_p = ((int32_t)rx[0] << 12) | ((int32_t)rx[1] << 4) | (rx[2] >> 4);
+    int32_t adc_t = ((int32_t)rx[3] << 12) | ((int32_t)rx[4] << 4) | (rx[5] >> 4);
+    int32_t t_fine;
+
+    // 转换未进行时数据寄存器保持复位值 0x80000
+    if (adc_t == 0x80000) {
+        PRINT("BME280 no conversion\n");
+        return -3;
+    }
+
+    values[0] = bme280_compensate_t(&bme280_calib, adc_t, &t_fine);
+    values[2] = (int32_t)bme280_compensate_p(&bme280_calib, adc_p, t_fine);
+    values[1] = SENSOR_VALUE_INVALID;
+    if (bme280_chip == BME280_CHIP_ID) {
+        int32_t adc_h = ((int32_t)rx[6] << 8) | rx[7];
+
+        values[1] = (int32_t)((bme280_compensate_h(&bme280_calib, adc_h, t_fine) * 100) >> 10);
+    }
+
+    PRINT("BME280: T=%d, H=%d, P=%d; trigger %d us, read %d us, planned awake %d us\n",
+          (int)values[0], (int)values[1], (int)values[2],
+          (int)RTC_TICKS_TO_US(jobs[0].t_trig), (int)RTC_TICKS_TO_US(jobs[0].t_read),
+          (int)bme280_plan_us);
+    return 0;
+}
+
+/**
+ * @brief 当前过采样在 bme280_res_opts 中的序号
+ */
+static uint8_t bme280_drv_resolution(void)
+{
+    return bme280_osr;
+}
+
+const sensor_driver_t bme280_sensor = {
+    .name = "BME280",
+    .addr = BME280_I2C_ADDR,
+    .num_jobs = 1,
+    .num_objects = sizeof(bme280_objects),
+    .num_res = sizeof(bme280_res_opts) / sizeof(bme280_res_opts[0]),
+    .active_ua = BME280_ACTIVE_UA,
+    .sleep_na = BME280_SLEEP_NA,
+    .objects = bme280_objects,
+    .res = bme280_res_opts,
+    .init = bme280_drv_init,
+    .trigger = bme280_drv_trigger,
+    .read = bme280_drv_read,
+    .resolution = bme280_drv_resolution,
+};
@@ -0,0 +1,112 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_derived.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : 由温湿度计算露点, 绝对湿度及饱和水汽压差 (查表, 无浮点)
+ *******************************************************************************/
+
+#include "sensor_derived.h"
+
+// 水蒸气比气体常数的倒数 M/R = 2.1668 g*K/J, 单位换算后的系数
+#define SENSOR_DERIVED_AH_COEF  2167
+
+// 饱和水汽压 (单位0.01Pa), -40°C ~ 85°C 每1°C一项
+// es = 611.2 * exp(17.62 * T / (243.12 + T)) Pa
+static const uint32_t sensor_svp_tab[] = {
+    1902, 2109, 2336, 2586, 2858, 3157, 3484, 3840, 4230, 4654,  // -40°C
+    5117, 5620, 6168, 6764, 7410, 8112, 8872, 9696, 10588, 11553,  // -30°C
+    12597, 13723, 14939, 16251, 17665, 19187, 20826, 22589, 24483, 26518,  // -20°C
+    28703, 31047, 33559, 36251, 39134, 42218, 45517, 49043, 52809, 56830,  // -10°C
+    61120, 65695, 70570, 75763, 81292, 87174, 93430, 100079, 107143, 114643,  // 0°C
+    122603, 131046, 139998, 149483, 159531, 170167, 181423, 193327, 205913, 219212,  // 10°C
+    233260, 248090, 263742, 280251, 297659, 316006, 335334, 355689, 377115, 399660,  // 20°C
+    423372, 448303, 474505, 502031, 530939, 561284, 593128, 626531, 661558, 698274,  // 30°C
+    736746, 777044, 819241, 863409, 909627, 957971, 1008523, 1061367, 1116588, 1174274,  // 40°C
+    1234516, 1297407, 1363042, 1431521, 1502945, 1577416, 1655043, 1735933, 1820201, 1907960,  // 50°C
+    1999329, 2094429, 2193384, 2296322, 2403374, 2514671, 2630353, 2750558, 2875431, 3005117,  // 60°C
+    3139768, 3279536, 3424580, 3575059, 3731139, 3892987, 4060774, 4234677, 4414874, 4601548,  // 70°C
+    4794885, 4995078, 5202319, 5416808, 5638748, 5868344,  // 80°C
+};
+
+#define SENSOR_SVP_NUM (sizeof(sensor_svp_tab) / sizeof(sensor_svp_tab[0]))
+
+_Static_assert(SENSOR_SVP_NUM == (SENSOR_DERIVED_T_MAX - SENSOR_DERIVED_T_MIN) / 100 + 1,
+               "table does not match the temperature range");
+
+/**
+ * @brief 饱和水汽压 (查表线性插值)
+ * @param temp 温度 (单位0.01°C)
+ * @return 饱和水汽压 (单位0.01Pa)
+ */
+uint32_t sensor_svp(int32_t temp)
+{
+    uint32_t t = (uint32_t)(temp - SENSOR_DERIVED_T_MIN);
+    uint32_t i = t / 100;
+    uint32_t f = t % 100;
+
+    if (i >= SENSOR_SVP_NUM - 1) {
+        return sensor_svp_tab[SENSOR_SVP_NUM - 1];
+    }
+    return sensor_svp_tab[i] + ((sensor_svp_tab[i + 1] - sensor_svp_tab[i]) * f + 50) / 100;
+}
+
+/**
+ * @brief 露点: 在饱和水汽压表中反查实际水汽压
+ * @param e 实际水汽压 (单位0.01Pa)
+ * @return 露点 (单位0.01°C)
+ */
+static int32_t sensor_dew_point(uint32_t e)
+{
+    uint32_t lo = 0, hi = SENSOR_SVP_NUM - 1;
+    uint32_t span;
+
+    if (e <= sensor_svp_tab[lo]) {
+        return SENSOR_DERIVED_T_MIN;
+    }
+    if (e >= sensor_svp_tab[hi]) {
+        return SENSOR_DERIVED_T_MAX;
+    }
+    // 二分查找 tab[lo] <= e < tab[hi], hi = lo + 1
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+
+        if (sensor_svp_tab[mid] <= e) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    span = sensor_svp_tab[hi] - sensor_svp_tab[lo];
+    return SENSOR_DERIVED_T_MIN + (int32_t)(lo * 100 + ((e - sensor_svp_tab[lo]) * 100 + span / 2) / span);
+}
+
+/**
+ * @brief 计算露点, 绝对湿度及饱和水汽压差
+ * @param temp 温度 (单位0.01°C)
+ * @param humid 相对湿度 (单位0.01%)
+ * @param out 结果指针
+ * @return 0表示成功，-1表示输入超出范围
+ */
+int sensor_derive(int32_t temp, int32_t humid, sensor_derived_t *out)
+{
+    uint32_t es, e;
+
+    if (temp < SENSOR_DERIVED_T_MIN || temp > SENSOR_DERIVED_T_MAX || humid < 0 || humid > 10000) {
+        return -1;
+    }
+
+    // e = es * RH, 约 30°C 以上先除以16避免32位溢出 (10000 = 16 * 625)
+    es = sensor_svp(temp);
+    if (es < UINT32_MAX / 10000) {
+        e = es * (uint32_t)humid / 10000;
+    } else {
+        e = (es >> 4) * (uint32_t)humid / 625;
+    }
+
+    out->dew_point = sensor_dew_point(e);
+    out->vpd = (int32_t)((es - e + 50) / 100);
+    // AH = e * M / (R * T): e 换算为0.1Pa, 温度为0.01K, 结果为0.01g/m3
+    out->abs_humid = (int32_t)((e / 10) * SENSOR_DERIVED_AH_COEF / (uint32_t)(temp + 27315));
+    return 0;
+}
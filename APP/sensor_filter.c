@@ -0,0 +1,86 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_filter.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : 传感器结果滤波: 短窗口中值去除毛刺, 整数指数平均压低噪声
+ *******************************************************************************/
+
+#include "sensor.h"
+#include "sensor_filter.h"
+
+_Static_assert(SENSOR_FILTER_MEDIAN >= 1 && SENSOR_FILTER_MEDIAN <= 7 && (SENSOR_FILTER_MEDIAN & 1),
+               "median window must be odd and at most 7");
+
+// 每个通道的滤波状态
+typedef struct {
+    int32_t win[SENSOR_FILTER_MEDIAN];  // 最近的样本 (环形)
+    int32_t ema;                        // 平均值, SENSOR_FILTER_FRAC 位小数
+    uint8_t pos;                        // 下一个样本的位置
+    uint8_t count;                      // 窗口中的样本数, 0 表示无历史
+} sensor_filter_t;
+
+// 所有通道的状态, 静态分配
+static sensor_filter_t sensor_filter_arena[SENSOR_OBJ_MAX];
+
+/**
+ * @brief 清除通道历史
+ * @param ch 通道
+ */
+void sensor_filter_reset(uint8_t ch)
+{
+    sensor_filter_arena[ch].count = 0;
+    sensor_filter_arena[ch].pos = 0;
+}
+
+/**
+ * @brief 窗口中值 (插入排序副本, 窗口未满时取已有样本的中值)
+ * @param f 通道状态
+ * @return 中值
+ */
+static int32_t sensor_filter_median(const sensor_filter_t *f)
+{
+    int32_t s[SENSOR_FILTER_MEDIAN];
+
+    for (uint8_t i = 0; i < f->count; i++) {
+        int32_t v = f->win[i];
+        uint8_t j = i;
+
+        while (j > 0 && s[j - 1] > v) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = v;
+    }
+    return s[f->count / 2];
+}
+
+/**
+ * @brief 滤波一个样本
+ * @param ch 通道
+ * @param value 样本
+ * @return 滤波结果
+ */
+int32_t sensor_filter_apply(uint8_t ch, int32_t value)
+{
+    sensor_filter_t *f = &sensor_filter_arena[ch];
+    int32_t med;
+
+    f->win[f->pos] = value;
+    f->pos = (f->pos + 1 == SENSOR_FILTER_MEDIAN) ? 0 : f->pos + 1;
+
+    // 第一个样本直接作为平均值的初值
+    if (f->count == 0) {
+        f->count = 1;
+        f->ema = value * (1 << SENSOR_FILTER_FRAC);
+        return value;
+    }
+    if (f->count < SENSOR_FILTER_MEDIAN) {
+        f->count++;
+    }
+
+    med = (SENSOR_FILTER_MEDIAN == 1) ? value : sensor_filter_median(f);
+    // ema += (med - ema) * alpha, 右移为算术移位
+    f->ema += (med * (1 << SENSOR_FILTER_FRAC) - f->ema) >> SENSOR_FILTER_EMA_SHIFT;
+    return (f->ema + (1 << (SENSOR_FILTER_FRAC - 1))) >> SENSOR_FILTER_FRAC;
+}
@@ -0,0 +1,395 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_sht20.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT20 温湿度传感器驱动
+ *******************************************************************************/
+
+#include "sensor_sht20.h"
+#include "HAL.h"
+
+// SHT20命令 (无保持主机模式, 转换期间释放总线)
+#define SHT20_TRIG_TEMP_MEASURE_NOHOLD 0xF3
+#define SHT20_TRIG_HUMI_MEASURE_NOHOLD 0xF5
+#define SHT20_WRITE_USER_REG           0xE6
+#define SHT20_READ_USER_REG            0xE7
+
+// 用户寄存器分辨率位 (bit7, bit0)
+#define SHT20_USER_REG_RES_MASK        0x81
+
+// 测量电流及休眠电流 (典型值)
+#define SHT20_ACTIVE_UA                300
+#define SHT20_SLEEP_NA                 150
+
+// 各分辨率的参数, 顺序与 sht20_res_t 一致
+static const struct {
+    uint8_t temp_bits;
+    uint8_t humi_bits;
+    uint8_t temp_ms;        // 最大转换时间
+    uint8_t humi_ms;
+} sht20_res_tab[] = {
+    { 14, 12, 85, 29 },     // SHT20_RES_RH12_T14
+    { 12, 8,  22, 4  },     // SHT20_RES_RH8_T12
+    { 13, 10, 43, 9  },     // SHT20_RES_RH10_T13
+    { 11, 11, 11, 15 },     // SHT20_RES_RH11_T11
+};
+
+// 驱动描述的分辨率选项: 温湿度总转换时间, 分辨率单位 0.0001°C / 0.0001%RH
+static const sensor_res_t sht20_res_opts[] = {
+    { 85 + 29, { 107, 305  } },
+    { 22 + 4,  { 429, 4883 } },
+    { 43 + 9,  { 215, 1221 } },
+    { 11 + 15, { 858, 610  } },
+};
+
+// 产生的 BTHome 对象, 顺序与 sht20_meas_t 一致
+static const uint8_t sht20_objects[] = {
+    BTHOME_ID_TEMPERATURE,
+    BTHOME_ID_HUMIDITY,
+};
+
+// 当前使用的分辨率 (上电默认 RH12/T14)
+static sht20_res_t sht20_res = SHT20_RES_RH12_T14;
+
+// 异步传输使用的传输描述和缓冲区 (同一时间只有一个 SHT20 传输)
+static i2c_xfer_t sht20_xfer;
+static struct i2c_msg sht20_msg;
+static uint8_t sht20_xfer_buf[3];
+
+/**
+ * @brief 选择满足精度目标且转换时间最短的分辨率
+ * @param temp_target 温度精度目标 (单位0.01°C)
+ * @param humi_target 湿度精度目标 (单位0.01%RH)
+ * @return 分辨率, 无法满足时返回最高分辨率
+ */
+sht20_res_t sht20_select_resolution(uint16_t temp_target, uint16_t humi_target)
+{
+    uint16_t target[2] = { temp_target, humi_target };
+
+    return (sht20_res_t)sensor_select_res(&sht20_sensor, target);
+}
+
+/**
+ * @brief 读取SHT20用户寄存器
+ * @param reg 寄存器值指针
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_read_user_reg(uint8_t *reg)
+{
+    uint8_t cmd = SHT20_READ_USER_REG;
+    struct i2c_msg msgs[2] = {
+        { SHT20_I2C_ADDR, 0, 1, &cmd },
+        { SHT20_I2C_ADDR, I2C_M_RD, 1, reg },
+    };
+    int ret;
+
+    // 写命令后重复起始读取, 一次中断驱动的传输完成
+    ret = i2c_transfer(msgs, 2);
+    if (ret != 2) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 写SHT20用户寄存器
+ * @param reg 寄存器值 (保留位需保持读出的值)
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_write_user_reg(uint8_t reg)
+{
+    uint8_t buf[2] = { SHT20_WRITE_USER_REG, reg };
+
+    if (i2c_write_to(SHT20_I2C_ADDR, buf, 2, true, true) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 设置SHT20测量分辨率 (读-改-写用户寄存器)
+ * @param res 分辨率
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_set_resolution(sht20_res_t res)
+{
+    uint8_t reg, val;
+    int ret;
+
+    ret = sht20_read_user_reg(&reg);
+    if (ret != 0) {
+        PRINT("SHT20 user reg read failed: %d\n", ret);
+        return ret;
+    }
+
+    val = (reg & ~SHT20_USER_REG_RES_MASK) | ((res & 0x02) << 6) | (res & 0x01);
+    if (val != reg) {
+        ret = sht20_write_user_reg(val);
+        if (ret != 0) {
+            PRINT("SHT20 user reg write failed: %d\n", ret);
+            return ret - 2;
+        }
+    }
+    sht20_res = res;
+
+    PRINT("SHT20 resolution: RH %d bit / T %d bit, conversion %d + %d ms\n",
+          sht20_res_tab[res].humi_bits, sht20_res_tab[res].temp_bits,
+          sht20_res_tab[res].temp_ms, sht20_res_tab[res].humi_ms);
+    return 0;
+}
+
+/**
+ * @brief 获取当前分辨率下的最大转换时间
+ * @param meas 测量类型 (温度/湿度)
+ * @return 转换时间 (ms)
+ */
+uint8_t sht20_conv_time_ms(sht20_meas_t meas)
+{
+    return (meas == SHT20_MEAS_TEMP) ? sht20_res_tab[sht20_res].temp_ms
+                                     : sht20_res_tab[sht20_res].humi_ms;
+}
+
+/**
+ * @brief 获取无保持主机模式的触发命令
+ * @param meas 测量类型 (温度/湿度)
+ * @return 命令字节
+ */
+uint8_t sht20_trigger_cmd(sht20_meas_t meas)
+{
+    return (meas == SHT20_MEAS_TEMP) ? SHT20_TRIG_TEMP_MEASURE_NOHOLD
+                                     : SHT20_TRIG_HUMI_MEASURE_NOHOLD;
+}
+
+/**
+ * @brief 触发SHT20一次测量 (无保持主机模式)
+ * @param meas 测量类型 (温度/湿度)
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_start_measure(sht20_meas_t meas)
+{
+    uint8_t cmd;
+    int ret;
+
+    cmd = sht20_trigger_cmd(meas);
+    ret = i2c_write_to(SHT20_I2C_ADDR, &cmd, 1, true, true);
+    if (ret != 0) {
+        PRINT("SHT20 trigger %d failed: %d\n", meas, ret);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 校验并换算SHT20测量结果
+ * @param meas 测量类型 (温度/湿度)
+ * @param buf 读出的3字节 (数据 + CRC)
+ * @param value 结果指针 (温度单位0.01°C, 湿度单位0.01%RH)
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_convert(sht20_meas_t meas, const uint8_t *buf, int16_t *value)
+{
+    if (sensor_crc8(buf, 2, 0x00) != buf[2]) {
+        PRINT("SHT20 %d CRC failed\n", meas);
+        return -3;
+    }
+
+    uint16_t raw = ((uint16_t)buf[0] << 8) | buf[1];
+    raw &= ~0x0003; // 清除状态位
+
+    if (meas == SHT20_MEAS_TEMP) {
+        // SHT20温度转换公式: T = -46.85 + 175.72 * raw / 2^16
+        // 转换为0.01°C单位: T = -4685 + 17572 * raw / 2^16
+        *value = (int16_t)((((int32_t)raw * 17572) >> 16) - 4685);
+        PRINT("SHT20 temp raw: 0x%04X, converted: %d (0.01°C)\n", raw, *value);
+    } else {
+        // SHT20湿度转换公式: RH = -6 + 125 * raw / 2^16
+        // 转换为0.01%RH单位: RH = -600 + 12500 * raw / 2^16
+        *value = (int16_t)((((int32_t)raw * 12500) >> 16) - 600);
+        PRINT("SHT20 humid raw: 0x%04X, converted: %d (0.01%%)\n", raw, *value);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 读取SHT20已完成的测量结果
+ * @param meas 测量类型 (温度/湿度)
+ * @param value 结果指针 (温度单位0.01°C, 湿度单位0.01%RH)
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_fetch_measure(sht20_meas_t meas, int16_t *value)
+{
+    uint8_t buf[3];
+    int ret;
+
+    // 转换未完成时SHT20不应答读地址
+    ret = i2c_read_from(SHT20_I2C_ADDR, buf, 3, true, 100);
+    if (ret != 3) {
+        PRINT("SHT20 read %d failed: %d\n", meas, ret);
+        return -2;
+    }
+    return sht20_convert(meas, buf, value);
+}
+
+/**
+ * @brief 异步触发SHT20一次测量, 完成后向 task_id 发送 I2C_XFER_DONE_MSG
+ * @param meas 测量类型 (温度/湿度)
+ * @param task_id 接收完成消息的任务
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_start_measure_async(sht20_meas_t meas, uint8_t task_id)
+{
+    sht20_xfer_buf[0] = sht20_trigger_cmd(meas);
+    sht20_msg.addr = SHT20_I2C_ADDR;
+    sht20_msg.flags = 0;
+    sht20_msg.len = 1;
+    sht20_msg.buf = sht20_xfer_buf;
+    sht20_xfer.msgs = &sht20_msg;
+    sht20_xfer.num = 1;
+    sht20_xfer.task_id = task_id;
+    sht20_xfer.tag = meas;
+
+    return i2c_submit(&sht20_xfer);
+}
+
+/**
+ * @brief 异步读取SHT20测量结果, 完成后向 task_id 发送 I2C_XFER_DONE_MSG
+ * @param meas 测量类型 (温度/湿度)
+ * @param task_id 接收完成消息的任务
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_fetch_measure_async(sht20_meas_t meas, uint8_t task_id)
+{
+    sht20_msg.addr = SHT20_I2C_ADDR;
+    sht20_msg.flags = I2C_M_RD;
+    sht20_msg.len = 3;
+    sht20_msg.buf = sht20_xfer_buf;
+    sht20_xfer.msgs = &sht20_msg;
+    sht20_xfer.num = 1;
+    sht20_xfer.task_id = task_id;
+    sht20_xfer.tag = meas;
+
+    return i2c_submit(&sht20_xfer);
+}
+
+/**
+ * @brief 处理异步读取的完成消息, 校验并换算结果
+ * @param xfer 完成的传输
+ * @param value 结果指针 (温度单位0.01°C, 湿度单位0.01%RH)
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_fetch_measure_done(const i2c_xfer_t *xfer, int16_t *value)
+{
+    if (xfer->status || xfer->actual != 3) {
+        PRINT("SHT20 read %d failed: %d\n", xfer->tag, -xfer->status);
+        return -2;
+    }
+    return sht20_convert((sht20_meas_t)xfer->tag, xfer->msgs[0].buf, value);
+}
+
+/**
+ * @brief 读取SHT20温度和湿度 (阻塞方式, 转换期间忙等)
+ * @param temp 温度指针 (单位0.01°C)
+ * @param humi 湿度指针 (单位0.01%RH)
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht20_read_temp_humi(int16_t *temp, int16_t *humi)
+{
+    int ret;
+
+    // 读取温度
+    ret = sht20_start_measure(SHT20_MEAS_TEMP);
+    if (ret != 0) {
+        return ret;
+    }
+    mDelaymS(sht20_conv_time_ms(SHT20_MEAS_TEMP));
+    ret = sht20_fetch_measure(SHT20_MEAS_TEMP, temp);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // 读取湿度
+    ret = sht20_start_measure(SHT20_MEAS_HUMI);
+    if (ret != 0) {
+        return ret - 3;
+    }
+    mDelaymS(sht20_conv_time_ms(SHT20_MEAS_HUMI));
+    ret = sht20_fetch_measure(SHT20_MEAS_HUMI, humi);
+    if (ret != 0) {
+        return ret - 3;
+    }
+
+    return 0;
+}
+
+// =============================================================================
+// 传感器驱动接口
+// =============================================================================
+
+/**
+ * @brief 按精度目标设置分辨率
+ * @return 0表示成功，负值表示错误代码
+ */
+static int sht20_drv_init(void)
+{
+    return sht20_set_resolution(sht20_select_resolution(SENSOR_TEMP_ACCURACY_TARGET,
+                                                        SENSOR_HUMI_ACCURACY_TARGET));
+}
+
+/**
+ * @brief 填写温度和湿度两个调度任务, 转换时间随分辨率变化
+ * @param jobs 调度任务
+ */
+static void sht20_drv_trigger(i2c_sched_job_t *jobs)
+{
+    for (uint8_t i = 0; i < 2; i++) {
+        jobs[i].cmd_len = 1;
+        jobs[i].cmd[0] = sht20_trigger_cmd((sht20_meas_t)i);
+        jobs[i].rx_len = 3;
+        jobs[i].conv_ms = sht20_conv_time_ms((sht20_meas_t)i);
+    }
+}
+
+/**
+ * @brief 校验并换算两个读出结果
+ * @param jobs 完成的调度任务
+ * @param values 结果 (温度单位0.01°C, 湿度单位0.01%RH)
+ * @return 0表示成功，负值表示错误代码
+ */
+static int sht20_drv_read(const i2c_sched_job_t *jobs, int32_t *values)
+{
+    int16_t value;
+
+    for (uint8_t i = 0; i < 2; i++) {
+        if (sht20_convert((sht20_meas_t)i, jobs[i].rx, &value) != 0) {
+            return -3;
+        }
+        values[i] = value;
+    }
+    return 0;
+}
+
+/**
+ * @brief 当前分辨率在 sht20_res_opts 中的序号
+ */
+static uint8_t sht20_drv_resolution(void)
+{
+    return sht20_res;
+}
+
+const sensor_driver_t sht20_sensor = {
+    .name = "SHT20",
+    .addr = SHT20_I2C_ADDR,
+    .num_jobs = 2,
+    .num_objects = sizeof(sht20_objects),
+    .num_res = sizeof(sht20_res_opts) / sizeof(sht20_res_opts[0]),
+    .active_ua = SHT20_ACTIVE_UA,
+    .sleep_na = SHT20_SLEEP_NA,
+    .objects = sht20_objects,
+    .res = sht20_res_opts,
+    .init = sht20_drv_init,
+    .trigger = sht20_drv_trigger,
+    .read = sht20_drv_read,
+    .resolution = sht20_drv_resolution,
+};
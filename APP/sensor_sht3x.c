@@ -0,0 +1,226 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_sht3x.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT3x 温湿度传感器驱动 (单次测量或周期测量)
+ *******************************************************************************/
+
+#include "sensor_sht3x.h"
+#include "HAL.h"
+
+// SHT3x命令 (16位, 高字节在前)
+#define SHT3X_CMD_FETCH                0xE000  // 读取周期测量结果
+#define SHT3X_CMD_BREAK                0x3093  // 停止周期测量
+#define SHT3X_CMD_HEATER_ON            0x306D
+#define SHT3X_CMD_HEATER_OFF           0x3066
+#define SHT3X_CMD_READ_STATUS          0xF32D
+
+// 测量电流, 单次测量空闲电流, 周期测量空闲电流 (典型值)
+#define SHT3X_ACTIVE_UA                600
+#define SHT3X_SLEEP_NA                 200
+#define SHT3X_PERIODIC_IDLE_NA         45000
+
+// 各重复性的命令, 顺序与 sht3x_rep_t 一致
+static const struct {
+    uint16_t single;        // 单次测量, 不拉伸时钟
+    uint16_t periodic;      // 周期测量 0.5 次/秒
+} sht3x_cmd_tab[] = {
+    { 0x2400, 0x2032 },     // SHT3X_REP_HIGH
+    { 0x240B, 0x2024 },     // SHT3X_REP_MEDIUM
+    { 0x2416, 0x202F },     // SHT3X_REP_LOW
+};
+
+// 分辨率选项: 最大转换时间, 重复性 (单位 0.0001°C / 0.0001%RH)
+static const sensor_res_t sht3x_res_opts[] = {
+    { 15, { 400,  800  } },
+    { 6,  { 800,  1500 } },
+    { 4,  { 1500, 2100 } },
+};
+
+static const uint8_t sht3x_objects[] = {
+    BTHOME_ID_TEMPERATURE,
+    BTHOME_ID_HUMIDITY,
+};
+
+static sht3x_rep_t sht3x_rep = SHT3X_REP_HIGH;
+// 周期测量刚启动, 第一个结果要一个测量周期 (2s) 后才能读取
+static uint8_t sht3x_fresh;
+
+/**
+ * @brief 发送一个16位命令
+ * @param cmd 命令
+ * @return 0表示成功，负值表示错误代码
+ */
+static int sht3x_write_cmd(uint16_t cmd)
+{
+    uint8_t buf[2] = { (uint8_t)(cmd >> 8), (uint8_t)cmd };
+
+    if (i2c_write_to(SHT3X_I2C_ADDR, buf, 2, true, true) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 校验并拆分6字节读出结果 (SHT3x/SHT4x 格式相同)
+ * @param buf 温度 MSB, LSB, CRC, 湿度 MSB, LSB, CRC
+ * @param temp 温度原始值指针
+ * @param humi 湿度原始值指针
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht3x_unpack(const uint8_t *buf, uint16_t *temp, uint16_t *humi)
+{
+    if (sensor_crc8(buf, 2, 0xFF) != buf[2] || sensor_crc8(buf + 3, 2, 0xFF) != buf[5]) {
+        return -3;
+    }
+    *temp = ((uint16_t)buf[0] << 8) | buf[1];
+    *humi = ((uint16_t)buf[3] << 8) | buf[4];
+    return 0;
+}
+
+/**
+ * @brief 开关内部加热器
+ * @param on 加热器状态
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht3x_set_heater(bool on)
+{
+    return sht3x_write_cmd(on ? SHT3X_CMD_HEATER_ON : SHT3X_CMD_HEATER_OFF);
+}
+
+/**
+ * @brief 读取状态寄存器
+ * @param status 状态指针
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht3x_read_status(uint16_t *status)
+{
+    uint8_t cmd[2] = { (uint8_t)(SHT3X_CMD_READ_STATUS >> 8), (uint8_t)SHT3X_CMD_READ_STATUS };
+    uint8_t buf[3];
+    struct i2c_msg msgs[2] = {
+        { SHT3X_I2C_ADDR, 0, 2, cmd },
+        { SHT3X_I2C_ADDR, I2C_M_RD, 3, buf },
+    };
+
+    if (i2c_transfer(msgs, 2) != 2 || sensor_crc8(buf, 2, 0xFF) != buf[2]) {
+        return -1;
+    }
+    *status = ((uint16_t)buf[0] << 8) | buf[1];
+    return 0;
+}
+
+// =============================================================================
+// 传感器驱动接口
+// =============================================================================
+
+/**
+ * @brief 选择重复性, 停止可能残留的周期测量, 周期模式下重新启动
+ * @return 0表示成功，负值表示错误代码
+ */
+static int sht3x_drv_init(void)
+{
+    static const uint16_t target[2] = { SENSOR_TEMP_ACCURACY_TARGET, SENSOR_HUMI_ACCURACY_TARGET };
+    int ret;
+
+    sht3x_rep = (sht3x_rep_t)sensor_select_res(&sht3x_sensor, target);
+
+    // 停止命令后需等待 1ms 才能接受新命令
+    ret = sht3x_write_cmd(SHT3X_CMD_BREAK);
+    if (ret != 0) {
+        PRINT("SHT3x break failed: %d\n", ret);
+        return ret;
+    }
+    mDelaymS(1);
+
+#if (SHT3X_MODE == SENSOR_MODE_PERIODIC)
+    ret = sht3x_write_cmd(sht3x_cmd_tab[sht3x_rep].periodic);
+    if (ret != 0) {
+        PRINT("SHT3x periodic start failed: %d\n", ret);
+        return ret - 1;
+    }
+    sht3x_fresh = TRUE;
+#endif
+
+    PRINT("SHT3x repeatability %d, %s, conversion %d ms\n", sht3x_rep,
+          (SHT3X_MODE == SENSOR_MODE_PERIODIC) ? "periodic" : "single shot",
+          sht3x_res_opts[sht3x_rep].conv_ms);
+    return 0;
+}
+
+/**
+ * @brief 单次测量: 触发后等待转换; 周期测量: 读取命令后直接读出
+ * @param jobs 调度任务
+ */
+static void sht3x_drv_trigger(i2c_sched_job_t *jobs)
+{
+#if (SHT3X_MODE == SENSOR_MODE_PERIODIC)
+    // 刚启动时还没有结果, 本次只读状态寄存器确认传感器在线
+    uint16_t cmd = sht3x_fresh ? SHT3X_CMD_READ_STATUS : SHT3X_CMD_FETCH;
+
+    jobs[0].flags = I2C_SCHED_FETCH;
+    jobs[0].rx_len = sht3x_fresh ? 3 : 6;
+#else
+    uint16_t cmd = sht3x_cmd_tab[sht3x_rep].single;
+
+    jobs[0].rx_len = 6;
+    jobs[0].conv_ms = sht3x_res_opts[sht3x_rep].conv_ms;
+#endif
+    jobs[0].cmd_len = 2;
+    jobs[0].cmd[0] = (uint8_t)(cmd >> 8);
+    jobs[0].cmd[1] = (uint8_t)cmd;
+}
+
+/**
+ * @brief 校验并换算读出结果
+ * @param jobs 完成的调度任务
+ * @param values 结果 (温度单位0.01°C, 湿度单位0.01%RH)
+ * @return 0表示成功, 1表示本次没有结果, 负值表示错误代码
+ */
+static int sht3x_drv_read(const i2c_sched_job_t *jobs, int32_t *values)
+{
+    uint16_t temp, humi;
+
+    if (sht3x_fresh) {
+        sht3x_fresh = FALSE;
+        return 1;
+    }
+    if (sht3x_unpack(jobs[0].rx, &temp, &humi) != 0) {
+        PRINT("SHT3x CRC failed\n");
+        return -3;
+    }
+
+    // T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535
+    values[0] = (int32_t)((uint32_t)temp * 17500 / 65535) - 4500;
+    values[1] = (int32_t)((uint32_t)humi * 10000 / 65535);
+    PRINT("SHT3x raw: 0x%04X 0x%04X, converted: %d %d\n", temp, humi, (int)values[0], (int)values[1]);
+    return 0;
+}
+
+/**
+ * @brief 当前重复性在 sht3x_res_opts 中的序号
+ */
+static uint8_t sht3x_drv_resolution(void)
+{
+    return sht3x_rep;
+}
+
+const sensor_driver_t sht3x_sensor = {
+    .name = "SHT3x",
+    .addr = SHT3X_I2C_ADDR,
+    .num_jobs = 1,
+    .num_objects = sizeof(sht3x_objects),
+    .num_res = sizeof(sht3x_res_opts) / sizeof(sht3x_res_opts[0]),
+    .active_ua = SHT3X_ACTIVE_UA,
+#if (SHT3X_MODE == SENSOR_MODE_PERIODIC)
+    .sleep_na = SHT3X_PERIODIC_IDLE_NA,
+#else
+    .sleep_na = SHT3X_SLEEP_NA,
+#endif
+    .objects = sht3x_objects,
+    .res = sht3x_res_opts,
+    .init = sht3x_drv_init,
+    .trigger = sht3x_drv_trigger,
+    .read = sht3x_drv_read,
+    .resolution = sht3x_drv_resolution,
+};
@@ -0,0 +1,257 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sensor_sht4x.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT4x 温湿度传感器驱动 (单次测量或预先触发)
+ *******************************************************************************/
+
+#include "sensor_sht4x.h"
+#include "sensor_sht3x.h"
+#include "HAL.h"
+
+// SHT4x命令 (8位)
+#define SHT4X_CMD_READ_SERIAL          0x89
+
+// 测量电流及空闲电流 (典型值)
+#define SHT4X_ACTIVE_UA                320
+#define SHT4X_SLEEP_NA                 80
+
+#define SHT4X_HEATER_NONE              0xFF
+
+// 各精度的测量命令, 顺序与 sht4x_prec_t 一致
+static const uint8_t sht4x_meas_cmd[] = { 0xFD, 0xF6, 0xE0 };
+
+// 加热脉冲命令及时长, 顺序与 sht4x_heater_t 一致; 脉冲结束后以高精度测量一次
+static const struct {
+    uint8_t cmd;
+    uint16_t ms;
+} sht4x_heater_tab[] = {
+    { 0x39, 1000 },
+    { 0x32, 100  },
+    { 0x2F, 1000 },
+    { 0x24, 100  },
+    { 0x1E, 1000 },
+    { 0x15, 100  },
+};
+
+// 分辨率选项: 最大转换时间, 重复性 (单位 0.0001°C / 0.0001%RH)
+static const sensor_res_t sht4x_res_opts[] = {
+    { 9, { 400,  800  } },
+    { 5, { 700,  1500 } },
+    { 2, { 1000, 2500 } },
+};
+
+static const uint8_t sht4x_objects[] = {
+    BTHOME_ID_TEMPERATURE,
+    BTHOME_ID_HUMIDITY,
+};
+
+static sht4x_prec_t sht4x_prec = SHT4X_PREC_HIGH;
+// 等待执行的加热脉冲
+static uint8_t sht4x_heater = SHT4X_HEATER_NONE;
+#if (SHT4X_MODE == SENSOR_MODE_PERIODIC)
+// 已触发的转换是否为加热脉冲及其时长
+static uint8_t sht4x_heated;
+static uint16_t sht4x_armed_ms;
+// 刚初始化, 转换尚未完成
+static uint8_t sht4x_fresh;
+#endif
+
+/**
+ * @brief 加热脉冲总时长 (含脉冲后的测量), 按时长误差预留 10%
+ */
+static uint16_t sht4x_heater_ms(uint8_t heater)
+{
+    return sht4x_heater_tab[heater].ms + sht4x_heater_tab[heater].ms / 10 + sht4x_res_opts[SHT4X_PREC_HIGH].conv_ms;
+}
+
+/**
+ * @brief 读取序列号
+ * @param serial 序列号指针
+ * @return 0表示成功，负值表示错误代码
+ */
+int sht4x_read_serial(uint32_t *serial)
+{
+    uint8_t cmd = SHT4X_CMD_READ_SERIAL;
+    uint8_t buf[6];
+    uint16_t hi, lo;
+
+    if (i2c_write_to(SHT4X_I2C_ADDR, &cmd, 1, true, true) != 0) {
+        return -1;
+    }
+    mDelaymS(1);
+    if (i2c_read_from(SHT4X_I2C_ADDR, buf, 6, true, 100) != 6) {
+        return -2;
+    }
+    // 与测量结果格式相同: 两个16位字各带 CRC
+    if (sht3x_unpack(buf, &hi, &lo) != 0) {
+        return -3;
+    }
+    *serial = ((uint32_t)hi << 16) | lo;
+    return 0;
+}
+
+/**
+ * @brief 请求在下一次测量时执行加热脉冲
+ * @param heater 加热功率及时长
+ */
+void sht4x_heater_request(sht4x_heater_t heater)
+{
+    sht4x_heater = heater;
+}
+
+#if (SHT4X_MODE == SENSOR_MODE_PERIODIC)
+/**
+ * @brief 触发下一次转换, 有等待的加热脉冲时以加热脉冲代替
+ * @return 0表示成功，负值表示错误代码
+ */
+static int sht4x_arm(void)
+{
+    uint8_t cmd = sht4x_meas_cmd[sht4x_prec];
+    uint16_t ms = sht4x_res_opts[sht4x_prec].conv_ms;
+    uint8_t heated = (sht4x_heater != SHT4X_HEATER_NONE);
+
+    if (heated) {
+        cmd = sht4x_heater_tab[sht4x_heater].cmd;
+        ms = sht4x_heater_ms(sht4x_heater);
+    }
+    if (i2c_write_to(SHT4X_I2C_ADDR, &cmd, 1, true, true) != 0) {
+        return -1;
+    }
+    sht4x_heated = heated;
+    sht4x_armed_ms = ms;
+    sht4x_heater = SHT4X_HEATER_NONE;
+    return 0;
+}
+#endif
+
+// =============================================================================
+// 传感器驱动接口
+// =============================================================================
+
+/**
+ * @brief 选择精度并读取序列号确认传感器在线, 预先触发模式下触发第一次转换
+ * @return 0表示成功，负值表示错误代码
+ */
+static int sht4x_drv_init(void)
+{
+    static const uint16_t target[2] = { SENSOR_TEMP_ACCURACY_TARGET, SENSOR_HUMI_ACCURACY_TARGET };
+    uint32_t serial;
+    int ret;
+
+    sht4x_prec = (sht4x_prec_t)sensor_select_res(&sht4x_sensor, target);
+
+    ret = sht4x_read_serial(&serial);
+    if (ret != 0) {
+        PRINT("SHT4x serial read failed: %d\n", ret);
+        return ret;
+    }
+
+#if (SHT4X_MODE == SENSOR_MODE_PERIODIC)
+    ret = sht4x_arm();
+    if (ret != 0) {
+        PRINT("SHT4x trigger failed: %d\n", ret);
+        return ret - 3;
+    }
+    sht4x_fresh = TRUE;
+#endif
+
+    PRINT("SHT4x serial %08X, precision %d, %s, conversion %d ms\n", (int)serial, sht4x_prec,
+          (SHT4X_MODE == SENSOR_MODE_PERIODIC) ? "pre-triggered" : "single shot",
+          sht4x_res_opts[sht4x_prec].conv_ms);
+    return 0;
+}
+
+/**
+ * @brief 单次测量: 触发后等待转换; 预先触发: 直接读出上次触发的结果
+ * @param jobs 调度任务
+ */
+static void sht4x_drv_trigger(i2c_sched_job_t *jobs)
+{
+    jobs[0].rx_len = 6;
+#if (SHT4X_MODE == SENSOR_MODE_PERIODIC)
+    if (sht4x_fresh) {
+        // 初始化时刚触发, 等待转换完成
+        jobs[0].conv_ms = sht4x_armed_ms;
+    } else {
+        jobs[0].flags = I2C_SCHED_FETCH;
+    }
+#else
+    jobs[0].cmd_len = 1;
+    if (sht4x_heater != SHT4X_HEATER_NONE) {
+        jobs[0].cmd[0] = sht4x_heater_tab[sht4x_heater].cmd;
+        jobs[0].conv_ms = sht4x_heater_ms(sht4x_heater);
+    } else {
+        jobs[0].cmd[0] = sht4x_meas_cmd[sht4x_prec];
+        jobs[0].conv_ms = sht4x_res_opts[sht4x_prec].conv_ms;
+    }
+#endif
+}
+
+/**
+ * @brief 校验并换算读出结果, 预先触发模式下触发下一次转换
+ * @param jobs 完成的调度任务
+ * @param values 结果 (温度单位0.01°C, 湿度单位0.01%RH)
+ * @return 0表示成功, 1表示本次为加热脉冲没有结果, 负值表示错误代码
+ */
+static int sht4x_drv_read(const i2c_sched_job_t *jobs, int32_t *values)
+{
+    uint16_t temp, humi;
+    int32_t rh;
+    uint8_t heated;
+
+#if (SHT4X_MODE == SENSOR_MODE_PERIODIC)
+    heated = sht4x_heated;
+    sht4x_fresh = FALSE;
+    if (sht4x_arm() != 0) {
+        PRINT("SHT4x trigger failed\n");
+        return -1;
+    }
+#else
+    heated = (jobs[0].cmd[0] != sht4x_meas_cmd[sht4x_prec]);
+    if (heated) {
+        sht4x_heater = SHT4X_HEATER_NONE;
+    }
+#endif
+
+    if (sht3x_unpack(jobs[0].rx, &temp, &humi) != 0) {
+        PRINT("SHT4x CRC failed\n");
+        return -3;
+    }
+    // 加热后的读数偏高, 丢弃
+    if (heated) {
+        return 1;
+    }
+
+    // T = -45 + 175 * raw / 65535, RH = -6 + 125 * raw / 65535 (限制在 0~100%)
+    rh = (int32_t)((uint32_t)humi * 12500 / 65535) - 600;
+    values[0] = (int32_t)((uint32_t)temp * 17500 / 65535) - 4500;
+    values[1] = rh < 0 ? 0 : (rh > 10000 ? 10000 : rh);
+    PRINT("SHT4x raw: 0x%04X 0x%04X, converted: %d %d\n", temp, humi, (int)values[0], (int)values[1]);
+    return 0;
+}
+
+/**
+ * @brief 当前精度在 sht4x_res_opts 中的序号
+ */
+static uint8_t sht4x_drv_resolution(void)
+{
+    return sht4x_prec;
+}
+
+const sensor_driver_t sht4x_sensor = {
+    .name = "SHT4x",
+    .addr = SHT4X_I2C_ADDR,
+    .num_jobs = 1,
+    .num_objects = sizeof(sht4x_objects),
+    .num_res = sizeof(sht4x_res_opts) / sizeof(sht4x_res_opts[0]),
+    .active_ua = SHT4X_ACTIVE_UA,
+    .sleep_na = SHT4X_SLEEP_NA,
+    .objects = sht4x_objects,
+    .res = sht4x_res_opts,
+    .init = sht4x_drv_init,
+    .trigger = sht4x_drv_trigger,
+    .read = sht4x_drv_read,
+    .resolution = sht4x_drv_resolution,
+};
@@ -0,0 +1,191 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ENERGY.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Per-state RTC tick accounting and average current estimate
+ *******************************************************************************/
+
+/******************************************************************************/
+#include "HAL.h"
+
+#if(defined(HAL_ENERGY)) && (HAL_ENERGY == TRUE)
+
+/* Radio on time per advertising event (3 channels) */
+#define ENERGY_RADIO_EVENT_TICKS       US_TO_RTC(HAL_ENERGY_RADIO_EVENT_US)
+
+static const uint32_t energyCurrentNA[ENERGY_STATE_MAX] = {
+    HAL_ENERGY_SLEEP_NA,
+    HAL_ENERGY_AWAKE_NA,
+    HAL_ENERGY_SENSOR_NA,
+    HAL_ENERGY_RADIO_NA,
+};
+
+static const char *const energyName[ENERGY_STATE_MAX] = {
+    "sleep",
+    "awake",
+    "sensor",
+    "radio",
+};
+
+static uint64_t energyTicks[ENERGY_STATE_MAX];
+static uint8_t  energyState;
+static uint32_t energyStamp;
+/* Advertising interval in RTC ticks and the ticks not yet counted as an event */
+static uint32_t energyAdvTicks;
+static uint32_t energyAdvRemain;
+static uint32_t energyRadioEvents;
+
+/*******************************************************************************
+ * @fn      HAL_EnergyInit
+ *
+ * @brief   Start accounting, the current state is ENERGY_STATE_AWAKE.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void HAL_EnergyInit(void)
+{
+    energyState = ENERGY_STATE_AWAKE;
+    energyStamp = RTC_GetCycle32k();
+}
+
+/*******************************************************************************
+ * @fn      HAL_EnergyEnter
+ *
+ * @brief   Charge the ticks since the last transition to the current state
+ *          and switch to a new one. Advertising events are counted from the
+ *          elapsed time, the BLE library has no per event hook.
+ *
+ * @param   state   - ENERGY_STATE_SLEEP / AWAKE / SENSOR.
+ *
+ * @return  previous state.
+ */
+uint8_t HAL_EnergyEnter(uint8_t state)
+{
+    uint32_t       now, elapsed;
+    uint8_t        prev;
+    unsigned long  irq_status;
+
+    SYS_DisableAllIrq(&irq_status);
+    now = RTC_GetCycle32k();
+    if(now < energyStamp)
+    {
+        elapsed = now + (RTC_MAX_COUNT - energyStamp);
+    }
+    else
+    {
+        elapsed = now - energyStamp;
+    }
+    energyStamp = now;
+    energyTicks[energyState] += elapsed;
+
+    if(energyAdvTicks)
+    {
+        energyAdvRemain += elapsed;
+        energyRadioEvents += energyAdvRemain / energyAdvTicks;
+        energyAdvRemain %= energyAdvTicks;
+    }
+
+    prev = energyState;
+    energyState = state;
+    SYS_RecoverIrq(irq_status);
+
+    return prev;
+}
+
+/*******************************************************************************
+ * @fn      HAL_EnergySetAdvInterval
+ *
+ * @brief   Set the advertising interval used to count radio events.
+ *
+ * @param   interval    - advertising interval (units of 625us), 0: not advertising.
+ *
+ * @return  None.
+ */
+void HAL_EnergySetAdvInterval(uint16_t interval)
+{
+    /* Charge the elapsed time at the old interval first */
+    HAL_EnergyEnter(energyState);
+    energyAdvTicks = (uint32_t)interval * FREQ_RTC / 1600;
+    energyAdvRemain = 0;
+}
+
+/*******************************************************************************
+ * @fn      HAL_EnergyGetReport
+ *
+ * @brief   Snapshot of the accounted ticks and the average current estimate.
+ *          Radio time is taken out of the awake time it overlaps.
+ *
+ * @param   report  - output.
+ *
+ * @return  None.
+ */
+void HAL_EnergyGetReport(energyReport_t *report)
+{
+    uint64_t charge = 0, total = 0;
+    uint8_t  i;
+
+    HAL_EnergyEnter(energyState);
+
+    for(i = 0; i < ENERGY_STATE_MAX; i++)
+    {
+        report->ticks[i] = energyTicks[i];
+    }
+    report->radioEvents = energyRadioEvents;
+    report->ticks[ENERGY_STATE_RADIO] = (uint64_t)energyRadioEvents * ENERGY_RADIO_EVENT_TICKS;
+    if(report->ticks[ENERGY_STATE_RADIO] > report->ticks[ENERGY_STATE_AWAKE])
+    {
+        report->ticks[ENERGY_STATE_RADIO] = report->ticks[ENERGY_STATE_AWAKE];
+    }
+    report->ticks[ENERGY_STATE_AWAKE] -= report->ticks[ENERGY_STATE_RADIO];
+
+    for(i = 0; i < ENERGY_STATE_MAX; i++)
+    {
+        charge += report->ticks[i] * energyCurrentNA[i];
+        total += report->ticks[i];
+    }
+    report->averageNA = total ? (uint32_t)(charge / total) : 0;
+}
+
+/*******************************************************************************
+ * @fn      HAL_EnergyAverage
+ *
+ * @brief   Average current estimate since init.
+ *
+ * @param   None.
+ *
+ * @return  current in nA.
+ */
+uint32_t HAL_EnergyAverage(void)
+{
+    energyReport_t report;
+
+    HAL_EnergyGetReport(&report);
+    return report.averageNA;
+}
+
+/*******************************************************************************
+ * @fn      HAL_EnergyDump
+ *
+ * @brief   Print the per-state time and average current over the debug UART.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void HAL_EnergyDump(void)
+{
+    energyReport_t report;
+    uint8_t        i;
+
+    HAL_EnergyGetReport(&report);
+    PRINT("energy: avg %d nA, %d adv events\n", (int)report.averageNA, (int)report.radioEvents);
+    for(i = 0; i < ENERGY_STATE_MAX; i++)
+    {
+        PRINT("  %-7s %d ms\n", energyName[i], (int)(report.ticks[i] * 1000 / FREQ_RTC));
+    }
+}
+
+#endif
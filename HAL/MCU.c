@@ -188,6 +188,26 @@ tmosEvents HAL_ProcessEvent(tmosTaskID task_id, tmosEvents events)
         return events ^ HAL_KEY_EVENT;
 #endif
     }
+    if(events & HAL_TRACE_EVENT)
+    {
+#if(defined HAL_TRACE) && (HAL_TRACE == TRUE)
+        HAL_TraceDump();
+  #if(HAL_TRACE_DUMP_PERIOD)
+        tmos_start_task(halTaskID, HAL_TRACE_EVENT, MS1_TO_SYSTEM_TIME(HAL_TRACE_DUMP_PERIOD));
+  #endif
+#endif
+        return events ^ HAL_TRACE_EVENT;
+    }
+    if(events & HAL_ENERGY_EVENT)
+    {
+#if(defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+        HAL_EnergyDump();
+  #if(HAL_ENERGY_REPORT_PERIOD)
+        tmos_start_task(halTaskID, HAL_ENERGY_EVENT, MS1_TO_SYSTEM_TIME(HAL_ENERGY_REPORT_PERIOD));
+  #endif
+#endif
+        return events ^ HAL_ENERGY_EVENT;
+    }
     if(events & HAL_REG_INIT_EVENT)
     {
 #if(defined BLE_CALIBRATION_ENABLE) && (BLE_CALIBRATION_ENABLE == TRUE) // У׼񣬵У׼ʱС10ms
@@ -221,6 +241,9 @@ void HAL_Init()
 {
     halTaskID = TMOS_ProcessEventRegister(HAL_ProcessEvent);
     HAL_TimeInit();
+#if(defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+    HAL_EnergyInit();
+#endif
 #if(defined HAL_SLEEP) && (HAL_SLEEP == TRUE)
     HAL_SleepInit();
 #endif
@@ -230,6 +253,12 @@ void HAL_Init()
 #if(defined HAL_KEY) && (HAL_KEY == TRUE)
     HAL_KeyInit();
 #endif
+#if(defined HAL_TRACE) && (HAL_TRACE == TRUE) && (HAL_TRACE_DUMP_PERIOD)
+    tmos_start_task(halTaskID, HAL_TRACE_EVENT, MS1_TO_SYSTEM_TIME(HAL_TRACE_DUMP_PERIOD));
+#endif
+#if(defined HAL_ENERGY) && (HAL_ENERGY == TRUE) && (HAL_ENERGY_REPORT_PERIOD)
+    tmos_start_task(halTaskID, HAL_ENERGY_EVENT, MS1_TO_SYSTEM_TIME(HAL_ENERGY_REPORT_PERIOD));
+#endif
 #if(defined BLE_CALIBRATION_ENABLE) && (BLE_CALIBRATION_ENABLE == TRUE)
     tmos_start_task(halTaskID, HAL_REG_INIT_EVENT, MS1_TO_SYSTEM_TIME(BLE_CALIBRATION_PERIOD)); // У׼񣬵У׼ʱС10ms
 #endif
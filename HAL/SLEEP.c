@@ -14,6 +14,8 @@
 /* ͷļ */
 #include "HAL.h"
 
+static volatile uint8_t halSleepHold = 0;
+
 /*******************************************************************************
  * @fn          CH59x_LowPower
  *
@@ -29,6 +31,8 @@ uint32_t CH59x_LowPower(uint32_t time)
     volatile uint32_t i;
     uint32_t time_sleep, time_curr;
     unsigned long irq_status;
+
+    TRACE_BEGIN(TRACE_ID_LOW_POWER);
     
     // ǰ
     if (time <= WAKE_UP_RTC_MAX_TIME) {
@@ -50,6 +54,7 @@ uint32_t CH59x_LowPower(uint32_t time)
     if ((time_sleep < SLEEP_RTC_MIN_TIME) || 
         (time_sleep > SLEEP_RTC_MAX_TIME)) {
         SYS_RecoverIrq(irq_status);
+        TRACE_END(TRACE_ID_LOW_POWER);
         return 2;
     }
 
@@ -61,19 +66,70 @@ uint32_t CH59x_LowPower(uint32_t time)
         __nop();
     }
   #endif
+    // Peripheral busy: wait in idle mode, the RTC trigger or its interrupt wakes the core
+    if(halSleepHold)
+    {
+        if(!RTCTigFlag)
+        {
+            LowPower_Idle();
+        }
+        TRACE_END(TRACE_ID_LOW_POWER);
+        return 1;
+    }
     // LOW POWER-sleepģʽ
     if(!RTCTigFlag)
     {
+        ENERGY_ENTER(ENERGY_STATE_SLEEP);
         LowPower_Sleep(RB_PWR_RAM2K | RB_PWR_RAM24K | RB_PWR_EXTEND | RB_XT_PRE_EN );
+        ENERGY_ENTER(ENERGY_STATE_AWAKE);
         HSECFG_Current(HSE_RCur_100); // Ϊ(͹ĺHSEƫõ)
         i = RTC_GetCycle32k();
         while(i == RTC_GetCycle32k());
+        TRACE_END(TRACE_ID_LOW_POWER);
         return 0;
     }
+    TRACE_END(TRACE_ID_LOW_POWER);
 #endif
     return 3;
 }
 
+/*******************************************************************************
+ * @fn      HAL_SleepHold
+ *
+ * @brief   Keep the core out of sleep mode while a peripheral that needs
+ *          HSE is busy.
+ *
+ * @param   mask    - HAL_SLEEP_HOLD_* reasons.
+ *
+ * @return  None.
+ */
+void HAL_SleepHold(uint8_t mask)
+{
+    unsigned long irq_status;
+
+    SYS_DisableAllIrq(&irq_status);
+    halSleepHold |= mask;
+    SYS_RecoverIrq(irq_status);
+}
+
+/*******************************************************************************
+ * @fn      HAL_SleepRelease
+ *
+ * @brief   Release a sleep hold set by HAL_SleepHold.
+ *
+ * @param   mask    - HAL_SLEEP_HOLD_* reasons.
+ *
+ * @return  None.
+ */
+void HAL_SleepRelease(uint8_t mask)
+{
+    unsigned long irq_status;
+
+    SYS_DisableAllIrq(&irq_status);
+    halSleepHold &= ~mask;
+    SYS_RecoverIrq(irq_status);
+}
+
 /*******************************************************************************
  * @fn      HAL_SleepInit
  *
@@ -0,0 +1,66 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : TRACE.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Cycle counter tracepoints recorded into a RAM ring buffer
+ *******************************************************************************/
+
+/******************************************************************************/
+#include "HAL.h"
+
+#if(defined(HAL_TRACE)) && (HAL_TRACE == TRUE)
+
+traceEntry_t HAL_TraceBuf[HAL_TRACE_BUF_SIZE];
+volatile uint32_t HAL_TraceHead;
+
+static const char *const traceName[TRACE_ID_MAX] = {
+    "advert_update",
+    "bat_sample",
+    "i2c_irq",
+    "low_power",
+    "sensor_filter",
+};
+
+/*******************************************************************************
+ * @fn      HAL_TraceDump
+ *
+ * @brief   Print the ring buffer over the debug UART, oldest entry first.
+ *          Each end entry is printed with the cycles since the matching
+ *          begin entry of the same id.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void HAL_TraceDump(void)
+{
+    uint32_t begin[TRACE_ID_MAX] = {0};
+    uint8_t  seen[TRACE_ID_MAX] = {0};
+    uint32_t head = HAL_TraceHead;
+    uint32_t i = (head > HAL_TRACE_BUF_SIZE) ? (head - HAL_TRACE_BUF_SIZE) : 0;
+
+    PRINT("trace: %d entries\n", (int)(head - i));
+    for(; i != head; i++)
+    {
+        traceEntry_t e = HAL_TraceBuf[i % HAL_TRACE_BUF_SIZE];
+        uint8_t      id = e.tag & 0xFF;
+
+        if(id >= TRACE_ID_MAX)
+        {
+            continue;
+        }
+        if(e.tag & TRACE_TAG_BEGIN)
+        {
+            begin[id] = e.cycles;
+            seen[id] = TRUE;
+        }
+        else if(seen[id])
+        {
+            seen[id] = FALSE;
+            PRINT("  %-14s %d\n", traceName[id], (int)(e.cycles - begin[id]));
+        }
+    }
+}
+
+#endif
@@ -66,6 +66,23 @@
  BLE_TX_NUM_EVENT                           - ¼Էٸݰ( Ĭ:1 )
  BLE_TX_POWER                               - 书( Ĭ:LL_TX_POWEER_0_DBM (0dBm) )
  
+ TRACE
+ HAL_TRACE                                  - Enable cycle counter tracepoints ( default: FALSE )
+ HAL_TRACE_BUF_SIZE                         - Trace ring buffer entries, power of 2 ( default: 64 )
+ HAL_TRACE_DUMP_PERIOD                      - Trace dump period over the debug UART in ms, 0: only on HAL_TRACE_EVENT ( default: 0 )
+
+ ENERGY
+ HAL_ENERGY                                 - Enable per-state energy accounting ( default: FALSE )
+ HAL_ENERGY_SLEEP_NA                        - Current while sleeping in nA ( default: 1500 )
+ HAL_ENERGY_AWAKE_NA                        - Current while awake at HSE in nA ( default: 2500000 )
+ HAL_ENERGY_SENSOR_NA                       - Current while awake during sensor I/O in nA ( default: 2800000 )
+ HAL_ENERGY_RADIO_NA                        - Current during an advertising event in nA ( default: 6000000 )
+ HAL_ENERGY_RADIO_EVENT_US                  - Radio on time of one advertising event in us ( default: 1500 )
+ HAL_ENERGY_REPORT_PERIOD                   - Energy report period over the debug UART in ms, 0: only on HAL_ENERGY_EVENT ( default: 0 )
+
+ I2C
+ SBP_I2C_EXPORT                             - Export the latest sample as I2C slave registers, with HAL_SLEEP the host START on SDA wakes the core ( default: FALSE )
+
  MULTICONN
  PERIPHERAL_MAX_CONNECTION                  - ͬʱٴӻɫ( Ĭ:1 )
  CENTRAL_MAX_CONNECTION                     - ͬʱɫ( Ĭ:3 )
@@ -138,6 +155,39 @@
 #ifndef BLE_TX_POWER
 #define BLE_TX_POWER                        LL_TX_POWEER_0_DBM
 #endif
+#ifndef HAL_TRACE
+#define HAL_TRACE                           FALSE
+#endif
+#ifndef HAL_TRACE_BUF_SIZE
+#define HAL_TRACE_BUF_SIZE                  64
+#endif
+#ifndef HAL_TRACE_DUMP_PERIOD
+#define HAL_TRACE_DUMP_PERIOD               0
+#endif
+#ifndef HAL_ENERGY
+#define HAL_ENERGY                          FALSE
+#endif
+#ifndef HAL_ENERGY_SLEEP_NA
+#define HAL_ENERGY_SLEEP_NA                 1500
+#endif
+#ifndef HAL_ENERGY_AWAKE_NA
+#define HAL_ENERGY_AWAKE_NA                 2500000
+#endif
+#ifndef HAL_ENERGY_SENSOR_NA
+#define HAL_ENERGY_SENSOR_NA                2800000
+#endif
+#ifndef HAL_ENERGY_RADIO_NA
+#define HAL_ENERGY_RADIO_NA                 6000000
+#endif
+#ifndef HAL_ENERGY_RADIO_EVENT_US
+#define HAL_ENERGY_RADIO_EVENT_US           1500
+#endif
+#ifndef HAL_ENERGY_REPORT_PERIOD
+#define HAL_ENERGY_REPORT_PERIOD            0
+#endif
+#ifndef SBP_I2C_EXPORT
+#define SBP_I2C_EXPORT                      FALSE
+#endif
 #ifndef PERIPHERAL_MAX_CONNECTION
 #define PERIPHERAL_MAX_CONNECTION           1
 #endif
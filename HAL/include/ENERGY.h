@@ -0,0 +1,102 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ENERGY.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Per-state RTC tick accounting and average current estimate
+ *******************************************************************************/
+
+/******************************************************************************/
+#ifndef __ENERGY_H
+#define __ENERGY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CONFIG.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Accounted states */
+#define ENERGY_STATE_SLEEP             0    // LowPower_Sleep, RTC running
+#define ENERGY_STATE_AWAKE             1    // awake at HSE, CPU running or idle
+#define ENERGY_STATE_SENSOR            2    // awake during sensor I/O
+#define ENERGY_STATE_RADIO             3    // advertising events, derived from the interval
+#define ENERGY_STATE_MAX               4
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+    uint64_t ticks[ENERGY_STATE_MAX];   // RTC ticks spent in each state
+    uint32_t radioEvents;               // advertising events since init
+    uint32_t averageNA;                 // average current estimate in nA
+} energyReport_t;
+
+/*********************************************************************
+ * MACROS
+ */
+
+#if(defined(HAL_ENERGY)) && (HAL_ENERGY == TRUE)
+#define ENERGY_ENTER(state)            HAL_EnergyEnter(state)
+#else
+#define ENERGY_ENTER(state)
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+#if(defined(HAL_ENERGY)) && (HAL_ENERGY == TRUE)
+/**
+ * @brief   Start accounting, the current state is ENERGY_STATE_AWAKE.
+ */
+extern void HAL_EnergyInit(void);
+
+/**
+ * @brief   Charge the ticks since the last transition to the current state
+ *          and switch to a new one.
+ *
+ * @param   state   - ENERGY_STATE_SLEEP / AWAKE / SENSOR.
+ *
+ * @return  previous state.
+ */
+extern uint8_t HAL_EnergyEnter(uint8_t state);
+
+/**
+ * @brief   Set the advertising interval used to count radio events.
+ *
+ * @param   interval    - advertising interval (units of 625us), 0: not advertising.
+ */
+extern void HAL_EnergySetAdvInterval(uint16_t interval);
+
+/**
+ * @brief   Snapshot of the accounted ticks and the average current estimate.
+ *
+ * @param   report  - output.
+ */
+extern void HAL_EnergyGetReport(energyReport_t *report);
+
+/**
+ * @brief   Average current estimate since init.
+ *
+ * @return  current in nA.
+ */
+extern uint32_t HAL_EnergyAverage(void);
+
+/**
+ * @brief   Print the per-state time and average current over the debug UART.
+ */
+extern void HAL_EnergyDump(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,10 +23,14 @@ extern "C" {
 #include "SLEEP.h"
 #include "LED.h"
 #include "KEY.h"
+#include "TRACE.h"
+#include "ENERGY.h"
 
 /* hal task Event */
 #define LED_BLINK_EVENT       0x0001
 #define HAL_KEY_EVENT         0x0002
+#define HAL_TRACE_EVENT       0x0004
+#define HAL_ENERGY_EVENT      0x0008
 #define HAL_REG_INIT_EVENT    0x2000
 #define HAL_TEST_EVENT        0x4000
 
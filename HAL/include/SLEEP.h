@@ -18,6 +18,14 @@
 extern "C" {
 #endif
 
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Sleep hold reasons, a held peripheral keeps the core in idle mode */
+#define HAL_SLEEP_HOLD_I2C          0x01
+#define HAL_SLEEP_HOLD_I2C_SLAVE    0x02
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -40,6 +48,22 @@ extern void HAL_SleepInit(void);
  */
 extern uint32_t CH59x_LowPower(uint32_t time);
 
+/**
+ * @brief   Keep the core out of sleep mode while a peripheral that needs
+ *          HSE is busy. The core waits in idle mode (WFI) instead and
+ *          still wakes on the RTC trigger.
+ *
+ * @param   mask    - HAL_SLEEP_HOLD_* reasons.
+ */
+extern void HAL_SleepHold(uint8_t mask);
+
+/**
+ * @brief   Release a sleep hold set by HAL_SleepHold, safe from interrupt context.
+ *
+ * @param   mask    - HAL_SLEEP_HOLD_* reasons.
+ */
+extern void HAL_SleepRelease(uint8_t mask);
+
 /*********************************************************************
 *********************************************************************/
 
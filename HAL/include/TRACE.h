@@ -0,0 +1,112 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : TRACE.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Cycle counter tracepoints recorded into a RAM ring buffer
+ *******************************************************************************/
+
+/******************************************************************************/
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CONFIG.h"
+#if !defined(__riscv)
+#include <time.h>
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Tracepoint ids */
+#define TRACE_ID_ADVERT_UPDATE         0
+#define TRACE_ID_BAT_SAMPLE            1
+#define TRACE_ID_I2C_IRQ               2
+#define TRACE_ID_LOW_POWER             3
+#define TRACE_ID_SENSOR_FILTER         4
+#define TRACE_ID_MAX                   5
+
+/* Entry tag: id in the low byte, begin flag above it */
+#define TRACE_TAG_BEGIN                0x100
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+    uint32_t cycles;
+    uint32_t tag;
+} traceEntry_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+#if(defined(HAL_TRACE)) && (HAL_TRACE == TRUE)
+extern traceEntry_t HAL_TraceBuf[HAL_TRACE_BUF_SIZE];
+extern volatile uint32_t HAL_TraceHead;
+#endif
+
+/*********************************************************************
+ * MACROS
+ */
+
+#if(defined(HAL_TRACE)) && (HAL_TRACE == TRUE)
+#define TRACE_BEGIN(id)                HAL_TraceRecord((id) | TRACE_TAG_BEGIN)
+#define TRACE_END(id)                  HAL_TraceRecord(id)
+#else
+#define TRACE_BEGIN(id)
+#define TRACE_END(id)
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+#if(defined(HAL_TRACE)) && (HAL_TRACE == TRUE)
+/**
+ * @brief   Current cycle count. On target this is the low word of the
+ *          SysTick counter, which runs at HCLK; on a host build it is
+ *          a monotonic clock in ns.
+ */
+__attribute__((always_inline)) static inline uint32_t HAL_TraceCycles(void)
+{
+#if defined(__riscv)
+    return *(volatile uint32_t *)&SysTick->CNT;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+#endif
+}
+
+/**
+ * @brief   Record one tracepoint, safe from interrupt context.
+ *
+ * @param   tag - tracepoint id, or'ed with TRACE_TAG_BEGIN for a begin entry.
+ */
+__attribute__((always_inline)) static inline void HAL_TraceRecord(uint32_t tag)
+{
+    uint32_t cycles = HAL_TraceCycles();
+    uint32_t idx = __atomic_fetch_add(&HAL_TraceHead, 1, __ATOMIC_RELAXED) % HAL_TRACE_BUF_SIZE;
+
+    HAL_TraceBuf[idx].cycles = cycles;
+    HAL_TraceBuf[idx].tag = tag;
+}
+
+/**
+ * @brief   Print the ring buffer over the debug UART as begin/end pairs.
+ */
+extern void HAL_TraceDump(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,230 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : bench_i2c_isr.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Worst case instructions and simulated cycles per
+ *                      I2C_IRQHandler path, for comparing driver revisions:
+ *                      built against each revision's app_i2c.c and app_i2c.h,
+ *                      runs the transfers every revision supports
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "app_i2c.h"
+#include "sim.h"
+#include "sim_i2c.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_OWN_ADDR          0x33
+#define BENCH_DEV_ADDR          0x50
+#define BENCH_NONE_ADDR         0x51
+
+#define BENCH_DEV_SIZE          8
+
+/* Bus settles after a call: STOP and the bus free time */
+#define BENCH_SETTLE            SIM_US(50)
+
+static const char *const bench_path_name[I2C_PATH_MAX] = {
+    "none", "m start", "m tx data", "m tx stop", "m tx restart", "m tx nack",
+    "m rx addr", "m rx data", "m rx stop", "m rx restart", "m rx nack",
+    "s tx addr", "s tx data", "s tx nack", "s rx addr", "s rx data", "s rx stop",
+    "error",
+};
+
+/*********************************************************************
+ * REGISTER MAP DEVICE
+ */
+
+static uint8_t bench_dev_mem[BENCH_DEV_SIZE];
+static uint8_t bench_dev_ptr;
+static uint8_t bench_dev_ptr_set;
+
+static uint8_t bench_dev_start(sim_i2c_dev_t *dev, uint8_t read)
+{
+    (void)dev;
+    if (!read) {
+        bench_dev_ptr_set = 0;
+    }
+    return 1;
+}
+
+static uint8_t bench_dev_write(sim_i2c_dev_t *dev, uint8_t data)
+{
+    (void)dev;
+    if (!bench_dev_ptr_set) {
+        bench_dev_ptr = data;
+        bench_dev_ptr_set = 1;
+        return 1;
+    }
+    if (bench_dev_ptr >= BENCH_DEV_SIZE) {
+        return 0;
+    }
+    bench_dev_mem[bench_dev_ptr++] = data;
+    return 1;
+}
+
+static uint8_t bench_dev_read(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    return bench_dev_ptr < BENCH_DEV_SIZE ? bench_dev_mem[bench_dev_ptr++] : 0xFF;
+}
+
+static void bench_dev_stop(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+}
+
+static sim_i2c_dev_t bench_dev = {
+    .addr = BENCH_DEV_ADDR,
+    .start = bench_dev_start,
+    .write = bench_dev_write,
+    .read = bench_dev_read,
+    .stop = bench_dev_stop,
+};
+
+/*********************************************************************
+ * SLAVE CALLBACKS
+ */
+
+static void bench_on_receive(uint8_t *data, uint8_t len)
+{
+    (void)data, (void)len;
+}
+
+static void bench_on_transmit(uint8_t *data, uint8_t *len)
+{
+    data[0] = 0xC0;
+    data[1] = 0xC1;
+    *len = 2;
+}
+
+static struct i2c_slave_cb bench_slave_cb = {
+    .on_transmit = bench_on_transmit,
+    .on_receive = bench_on_receive,
+};
+
+/*********************************************************************
+ * INSTRUCTIONS PER INTERRUPT
+ */
+
+static i2c_isr_profile_t bench_profile;
+static uint32_t bench_insns_max[I2C_PATH_MAX];
+
+/* Charge the count to the path whose hits went up */
+static void bench_icount_done(uint8_t irq, uint32_t count)
+{
+    i2c_isr_profile_t now;
+
+    (void)irq;
+    i2c_isr_profile_get(&now);
+    for (uint8_t i = 0; i < I2C_PATH_MAX; i++) {
+        if (now.hits[i] != bench_profile.hits[i] && count > bench_insns_max[i]) {
+            bench_insns_max[i] = count;
+        }
+    }
+    bench_profile = now;
+}
+
+/*********************************************************************
+ * SCENARIOS
+ */
+
+/* Let the bus settle and program the peripheral again: older revisions
+ * leave ACK off after a read and the slave state after a host write */
+static void bench_reset(void)
+{
+    sim_advance(BENCH_SETTLE);
+    i2c_app_init((BENCH_OWN_ADDR + 1) << 1);
+    i2c_app_init(BENCH_OWN_ADDR << 1);
+}
+
+static void bench_run(void)
+{
+    uint8_t wr[] = { 0x02, 0xAA, 0xBB, 0xCC, 0xDD }, w2[] = { 0x04, 0x20, 0x21 };
+    uint8_t reg = 0x02, rd[4], one;
+    struct i2c_msg ww[] = {
+        { BENCH_DEV_ADDR, 0, 3, wr },
+        { BENCH_DEV_ADDR, 0, sizeof(w2), w2 },
+    };
+    struct i2c_msg wrd[] = {
+        { BENCH_DEV_ADDR, 0, 1, &reg },
+        { BENCH_DEV_ADDR, I2C_M_RD, sizeof(rd), rd },
+    };
+    struct i2c_msg rw[] = {
+        { BENCH_DEV_ADDR, I2C_M_RD, 1, &one },
+        { BENCH_DEV_ADDR, 0, sizeof(w2), w2 },
+    };
+    static const uint16_t errors[] = { RB_I2C_ARLO, RB_I2C_BERR, RB_I2C_OVR };
+
+    /* slave first, while ACK is on */
+    i2c_slave_cb_register(&bench_slave_cb);
+    bench_reset();
+    sim_i2c_host_read(BENCH_OWN_ADDR, rd, 3);
+    bench_reset();
+    sim_i2c_host_write(BENCH_OWN_ADDR, wr, 3, 1);
+    i2c_slave_cb_register(NULL);
+
+    bench_reset();
+    i2c_write_to(BENCH_DEV_ADDR, wr, 3, 1, 1);
+    bench_reset();
+    i2c_write_to(BENCH_DEV_ADDR, &reg, 1, 1, 0);
+    i2c_read_from(BENCH_DEV_ADDR, rd, sizeof(rd), 1, 10);
+    bench_reset();
+    i2c_transfer(ww, 2);
+    bench_reset();
+    i2c_transfer(wrd, 2);
+    bench_reset();
+    i2c_transfer(rw, 2);
+
+    /* address NACK on write and read, data NACK at the end of the map */
+    bench_reset();
+    i2c_write_to(BENCH_NONE_ADDR, wr, 1, 1, 1);
+    bench_reset();
+    i2c_read_from(BENCH_NONE_ADDR, rd, 2, 1, 10);
+    bench_reset();
+    wr[0] = 0x06;
+    i2c_write_to(BENCH_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    wr[0] = 0x02;
+
+    for (uint8_t i = 0; i < sizeof(errors) / sizeof(errors[0]); i++) {
+        bench_reset();
+        sim_i2c_inject(errors[i]);
+        i2c_write_to(BENCH_DEV_ADDR, wr, 3, 1, 1);
+        sim_advance(SIM_US(100));
+    }
+    bench_reset();
+}
+
+/*********************************************************************
+ * BENCH
+ */
+
+int main(void)
+{
+    i2c_isr_profile_t profile;
+
+    SetSysClock(CLK_SOURCE_PLL_60MHz);
+    sim_i2c_attach(&bench_dev);
+    i2c_app_init(BENCH_OWN_ADDR << 1);
+
+    i2c_isr_profile_reset();
+    sim_icount_irq(I2C_IRQn, bench_icount_done);
+    bench_run();
+    sim_icount_irq(I2C_IRQn, NULL);
+
+    i2c_isr_profile_get(&profile);
+    printf("%-13s %6s %10s %10s\n", "path", "hits", "max insns", "max cycles");
+    for (uint8_t i = 0; i < I2C_PATH_MAX; i++) {
+        if (profile.hits[i]) {
+            printf("%-13s %6u %10u %10u\n", bench_path_name[i], profile.hits[i],
+                   bench_insns_max[i], profile.cycles_max[i]);
+        }
+    }
+    return 0;
+}
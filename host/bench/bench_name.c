@@ -0,0 +1,163 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : bench_name.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Cost of formatting the advert name: the fixed-point
+ *                      update_advert_device_name() of the firmware against
+ *                      the snprintf("%.0f") path it replaced, on the same
+ *                      readings. Host instructions and time per call; the
+ *                      linked size of the CH592 printf needs its toolchain
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "HAL.h"
+#include "bthome.h"
+#include "sensor.h"
+#include "sim.h"
+#include "sim_ble.h"
+#include "sim_sensors.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_CALLS             100000
+#define BENCH_NAME_MAX          29
+
+/* The filter needs a few samples to settle on a new reading */
+#define BENCH_SETTLE            SIM_S(900)
+
+typedef struct {
+    int32_t temp;                   // 0.01 C
+    int32_t humi;                   // 0.01 %RH
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    { 2345, 4560 },
+    { -567, 10000 },                // uint16_t parameters printed 650C
+};
+
+/*********************************************************************
+ * FORMATTERS
+ */
+
+int app_main(void);
+void update_advert_device_name(uint8_t battery_percent);
+
+typedef struct {
+    uint8_t battery;
+    int32_t temp;
+    int32_t humi;
+    uint8_t name_len;               // length of the name field of the advert
+    uint8_t name[BENCH_NAME_MAX];
+} bench_arg_t;
+
+/* The formatter before the fixed-point one, writing to a field of the same
+ * length outside the advert */
+static void bench_snprintf(void *arg)
+{
+    bench_arg_t *a = arg;
+    uint16_t temperature = a->temp, humidity = a->humi;
+    char name_buffer[22];
+
+    snprintf(name_buffer, sizeof(name_buffer), "%d%%/%.0fC/%.0f%%",
+             a->battery, temperature / 100.0, humidity / 100.0);
+
+    int name_len = strlen(name_buffer);
+    if (name_len > a->name_len) name_len = a->name_len;
+
+    memcpy(a->name, name_buffer, name_len);
+    for (int i = name_len; i < a->name_len; i++) {
+        a->name[i] = ' ';
+    }
+}
+
+static void bench_fixed(void *arg)
+{
+    bench_arg_t *a = arg;
+
+    update_advert_device_name(a->battery);
+}
+
+static void bench_empty(void *arg)
+{
+    (void)arg;
+}
+
+/*********************************************************************
+ * MEASUREMENT
+ */
+
+static double bench_ns_per_call(void (*fn)(void *arg), void *arg)
+{
+    struct timespec t0, t1;
+
+    fn(arg);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        fn(arg);
+        __asm__ volatile("" : : : "memory");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / BENCH_CALLS;
+}
+
+/* Name field of the advert as the firmware last broadcast it, 0 if none */
+static uint8_t bench_adv_name(uint8_t *name)
+{
+    uint16_t len, i = 0;
+    const uint8_t *d = sim_gap_adv_data(&len);
+
+    while (i + 1 < len && d[i]) {
+        if (d[i + 1] == GAP_ADTYPE_LOCAL_NAME_COMPLETE && d[i] - 1 <= BENCH_NAME_MAX) {
+            memcpy(name, &d[i + 2], d[i] - 1);
+            return d[i] - 1;
+        }
+        i += d[i] + 1;
+    }
+    return 0;
+}
+
+/*********************************************************************
+ * BENCH
+ */
+
+int main(void)
+{
+    bench_arg_t arg = { .battery = 25 };
+    uint32_t empty = sim_icount_call(bench_empty, NULL);
+    uint8_t name[BENCH_NAME_MAX];
+
+    sim_i2c_attach(sim_sht20());
+    sim_adc_set_battery_mv(3300);
+    sim_adc_set_chip_temp(2500);
+    sim_main_start(app_main);
+
+    printf("%-8s %-8s %-9s %10s %8s  %s\n", "T", "RH", "path", "insns", "ns", "name");
+    for (uint8_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        sim_sht20_set(bench_cases[c].temp, bench_cases[c].humi);
+        sim_main_run(BENCH_SETTLE);
+        sensor_get(BTHOME_ID_TEMPERATURE, &arg.temp);
+        sensor_get(BTHOME_ID_HUMIDITY, &arg.humi);
+        arg.name_len = bench_adv_name(name);
+        if (!arg.name_len) {
+            printf("no name in the advert (encrypted layout?)\n");
+            return 1;
+        }
+
+        printf("%-8.2f %-8.2f %-9s %10u %8.1f  \"%.*s\"\n", arg.temp / 100.0, arg.humi / 100.0,
+               "fixed", sim_icount_call(bench_fixed, &arg) - empty,
+               bench_ns_per_call(bench_fixed, &arg), arg.name_len, name);
+
+        bench_snprintf(&arg);
+        printf("%-8s %-8s %-9s %10u %8.1f  \"%.*s\"\n", "", "", "snprintf",
+               sim_icount_call(bench_snprintf, &arg) - empty,
+               bench_ns_per_call(bench_snprintf, &arg), arg.name_len, arg.name);
+    }
+    return 0;
+}
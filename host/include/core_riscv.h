@@ -0,0 +1,295 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : core_riscv.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Host replacement of RVMSIS/core_riscv.h: same types and
+ *                      functions, PFIC, SysTick and the CSR accesses go to the
+ *                      simulation instead of RISC-V instructions
+ *******************************************************************************/
+
+#ifndef __CORE_RV3A_H__
+#define __CORE_RV3A_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* IO definitions */
+#ifdef __cplusplus
+  #define __I    volatile
+#else
+  #define __I    volatile const
+#endif
+#define __O                 volatile
+#define __IO                volatile
+
+#define RV_STATIC_INLINE    static inline
+
+typedef enum
+{
+    DISABLE = 0,
+    ENABLE = !DISABLE
+} FunctionalState;
+
+typedef enum
+{
+    RESET = 0,
+    SET = !RESET
+} FlagStatus, ITStatus;
+
+/* memory mapped structure for Program Fast Interrupt Controller (PFIC) */
+typedef struct
+{
+    __I uint32_t  ISR[8];           // 0
+    __I uint32_t  IPR[8];           // 20H
+    __IO uint32_t ITHRESDR;         // 40H
+    uint8_t       RESERVED[4];      // 44H
+    __O uint32_t  CFGR;             // 48H
+    __I uint32_t  GISR;             // 4CH
+    __IO uint8_t  VTFIDR[4];        // 50H
+    uint8_t       RESERVED0[0x0C];  // 54H
+    __IO uint32_t VTFADDR[4];       // 60H
+    uint8_t       RESERVED1[0x90];  // 70H
+    __O uint32_t  IENR[8];          // 100H
+    uint8_t       RESERVED2[0x60];  // 120H
+    __O uint32_t  IRER[8];          // 180H
+    uint8_t       RESERVED3[0x60];  // 1A0H
+    __O uint32_t  IPSR[8];          // 200H
+    uint8_t       RESERVED4[0x60];  // 220H
+    __O uint32_t  IPRR[8];          // 280H
+    uint8_t       RESERVED5[0x60];  // 2A0H
+    __IO uint32_t IACTR[8];         // 300H
+    uint8_t       RESERVED6[0xE0];  // 320H
+    __IO uint8_t  IPRIOR[256];      // 400H
+    uint8_t       RESERVED7[0x810]; // 500H
+    __IO uint32_t SCTLR;            // D10H
+} PFIC_Type;
+
+/* memory mapped structure for SysTick */
+typedef struct
+{
+    __IO uint32_t CTLR;
+    __IO uint32_t SR;
+    __IO uint64_t CNT;
+    __IO uint64_t CMP;
+} SysTick_Type;
+
+/* Simulated PFIC registers (only SCTLR and IPRIOR are kept), SysTick with
+ * CNT updated to the current simulated time on every use */
+extern PFIC_Type sim_pfic;
+SysTick_Type *sim_systick(void);
+
+#define PFIC                    (&sim_pfic)
+#define SysTick                 (sim_systick())
+
+#define PFIC_KEY1               ((uint32_t)0xFA050000)
+#define PFIC_KEY2               ((uint32_t)0xBCAF0000)
+#define PFIC_KEY3               ((uint32_t)0xBEEF0000)
+
+/* Interrupt controller and core of the simulation, see sim.h */
+void sim_irq_enable(uint8_t irq);
+void sim_irq_disable(uint8_t irq);
+uint32_t sim_irq_enabled(uint8_t irq);
+uint32_t sim_irq_pending(uint8_t irq);
+void sim_irq_set_pending(uint8_t irq);
+void sim_irq_clear_pending(uint8_t irq);
+uint32_t sim_irq_active(uint8_t irq);
+uint32_t sim_irq_global(uint32_t set, uint32_t clear);
+void sim_wfi(void);
+void sim_reset(void) __attribute__((noreturn));
+
+/* ##########################   define  #################################### */
+#define __nop()                 do {} while (0)
+
+#define PFIC_EnableAllIRQ()     {sim_irq_global(0x88, 0);}
+#define PFIC_DisableAllIRQ()    {sim_irq_global(0, 0x88);}
+
+/* ##########################   PFIC functions  #################################### */
+
+RV_STATIC_INLINE uint32_t __risc_v_enable_irq(uint32_t mpie_mie)
+{
+    return sim_irq_global(mpie_mie, 0);
+}
+
+RV_STATIC_INLINE uint32_t __risc_v_disable_irq(void)
+{
+    return sim_irq_global(0, 0x88) & 0x88;
+}
+
+RV_STATIC_INLINE void PFIC_EnableIRQ(IRQn_Type IRQn)
+{
+    sim_irq_enable(IRQn);
+}
+
+RV_STATIC_INLINE void PFIC_DisableIRQ(IRQn_Type IRQn)
+{
+    sim_irq_disable(IRQn);
+}
+
+RV_STATIC_INLINE uint32_t PFIC_GetStatusIRQ(IRQn_Type IRQn)
+{
+    return sim_irq_enabled(IRQn);
+}
+
+RV_STATIC_INLINE uint32_t PFIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+    return sim_irq_pending(IRQn);
+}
+
+RV_STATIC_INLINE void PFIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    sim_irq_set_pending(IRQn);
+}
+
+RV_STATIC_INLINE void PFIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    sim_irq_clear_pending(IRQn);
+}
+
+RV_STATIC_INLINE uint32_t PFIC_GetActive(IRQn_Type IRQn)
+{
+    return sim_irq_active(IRQn);
+}
+
+RV_STATIC_INLINE void PFIC_SetPriority(IRQn_Type IRQn, uint8_t priority)
+{
+    PFIC->IPRIOR[(uint32_t)(IRQn)] = priority;
+}
+
+RV_STATIC_INLINE void SetVTFIRQ(uint32_t addr, IRQn_Type IRQn, uint8_t num, FunctionalState NewState)
+{
+    (void)addr;
+    (void)IRQn;
+    (void)num;
+    (void)NewState;
+}
+
+RV_STATIC_INLINE void _SEV(void)
+{
+    PFIC->SCTLR |= (1<<3)|(1<<5);
+}
+
+RV_STATIC_INLINE void _WFE(void)
+{
+    PFIC->SCTLR |= (1<<3);
+    sim_wfi();
+}
+
+RV_STATIC_INLINE void __WFE(void)
+{
+    _SEV();
+    _WFE();
+    _WFE();
+}
+
+RV_STATIC_INLINE void __WFI(void)
+{
+    PFIC->SCTLR &= ~(1 << 3); // wfi
+    sim_wfi();
+}
+
+RV_STATIC_INLINE void PFIC_SystemReset(void)
+{
+    sim_reset();
+}
+
+/* Atomic memory operations: plain C, the simulation runs one context at a time */
+RV_STATIC_INLINE int32_t __AMOADD_W(volatile int32_t *addr, int32_t value)
+{
+    *addr += value;
+    return *addr;
+}
+
+RV_STATIC_INLINE int32_t __AMOAND_W(volatile int32_t *addr, int32_t value)
+{
+    *addr &= value;
+    return *addr;
+}
+
+RV_STATIC_INLINE int32_t __AMOMAX_W(volatile int32_t *addr, int32_t value)
+{
+    if (value > *addr) {
+        *addr = value;
+    }
+    return *addr;
+}
+
+RV_STATIC_INLINE uint32_t __AMOMAXU_W(volatile uint32_t *addr, uint32_t value)
+{
+    if (value > *addr) {
+        *addr = value;
+    }
+    return *addr;
+}
+
+RV_STATIC_INLINE int32_t __AMOMIN_W(volatile int32_t *addr, int32_t value)
+{
+    if (value < *addr) {
+        *addr = value;
+    }
+    return *addr;
+}
+
+RV_STATIC_INLINE uint32_t __AMOMINU_W(volatile uint32_t *addr, uint32_t value)
+{
+    if (value < *addr) {
+        *addr = value;
+    }
+    return *addr;
+}
+
+RV_STATIC_INLINE int32_t __AMOOR_W(volatile int32_t *addr, int32_t value)
+{
+    *addr |= value;
+    return *addr;
+}
+
+RV_STATIC_INLINE uint32_t __AMOSWAP_W(volatile uint32_t *addr, uint32_t newval)
+{
+    uint32_t result = *addr;
+
+    *addr = newval;
+    return result;
+}
+
+RV_STATIC_INLINE int32_t __AMOXOR_W(volatile int32_t *addr, int32_t value)
+{
+    *addr ^= value;
+    return *addr;
+}
+
+/* SysTick */
+#define SysTick_LOAD_RELOAD_Msk    (0xFFFFFFFFFFFFFFFF)
+#define SysTick_CTLR_SWIE          (1 << 31)
+#define SysTick_CTLR_INIT          (1 << 5)
+#define SysTick_CTLR_MODE          (1 << 4)
+#define SysTick_CTLR_STRE          (1 << 3)
+#define SysTick_CTLR_STCLK         (1 << 2)
+#define SysTick_CTLR_STIE          (1 << 1)
+#define SysTick_CTLR_STE           (1 << 0)
+
+#define SysTick_SR_CNTIF           (1 << 0)
+
+RV_STATIC_INLINE uint32_t SysTick_Config(uint64_t ticks)
+{
+    if((ticks - 1) > SysTick_LOAD_RELOAD_Msk)
+        return (1); /* Reload value impossible */
+
+    SysTick->CMP = ticks - 1; /* set reload register */
+    PFIC_EnableIRQ(SysTick_IRQn);
+    SysTick->CTLR = SysTick_CTLR_INIT |
+                    SysTick_CTLR_STRE |
+                    SysTick_CTLR_STCLK |
+                    SysTick_CTLR_STIE |
+                    SysTick_CTLR_STE; /* Enable SysTick IRQ and SysTick Timer */
+    return (0);                       /* Function successful */
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CORE_RV3A_H__ */
@@ -0,0 +1,268 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Host simulation of the CH592: time, interrupts and
+ *                      peripheral models
+ *******************************************************************************/
+
+#ifndef SIM_H
+#define SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Simulated cost of one peripheral register access or SPL call (ns),
+ * about one polling loop iteration at 60MHz */
+#define SIM_IO_NS               100
+
+/* Last interrupt number + 1 */
+#define SIM_IRQ_MAX             36
+
+/* Dispatches of one interrupt within 1ms of simulated time that abort
+ * the run as an interrupt storm (a handler that does not clear its source) */
+#define SIM_IRQ_STORM           2000
+
+/* Wake up from LowPower_Sleep(): HSE start and flash power up (ns) */
+#define SIM_WAKE_NS             1400000
+
+/* Wall clock time limit of a run (s), catches firmware stuck in a loop
+ * that never touches a register */
+#define SIM_WALL_LIMIT          120
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/**
+ * @brief   Peripheral model, stepped as simulated time advances.
+ */
+typedef struct sim_model {
+    const char *name;
+    /* Fold register accesses made since the last call into the model */
+    void (*sync)(void);
+    /* Time of the next internal event (ns), UINT64_MAX if none */
+    uint64_t (*next)(void);
+    /* Process the events due at the current time */
+    void (*step)(void);
+    struct sim_model *link;
+} sim_model_t;
+
+/**
+ * @brief   Interrupt line of a peripheral model: returns non zero while
+ *          the peripheral requests the interrupt (level triggered).
+ */
+typedef uint8_t (*sim_irq_level_t)(void);
+
+/**
+ * @brief   Called after the handler of an edge triggered interrupt returns,
+ *          clears the flag the handler acknowledged (write 1 to clear flags
+ *          cannot be told from reads in the register memory).
+ */
+typedef void (*sim_irq_eoi_t)(void);
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/**
+ * @brief   Current simulated time (ns since reset).
+ */
+uint64_t sim_time(void);
+
+/**
+ * @brief   Let simulated time pass: models are stepped through every
+ *          event in between and enabled interrupts are dispatched.
+ *
+ * @param ns    Time to advance (ns).
+ */
+void sim_advance(uint64_t ns);
+
+/**
+ * @brief   Advance to an absolute time, see sim_advance().
+ *
+ * @param t     Target time (ns), ignored if in the past.
+ */
+void sim_advance_to(uint64_t t);
+
+/**
+ * @brief   One register access of the CPU: fold in earlier accesses and
+ *          let SIM_IO_NS pass.
+ */
+void sim_io(void);
+
+/**
+ * @brief   Fold register accesses made since the last model step into all
+ *          models, without letting time pass.
+ */
+void sim_sync(void);
+
+/**
+ * @brief   System clock (Hz) as configured by SetSysClock().
+ */
+uint32_t sim_sysclk(void);
+
+/**
+ * @brief   Wait for an interrupt (WFI): advance to the next model event
+ *          until an interrupt is dispatched or limit is reached.
+ *
+ * @param limit Absolute time (ns) to give up at, UINT64_MAX for none.
+ *
+ * @return  1 if an interrupt was dispatched, 0 at the limit.
+ */
+uint8_t sim_wait_irq(uint64_t limit);
+
+/**
+ * @brief   Add a peripheral model. Models are stepped in registration order.
+ */
+void sim_model_register(sim_model_t *model);
+
+/**
+ * @brief   Connect a model to an interrupt line.
+ *
+ * @param irq   Interrupt number (IRQn_Type).
+ * @param level Level of a level triggered line, NULL if edge triggered.
+ * @param eoi   Called after each handler, may be NULL.
+ */
+void sim_irq_connect(uint8_t irq, sim_irq_level_t level, sim_irq_eoi_t eoi);
+
+/**
+ * @brief   Latch an edge triggered interrupt (dispatched once when enabled).
+ */
+void sim_irq_raise(uint8_t irq);
+
+/**
+ * @brief   Dispatch pending interrupts that are enabled, if not masked and
+ *          not already in an interrupt handler.
+ */
+void sim_irq_check(void);
+
+/**
+ * @brief   Whether an interrupt handler is running.
+ */
+uint8_t sim_in_irq(void);
+
+/**
+ * @brief   Called around every interrupt handler, e.g. to count its
+ *          instructions. NULL to remove.
+ */
+void sim_irq_hook(void (*enter)(uint8_t irq), void (*leave)(uint8_t irq));
+
+/**
+ * @brief   Whether a host code address is firmware code: __HIGH_CODE
+ *          functions or the .text of the firmware objects.
+ */
+uint8_t sim_fw_code(uintptr_t pc);
+
+/**
+ * @brief   Host instruction address a signal interrupted, from the context
+ *          argument of an SA_SIGINFO handler.
+ */
+uintptr_t sim_signal_pc(const void *ctx);
+
+/**
+ * @brief   Count the host instructions executed in firmware code by every
+ *          handler of one interrupt, a proxy for its cycles on the CH592.
+ *          Uses the interrupt hook (sim_irq_hook) and SIGTRAP.
+ *
+ * @param irq   Interrupt number.
+ * @param done  Called after each handler with its count, NULL to stop.
+ */
+void sim_icount_irq(uint8_t irq, void (*done)(uint8_t irq, uint32_t count));
+
+/**
+ * @brief   Count the host instructions of one call, C library and
+ *          simulation code included, plus a few of the call itself.
+ *
+ * @param fn    Function to run.
+ * @param arg   Its argument.
+ * @return      Instructions executed.
+ */
+uint32_t sim_icount_call(void (*fn)(void *arg), void *arg);
+
+/**
+ * @brief   Stop and restart counting around simulation code run from a
+ *          handler (time advancing on register accesses), nestable.
+ */
+void sim_icount_pause(void);
+void sim_icount_resume(void);
+
+/**
+ * @brief   Number of dispatches of an interrupt since reset.
+ */
+uint32_t sim_irq_count(uint8_t irq);
+
+/**
+ * @brief   Whether the core is in LowPower_Sleep(): peripherals without
+ *          their clock do not respond.
+ */
+uint8_t sim_sleeping(void);
+
+/**
+ * @brief   RTC count (32kHz ticks) at the current simulated time.
+ */
+uint32_t sim_rtc_count(void);
+
+/**
+ * @brief   Time (ns) spent in LowPower_Sleep() and LowPower_Idle() since reset.
+ */
+uint64_t sim_sleep_time(void);
+uint64_t sim_idle_time(void);
+
+/**
+ * @brief   Abort the run with a message, for model and harness errors.
+ */
+void sim_fatal(const char *fmt, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+/**
+ * @brief   Run an entry point (the firmware main()) as a coroutine:
+ *          sim_main_run() resumes it until simulated time reaches the limit,
+ *          TMOS_SystemProcess() hands control back.
+ *
+ * @param entry Entry point, never returns.
+ */
+void sim_main_start(int (*entry)(void));
+
+/**
+ * @brief   Resume the firmware started by sim_main_start().
+ *
+ * @param ns    Simulated time to run for (ns).
+ */
+void sim_main_run(uint64_t ns);
+
+/**
+ * @brief   Called by TMOS_SystemProcess(): return to sim_main_run() once
+ *          its time is up.
+ */
+void sim_main_yield(void);
+
+/**
+ * @brief   End of the current sim_main_run() (ns), UINT64_MAX outside of it.
+ */
+uint64_t sim_run_limit_get(void);
+
+/**
+ * @brief   Run TMOS_SystemProcess() until simulated time reaches the limit,
+ *          for tests that drive the tasks without main().
+ *
+ * @param ns    Simulated time to run for (ns).
+ */
+void sim_tmos_run(uint64_t ns);
+
+#define SIM_US(x)               ((uint64_t)(x) * 1000)
+#define SIM_MS(x)               ((uint64_t)(x) * 1000000)
+#define SIM_S(x)                ((uint64_t)(x) * 1000000000)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_H */
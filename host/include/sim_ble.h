@@ -0,0 +1,66 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_ble.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Fake TMOS scheduler and GAP broadcaster role of the
+ *                      host simulation, state the tests look at
+ *******************************************************************************/
+
+#ifndef SIM_BLE_H
+#define SIM_BLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Awake time of one advertising event on three channels (ns) */
+#define SIM_ADV_EVENT_NS        1500000
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/**
+ * @brief   TMOS messages allocated and not yet freed.
+ */
+uint32_t sim_tmos_msgs(void);
+
+/**
+ * @brief   Broadcaster role state (gapRole_States_t).
+ */
+uint32_t sim_gap_state(void);
+
+/**
+ * @brief   Advertising interval in use (0.625ms), 0 while not advertising.
+ */
+uint16_t sim_gap_adv_interval(void);
+
+/**
+ * @brief   Advertising data on air.
+ *
+ * @param len   Pointer to output, data length.
+ */
+const uint8_t *sim_gap_adv_data(uint16_t *len);
+
+/**
+ * @brief   Advertising events sent since reset.
+ */
+uint32_t sim_gap_adv_events(void);
+
+/**
+ * @brief   GAP_UpdateAdvertisingData() calls since reset.
+ */
+uint32_t sim_gap_updates(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_BLE_H */
@@ -0,0 +1,112 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_i2c.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Register level model of the CH592 I2C peripheral, the
+ *                      devices on its bus and a host master addressing it
+ *******************************************************************************/
+
+#ifndef SIM_I2C_H
+#define SIM_I2C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/**
+ * @brief   Slave device on the simulated bus. The callbacks run at the
+ *          simulated time the bus event completes.
+ */
+typedef struct sim_i2c_dev {
+    uint8_t addr;           // 7bit address
+    /* START or repeated START with our address: return 1 to acknowledge */
+    uint8_t (*start)(struct sim_i2c_dev *dev, uint8_t read);
+    /* Byte written by the master: return 1 to acknowledge */
+    uint8_t (*write)(struct sim_i2c_dev *dev, uint8_t data);
+    /* Next byte read by the master */
+    uint8_t (*read)(struct sim_i2c_dev *dev);
+    /* STOP, or START addressing another device */
+    void (*stop)(struct sim_i2c_dev *dev);
+    struct sim_i2c_dev *link;
+} sim_i2c_dev_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/**
+ * @brief   Put a device on the bus.
+ */
+void sim_i2c_attach(sim_i2c_dev_t *dev);
+
+/**
+ * @brief   Take a device off the bus, its address is not acknowledged.
+ */
+void sim_i2c_detach(sim_i2c_dev_t *dev);
+
+/**
+ * @brief   Bus trace since the last sim_i2c_trace_clear(), one token per
+ *          bus event: "S" START, "Sr" repeated START, "P" STOP,
+ *          "W40+" / "R40-" address with direction and ACK / NACK,
+ *          "E7+" data byte with ACK / NACK, "ARLO" / "BERR" injected
+ *          errors, "SDA-" / "SDA+" SDA held low / released by a device.
+ */
+const char *sim_i2c_trace(void);
+
+/**
+ * @brief   Clear the bus trace.
+ */
+void sim_i2c_trace_clear(void);
+
+/**
+ * @brief   Host master on the bus writing to the CH592 as slave, at 400kHz.
+ *          Blocks while simulated time passes, the I2C interrupt runs in
+ *          between; a slave holding SCL too long aborts the run.
+ *
+ * @param addr      7bit address.
+ * @param stop      0 to keep the bus: the next host access starts with a
+ *                  repeated START.
+ *
+ * @return  Bytes acknowledged, -1 if the address was not.
+ */
+int sim_i2c_host_write(uint8_t addr, const uint8_t *data, uint8_t len, uint8_t stop);
+
+/**
+ * @brief   Host master reading from the CH592 as slave: every byte but the
+ *          last acknowledged, then STOP.
+ *
+ * @return  len, -1 if the address was not acknowledged.
+ */
+int sim_i2c_host_read(uint8_t addr, uint8_t *data, uint8_t len);
+
+/**
+ * @brief   Error flags (RB_I2C_BERR, RB_I2C_ARLO, ...) raised at the end of
+ *          the next address or data byte the CH592 sends or receives as
+ *          master. ARLO: another master won, it keeps the bus for two more
+ *          bytes. BERR: the byte is cut short. Other flags are only raised.
+ */
+void sim_i2c_inject(uint16_t flags);
+
+/**
+ * @brief   A device holds SDA low, the bus stays busy until SCL has been
+ *          clocked as GPIO that many times (the bus recovery).
+ */
+void sim_i2c_stick_sda(uint8_t clocks);
+
+/**
+ * @brief   Bit time of the bus as configured in R16_I2C_CKCFGR (ns).
+ */
+uint32_t sim_i2c_bit_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_I2C_H */
@@ -0,0 +1,74 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_prelude.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Included ahead of every firmware source in the host
+ *                      build: 32 bit register types, no interrupt attribute,
+ *                      and the registers with side effects on access routed
+ *                      to the peripheral models
+ *******************************************************************************/
+
+#ifndef SIM_PRELUDE_H
+#define SIM_PRELUDE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* CH592SFR.h types its 32 bit registers as long, 64 bit on the host */
+#define INT32       int32_t
+#define UINT32      uint32_t
+#define UINT32V     volatile uint32_t
+#define PINT32      int32_t *
+#define PUINT32     uint32_t *
+#define PUINT32V    volatile uint32_t *
+
+/* Interrupt handlers are plain functions called by the simulation, the
+ * code they run is kept in its own section to count its instructions */
+#define __INTERRUPT
+#define __HIGH_CODE __attribute__((section("sim_highcode")))
+
+#include "CH592SFR.h"
+
+/* Register index of sim_i2c_reg(): offset from BA_I2C / 4 */
+#define SIM_I2C_CTRL1       0
+#define SIM_I2C_CTRL2       1
+#define SIM_I2C_OADDR1      2
+#define SIM_I2C_OADDR2      3
+#define SIM_I2C_DATAR       4
+#define SIM_I2C_STAR1       5
+#define SIM_I2C_STAR2       6
+#define SIM_I2C_CKCFGR      7
+#define SIM_I2C_RTR         8
+#define SIM_I2C_REGS        9
+
+/* I2C registers: flags are cleared by the access sequence (STAR1 read then
+ * DATAR write and so on), so every access goes through the model */
+volatile uint16_t *sim_i2c_reg(uint8_t reg);
+
+#undef R16_I2C_CTRL1
+#undef R16_I2C_CTRL2
+#undef R16_I2C_OADDR1
+#undef R16_I2C_OADDR2
+#undef R16_I2C_DATAR
+#undef R16_I2C_STAR1
+#undef R16_I2C_STAR2
+#undef R16_I2C_CKCFGR
+#undef R16_I2C_RTR
+#define R16_I2C_CTRL1       (*sim_i2c_reg(SIM_I2C_CTRL1))
+#define R16_I2C_CTRL2       (*sim_i2c_reg(SIM_I2C_CTRL2))
+#define R16_I2C_OADDR1      (*sim_i2c_reg(SIM_I2C_OADDR1))
+#define R16_I2C_OADDR2      (*sim_i2c_reg(SIM_I2C_OADDR2))
+#define R16_I2C_DATAR       (*sim_i2c_reg(SIM_I2C_DATAR))
+#define R16_I2C_STAR1       (*sim_i2c_reg(SIM_I2C_STAR1))
+#define R16_I2C_STAR2       (*sim_i2c_reg(SIM_I2C_STAR2))
+#define R16_I2C_CKCFGR      (*sim_i2c_reg(SIM_I2C_CKCFGR))
+#define R16_I2C_RTR         (*sim_i2c_reg(SIM_I2C_RTR))
+
+/* ADC: a conversion started by RB_ADC_START completes while the CPU polls */
+volatile uint8_t *sim_adc_convert(void);
+
+#undef R8_ADC_CONVERT
+#define R8_ADC_CONVERT      (*sim_adc_convert())
+
+#endif /* SIM_PRELUDE_H */
@@ -0,0 +1,185 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_sensors.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Sensor models of the host simulation: the values the
+ *                      ADC and the devices on the I2C bus measure
+ *******************************************************************************/
+
+#ifndef SIM_SENSORS_H
+#define SIM_SENSORS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "sim_i2c.h"
+
+/*********************************************************************
+ * ADC
+ */
+
+/**
+ * @brief   Battery voltage seen by the VBAT channel (mV).
+ */
+void sim_adc_set_battery_mv(uint16_t mv);
+
+/**
+ * @brief   Chip temperature seen by the temperature sensor channel (0.01C).
+ */
+void sim_adc_set_chip_temp(int32_t centi);
+
+/**
+ * @brief   ADC offset error (LSB): added to every conversion, read back
+ *          negated by ADC_DataCalib_Rough().
+ */
+void sim_adc_set_offset(int16_t lsb);
+
+/**
+ * @brief   Noise of the conversions: peak deviation (LSB) and the
+ *          fraction (1/256) of conversions hit by an outlier.
+ */
+void sim_adc_set_noise(uint8_t lsb, uint8_t outlier);
+
+/**
+ * @brief   Conversions since reset, single and DMA.
+ */
+uint32_t sim_adc_conversions(void);
+
+/*********************************************************************
+ * SHT20
+ */
+
+/**
+ * @brief   SHT20 temperature and humidity sensor at address 0x40.
+ *          sim_i2c_attach(sim_sht20()) puts it on the bus.
+ */
+sim_i2c_dev_t *sim_sht20(void);
+
+/**
+ * @brief   Conditions the SHT20 measures.
+ *
+ * @param temp      Temperature (0.01C).
+ * @param humi      Relative humidity (0.01%RH).
+ */
+void sim_sht20_set(int32_t temp, int32_t humi);
+
+/**
+ * @brief   Measurements completed and user register writes since reset.
+ */
+uint32_t sim_sht20_measurements(void);
+uint32_t sim_sht20_reg_writes(void);
+
+/*********************************************************************
+ * SHT3x
+ */
+
+/**
+ * @brief   SHT3x temperature and humidity sensor at address 0x44, single
+ *          shot or periodic at 0.5 mps. sim_i2c_attach(sim_sht3x()) puts
+ *          it on the bus.
+ */
+sim_i2c_dev_t *sim_sht3x(void);
+
+/**
+ * @brief   Conditions the SHT3x measures (0.01C, 0.01%RH).
+ */
+void sim_sht3x_set(int32_t temp, int32_t humi);
+
+/**
+ * @brief   Conversions completed and periodic results fetched since reset.
+ */
+uint32_t sim_sht3x_measurements(void);
+uint32_t sim_sht3x_fetches(void);
+
+/**
+ * @brief   Heater bit of the status register.
+ */
+uint8_t sim_sht3x_heater(void);
+
+/*********************************************************************
+ * SHT4x
+ */
+
+/**
+ * @brief   SHT4x temperature and humidity sensor at address 0x44. A
+ *          heater pulse ends with a measurement reading warmer than the
+ *          conditions. sim_i2c_attach(sim_sht4x()) puts it on the bus.
+ */
+sim_i2c_dev_t *sim_sht4x(void);
+
+/**
+ * @brief   Conditions the SHT4x measures (0.01C, 0.01%RH).
+ */
+void sim_sht4x_set(int32_t temp, int32_t humi);
+
+/**
+ * @brief   Conversions completed, and those that ended a heater pulse,
+ *          since reset.
+ */
+uint32_t sim_sht4x_measurements(void);
+uint32_t sim_sht4x_heater_pulses(void);
+
+/*********************************************************************
+ * BME280
+ */
+
+#define SIM_BME280_CHIP_BME280  0x60
+#define SIM_BME280_CHIP_BMP280  0x58
+
+/* Trimming parameters dig_T1..T3, dig_P1..P9, dig_H1..H6 */
+typedef struct {
+    int32_t t[3];
+    int32_t p[9];
+    int32_t h[6];
+} sim_bme280_calib_t;
+
+/**
+ * @brief   BME280 at address 0x76, forced mode conversions taking the
+ *          typical measurement time. sim_i2c_attach(sim_bme280()) puts it
+ *          on the bus.
+ */
+sim_i2c_dev_t *sim_bme280(void);
+
+/**
+ * @brief   Chip id the model answers with: SIM_BME280_CHIP_BMP280 has no
+ *          humidity channel. Resets the registers.
+ */
+void sim_bme280_chip(uint8_t chip_id);
+
+/**
+ * @brief   Trimming parameters of the model: temperature and pressure of
+ *          the datasheet compensation example.
+ */
+const sim_bme280_calib_t *sim_bme280_calib(void);
+
+/**
+ * @brief   Conditions the BME280 measures.
+ *
+ * @param temp      Temperature (0.01C).
+ * @param humi      Relative humidity (0.01%RH).
+ * @param pres      Pressure (Pa).
+ */
+void sim_bme280_set(int32_t temp, int32_t humi, uint32_t pres);
+
+/**
+ * @brief   Raw values whose floating point compensation of the datasheet
+ *          gives the conditions, at full 20 bit resolution.
+ */
+void sim_bme280_raw(int32_t temp, int32_t humi, uint32_t pres,
+                    int32_t *adc_t, int32_t *adc_p, int32_t *adc_h);
+
+/**
+ * @brief   Conversions completed, and data reads started while one was
+ *          running, since reset.
+ */
+uint32_t sim_bme280_measurements(void);
+uint32_t sim_bme280_early_reads(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_SENSORS_H */
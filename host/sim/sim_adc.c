@@ -0,0 +1,246 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_adc.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : ADC model: single conversions of the battery and chip
+ *                      temperature channels, offset test mode, automatic
+ *                      conversions into RAM by DMA
+ *******************************************************************************/
+
+#include "CH59x_common.h"
+#include "sim.h"
+#include "sim_sensors.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* One conversion (ns) */
+#define SIM_ADC_CONV_NS         2000
+
+/* Internal reference of the battery channel at -12dB (mV) */
+#define SIM_ADC_VREF            1050
+
+/* Chip temperature sensor: code at 25C (ROM_CFG_TMP_25C) and LSB per 1C (x100) */
+#define SIM_ADC_TS_25C          1900
+#define SIM_ADC_TS_SLOPE        283
+
+/* R8_ADC_CONVERT itself, the firmware's name goes through sim_adc_convert() */
+#define SIM_ADC_CONVERT         (*((volatile uint8_t *)0x4000105A))
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint16_t sim_bat_mv = 3300;
+static int32_t sim_chip_temp = 2500;
+static int16_t sim_offset;
+static uint8_t sim_noise_lsb;
+static uint8_t sim_noise_outlier;
+static uint32_t sim_noise_seed = 1;
+static uint32_t sim_conversions;
+
+/* single conversion in progress */
+static uint8_t sim_conv_busy;
+static uint64_t sim_conv_done;
+
+/* DMA: full addresses of the buffer, the register keeps 16 bits */
+static uintptr_t sim_dma_beg;
+static uintptr_t sim_dma_end;
+static uintptr_t sim_dma_next;
+static uint8_t sim_dma_running;
+static uint8_t sim_dma_finished;
+static uint64_t sim_dma_due;
+
+/*********************************************************************
+ * CONVERSIONS
+ */
+
+static uint32_t sim_adc_rand(void)
+{
+    sim_noise_seed = sim_noise_seed * 1103515245 + 12345;
+    return (sim_noise_seed >> 16) & 0x7FFF;
+}
+
+/* Result of a conversion of the configured channel in 1/256 LSB */
+static int32_t sim_adc_ideal(void)
+{
+    if (R8_ADC_CFG & RB_ADC_OFS_TEST) {
+        /* input shorted: the inverted result reads back 2048 + offset */
+        return (2047 - sim_offset) * 256;
+    }
+    switch (R8_ADC_CHANNEL) {
+    case CH_INTE_VBAT:
+        return (int32_t)(((int64_t)sim_bat_mv + 3 * SIM_ADC_VREF) * 512 * 256 / SIM_ADC_VREF) +
+               sim_offset * 256;
+    case CH_INTE_VTEMP:
+        return SIM_ADC_TS_25C * 256 + (sim_chip_temp - 2500) * SIM_ADC_TS_SLOPE * 256 / 10000 +
+               sim_offset * 256;
+    default:
+        return 2048 * 256;
+    }
+}
+
+static uint16_t sim_adc_sample(void)
+{
+    int32_t v = sim_adc_ideal();
+
+    /* quantisation with a uniform dither, so averages resolve below 1 LSB */
+    v += sim_adc_rand() & 0xFF;
+    if (sim_noise_lsb) {
+        v += ((int32_t)(sim_adc_rand() % (2 * sim_noise_lsb + 1)) - sim_noise_lsb) * 256;
+    }
+    if (sim_noise_outlier && (sim_adc_rand() & 0xFF) < sim_noise_outlier) {
+        v += (sim_adc_rand() & 1 ? 64 : -64) * 256;
+    }
+    v >>= 8;
+    sim_conversions++;
+    return v < 0 ? 0 : v > RB_ADC_DATA ? RB_ADC_DATA : v;
+}
+
+volatile uint8_t *sim_adc_convert(void)
+{
+    sim_io();
+    return &SIM_ADC_CONVERT;
+}
+
+/*********************************************************************
+ * MODEL
+ */
+
+/* Interval of the automatic conversions (ns) */
+static uint64_t sim_adc_period(void)
+{
+    return (256 - R8_ADC_AUTO_CYCLE) * 16 * 1000000000ULL / sim_sysclk();
+}
+
+static void sim_adc_sync(void)
+{
+    uint8_t dma = R8_ADC_CTRL_DMA;
+
+    if ((SIM_ADC_CONVERT & RB_ADC_START) && !sim_conv_busy) {
+        sim_conv_busy = 1;
+        sim_conv_done = sim_time() + SIM_ADC_CONV_NS;
+    }
+
+    if (!(dma & RB_ADC_AUTO_EN)) {
+        sim_dma_running = 0;
+        sim_dma_finished = 0;
+    } else if (!(dma & RB_ADC_DMA_ENABLE)) {
+        sim_dma_running = 0;
+    } else if (!sim_dma_running && !sim_dma_finished) {
+        if (((sim_dma_beg ^ R16_ADC_DMA_BEG) & 0xFFFF) || ((sim_dma_end ^ R16_ADC_DMA_END) & 0xFFFF)) {
+            sim_fatal("ADC DMA started without ADC_DMACfg()");
+        }
+        sim_dma_running = 1;
+        sim_dma_next = sim_dma_beg;
+        sim_dma_due = sim_time() + sim_adc_period();
+    }
+}
+
+static uint64_t sim_adc_next(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    if (sim_conv_busy) {
+        next = sim_conv_done;
+    }
+    if (sim_dma_running && sim_dma_due < next) {
+        next = sim_dma_due;
+    }
+    return next;
+}
+
+static void sim_adc_step(void)
+{
+    uint64_t now = sim_time();
+
+    if (sim_conv_busy && now >= sim_conv_done) {
+        sim_conv_busy = 0;
+        R16_ADC_DATA = sim_adc_sample();
+        SIM_ADC_CONVERT &= ~RB_ADC_START;
+    }
+
+    if (sim_dma_running && now >= sim_dma_due) {
+        *(volatile uint16_t *)sim_dma_next = sim_adc_sample();
+        sim_dma_next += sizeof(uint16_t);
+        sim_dma_due += sim_adc_period();
+        if (sim_dma_next >= sim_dma_end) {
+            if (R8_ADC_CTRL_DMA & RB_ADC_DMA_LOOP) {
+                sim_dma_next = sim_dma_beg;
+            } else {
+                sim_dma_running = 0;
+                sim_dma_finished = 1;
+            }
+            R8_ADC_DMA_IF |= RB_ADC_IF_DMA_END;
+            if (R8_ADC_CTRL_DMA & RB_ADC_IE_DMA_END) {
+                sim_irq_raise(ADC_IRQn);
+            }
+        }
+    }
+}
+
+/* ADC_ClearDMAFlag() writes 1 to the flag with |=, clear it for the handler */
+static void sim_adc_eoi(void)
+{
+    R8_ADC_DMA_IF &= ~RB_ADC_IF_DMA_END;
+}
+
+static sim_model_t sim_adc_model = {
+    .name = "adc",
+    .sync = sim_adc_sync,
+    .next = sim_adc_next,
+    .step = sim_adc_step,
+};
+
+__attribute__((constructor(102)))
+static void sim_adc_init(void)
+{
+    sim_model_register(&sim_adc_model);
+    sim_irq_connect(ADC_IRQn, NULL, sim_adc_eoi);
+}
+
+/* The register holds the low 16 bits of the buffer address, keep the rest */
+void __real_ADC_DMACfg(uint8_t s, uint32_t startAddr, uint32_t endAddr, ADC_DMAModeTypeDef m);
+
+void __wrap_ADC_DMACfg(uint8_t s, uint32_t startAddr, uint32_t endAddr, ADC_DMAModeTypeDef m)
+{
+    if (s != DISABLE) {
+        sim_dma_beg = startAddr;
+        sim_dma_end = endAddr;
+        sim_dma_finished = 0;
+    }
+    sim_io();
+    __real_ADC_DMACfg(s, startAddr, endAddr, m);
+}
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+void sim_adc_set_battery_mv(uint16_t mv)
+{
+    sim_bat_mv = mv;
+}
+
+void sim_adc_set_chip_temp(int32_t centi)
+{
+    sim_chip_temp = centi;
+}
+
+void sim_adc_set_offset(int16_t lsb)
+{
+    sim_offset = lsb;
+}
+
+void sim_adc_set_noise(uint8_t lsb, uint8_t outlier)
+{
+    sim_noise_lsb = lsb;
+    sim_noise_outlier = outlier;
+}
+
+uint32_t sim_adc_conversions(void)
+{
+    return sim_conversions;
+}
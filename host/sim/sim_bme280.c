@@ -0,0 +1,358 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_bme280.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : BME280/BMP280 model: register map, calibration of
+ *                      the datasheet example, forced mode conversions with
+ *                      the typical measurement time, oversampling resolution
+ *******************************************************************************/
+
+#include "sim.h"
+#include "sim_sensors.h"
+
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SIM_BME280_ADDR         0x76
+
+#define SIM_BME280_REG_CALIB_TP 0x88
+#define SIM_BME280_REG_H1       0xA1
+#define SIM_BME280_REG_CHIP_ID  0xD0
+#define SIM_BME280_REG_RESET    0xE0
+#define SIM_BME280_REG_CALIB_H  0xE1
+#define SIM_BME280_REG_CTRL_HUM 0xF2
+#define SIM_BME280_REG_STATUS   0xF3
+#define SIM_BME280_REG_CTRL_MEAS 0xF4
+#define SIM_BME280_REG_CONFIG   0xF5
+#define SIM_BME280_REG_DATA     0xF7
+
+#define SIM_BME280_RESET_WORD   0xB6
+#define SIM_BME280_STATUS_MEASURING 0x08
+
+/* Trimming parameters: temperature and pressure of the datasheet
+ * compensation example, humidity typical of a production part */
+static const sim_bme280_calib_t sim_bme280_calib_default = {
+    .t = { 27504, 26435, -1000 },
+    .p = { 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 },
+    .h = { 75, 362, 0, 313, 50, 30 },
+};
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const sim_bme280_calib_t *sim_bme280_cal = &sim_bme280_calib_default;
+static int32_t sim_bme280_temp = 2500;
+static int32_t sim_bme280_humi = 5000;
+static uint32_t sim_bme280_pres = 101325;
+static uint8_t sim_bme280_chip_id = SIM_BME280_CHIP_BME280;
+
+static uint8_t sim_bme280_regs[256];
+static uint8_t sim_bme280_ptr;          // register of the next read or write
+static uint8_t sim_bme280_first;        // next written byte is a register address
+static uint8_t sim_bme280_osrs_h;       // humidity oversampling latched by ctrl_meas
+static uint8_t sim_bme280_measuring;
+static uint64_t sim_bme280_ready;       // end of the conversion
+
+static uint32_t sim_bme280_meas_count;
+static uint32_t sim_bme280_early_count;
+
+/*********************************************************************
+ * COMPENSATION
+ */
+
+/* Floating point compensation of the datasheet (BME280 section 8.1),
+ * the reference the raw values are searched against */
+static double sim_bme280_comp_t(int32_t adc_t, double *t_fine)
+{
+    const sim_bme280_calib_t *c = sim_bme280_cal;
+    double var1 = (adc_t / 16384.0 - c->t[0] / 1024.0) * c->t[1];
+    double var2 = (adc_t / 131072.0 - c->t[0] / 8192.0) *
+                  (adc_t / 131072.0 - c->t[0] / 8192.0) * c->t[2];
+
+    *t_fine = var1 + var2;
+    return *t_fine / 5120.0;
+}
+
+static double sim_bme280_comp_p(int32_t adc_p, double t_fine)
+{
+    const sim_bme280_calib_t *c = sim_bme280_cal;
+    double var1 = t_fine / 2.0 - 64000.0;
+    double var2 = var1 * var1 * c->p[5] / 32768.0;
+    double p;
+
+    var2 = var2 + var1 * c->p[4] * 2.0;
+    var2 = var2 / 4.0 + c->p[3] * 65536.0;
+    var1 = (c->p[2] * var1 * var1 / 524288.0 + c->p[1] * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * c->p[0];
+    if (var1 == 0.0) {
+        return 0;
+    }
+    p = 1048576.0 - adc_p;
+    p = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = c->p[8] * p * p / 2147483648.0;
+    var2 = p * c->p[7] / 32768.0;
+    return p + (var1 + var2 + c->p[6]) / 16.0;
+}
+
+static double sim_bme280_comp_h(int32_t adc_h, double t_fine)
+{
+    const sim_bme280_calib_t *c = sim_bme280_cal;
+    double h = t_fine - 76800.0;
+
+    h = (adc_h - (c->h[3] * 64.0 + c->h[4] / 16384.0 * h)) *
+        (c->h[1] / 65536.0 * (1.0 + c->h[5] / 67108864.0 * h * (1.0 + c->h[2] / 67108864.0 * h)));
+    h = h * (1.0 - c->h[0] * h / 524288.0);
+    return h < 0 ? 0 : h > 100 ? 100 : h;
+}
+
+/* Smallest raw value in [0, max] whose compensated value reaches the
+ * target, the compensation rising with the raw value */
+static int32_t sim_bme280_search(double (*comp)(int32_t raw, double t_fine), double t_fine,
+                                 double target, int32_t max)
+{
+    int32_t lo = 0, hi = max;
+
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+
+        if (comp(mid, t_fine) < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static double sim_bme280_comp_t_raw(int32_t raw, double unused)
+{
+    double t_fine;
+
+    (void)unused;
+    return sim_bme280_comp_t(raw, &t_fine);
+}
+
+/* Pressure falls as the raw value rises: search the complement */
+static double sim_bme280_comp_p_rev(int32_t raw, double t_fine)
+{
+    return sim_bme280_comp_p(0xFFFFF - raw, t_fine);
+}
+
+/*********************************************************************
+ * DEVICE
+ */
+
+static void sim_bme280_put20(uint8_t reg, int32_t raw)
+{
+    sim_bme280_regs[reg] = raw >> 12;
+    sim_bme280_regs[reg + 1] = (raw >> 4) & 0xFF;
+    sim_bme280_regs[reg + 2] = (raw & 0x0F) << 4;
+}
+
+/* Oversampling setting 1..5 gives 16 + osrs - 1 bits of a 20 bit value,
+ * the unused low bits read 0 */
+static int32_t sim_bme280_quantize(int32_t raw, uint8_t osrs)
+{
+    return raw & ~((1 << (5 - osrs)) - 1);
+}
+
+/* Power on values: calibration and chip id, data at the skipped values */
+static void sim_bme280_reset(void)
+{
+    const sim_bme280_calib_t *c = sim_bme280_cal;
+    uint8_t *r = sim_bme280_regs;
+
+    memset(r, 0, sizeof(sim_bme280_regs));
+    for (uint8_t i = 0; i < 3; i++) {
+        r[SIM_BME280_REG_CALIB_TP + 2 * i] = c->t[i] & 0xFF;
+        r[SIM_BME280_REG_CALIB_TP + 2 * i + 1] = (uint16_t)c->t[i] >> 8;
+    }
+    for (uint8_t i = 0; i < 9; i++) {
+        r[SIM_BME280_REG_CALIB_TP + 6 + 2 * i] = c->p[i] & 0xFF;
+        r[SIM_BME280_REG_CALIB_TP + 6 + 2 * i + 1] = (uint16_t)c->p[i] >> 8;
+    }
+    if (sim_bme280_chip_id == SIM_BME280_CHIP_BME280) {
+        r[SIM_BME280_REG_H1] = c->h[0];
+        r[SIM_BME280_REG_CALIB_H] = c->h[1] & 0xFF;
+        r[SIM_BME280_REG_CALIB_H + 1] = (uint16_t)c->h[1] >> 8;
+        r[SIM_BME280_REG_CALIB_H + 2] = c->h[2];
+        r[SIM_BME280_REG_CALIB_H + 3] = c->h[3] >> 4;
+        r[SIM_BME280_REG_CALIB_H + 4] = (c->h[3] & 0x0F) | (c->h[4] & 0x0F) << 4;
+        r[SIM_BME280_REG_CALIB_H + 5] = c->h[4] >> 4;
+        r[SIM_BME280_REG_CALIB_H + 6] = c->h[5];
+    }
+    r[SIM_BME280_REG_CHIP_ID] = sim_bme280_chip_id;
+    sim_bme280_put20(SIM_BME280_REG_DATA, 0x80000);
+    sim_bme280_put20(SIM_BME280_REG_DATA + 3, 0x80000);
+    r[SIM_BME280_REG_DATA + 6] = 0x80;
+    sim_bme280_measuring = 0;
+}
+
+/* End of a forced conversion: data registers updated, back to sleep mode */
+static void sim_bme280_sync(void)
+{
+    uint8_t meas = sim_bme280_regs[SIM_BME280_REG_CTRL_MEAS];
+    uint8_t osrs_t = meas >> 5, osrs_p = (meas >> 2) & 0x07;
+    int32_t adc_t, adc_p, adc_h;
+
+    if (!sim_bme280_measuring || sim_time() < sim_bme280_ready) {
+        return;
+    }
+    sim_bme280_raw(sim_bme280_temp, sim_bme280_humi, sim_bme280_pres, &adc_t, &adc_p, &adc_h);
+    if (osrs_p) {
+        sim_bme280_put20(SIM_BME280_REG_DATA, sim_bme280_quantize(adc_p, osrs_p > 5 ? 5 : osrs_p));
+    }
+    if (osrs_t) {
+        sim_bme280_put20(SIM_BME280_REG_DATA + 3, sim_bme280_quantize(adc_t, osrs_t > 5 ? 5 : osrs_t));
+    }
+    if (sim_bme280_osrs_h && sim_bme280_chip_id == SIM_BME280_CHIP_BME280) {
+        sim_bme280_regs[SIM_BME280_REG_DATA + 6] = adc_h >> 8;
+        sim_bme280_regs[SIM_BME280_REG_DATA + 7] = adc_h & 0xFF;
+    }
+    sim_bme280_regs[SIM_BME280_REG_CTRL_MEAS] &= ~0x03;
+    sim_bme280_measuring = 0;
+    sim_bme280_meas_count++;
+}
+
+/* Typical measurement time (datasheet 9.1): 1 ms plus 2 ms per sample of
+ * each channel, 0.5 ms more for pressure and humidity */
+static uint32_t sim_bme280_meas_us(uint8_t meas)
+{
+    static const uint8_t times[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+    uint8_t t = times[meas >> 5], p = times[(meas >> 2) & 0x07];
+    uint8_t h = (sim_bme280_chip_id == SIM_BME280_CHIP_BME280) ? times[sim_bme280_osrs_h] : 0;
+
+    return 1000 + 2000 * t + (p ? 2000 * p + 500 : 0) + (h ? 2000 * h + 500 : 0);
+}
+
+static void sim_bme280_write_reg(uint8_t reg, uint8_t val)
+{
+    switch (reg) {
+    case SIM_BME280_REG_RESET:
+        if (val == SIM_BME280_RESET_WORD) {
+            sim_bme280_reset();
+        }
+        break;
+    case SIM_BME280_REG_CTRL_HUM:
+        sim_bme280_regs[reg] = val & 0x07;
+        break;
+    case SIM_BME280_REG_CTRL_MEAS:
+        /* ctrl_hum takes effect on a write of ctrl_meas */
+        sim_bme280_regs[reg] = val;
+        sim_bme280_osrs_h = sim_bme280_regs[SIM_BME280_REG_CTRL_HUM];
+        if ((val & 0x03) == 0x01 || (val & 0x03) == 0x02) {
+            sim_bme280_measuring = 1;
+            sim_bme280_ready = sim_time() + SIM_US(sim_bme280_meas_us(val));
+        }
+        break;
+    case SIM_BME280_REG_CONFIG:
+        sim_bme280_regs[reg] = val;
+        break;
+    default:
+        break;
+    }
+}
+
+static uint8_t sim_bme280_start(sim_i2c_dev_t *dev, uint8_t read)
+{
+    (void)dev;
+    sim_bme280_sync();
+    sim_bme280_first = !read;
+    if (read && sim_bme280_measuring && sim_bme280_ptr >= SIM_BME280_REG_DATA) {
+        sim_bme280_early_count++;
+    }
+    return 1;
+}
+
+/* Register address, then (data, address) pairs */
+static uint8_t sim_bme280_write(sim_i2c_dev_t *dev, uint8_t data)
+{
+    (void)dev;
+    if (sim_bme280_first) {
+        sim_bme280_ptr = data;
+        sim_bme280_first = 0;
+    } else {
+        sim_bme280_write_reg(sim_bme280_ptr, data);
+        sim_bme280_first = 1;
+    }
+    return 1;
+}
+
+static uint8_t sim_bme280_read(sim_i2c_dev_t *dev)
+{
+    uint8_t reg = sim_bme280_ptr++;
+
+    (void)dev;
+    if (reg == SIM_BME280_REG_STATUS) {
+        return sim_bme280_measuring ? SIM_BME280_STATUS_MEASURING : 0;
+    }
+    return sim_bme280_regs[reg];
+}
+
+static void sim_bme280_stop(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+}
+
+static sim_i2c_dev_t sim_bme280_dev = {
+    .addr = SIM_BME280_ADDR,
+    .start = sim_bme280_start,
+    .write = sim_bme280_write,
+    .read = sim_bme280_read,
+    .stop = sim_bme280_stop,
+};
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+sim_i2c_dev_t *sim_bme280(void)
+{
+    sim_bme280_reset();
+    return &sim_bme280_dev;
+}
+
+void sim_bme280_chip(uint8_t chip_id)
+{
+    sim_bme280_chip_id = chip_id;
+    sim_bme280_reset();
+}
+
+const sim_bme280_calib_t *sim_bme280_calib(void)
+{
+    return sim_bme280_cal;
+}
+
+void sim_bme280_set(int32_t temp, int32_t humi, uint32_t pres)
+{
+    sim_bme280_temp = temp;
+    sim_bme280_humi = humi;
+    sim_bme280_pres = pres;
+}
+
+void sim_bme280_raw(int32_t temp, int32_t humi, uint32_t pres,
+                    int32_t *adc_t, int32_t *adc_p, int32_t *adc_h)
+{
+    double t_fine;
+
+    *adc_t = sim_bme280_search(sim_bme280_comp_t_raw, 0, temp / 100.0, 0xFFFFF);
+    sim_bme280_comp_t(*adc_t, &t_fine);
+    *adc_p = 0xFFFFF - sim_bme280_search(sim_bme280_comp_p_rev, t_fine, pres, 0xFFFFF);
+    *adc_h = sim_bme280_search(sim_bme280_comp_h, t_fine, humi / 100.0, 0xFFFF);
+}
+
+uint32_t sim_bme280_measurements(void)
+{
+    sim_bme280_sync();
+    return sim_bme280_meas_count;
+}
+
+uint32_t sim_bme280_early_reads(void)
+{
+    return sim_bme280_early_count;
+}
@@ -0,0 +1,866 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_core.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Simulated time, interrupt controller, RTC, register
+ *                      memory and the system/clock/power library functions
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include "CH59x_common.h"
+#include "sim.h"
+
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Register memory: SFR block and the ROM configuration page */
+#define SIM_SFR_BASE        0x40000000UL
+#define SIM_SFR_SIZE        0x10000
+#define SIM_ROM_CFG_BASE    0x7F000UL
+#define SIM_ROM_CFG_SIZE    0x1000
+
+/* Chip temperature sensor calibration: ADC code at 25C */
+#define SIM_ROM_TMP_25C     1900
+
+/* Stack of the firmware coroutine */
+#define SIM_MAIN_STACK      (1024 * 1024)
+
+/* Busy loops: wall clock period (ns) of the check for firmware spinning on
+ * RAM, and the simulated time each check lets pass, about 300 cycles */
+#define SIM_SPIN_PERIOD     50000
+#define SIM_SPIN_NS         5000
+
+/* REG_RIP of <sys/ucontext.h>, hidden there as the prelude is included
+ * ahead of _GNU_SOURCE */
+#define SIM_REG_RIP         16
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint64_t sim_now;
+static uint32_t sim_advancing;          // depth of sim_advance_to()
+static sim_model_t *sim_models;
+
+static struct {
+    sim_irq_level_t level;
+    sim_irq_eoi_t eoi;
+    uint8_t latched;
+    uint8_t enabled;
+    uint32_t count;
+    uint32_t window_count;
+} sim_irqs[SIM_IRQ_MAX];
+
+static uint8_t sim_mie = 1;             // startup code enables interrupts before main
+static uint8_t sim_isr_active = 0xFF;   // interrupt being handled, 0xFF in thread mode
+static uint8_t sim_asleep;
+static uint64_t sim_storm_window;
+static uint32_t sim_dispatches;
+static void (*sim_hook_enter)(uint8_t irq);
+static void (*sim_hook_leave)(uint8_t irq);
+
+static uint64_t sim_sleep_ns;
+static uint64_t sim_idle_ns;
+
+/* RTC: last tick checked for a trigger match */
+static uint64_t sim_rtc_checked;
+
+/* Data flash */
+static uint8_t sim_eeprom[EEPROM_MAX_SIZE];
+
+/* Firmware coroutine */
+static ucontext_t sim_host_ctx;
+static ucontext_t sim_fw_ctx;
+static uint8_t sim_fw_running;
+static uint8_t sim_tmos_running;
+static uint64_t sim_run_limit;
+static int (*sim_fw_entry)(void);
+
+PFIC_Type sim_pfic;
+static SysTick_Type sim_systick_regs;
+
+/* Firmware code: __HIGH_CODE functions and the .text of the firmware
+ * objects, renamed by the Makefile */
+extern const char __start_sim_highcode[] __attribute__((weak));
+extern const char __stop_sim_highcode[] __attribute__((weak));
+extern const char __start_sim_fw_text[] __attribute__((weak));
+extern const char __stop_sim_fw_text[] __attribute__((weak));
+
+/* Interrupt handlers of the firmware, the ones it does not define stay NULL */
+void GPIOA_IRQHandler(void) __attribute__((weak));
+void GPIOB_IRQHandler(void) __attribute__((weak));
+void RTC_IRQHandler(void) __attribute__((weak));
+void ADC_IRQHandler(void) __attribute__((weak));
+void I2C_IRQHandler(void) __attribute__((weak));
+void SysTick_Handler(void) __attribute__((weak));
+
+static void (*sim_vector(uint8_t irq))(void)
+{
+    switch (irq) {
+    case SysTick_IRQn:
+        return SysTick_Handler;
+    case GPIO_A_IRQn:
+        return GPIOA_IRQHandler;
+    case GPIO_B_IRQn:
+        return GPIOB_IRQHandler;
+    case RTC_IRQn:
+        return RTC_IRQHandler;
+    case ADC_IRQn:
+        return ADC_IRQHandler;
+    case I2C_IRQn:
+        return I2C_IRQHandler;
+    default:
+        return NULL;
+    }
+}
+
+/*********************************************************************
+ * ERRORS
+ */
+
+void sim_fatal(const char *fmt, ...)
+{
+    va_list ap;
+
+    fflush(stdout);
+    fprintf(stderr, "sim: %llu.%06llu ms: ", (unsigned long long)(sim_now / 1000000),
+            (unsigned long long)(sim_now % 1000000));
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+static void sim_wall_limit(int sig)
+{
+    (void)sig;
+    sim_fatal("wall clock limit of %d s reached, firmware stuck?", SIM_WALL_LIMIT);
+}
+
+/*********************************************************************
+ * RTC
+ */
+
+static uint64_t sim_rtc_tick(uint64_t t)
+{
+    return t * CAB_LSIFQ / 1000000000ULL;
+}
+
+static uint64_t sim_rtc_tick_time(uint64_t tick)
+{
+    return (tick * 1000000000ULL + CAB_LSIFQ - 1) / CAB_LSIFQ;
+}
+
+uint32_t sim_rtc_count(void)
+{
+    return (uint32_t)(sim_rtc_tick(sim_now) % RTC_MAX_COUNT);
+}
+
+static void sim_rtc_sync(void)
+{
+    uint64_t tick = sim_rtc_tick(sim_now);
+
+    if (tick > sim_rtc_checked) {
+        sim_rtc_checked = tick;
+    }
+}
+
+/* First tick after the last one checked where the count matches R32_RTC_TRIG */
+static uint64_t sim_rtc_next(void)
+{
+    uint64_t base, tick;
+
+    if (!(R8_RTC_MODE_CTRL & RB_RTC_TRIG_EN) || R32_RTC_TRIG >= RTC_MAX_COUNT) {
+        return UINT64_MAX;
+    }
+    base = sim_rtc_checked - sim_rtc_checked % RTC_MAX_COUNT;
+    tick = base + R32_RTC_TRIG;
+    if (tick <= sim_rtc_checked) {
+        tick += RTC_MAX_COUNT;
+    }
+    return sim_rtc_tick_time(tick);
+}
+
+static void sim_rtc_step(void)
+{
+    uint64_t tick = sim_rtc_tick(sim_now);
+
+    if ((R8_RTC_MODE_CTRL & RB_RTC_TRIG_EN) && tick > sim_rtc_checked &&
+        tick % RTC_MAX_COUNT == R32_RTC_TRIG) {
+        R8_RTC_FLAG_CTRL |= RB_RTC_TRIG_FLAG;
+        sim_irq_raise(RTC_IRQn);
+    }
+    sim_rtc_sync();
+}
+
+static sim_model_t sim_rtc_model = {
+    .name = "rtc",
+    .sync = sim_rtc_sync,
+    .next = sim_rtc_next,
+    .step = sim_rtc_step,
+};
+
+/*********************************************************************
+ * TIME AND MODELS
+ */
+
+uint64_t sim_time(void)
+{
+    return sim_now;
+}
+
+uint32_t sim_sysclk(void)
+{
+    return GetSysClock();
+}
+
+void sim_model_register(sim_model_t *model)
+{
+    sim_model_t **p = &sim_models;
+
+    while (*p) {
+        p = &(*p)->link;
+    }
+    model->link = NULL;
+    *p = model;
+}
+
+void sim_sync(void)
+{
+    for (sim_model_t *m = sim_models; m; m = m->link) {
+        if (m->sync) {
+            m->sync();
+        }
+    }
+}
+
+static uint64_t sim_models_next(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    for (sim_model_t *m = sim_models; m; m = m->link) {
+        if (m->next) {
+            uint64_t t = m->next();
+
+            if (t < next) {
+                next = t;
+            }
+        }
+    }
+    return next;
+}
+
+static void sim_models_step(void)
+{
+    for (sim_model_t *m = sim_models; m; m = m->link) {
+        if (m->next && m->step && m->next() <= sim_now) {
+            m->step();
+        }
+    }
+}
+
+static void sim_set_now(uint64_t t)
+{
+    if (t > sim_now) {
+        sim_now = t;
+    }
+    R32_RTC_CNT_32K = sim_rtc_count();
+}
+
+void sim_advance_to(uint64_t t)
+{
+    sim_advancing++;
+    sim_icount_pause();
+    for (;;) {
+        uint64_t next;
+
+        sim_sync();
+        sim_irq_check();
+        next = sim_models_next();
+        if (next > t || sim_now >= t) {
+            break;
+        }
+        sim_set_now(next);
+        sim_models_step();
+    }
+    sim_set_now(t);
+    sim_sync();
+    sim_irq_check();
+    sim_icount_resume();
+    sim_advancing--;
+}
+
+void sim_advance(uint64_t ns)
+{
+    sim_advance_to(sim_now + ns);
+}
+
+void sim_io(void)
+{
+    sim_advance(SIM_IO_NS);
+}
+
+/*********************************************************************
+ * INTERRUPTS
+ */
+
+void sim_irq_connect(uint8_t irq, sim_irq_level_t level, sim_irq_eoi_t eoi)
+{
+    sim_irqs[irq].level = level;
+    sim_irqs[irq].eoi = eoi;
+}
+
+void sim_irq_raise(uint8_t irq)
+{
+    sim_irqs[irq].latched = 1;
+}
+
+static uint8_t sim_irq_requested(uint8_t irq)
+{
+    return sim_irqs[irq].latched || (sim_irqs[irq].level && sim_irqs[irq].level());
+}
+
+/* Highest priority pending and enabled interrupt, SIM_IRQ_MAX if none */
+static uint8_t sim_irq_next(void)
+{
+    for (uint8_t irq = 0; irq < SIM_IRQ_MAX; irq++) {
+        if (sim_irqs[irq].enabled && sim_irq_requested(irq)) {
+            return irq;
+        }
+    }
+    return SIM_IRQ_MAX;
+}
+
+static void sim_irq_dispatch(uint8_t irq)
+{
+    void (*handler)(void) = sim_vector(irq);
+
+    if (!handler) {
+        sim_fatal("interrupt %d enabled without a handler", irq);
+    }
+    if (sim_now - sim_storm_window >= SIM_MS(1)) {
+        sim_storm_window = sim_now;
+        for (uint8_t i = 0; i < SIM_IRQ_MAX; i++) {
+            sim_irqs[i].window_count = 0;
+        }
+    }
+    if (++sim_irqs[irq].window_count > SIM_IRQ_STORM) {
+        sim_fatal("interrupt %d storm, source not cleared by its handler", irq);
+    }
+
+    sim_irqs[irq].latched = 0;
+    sim_irqs[irq].count++;
+    sim_dispatches++;
+    sim_isr_active = irq;
+    if (sim_hook_enter) {
+        sim_hook_enter(irq);
+    }
+    handler();
+    if (sim_hook_leave) {
+        sim_hook_leave(irq);
+    }
+    sim_sync();
+    if (sim_irqs[irq].eoi) {
+        sim_irqs[irq].eoi();
+    }
+    sim_isr_active = 0xFF;
+}
+
+void sim_irq_check(void)
+{
+    uint8_t irq;
+
+    if (!sim_mie || sim_asleep || sim_isr_active != 0xFF) {
+        return;
+    }
+    while ((irq = sim_irq_next()) != SIM_IRQ_MAX) {
+        sim_irq_dispatch(irq);
+        sim_sync();
+    }
+}
+
+uint8_t sim_in_irq(void)
+{
+    return sim_isr_active != 0xFF;
+}
+
+void sim_irq_hook(void (*enter)(uint8_t irq), void (*leave)(uint8_t irq))
+{
+    sim_hook_enter = enter;
+    sim_hook_leave = leave;
+}
+
+uint32_t sim_irq_count(uint8_t irq)
+{
+    return sim_irqs[irq].count;
+}
+
+void sim_irq_enable(uint8_t irq)
+{
+    sim_irqs[irq].enabled = 1;
+    sim_irq_check();
+}
+
+void sim_irq_disable(uint8_t irq)
+{
+    sim_irqs[irq].enabled = 0;
+}
+
+uint32_t sim_irq_enabled(uint8_t irq)
+{
+    return sim_irqs[irq].enabled;
+}
+
+uint32_t sim_irq_pending(uint8_t irq)
+{
+    return sim_irq_requested(irq);
+}
+
+void sim_irq_set_pending(uint8_t irq)
+{
+    sim_irq_raise(irq);
+    sim_irq_check();
+}
+
+void sim_irq_clear_pending(uint8_t irq)
+{
+    sim_irqs[irq].latched = 0;
+}
+
+uint32_t sim_irq_active(uint8_t irq)
+{
+    return sim_isr_active == irq;
+}
+
+/* mstatus MIE/MPIE: set and clear bits, returns the previous value */
+uint32_t sim_irq_global(uint32_t set, uint32_t clear)
+{
+    uint32_t prev = sim_mie ? 0x88 : 0;
+
+    if (clear & 0x08) {
+        sim_mie = 0;
+    }
+    if (set & 0x08) {
+        sim_mie = 1;
+        sim_irq_check();
+    }
+    return prev;
+}
+
+/* Whether any interrupt is enabled in the PFIC, a WFI can only end on one */
+static uint8_t sim_irq_any_enabled(void)
+{
+    for (uint8_t irq = 0; irq < SIM_IRQ_MAX; irq++) {
+        if (sim_irqs[irq].enabled) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint8_t sim_wait_irq(uint64_t limit)
+{
+    uint32_t dispatches = sim_dispatches;
+
+    if (limit == UINT64_MAX && !sim_irq_any_enabled()) {
+        sim_fatal("WFI with every interrupt disabled, the core never wakes");
+    }
+    for (;;) {
+        uint64_t next;
+
+        sim_sync();
+        if (sim_irq_next() != SIM_IRQ_MAX) {
+            /* wakes the core, taken right away if interrupts are on */
+            sim_irq_check();
+            return 1;
+        }
+        next = sim_models_next();
+        if (next >= limit) {
+            if (limit == UINT64_MAX) {
+                sim_fatal("waiting for an interrupt that can never come");
+            }
+            sim_advance_to(limit);
+            return sim_dispatches != dispatches;
+        }
+        sim_advance_to(next > sim_now ? next : sim_now + 1);
+        if (sim_dispatches != dispatches) {
+            return 1;
+        }
+    }
+}
+
+void sim_wfi(void)
+{
+    sim_wait_irq(UINT64_MAX);
+}
+
+void sim_reset(void)
+{
+    sim_fatal("PFIC_SystemReset()");
+}
+
+uint8_t sim_sleeping(void)
+{
+    return sim_asleep;
+}
+
+SysTick_Type *sim_systick(void)
+{
+    sim_systick_regs.CNT = sim_now * (GetSysClock() / 1000000) / 1000;
+    return &sim_systick_regs;
+}
+
+/*********************************************************************
+ * FIRMWARE COROUTINE
+ */
+
+static void sim_main_entry(void)
+{
+    sim_fw_entry();
+    sim_fatal("main() returned");
+}
+
+void sim_main_start(int (*entry)(void))
+{
+    static uint8_t *stack;
+
+    if (!stack) {
+        stack = malloc(SIM_MAIN_STACK);
+    }
+    sim_fw_entry = entry;
+    getcontext(&sim_fw_ctx);
+    sim_fw_ctx.uc_stack.ss_sp = stack;
+    sim_fw_ctx.uc_stack.ss_size = SIM_MAIN_STACK;
+    sim_fw_ctx.uc_link = NULL;
+    makecontext(&sim_fw_ctx, sim_main_entry, 0);
+}
+
+void sim_main_run(uint64_t ns)
+{
+    sim_run_limit = sim_now + ns;
+    sim_fw_running = 1;
+    swapcontext(&sim_host_ctx, &sim_fw_ctx);
+    sim_fw_running = 0;
+}
+
+void sim_main_yield(void)
+{
+    if (sim_fw_running && sim_now >= sim_run_limit) {
+        swapcontext(&sim_fw_ctx, &sim_host_ctx);
+    }
+}
+
+/* TMOS_SystemProcess() of sim_tmos.c */
+void TMOS_SystemProcess(void);
+
+void sim_tmos_run(uint64_t ns)
+{
+    sim_run_limit = sim_now + ns;
+    sim_tmos_running = 1;
+    while (sim_now < sim_run_limit) {
+        TMOS_SystemProcess();
+    }
+    sim_tmos_running = 0;
+}
+
+uint64_t sim_run_limit_get(void)
+{
+    return (sim_fw_running || sim_tmos_running) ? sim_run_limit : UINT64_MAX;
+}
+
+/*********************************************************************
+ * BUSY LOOPS
+ */
+
+uint8_t sim_fw_code(uintptr_t pc)
+{
+    return (pc >= (uintptr_t)__start_sim_highcode && pc < (uintptr_t)__stop_sim_highcode) ||
+           (pc >= (uintptr_t)__start_sim_fw_text && pc < (uintptr_t)__stop_sim_fw_text);
+}
+
+uintptr_t sim_signal_pc(const void *ctx)
+{
+    return (uintptr_t)((const ucontext_t *)ctx)->uc_mcontext.gregs[SIM_REG_RIP];
+}
+
+/* Firmware waiting on a variable an interrupt handler sets never reaches a
+ * register: let time pass when the timer finds it in firmware code in
+ * thread mode, the simulation itself is not interrupted */
+static void sim_spin_check(int sig, siginfo_t *info, void *ctx)
+{
+    (void)sig, (void)info;
+    if (sim_advancing || sim_isr_active != 0xFF || !sim_fw_code(sim_signal_pc(ctx))) {
+        return;
+    }
+    sim_advance(SIM_SPIN_NS);
+}
+
+static void sim_spin_start(void)
+{
+    struct sigaction sa;
+    struct sigevent sev;
+    struct itimerspec its;
+    timer_t timer;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sim_spin_check;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo = SIGUSR1;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_nsec = SIM_SPIN_PERIOD;
+    its.it_interval.tv_nsec = SIM_SPIN_PERIOD;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &timer) || timer_settime(timer, 0, &its, NULL)) {
+        fprintf(stderr, "sim: cannot start the busy loop timer\n");
+        exit(2);
+    }
+}
+
+/*********************************************************************
+ * REGISTER MEMORY
+ */
+
+static void sim_map(unsigned long base, size_t size)
+{
+    void *p = mmap((void *)base, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (p != (void *)base) {
+        fprintf(stderr, "sim: cannot map registers at 0x%lx\n", base);
+        exit(2);
+    }
+}
+
+__attribute__((constructor(101)))
+static void sim_init(void)
+{
+    sim_map(SIM_SFR_BASE, SIM_SFR_SIZE);
+    sim_map(SIM_ROM_CFG_BASE, SIM_ROM_CFG_SIZE);
+
+    /* reset values the firmware depends on */
+    R32_CLK_SYS_CFG = 5;                                    // HSE / 5 = 6.4MHz after reset
+    R8_UART1_LSR = RB_LSR_TX_ALL_EMP;
+    R32_PB_PIN = bSDA | bSCL;                               // pulled up bus
+    *(volatile uint32_t *)ROM_CFG_TMP_25C = (25 << 16) | SIM_ROM_TMP_25C;
+    memset(sim_eeprom, 0xFF, sizeof(sim_eeprom));
+
+    sim_model_register(&sim_rtc_model);
+
+    signal(SIGALRM, sim_wall_limit);
+    alarm(SIM_WALL_LIMIT);
+    sim_spin_start();
+    setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+/*********************************************************************
+ * SYSTEM LIBRARY STAND-INS (CH59x_sys.c, CH59x_clk.c, CH59x_pwr.c)
+ */
+
+void SetSysClock(SYS_CLKTypeDef sc)
+{
+    sim_io();
+    R32_CLK_SYS_CFG = sc;
+}
+
+uint32_t GetSysClock(void)
+{
+    uint16_t rev = R32_CLK_SYS_CFG & 0xff;
+
+    if ((rev & 0x40) == (0 << 6)) {
+        return (32000000 / (rev & 0x1f));
+    } else if ((rev & RB_CLK_SYS_MOD) == (1 << 6)) {
+        return (480000000 / (rev & 0x1f));
+    } else {
+        return (32000);
+    }
+}
+
+/* As CH59x_sys.c: saves the enables of interrupts 8 and up (PFIC->ISR) and
+ * clears every one of them (PFIC->IRER), mstatus.MIE is left as it is, so
+ * no interrupt can wake a WFI in between */
+void SYS_DisableAllIrq(uint32_t *pirqv)
+{
+    uint32_t irqv = 0;
+
+    for (uint8_t irq = 8; irq < SIM_IRQ_MAX; irq++) {
+        if (sim_irqs[irq].enabled) {
+            irqv |= 1UL << (irq - 8);
+        }
+        sim_irqs[irq].enabled = 0;
+    }
+    *pirqv = irqv;
+}
+
+/* Sets the saved enables again (PFIC->IENR) */
+void SYS_RecoverIrq(uint32_t irq_status)
+{
+    for (uint8_t irq = 8; irq < SIM_IRQ_MAX; irq++) {
+        if (irq_status & (1UL << (irq - 8))) {
+            sim_irqs[irq].enabled = 1;
+        }
+    }
+    sim_irq_check();
+}
+
+uint32_t SYS_GetSysTickCnt(void)
+{
+    sim_io();
+    return (uint32_t)sim_systick()->CNT;
+}
+
+void mDelayuS(uint16_t t)
+{
+    sim_advance(SIM_US(t));
+}
+
+void mDelaymS(uint16_t t)
+{
+    sim_advance(SIM_MS(t));
+}
+
+uint32_t RTC_GetCycle32k(void)
+{
+    sim_io();
+    return sim_rtc_count();
+}
+
+void RTC_InitTime(uint16_t y, uint16_t mon, uint16_t d, uint16_t h, uint16_t m, uint16_t s)
+{
+    (void)y, (void)mon, (void)d, (void)h, (void)m, (void)s;
+    sim_io();
+}
+
+void Calibration_LSI(Cali_LevelTypeDef cali_Lv)
+{
+    (void)cali_Lv;
+    sim_advance(SIM_MS(1));
+}
+
+void LSECFG_Current(LSECurrentTypeDef c)
+{
+    (void)c;
+    sim_io();
+}
+
+void HSECFG_Current(HSECurrentTypeDef c)
+{
+    (void)c;
+    sim_io();
+}
+
+void PWR_DCDCCfg(FunctionalState s)
+{
+    (void)s;
+    sim_io();
+}
+
+void PWR_PeriphClkCfg(FunctionalState s, uint16_t perph)
+{
+    uint32_t sleep_ctrl = R32_SLEEP_CONTROL;
+
+    if (s == DISABLE) {
+        sleep_ctrl |= perph;
+    } else {
+        sleep_ctrl &= ~perph;
+    }
+    sim_io();
+    R32_SLEEP_CONTROL = sleep_ctrl;
+}
+
+void LowPower_Idle(void)
+{
+    uint64_t start = sim_now;
+
+    sim_wait_irq(UINT64_MAX);
+    sim_idle_ns += sim_now - start;
+}
+
+/* Sleep until an enabled interrupt is requested, then take the wake up time
+ * before its handler runs */
+void LowPower_Sleep(uint16_t rm)
+{
+    uint64_t start = sim_now;
+
+    (void)rm;
+    sim_asleep = 1;
+    while (sim_irq_next() == SIM_IRQ_MAX) {
+        uint64_t next = sim_models_next();
+
+        if (next == UINT64_MAX) {
+            sim_fatal("sleeping without a wake up source");
+        }
+        sim_advance_to(next > sim_now ? next : sim_now + 1);
+    }
+    sim_sleep_ns += sim_now - start;
+    sim_asleep = 0;
+    sim_advance(SIM_WAKE_NS);
+}
+
+uint64_t sim_sleep_time(void)
+{
+    return sim_sleep_ns;
+}
+
+uint64_t sim_idle_time(void)
+{
+    return sim_idle_ns;
+}
+
+void UART1_DefInit(void)
+{
+    sim_io();
+}
+
+/*********************************************************************
+ * FLASH (ISP592.h)
+ */
+
+uint32_t FLASH_EEPROM_CMD(uint8_t cmd, uint32_t StartAddr, void *Buffer, uint32_t Length)
+{
+    static const uint8_t mac[6] = { 0x84, 0xC2, 0xE4, 0x03, 0x02, 0x02 };
+
+    sim_advance(SIM_US(10));
+    switch (cmd) {
+    case CMD_GET_ROM_INFO:
+        if (StartAddr == ROM_CFG_MAC_ADDR) {
+            memcpy(Buffer, mac, sizeof(mac));
+            return 0;
+        }
+        return 1;
+    case CMD_EEPROM_READ:
+    case CMD_EEPROM_WRITE:
+    case CMD_EEPROM_ERASE:
+        if ((uint64_t)StartAddr + Length > EEPROM_MAX_SIZE) {
+            sim_fatal("data flash access 0x%x+%u out of range", StartAddr, Length);
+        }
+        if (cmd == CMD_EEPROM_READ) {
+            memcpy(Buffer, &sim_eeprom[StartAddr], Length);
+        } else if (cmd == CMD_EEPROM_WRITE) {
+            memcpy(&sim_eeprom[StartAddr], Buffer, Length);
+            sim_advance(SIM_US(30) * ((Length + 3) / 4));
+        } else {
+            memset(&sim_eeprom[StartAddr], 0xFF, Length);
+            sim_advance(SIM_MS(3));
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,261 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_gap.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Fake GAP broadcaster role: role states, advertising
+ *                      parameters and data, advertising events in simulated
+ *                      time
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "sim.h"
+#include "sim_ble.h"
+
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SIM_GAP_NOTIFY_EVT      0x0001
+#define SIM_GAP_ADV_EVT         0x0002
+
+#define SIM_GAP_NOTIFY_MAX      8
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static tmosTaskID sim_gap_task = INVALID_TASK_ID;
+static gapRolesBroadcasterCBs_t *sim_gap_cbs;
+static gapRole_States_t sim_gap_role_state = GAPROLE_INIT;
+
+/* state changes not yet passed to the application */
+static gapRole_States_t sim_gap_notify[SIM_GAP_NOTIFY_MAX];
+static uint8_t sim_gap_notify_num;
+
+static uint8_t sim_gap_enabled = TRUE;
+static uint8_t sim_gap_event_type = GAP_ADTYPE_ADV_IND;
+static uint16_t sim_gap_int_min = 160;
+static uint16_t sim_gap_int_max = 160;
+static uint16_t sim_gap_interval;           // interval of the running advertising set
+
+static uint8_t sim_gap_data[B_MAX_ADV_LEN];
+static uint16_t sim_gap_data_len;
+
+static uint32_t sim_gap_events;
+static uint32_t sim_gap_update_count;
+
+/*********************************************************************
+ * ROLE STATE
+ */
+
+static void sim_gap_set_state(gapRole_States_t state)
+{
+    sim_gap_role_state = state;
+    if (sim_gap_notify_num >= SIM_GAP_NOTIFY_MAX) {
+        sim_fatal("GAP state notifications not processed");
+    }
+    sim_gap_notify[sim_gap_notify_num++] = state;
+    tmos_set_event(sim_gap_task, SIM_GAP_NOTIFY_EVT);
+}
+
+static void sim_gap_adv_start(void)
+{
+    /* legacy advertising: 20ms .. 10.24s */
+    if (sim_gap_int_min < 32 || sim_gap_int_min > 16384 || sim_gap_int_min > sim_gap_int_max) {
+        sim_fatal("advertising interval %u..%u invalid", sim_gap_int_min, sim_gap_int_max);
+    }
+    sim_gap_interval = sim_gap_int_min;
+    sim_gap_set_state(GAPROLE_ADVERTISING);
+    tmos_start_reload_task(sim_gap_task, SIM_GAP_ADV_EVT, sim_gap_interval);
+}
+
+static void sim_gap_adv_stop(void)
+{
+    tmos_stop_task(sim_gap_task, SIM_GAP_ADV_EVT);
+    tmos_clear_event(sim_gap_task, SIM_GAP_ADV_EVT);
+    sim_gap_interval = 0;
+    sim_gap_set_state(GAPROLE_WAITING);
+}
+
+static tmosEvents sim_gap_process_event(tmosTaskID task_id, tmosEvents events)
+{
+    (void)task_id;
+
+    if (events & SIM_GAP_NOTIFY_EVT) {
+        /* the callback may change the state again, appending to the queue */
+        while (sim_gap_notify_num) {
+            gapRole_States_t state = sim_gap_notify[0];
+
+            sim_gap_notify_num--;
+            memmove(&sim_gap_notify[0], &sim_gap_notify[1], sim_gap_notify_num * sizeof(state));
+            if (sim_gap_cbs && sim_gap_cbs->pfnStateChange) {
+                sim_gap_cbs->pfnStateChange(state);
+            }
+        }
+        return events ^ SIM_GAP_NOTIFY_EVT;
+    }
+
+    if (events & SIM_GAP_ADV_EVT) {
+        /* the radio sends the packet on the three advertising channels */
+        sim_gap_events++;
+        sim_advance(SIM_ADV_EVENT_NS);
+        return events ^ SIM_GAP_ADV_EVT;
+    }
+
+    return 0;
+}
+
+/*********************************************************************
+ * LIBRARY
+ */
+
+bStatus_t GAPRole_BroadcasterInit(void)
+{
+    if (sim_gap_task == INVALID_TASK_ID) {
+        sim_gap_task = TMOS_ProcessEventRegister(sim_gap_process_event);
+    }
+    return SUCCESS;
+}
+
+bStatus_t GAPRole_BroadcasterStartDevice(gapRolesBroadcasterCBs_t *pAppCallbacks)
+{
+    if (sim_gap_task == INVALID_TASK_ID || sim_gap_role_state != GAPROLE_INIT) {
+        return FAILURE;
+    }
+    sim_gap_cbs = pAppCallbacks;
+    sim_gap_set_state(GAPROLE_STARTED);
+    if (sim_gap_enabled) {
+        sim_gap_adv_start();
+    }
+    return SUCCESS;
+}
+
+bStatus_t GAPRole_SetParameter(uint16_t param, uint16_t len, void *pValue)
+{
+    switch (param) {
+    case GAPROLE_ADVERT_ENABLED:
+        if (len != sizeof(uint8_t)) {
+            return FAILURE;
+        }
+        sim_gap_enabled = *(uint8_t *)pValue;
+        if (sim_gap_role_state == GAPROLE_INIT) {
+            break;
+        }
+        if (sim_gap_enabled && sim_gap_role_state != GAPROLE_ADVERTISING) {
+            sim_gap_adv_start();
+        } else if (!sim_gap_enabled && sim_gap_role_state == GAPROLE_ADVERTISING) {
+            sim_gap_adv_stop();
+        }
+        break;
+
+    case GAPROLE_ADV_EVENT_TYPE:
+        if (len != sizeof(uint8_t)) {
+            return FAILURE;
+        }
+        sim_gap_event_type = *(uint8_t *)pValue;
+        break;
+
+    case GAPROLE_ADVERT_DATA:
+        if (len > B_MAX_ADV_LEN) {
+            return FAILURE;
+        }
+        memcpy(sim_gap_data, pValue, len);
+        sim_gap_data_len = len;
+        break;
+
+    default:
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+bStatus_t GAPRole_GetParameter(uint16_t param, void *pValue)
+{
+    switch (param) {
+    case GAPROLE_STATE:
+        *(uint8_t *)pValue = (uint8_t)sim_gap_role_state;
+        break;
+
+    case GAPROLE_ADVERT_ENABLED:
+        *(uint8_t *)pValue = sim_gap_enabled;
+        break;
+
+    case GAPROLE_ADV_EVENT_TYPE:
+        *(uint8_t *)pValue = sim_gap_event_type;
+        break;
+
+    case GAPROLE_ADVERT_DATA:
+        memcpy(pValue, sim_gap_data, sim_gap_data_len);
+        break;
+
+    default:
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+bStatus_t GAP_SetParamValue(uint16_t paramID, uint16_t paramValue)
+{
+    switch (paramID) {
+    case TGAP_DISC_ADV_INT_MIN:
+        sim_gap_int_min = paramValue;
+        break;
+
+    case TGAP_DISC_ADV_INT_MAX:
+        sim_gap_int_max = paramValue;
+        break;
+
+    default:
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+bStatus_t GAP_UpdateAdvertisingData(uint8_t taskID, uint8_t adType, uint16_t dataLen, uint8_t *pAdvertData)
+{
+    (void)taskID;
+
+    if (dataLen > B_MAX_ADV_LEN) {
+        return FAILURE;
+    }
+    /* adType FALSE is the scan response, not modelled for a broadcaster */
+    if (adType) {
+        memcpy(sim_gap_data, pAdvertData, dataLen);
+        sim_gap_data_len = dataLen;
+    }
+    sim_gap_update_count++;
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+uint32_t sim_gap_state(void)
+{
+    return sim_gap_role_state;
+}
+
+uint16_t sim_gap_adv_interval(void)
+{
+    return sim_gap_interval;
+}
+
+const uint8_t *sim_gap_adv_data(uint16_t *len)
+{
+    *len = sim_gap_data_len;
+    return sim_gap_data;
+}
+
+uint32_t sim_gap_adv_events(void)
+{
+    return sim_gap_events;
+}
+
+uint32_t sim_gap_updates(void)
+{
+    return sim_gap_update_count;
+}
@@ -0,0 +1,911 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_i2c.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Register level model of the I2C peripheral: flags set
+ *                      and cleared by the same access sequences as the
+ *                      hardware, bus events at the bit rate of
+ *                      R16_I2C_CKCFGR, devices attached to the bus, a host
+ *                      master addressing the CH592 as slave, injected bus
+ *                      errors and a device holding SDA low
+ *******************************************************************************/
+
+#include "CH59x_common.h"
+#include "sim.h"
+#include "sim_i2c.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* I2C clock gate: RB_SLP_CLK_I2C of R8_SLP_CLK_OFF1, second byte of R32_SLEEP_CONTROL */
+#define SIM_I2C_SLP_CLK         ((uint32_t)RB_SLP_CLK_I2C << 8)
+
+/* STAR1 flags cleared by writing 0 */
+#define SIM_I2C_RC_W0           (RB_I2C_BERR | RB_I2C_ARLO | RB_I2C_AF | RB_I2C_OVR | \
+                                 RB_I2C_PECERR | RB_I2C_TIMEOUT | RB_I2C_SMBALERT)
+
+/* STAR1 flags behind ITEVTEN, ITBUFEN and ITERREN */
+#define SIM_I2C_EVT_FLAGS       (RB_I2C_SB | RB_I2C_ADDR | RB_I2C_BTF | RB_I2C_ADD10 | RB_I2C_STOPF)
+#define SIM_I2C_BUF_FLAGS       (RB_I2C_TxE | RB_I2C_RxNE)
+#define SIM_I2C_ERR_FLAGS       SIM_I2C_RC_W0
+
+#define SIM_I2C_NONE            0xFF
+#define SIM_I2C_TRACE_LEN       4096
+
+/* Bit time of the host master (ns), 400kHz */
+#define SIM_I2C_HOST_BIT_NS     2500
+
+/* Longest the host master waits for the CH592 to release SCL (ns) */
+#define SIM_I2C_HOST_STRETCH_NS SIM_MS(10)
+
+/* Bytes the master that won arbitration still sends before its STOP */
+#define SIM_I2C_LOST_BYTES      2
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/* Where the master is on the bus */
+typedef enum {
+    SIM_I2C_IDLE,           // bus free, or waiting for START
+    SIM_I2C_START,          // START or repeated START going out
+    SIM_I2C_SB,             // START sent, SCL held until the address is written
+    SIM_I2C_ADDR,           // address byte and its ACK on the wire
+    SIM_I2C_ADDR_HOLD,      // address acknowledged, SCL held until ADDR is cleared
+    SIM_I2C_TX,             // data byte and its ACK on the wire
+    SIM_I2C_TX_HOLD,        // shift register and DATAR empty, SCL held
+    SIM_I2C_RX,             // data bits coming in
+    SIM_I2C_RX_HOLD,        // byte in, DATAR still full (BTF), SCL held before ACK
+    SIM_I2C_RX_ACK,         // ACK bit of a received byte
+    SIM_I2C_NACK_HOLD,      // NACK sent or received, waiting for STOP or START
+    SIM_I2C_STOP,           // STOP going out
+} sim_i2c_phase_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint16_t sim_i2c_regs[SIM_I2C_REGS];
+static uint8_t sim_i2c_dr;                  // DATAR
+static uint8_t sim_i2c_dr_full;             // DATAR written, not yet in the shift register
+
+/* Register access handed out by sim_i2c_reg(), folded in on the next sync */
+static volatile uint16_t sim_i2c_cells[SIM_I2C_REGS];
+static uint8_t sim_i2c_pending = SIM_I2C_NONE;
+static uint16_t sim_i2c_published;
+static uint16_t sim_i2c_snap;               // STAR1 as last read, for the clear sequences
+
+static sim_i2c_phase_t sim_i2c_phase;
+static uint64_t sim_i2c_due = UINT64_MAX;
+static uint64_t sim_i2c_free_at;            // bus free time after the last STOP
+static uint8_t sim_i2c_shift;               // byte on the wire
+static uint8_t sim_i2c_addr;                // address byte of the transaction
+static uint8_t sim_i2c_ack;                 // ACK sampled for the received byte
+
+static sim_i2c_dev_t *sim_i2c_devs;
+static sim_i2c_dev_t *sim_i2c_dev;          // device addressed
+
+/* Host master and the CH592 as its slave */
+static uint8_t sim_i2c_host_busy;           // host master owns the bus
+static uint8_t sim_i2c_slave;               // CH592 addressed by the host
+
+/* Faults */
+static uint16_t sim_i2c_inject_flags;       // error flags for the next master byte
+static uint64_t sim_i2c_other_end = UINT64_MAX; // STOP of the master that won arbitration
+static uint8_t sim_i2c_sda_stuck;           // SCL pulses until SDA is let go, 0 if free
+static uint8_t sim_i2c_scl_driven;          // SCL driven low as GPIO
+
+static char sim_i2c_trace_buf[SIM_I2C_TRACE_LEN];
+static size_t sim_i2c_trace_len;
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define STAR1   sim_i2c_regs[SIM_I2C_STAR1]
+#define STAR2   sim_i2c_regs[SIM_I2C_STAR2]
+#define CTRL1   sim_i2c_regs[SIM_I2C_CTRL1]
+#define CTRL2   sim_i2c_regs[SIM_I2C_CTRL2]
+
+static uint8_t sim_i2c_clocked(void)
+{
+    return !(R32_SLEEP_CONTROL & SIM_I2C_SLP_CLK);
+}
+
+static uint8_t sim_i2c_enabled(void)
+{
+    return sim_i2c_clocked() && (CTRL1 & RB_I2C_PE);
+}
+
+/* Bus taken by someone else: the host master or a device holding SDA */
+static uint8_t sim_i2c_bus_taken(void)
+{
+    return sim_i2c_host_busy || sim_i2c_sda_stuck || sim_i2c_other_end != UINT64_MAX;
+}
+
+static void sim_i2c_trace_add(const char *fmt, uint8_t a, char ack)
+{
+    char tok[8];
+    int n = snprintf(tok, sizeof(tok), fmt, a, ack);
+
+    if (sim_i2c_trace_len + n + 2 < SIM_I2C_TRACE_LEN) {
+        if (sim_i2c_trace_len) {
+            sim_i2c_trace_buf[sim_i2c_trace_len++] = ' ';
+        }
+        memcpy(&sim_i2c_trace_buf[sim_i2c_trace_len], tok, n + 1);
+        sim_i2c_trace_len += n;
+    }
+}
+
+uint32_t sim_i2c_bit_ns(void)
+{
+    uint16_t ccr = sim_i2c_regs[SIM_I2C_CKCFGR];
+    uint32_t freq = CTRL2 & RB_I2C_FREQ;
+    uint32_t mult;
+
+    if (!freq || !(ccr & RB_I2C_CCR)) {
+        return 10000;
+    }
+    if (ccr & RB_I2C_F_S) {
+        mult = (ccr & RB_I2C_DUTY) ? 25 : 3;
+    } else {
+        mult = 2;
+    }
+    return (ccr & RB_I2C_CCR) * mult * 1000 / freq;
+}
+
+static void sim_i2c_schedule(sim_i2c_phase_t phase, uint64_t ns)
+{
+    sim_i2c_phase = phase;
+    sim_i2c_due = sim_time() + ns;
+}
+
+static void sim_i2c_hold(sim_i2c_phase_t phase)
+{
+    sim_i2c_phase = phase;
+    sim_i2c_due = UINT64_MAX;
+}
+
+static void sim_i2c_reset(void)
+{
+    memset(sim_i2c_regs, 0, sizeof(sim_i2c_regs));
+    sim_i2c_dr = 0;
+    sim_i2c_dr_full = 0;
+    sim_i2c_snap = 0;
+    sim_i2c_hold(SIM_I2C_IDLE);
+}
+
+/* Peripheral disabled or reset in the middle of a transaction: it lets go
+ * of the lines, the device sees the transaction end */
+static void sim_i2c_release(void)
+{
+    if (sim_i2c_dev) {
+        sim_i2c_dev->stop(sim_i2c_dev);
+        sim_i2c_dev = NULL;
+    }
+    STAR1 = 0;
+    STAR2 = sim_i2c_bus_taken() ? RB_I2C_BUSY : 0;
+    CTRL1 &= ~(RB_I2C_START | RB_I2C_STOP);
+    sim_i2c_slave = 0;
+    sim_i2c_hold(SIM_I2C_IDLE);
+}
+
+/*********************************************************************
+ * BUS
+ */
+
+/* SCL is held: go on with a pending STOP or START */
+static void sim_i2c_kick(void)
+{
+    uint32_t half = sim_i2c_bit_ns() / 2;
+
+    switch (sim_i2c_phase) {
+    case SIM_I2C_IDLE:
+        /* STOP without a transaction is dropped */
+        CTRL1 &= ~RB_I2C_STOP;
+        if (CTRL1 & RB_I2C_START) {
+            uint64_t now = sim_time();
+
+            if (sim_i2c_bus_taken()) {
+                /* START waits for the bus to be free */
+                sim_i2c_hold(SIM_I2C_START);
+            } else {
+                sim_i2c_phase = SIM_I2C_START;
+                sim_i2c_due = (sim_i2c_free_at > now ? sim_i2c_free_at : now) + half;
+            }
+        }
+        break;
+
+    case SIM_I2C_TX_HOLD:
+    case SIM_I2C_NACK_HOLD:
+        if (CTRL1 & RB_I2C_STOP) {
+            sim_i2c_schedule(SIM_I2C_STOP, half);
+        } else if (CTRL1 & RB_I2C_START) {
+            sim_i2c_schedule(SIM_I2C_START, half);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* The bus became free: a START waiting for it goes out */
+static void sim_i2c_bus_free(void)
+{
+    if (sim_i2c_bus_taken()) {
+        return;
+    }
+    STAR2 &= ~RB_I2C_BUSY;
+    sim_i2c_free_at = sim_time() + sim_i2c_bit_ns();
+    if (sim_i2c_phase == SIM_I2C_START && sim_i2c_due == UINT64_MAX) {
+        sim_i2c_phase = SIM_I2C_IDLE;
+    }
+    sim_i2c_kick();
+}
+
+/*
+ * Error flags injected for this byte. ARLO: another master won the
+ * arbitration, ours drops to slave while the winner finishes. BERR: a
+ * misplaced START or STOP, the master holds the bus until it sends STOP.
+ * Returns 1 if the byte was cut short.
+ */
+static uint8_t sim_i2c_inject_check(void)
+{
+    uint16_t flags = sim_i2c_inject_flags;
+
+    if (!flags) {
+        return 0;
+    }
+    sim_i2c_inject_flags = 0;
+    STAR1 |= flags;
+
+    if (flags & RB_I2C_ARLO) {
+        sim_i2c_trace_add("ARLO", 0, 0);
+        if (sim_i2c_dev) {
+            sim_i2c_dev->stop(sim_i2c_dev);
+            sim_i2c_dev = NULL;
+        }
+        STAR1 &= ~(RB_I2C_SB | RB_I2C_ADDR | RB_I2C_TxE | RB_I2C_BTF);
+        STAR2 &= ~(RB_I2C_MSL | RB_I2C_TRA);
+        sim_i2c_dr_full = 0;
+        sim_i2c_other_end = sim_time() + SIM_I2C_LOST_BYTES * 9 * sim_i2c_bit_ns();
+        sim_i2c_hold(SIM_I2C_IDLE);
+        return 1;
+    }
+    if (flags & RB_I2C_BERR) {
+        sim_i2c_trace_add("BERR", 0, 0);
+        sim_i2c_hold(SIM_I2C_NACK_HOLD);
+        sim_i2c_kick();
+        return 1;
+    }
+    return 0;
+}
+
+/* The master that won the arbitration sent its STOP */
+static void sim_i2c_other_done(void)
+{
+    sim_i2c_other_end = UINT64_MAX;
+    sim_i2c_trace_add("P", 0, 0);
+    sim_i2c_bus_free();
+}
+
+/* DATAR to the shift register */
+static void sim_i2c_tx_load(void)
+{
+    sim_i2c_shift = sim_i2c_dr;
+    sim_i2c_dr_full = 0;
+    STAR1 |= RB_I2C_TxE;
+    STAR1 &= ~RB_I2C_BTF;
+    sim_i2c_schedule(SIM_I2C_TX, 9 * sim_i2c_bit_ns());
+}
+
+static void sim_i2c_start_done(void)
+{
+    uint8_t repeated = (STAR2 & RB_I2C_BUSY) != 0;
+
+    sim_i2c_trace_add(repeated ? "Sr" : "S", 0, 0);
+    CTRL1 &= ~RB_I2C_START;
+    STAR1 &= ~(RB_I2C_TxE | RB_I2C_BTF | RB_I2C_RxNE);
+    STAR1 |= RB_I2C_SB;
+    STAR2 = (STAR2 & ~RB_I2C_TRA) | RB_I2C_MSL | RB_I2C_BUSY;
+    /* a byte written ahead of SB is lost */
+    sim_i2c_dr_full = 0;
+    sim_i2c_hold(SIM_I2C_SB);
+}
+
+static void sim_i2c_addr_done(void)
+{
+    sim_i2c_dev_t *dev;
+    uint8_t read = sim_i2c_addr & 1, ack;
+
+    if (sim_i2c_inject_check()) {
+        return;
+    }
+    for (dev = sim_i2c_devs; dev; dev = dev->link) {
+        if (dev->addr == (sim_i2c_addr >> 1)) {
+            break;
+        }
+    }
+    if (sim_i2c_dev && sim_i2c_dev != dev) {
+        sim_i2c_dev->stop(sim_i2c_dev);
+    }
+    sim_i2c_dev = dev;
+    ack = dev && dev->start(dev, read);
+    sim_i2c_trace_add(read ? "R%02X%c" : "W%02X%c", sim_i2c_addr >> 1, ack ? '+' : '-');
+
+    if (!ack) {
+        STAR1 |= RB_I2C_AF;
+        sim_i2c_hold(SIM_I2C_NACK_HOLD);
+        sim_i2c_kick();
+        return;
+    }
+    STAR1 |= RB_I2C_ADDR;
+    if (read) {
+        STAR2 &= ~RB_I2C_TRA;
+    } else {
+        STAR2 |= RB_I2C_TRA;
+    }
+    sim_i2c_hold(SIM_I2C_ADDR_HOLD);
+}
+
+/* ADDR cleared: the data phase starts */
+static void sim_i2c_addr_cleared(void)
+{
+    if (sim_i2c_slave) {
+        /* slave transmitter: the host clocks the bytes out of DATAR */
+        if (STAR2 & RB_I2C_TRA) {
+            STAR1 |= RB_I2C_TxE;
+        }
+        return;
+    }
+    if (STAR2 & RB_I2C_TRA) {
+        STAR1 |= RB_I2C_TxE;
+        sim_i2c_hold(SIM_I2C_TX_HOLD);
+        if (sim_i2c_dr_full) {
+            sim_i2c_tx_load();
+        }
+    } else {
+        sim_i2c_schedule(SIM_I2C_RX, 8 * sim_i2c_bit_ns());
+    }
+}
+
+static void sim_i2c_tx_done(void)
+{
+    uint8_t ack;
+
+    if (sim_i2c_inject_check()) {
+        return;
+    }
+    ack = sim_i2c_dev && sim_i2c_dev->write(sim_i2c_dev, sim_i2c_shift);
+    sim_i2c_trace_add("%02X%c", sim_i2c_shift, ack ? '+' : '-');
+    if (!ack) {
+        STAR1 |= RB_I2C_AF;
+        sim_i2c_hold(SIM_I2C_NACK_HOLD);
+        sim_i2c_kick();
+        return;
+    }
+    /* STOP and START are sent after the current byte, ahead of DATAR */
+    if (CTRL1 & (RB_I2C_STOP | RB_I2C_START)) {
+        sim_i2c_hold(SIM_I2C_TX_HOLD);
+        sim_i2c_kick();
+    } else if (sim_i2c_dr_full) {
+        sim_i2c_tx_load();
+    } else {
+        STAR1 |= RB_I2C_BTF;
+        sim_i2c_hold(SIM_I2C_TX_HOLD);
+    }
+}
+
+/* Eight bits in: the ACK bit follows, sampled from CTRL1 as it starts */
+static void sim_i2c_rx_ack(void)
+{
+    sim_i2c_ack = (CTRL1 & RB_I2C_ACK) != 0;
+    sim_i2c_schedule(SIM_I2C_RX_ACK, sim_i2c_bit_ns());
+}
+
+static void sim_i2c_rx_done(void)
+{
+    sim_i2c_shift = sim_i2c_dev ? sim_i2c_dev->read(sim_i2c_dev) : 0xFF;
+    if (STAR1 & RB_I2C_RxNE) {
+        STAR1 |= RB_I2C_BTF;
+        sim_i2c_hold(SIM_I2C_RX_HOLD);
+        return;
+    }
+    sim_i2c_rx_ack();
+}
+
+static void sim_i2c_rx_ack_done(void)
+{
+    if (sim_i2c_inject_check()) {
+        return;
+    }
+    sim_i2c_trace_add("%02X%c", sim_i2c_shift, sim_i2c_ack ? '+' : '-');
+    sim_i2c_dr = sim_i2c_shift;
+    STAR1 |= RB_I2C_RxNE;
+
+    if (!sim_i2c_ack) {
+        sim_i2c_hold(SIM_I2C_NACK_HOLD);
+        sim_i2c_kick();
+    } else if (CTRL1 & (RB_I2C_STOP | RB_I2C_START)) {
+        sim_i2c_hold(SIM_I2C_NACK_HOLD);
+        sim_i2c_kick();
+    } else {
+        sim_i2c_schedule(SIM_I2C_RX, 8 * sim_i2c_bit_ns());
+    }
+}
+
+static void sim_i2c_stop_done(void)
+{
+    sim_i2c_trace_add("P", 0, 0);
+    if (sim_i2c_dev) {
+        sim_i2c_dev->stop(sim_i2c_dev);
+        sim_i2c_dev = NULL;
+    }
+    CTRL1 &= ~RB_I2C_STOP;
+    STAR1 &= ~(RB_I2C_TxE | RB_I2C_BTF);
+    STAR2 &= ~(RB_I2C_MSL | RB_I2C_TRA);
+    sim_i2c_hold(SIM_I2C_IDLE);
+    sim_i2c_bus_free();
+}
+
+/*********************************************************************
+ * REGISTER ACCESS
+ */
+
+static void sim_i2c_dr_write(uint8_t data)
+{
+    if (sim_i2c_phase == SIM_I2C_SB && (sim_i2c_snap & RB_I2C_SB)) {
+        /* SB cleared by STAR1 read then DATAR write: the address goes out */
+        STAR1 &= ~RB_I2C_SB;
+        sim_i2c_snap &= ~RB_I2C_SB;
+        sim_i2c_addr = data;
+        sim_i2c_schedule(SIM_I2C_ADDR, 9 * sim_i2c_bit_ns());
+        return;
+    }
+    sim_i2c_dr = data;
+    sim_i2c_dr_full = 1;
+    STAR1 &= ~(RB_I2C_TxE | RB_I2C_BTF);
+    if (sim_i2c_phase == SIM_I2C_TX_HOLD && !(CTRL1 & (RB_I2C_STOP | RB_I2C_START))) {
+        sim_i2c_tx_load();
+    }
+}
+
+static void sim_i2c_dr_read(void)
+{
+    STAR1 &= ~RB_I2C_RxNE;
+    if (sim_i2c_phase == SIM_I2C_RX_HOLD) {
+        /* the byte held by BTF moves on to its ACK bit */
+        STAR1 &= ~RB_I2C_BTF;
+        sim_i2c_rx_ack();
+    }
+}
+
+static void sim_i2c_ctrl1_write(uint16_t val)
+{
+    uint16_t old = CTRL1;
+
+    CTRL1 = val;
+    if (val & RB_I2C_SWRST) {
+        sim_i2c_release();
+        sim_i2c_reset();
+        CTRL1 = RB_I2C_SWRST;
+        return;
+    }
+    if ((old & RB_I2C_PE) && !(val & RB_I2C_PE)) {
+        sim_i2c_release();
+        return;
+    }
+    sim_i2c_kick();
+}
+
+/* Fold the access handed out last into the model */
+static void sim_i2c_access(void)
+{
+    uint8_t reg = sim_i2c_pending;
+    uint16_t val;
+    uint8_t write;
+
+    if (reg == SIM_I2C_NONE) {
+        return;
+    }
+    sim_i2c_pending = SIM_I2C_NONE;
+    val = sim_i2c_cells[reg];
+    write = (val != sim_i2c_published);
+
+    /* no clock, no register */
+    if (!sim_i2c_clocked()) {
+        return;
+    }
+
+    switch (reg) {
+    case SIM_I2C_STAR1:
+        if (write) {
+            STAR1 &= val | ~SIM_I2C_RC_W0;
+        } else {
+            sim_i2c_snap = sim_i2c_published;
+        }
+        break;
+
+    case SIM_I2C_STAR2:
+        if ((sim_i2c_snap & RB_I2C_ADDR) && (STAR1 & RB_I2C_ADDR)) {
+            STAR1 &= ~RB_I2C_ADDR;
+            sim_i2c_snap &= ~RB_I2C_ADDR;
+            sim_i2c_addr_cleared();
+        }
+        break;
+
+    case SIM_I2C_DATAR:
+        /* published with the high byte set, the firmware writes 8 bits */
+        if (write && !(val & 0xFF00)) {
+            sim_i2c_dr_write((uint8_t)val);
+        } else if (!write) {
+            sim_i2c_dr_read();
+        }
+        break;
+
+    case SIM_I2C_CTRL1:
+        if ((sim_i2c_snap & RB_I2C_STOPF) && (STAR1 & RB_I2C_STOPF)) {
+            STAR1 &= ~RB_I2C_STOPF;
+            sim_i2c_snap &= ~RB_I2C_STOPF;
+        }
+        if (write) {
+            sim_i2c_ctrl1_write(val);
+        }
+        break;
+
+    default:
+        if (write) {
+            sim_i2c_regs[reg] = val;
+        }
+        break;
+    }
+}
+
+volatile uint16_t *sim_i2c_reg(uint8_t reg)
+{
+    if (reg >= SIM_I2C_REGS) {
+        sim_fatal("I2C register %d", reg);
+    }
+    sim_io();
+    sim_i2c_access();
+
+    if (!sim_i2c_clocked()) {
+        sim_i2c_published = 0;
+    } else if (reg == SIM_I2C_DATAR) {
+        sim_i2c_published = 0xFF00 | sim_i2c_dr;
+    } else {
+        sim_i2c_published = sim_i2c_regs[reg];
+    }
+    sim_i2c_cells[reg] = sim_i2c_published;
+    sim_i2c_pending = reg;
+    return &sim_i2c_cells[reg];
+}
+
+/*********************************************************************
+ * HOST MASTER
+ */
+
+/* SCL held low by the CH592 until cond() is false, the host waits */
+static void sim_i2c_host_stretch(uint8_t (*cond)(void), const char *what)
+{
+    uint64_t limit = sim_time() + SIM_I2C_HOST_STRETCH_NS;
+
+    while (cond()) {
+        if (sim_time() >= limit) {
+            sim_fatal("I2C slave holds SCL, %s not handled", what);
+        }
+        sim_advance(SIM_US(1));
+    }
+}
+
+static uint8_t sim_i2c_addr_held(void)
+{
+    return (STAR1 & RB_I2C_ADDR) != 0;
+}
+
+static uint8_t sim_i2c_rx_held(void)
+{
+    return (STAR1 & RB_I2C_RxNE) != 0;
+}
+
+static uint8_t sim_i2c_tx_held(void)
+{
+    return !sim_i2c_dr_full;
+}
+
+/* START, or repeated START if the host already owns the bus */
+static void sim_i2c_host_start(void)
+{
+    if (sim_i2c_phase == SIM_I2C_START) {
+        /* START of the CH592 loses to ours, it goes out after our STOP */
+        sim_i2c_hold(SIM_I2C_START);
+    } else if (sim_i2c_phase != SIM_I2C_IDLE) {
+        sim_fatal("host START while the CH592 is master on the bus");
+    }
+    if (sim_i2c_sda_stuck || sim_i2c_other_end != UINT64_MAX) {
+        sim_fatal("host START on a busy bus");
+    }
+    sim_i2c_trace_add(sim_i2c_host_busy ? "Sr" : "S", 0, 0);
+    sim_i2c_host_busy = 1;
+    sim_i2c_slave = 0;
+    if (sim_i2c_clocked()) {
+        STAR2 |= RB_I2C_BUSY;
+    }
+    sim_advance(SIM_I2C_HOST_BIT_NS / 2);
+}
+
+/* Address byte: returns 1 if the CH592 acknowledged it as slave */
+static uint8_t sim_i2c_host_addr(uint8_t addr, uint8_t read)
+{
+    uint8_t own = (sim_i2c_regs[SIM_I2C_OADDR1] >> 1) & 0x7F;
+    uint8_t ack;
+
+    sim_advance(8 * SIM_I2C_HOST_BIT_NS);
+    ack = sim_i2c_enabled() && (CTRL1 & RB_I2C_ACK) && own == addr;
+    sim_i2c_trace_add(read ? "R%02X%c" : "W%02X%c", addr, ack ? '+' : '-');
+    if (!ack) {
+        sim_advance(SIM_I2C_HOST_BIT_NS);
+        return 0;
+    }
+    sim_i2c_slave = 1;
+    sim_i2c_dr_full = 0;
+    if (read) {
+        STAR2 |= RB_I2C_TRA;
+    } else {
+        STAR2 &= ~RB_I2C_TRA;
+    }
+    STAR1 |= RB_I2C_ADDR;
+    sim_i2c_host_stretch(sim_i2c_addr_held, "ADDR");
+    sim_advance(SIM_I2C_HOST_BIT_NS);
+    return 1;
+}
+
+/* Byte written to the CH592 as slave receiver: returns its ACK */
+static uint8_t sim_i2c_host_tx(uint8_t data)
+{
+    uint8_t ack;
+
+    sim_advance(8 * SIM_I2C_HOST_BIT_NS);
+    if (STAR1 & RB_I2C_RxNE) {
+        /* DATAR not read yet: the byte waits in the shift register */
+        STAR1 |= RB_I2C_BTF;
+        sim_i2c_host_stretch(sim_i2c_rx_held, "RxNE");
+        STAR1 &= ~RB_I2C_BTF;
+    }
+    sim_i2c_dr = data;
+    STAR1 |= RB_I2C_RxNE;
+    ack = (CTRL1 & RB_I2C_ACK) != 0;
+    sim_i2c_trace_add("%02X%c", data, ack ? '+' : '-');
+    sim_advance(SIM_I2C_HOST_BIT_NS);
+    return ack;
+}
+
+/* Byte read from the CH592 as slave transmitter, the host ACKs it or not */
+static uint8_t sim_i2c_host_rx(uint8_t ack)
+{
+    uint8_t data;
+
+    if (!sim_i2c_dr_full) {
+        /* nothing in DATAR yet: SCL held until it is written */
+        STAR1 |= RB_I2C_BTF;
+        sim_i2c_host_stretch(sim_i2c_tx_held, "TxE");
+    }
+    data = sim_i2c_dr;
+    sim_i2c_dr_full = 0;
+    STAR1 &= ~RB_I2C_BTF;
+    STAR1 |= RB_I2C_TxE;
+    sim_advance(8 * SIM_I2C_HOST_BIT_NS);
+    sim_i2c_trace_add("%02X%c", data, ack ? '+' : '-');
+    if (!ack) {
+        STAR1 |= RB_I2C_AF;
+    }
+    sim_advance(SIM_I2C_HOST_BIT_NS);
+    return data;
+}
+
+static void sim_i2c_host_stop(void)
+{
+    sim_i2c_trace_add("P", 0, 0);
+    if (sim_i2c_slave && !(STAR2 & RB_I2C_TRA)) {
+        /* STOPF only as slave receiver */
+        STAR1 |= RB_I2C_STOPF;
+    }
+    STAR1 &= ~(RB_I2C_TxE | RB_I2C_BTF);
+    STAR2 &= ~RB_I2C_TRA;
+    sim_i2c_dr_full = 0;
+    sim_i2c_slave = 0;
+    sim_i2c_host_busy = 0;
+    sim_i2c_bus_free();
+    sim_advance(SIM_I2C_HOST_BIT_NS);
+}
+
+/*********************************************************************
+ * MODEL
+ */
+
+/* Bus recovery clocks SCL as GPIO: each low pulse driven and released
+ * shifts one bit out of the device holding SDA */
+static void sim_i2c_gpio_sync(void)
+{
+    uint8_t driven = (R32_PB_DIR & bSCL) != 0;
+
+    if (sim_i2c_scl_driven && !driven && sim_i2c_sda_stuck) {
+        if (!--sim_i2c_sda_stuck) {
+            R32_PB_PIN |= bSDA;
+            sim_i2c_trace_add("SDA+", 0, 0);
+            sim_i2c_bus_free();
+        }
+    }
+    sim_i2c_scl_driven = driven;
+}
+
+static void sim_i2c_sync(void)
+{
+    sim_i2c_access();
+    sim_i2c_gpio_sync();
+    if (sim_sleeping() && sim_i2c_phase != SIM_I2C_IDLE && sim_i2c_phase != SIM_I2C_STOP &&
+        !(sim_i2c_phase == SIM_I2C_START && sim_i2c_due == UINT64_MAX)) {
+        sim_fatal("sleep in the middle of an I2C transaction");
+    }
+}
+
+static uint64_t sim_i2c_next(void)
+{
+    if (!sim_i2c_enabled() || sim_sleeping()) {
+        return UINT64_MAX;
+    }
+    return sim_i2c_due < sim_i2c_other_end ? sim_i2c_due : sim_i2c_other_end;
+}
+
+static void sim_i2c_step(void)
+{
+    if (sim_i2c_other_end <= sim_time()) {
+        sim_i2c_other_done();
+    }
+    if (sim_i2c_due > sim_time()) {
+        return;
+    }
+    sim_i2c_due = UINT64_MAX;
+
+    switch (sim_i2c_phase) {
+    case SIM_I2C_START:
+        sim_i2c_start_done();
+        break;
+    case SIM_I2C_ADDR:
+        sim_i2c_addr_done();
+        break;
+    case SIM_I2C_TX:
+        sim_i2c_tx_done();
+        break;
+    case SIM_I2C_RX:
+        sim_i2c_rx_done();
+        break;
+    case SIM_I2C_RX_ACK:
+        sim_i2c_rx_ack_done();
+        break;
+    case SIM_I2C_STOP:
+        sim_i2c_stop_done();
+        break;
+    default:
+        break;
+    }
+}
+
+static uint8_t sim_i2c_level(void)
+{
+    uint16_t s = STAR1, c = CTRL2;
+
+    if (!sim_i2c_enabled()) {
+        return 0;
+    }
+    if ((c & RB_I2C_ITEVTEN) &&
+        ((s & SIM_I2C_EVT_FLAGS) || ((c & RB_I2C_ITBUFEN) && (s & SIM_I2C_BUF_FLAGS)))) {
+        return 1;
+    }
+    return (c & RB_I2C_ITERREN) && (s & SIM_I2C_ERR_FLAGS);
+}
+
+static sim_model_t sim_i2c_model = {
+    .name = "i2c",
+    .sync = sim_i2c_sync,
+    .next = sim_i2c_next,
+    .step = sim_i2c_step,
+};
+
+__attribute__((constructor(102)))
+static void sim_i2c_init(void)
+{
+    sim_i2c_reset();
+    sim_model_register(&sim_i2c_model);
+    sim_irq_connect(I2C_IRQn, sim_i2c_level, NULL);
+}
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+void sim_i2c_attach(sim_i2c_dev_t *dev)
+{
+    dev->link = sim_i2c_devs;
+    sim_i2c_devs = dev;
+}
+
+void sim_i2c_detach(sim_i2c_dev_t *dev)
+{
+    for (sim_i2c_dev_t **p = &sim_i2c_devs; *p; p = &(*p)->link) {
+        if (*p == dev) {
+            *p = dev->link;
+            break;
+        }
+    }
+    if (sim_i2c_dev == dev) {
+        sim_i2c_dev = NULL;
+    }
+}
+
+int sim_i2c_host_write(uint8_t addr, const uint8_t *data, uint8_t len, uint8_t stop)
+{
+    int acked = 0;
+
+    sim_i2c_host_start();
+    if (!sim_i2c_host_addr(addr, 0)) {
+        sim_i2c_host_stop();
+        return -1;
+    }
+    while (acked < len && sim_i2c_host_tx(data[acked])) {
+        acked++;
+    }
+    if (stop || acked < len) {
+        sim_i2c_host_stop();
+    }
+    return acked;
+}
+
+int sim_i2c_host_read(uint8_t addr, uint8_t *data, uint8_t len)
+{
+    sim_i2c_host_start();
+    if (!sim_i2c_host_addr(addr, 1)) {
+        sim_i2c_host_stop();
+        return -1;
+    }
+    for (uint8_t i = 0; i < len; i++) {
+        data[i] = sim_i2c_host_rx(i + 1 < len);
+    }
+    sim_i2c_host_stop();
+    return len;
+}
+
+void sim_i2c_inject(uint16_t flags)
+{
+    sim_i2c_inject_flags = flags & SIM_I2C_RC_W0;
+}
+
+void sim_i2c_stick_sda(uint8_t clocks)
+{
+    sim_i2c_sda_stuck = clocks;
+    sim_i2c_scl_driven = (R32_PB_DIR & bSCL) != 0;
+    if (clocks) {
+        R32_PB_PIN &= ~bSDA;
+        sim_i2c_trace_add("SDA-", 0, 0);
+        if (sim_i2c_clocked()) {
+            STAR2 |= RB_I2C_BUSY;
+        }
+    }
+}
+
+const char *sim_i2c_trace(void)
+{
+    return sim_i2c_trace_buf;
+}
+
+void sim_i2c_trace_clear(void)
+{
+    sim_i2c_trace_len = 0;
+    sim_i2c_trace_buf[0] = '\0';
+}
@@ -0,0 +1,145 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_icount.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Instruction count of interrupt handlers: the x86-64 host
+ *                      single steps the handler (trap flag) and counts the
+ *                      instructions executed in firmware code, the time
+ *                      spent in the simulation itself is not stepped; and of
+ *                      a single call, C library included
+ *******************************************************************************/
+
+#include "sim.h"
+
+#include <signal.h>
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* EFLAGS.TF: trap after every instruction */
+#define SIM_ICOUNT_TF           0x100
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint8_t sim_icount_target = 0xFF;
+static void (*sim_icount_done)(uint8_t irq, uint32_t count);
+
+static uint8_t sim_icount_active;       // stepping a handler or a call
+static uint8_t sim_icount_all;          // count host code too
+static uint32_t sim_icount_paused;      // depth of sim_icount_pause()
+static uint32_t sim_icount_count;
+static uintptr_t sim_icount_prev;       // instruction executed before the trap
+
+/*********************************************************************
+ * STEPPING
+ */
+
+static void sim_icount_trap(int sig, siginfo_t *info, void *ctx)
+{
+    (void)sig, (void)info;
+    if (sim_icount_prev && (sim_icount_all || sim_fw_code(sim_icount_prev))) {
+        sim_icount_count++;
+    }
+    sim_icount_prev = sim_signal_pc(ctx);
+}
+
+static void sim_icount_step(uint8_t on)
+{
+    if (on) {
+        sim_icount_prev = 0;
+        __asm__ volatile("pushfq; orq %0, (%%rsp); popfq" : : "i"(SIM_ICOUNT_TF) : "cc", "memory");
+    } else {
+        __asm__ volatile("pushfq; andq %0, (%%rsp); popfq" : : "i"(~SIM_ICOUNT_TF) : "cc", "memory");
+    }
+}
+
+static void sim_icount_enter(uint8_t irq)
+{
+    if (irq != sim_icount_target) {
+        return;
+    }
+    sim_icount_count = 0;
+    sim_icount_paused = 0;
+    sim_icount_active = 1;
+    sim_icount_step(1);
+}
+
+static void sim_icount_leave(uint8_t irq)
+{
+    if (irq != sim_icount_target || !sim_icount_active) {
+        return;
+    }
+    sim_icount_step(0);
+    sim_icount_active = 0;
+    sim_icount_done(irq, sim_icount_count);
+}
+
+void sim_icount_pause(void)
+{
+    if (sim_icount_active && !sim_icount_paused++) {
+        sim_icount_step(0);
+    }
+}
+
+void sim_icount_resume(void)
+{
+    if (sim_icount_active && !--sim_icount_paused) {
+        sim_icount_step(1);
+    }
+}
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+static void sim_icount_install(void)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sim_icount_trap;
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTRAP, &sa, NULL);
+}
+
+void sim_icount_irq(uint8_t irq, void (*done)(uint8_t irq, uint32_t count))
+{
+    if (!done) {
+        sim_irq_hook(NULL, NULL);
+        sim_icount_target = 0xFF;
+        return;
+    }
+    sim_icount_install();
+
+    sim_icount_target = irq;
+    sim_icount_done = done;
+    sim_irq_hook(sim_icount_enter, sim_icount_leave);
+}
+
+uint32_t sim_icount_call(void (*fn)(void *arg), void *arg)
+{
+    sigset_t spin, prev;
+
+    /* the busy loop timer would step through sim_advance() in firmware code */
+    sigemptyset(&spin);
+    sigaddset(&spin, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &spin, &prev);
+    sim_icount_install();
+    sim_icount_count = 0;
+    sim_icount_paused = 0;
+    sim_icount_all = 1;
+    sim_icount_active = 1;
+    sim_icount_step(1);
+    fn(arg);
+    sim_icount_step(0);
+    sim_icount_active = 0;
+    sim_icount_all = 0;
+    sigprocmask(SIG_SETMASK, &prev, NULL);
+    return sim_icount_count;
+}
@@ -0,0 +1,219 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_sht20.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT20 model: no hold master measurements, user
+ *                      register, conversion time by resolution, CRC
+ *******************************************************************************/
+
+#include "sim.h"
+#include "sim_sensors.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SIM_SHT20_ADDR          0x40
+
+#define SIM_SHT20_TRIG_T        0xF3
+#define SIM_SHT20_TRIG_RH       0xF5
+#define SIM_SHT20_WRITE_REG     0xE6
+#define SIM_SHT20_READ_REG      0xE7
+#define SIM_SHT20_SOFT_RESET    0xFE
+
+#define SIM_SHT20_REG_DEFAULT   0x02
+#define SIM_SHT20_REG_RW        0x87    // resolution, heater, OTP reload
+
+/* Typical conversion time (us), about 3/4 of the datasheet maximum,
+ * by resolution (user register bits 7 and 0) */
+static const uint32_t sim_sht20_conv_us[4][2] = {
+    /*  T       RH */
+    { 66000, 22000 },       // RH12/T14
+    { 17000,  3000 },       // RH8/T12
+    { 33000,  7000 },       // RH10/T13
+    {  9000, 12000 },       // RH11/T11
+};
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum {
+    SIM_SHT20_CMD,          // next written byte is a command
+    SIM_SHT20_REG_DATA,     // next written byte goes to the user register
+    SIM_SHT20_IGNORE,       // further bytes not acknowledged
+} sim_sht20_rx_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static int32_t sim_sht20_temp = 2500;
+static int32_t sim_sht20_humi = 5000;
+static uint8_t sim_sht20_reg = SIM_SHT20_REG_DEFAULT;
+
+static sim_sht20_rx_t sim_sht20_rx;
+static uint8_t sim_sht20_read_reg;      // a read returns the user register
+static uint8_t sim_sht20_measuring;     // 0, or the trigger command
+static uint64_t sim_sht20_ready;        // end of the conversion
+static uint8_t sim_sht20_result[3];
+static uint8_t sim_sht20_result_valid;
+static uint8_t sim_sht20_idx;
+
+static uint32_t sim_sht20_meas_count;
+static uint32_t sim_sht20_write_count;
+
+/*********************************************************************
+ * DEVICE
+ */
+
+static uint8_t sim_sht20_crc(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0;
+
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/* Inverse of the datasheet formulas, status bit 1 set for humidity */
+static void sim_sht20_convert(uint8_t cmd)
+{
+    int64_t raw;
+
+    if (cmd == SIM_SHT20_TRIG_T) {
+        raw = ((int64_t)sim_sht20_temp + 4685) * 65536 / 17572;
+    } else {
+        raw = ((int64_t)sim_sht20_humi + 600) * 65536 / 12500;
+    }
+    raw = raw < 0 ? 0 : raw > 0xFFFF ? 0xFFFF : raw;
+    raw = (raw & 0xFFFC) | (cmd == SIM_SHT20_TRIG_RH ? 0x02 : 0x00);
+
+    sim_sht20_result[0] = raw >> 8;
+    sim_sht20_result[1] = raw & 0xFF;
+    sim_sht20_result[2] = sim_sht20_crc(sim_sht20_result, 2);
+    sim_sht20_result_valid = 1;
+    sim_sht20_meas_count++;
+}
+
+static uint8_t sim_sht20_busy(void)
+{
+    if (sim_sht20_measuring && sim_time() >= sim_sht20_ready) {
+        sim_sht20_convert(sim_sht20_measuring);
+        sim_sht20_measuring = 0;
+    }
+    return sim_sht20_measuring != 0;
+}
+
+static uint8_t sim_sht20_start(sim_i2c_dev_t *dev, uint8_t read)
+{
+    (void)dev;
+
+    /* no hold master: the address is not acknowledged while converting */
+    if (sim_sht20_busy()) {
+        return 0;
+    }
+    sim_sht20_idx = 0;
+    if (!read) {
+        sim_sht20_rx = SIM_SHT20_CMD;
+        sim_sht20_read_reg = 0;
+        return 1;
+    }
+    return sim_sht20_read_reg || sim_sht20_result_valid;
+}
+
+static uint8_t sim_sht20_write(sim_i2c_dev_t *dev, uint8_t data)
+{
+    uint8_t res = ((sim_sht20_reg >> 6) & 0x02) | (sim_sht20_reg & 0x01);
+
+    (void)dev;
+    switch (sim_sht20_rx) {
+    case SIM_SHT20_CMD:
+        sim_sht20_rx = SIM_SHT20_IGNORE;
+        switch (data) {
+        case SIM_SHT20_TRIG_T:
+        case SIM_SHT20_TRIG_RH:
+            sim_sht20_result_valid = 0;
+            sim_sht20_measuring = data;
+            sim_sht20_ready = sim_time() + SIM_US(sim_sht20_conv_us[res][data == SIM_SHT20_TRIG_RH]);
+            return 1;
+        case SIM_SHT20_WRITE_REG:
+            sim_sht20_rx = SIM_SHT20_REG_DATA;
+            return 1;
+        case SIM_SHT20_READ_REG:
+            sim_sht20_read_reg = 1;
+            return 1;
+        case SIM_SHT20_SOFT_RESET:
+            sim_sht20_reg = SIM_SHT20_REG_DEFAULT;
+            sim_sht20_result_valid = 0;
+            return 1;
+        default:
+            return 0;
+        }
+
+    case SIM_SHT20_REG_DATA:
+        sim_sht20_rx = SIM_SHT20_IGNORE;
+        sim_sht20_reg = (sim_sht20_reg & ~SIM_SHT20_REG_RW) | (data & SIM_SHT20_REG_RW);
+        sim_sht20_write_count++;
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+static uint8_t sim_sht20_read(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    if (sim_sht20_read_reg) {
+        return sim_sht20_reg;
+    }
+    if (sim_sht20_result_valid && sim_sht20_idx < sizeof(sim_sht20_result)) {
+        return sim_sht20_result[sim_sht20_idx++];
+    }
+    return 0xFF;
+}
+
+static void sim_sht20_stop(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    sim_sht20_rx = SIM_SHT20_IGNORE;
+}
+
+static sim_i2c_dev_t sim_sht20_dev = {
+    .addr = SIM_SHT20_ADDR,
+    .start = sim_sht20_start,
+    .write = sim_sht20_write,
+    .read = sim_sht20_read,
+    .stop = sim_sht20_stop,
+};
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+sim_i2c_dev_t *sim_sht20(void)
+{
+    return &sim_sht20_dev;
+}
+
+void sim_sht20_set(int32_t temp, int32_t humi)
+{
+    sim_sht20_temp = temp;
+    sim_sht20_humi = humi;
+}
+
+uint32_t sim_sht20_measurements(void)
+{
+    return sim_sht20_meas_count;
+}
+
+uint32_t sim_sht20_reg_writes(void)
+{
+    return sim_sht20_write_count;
+}
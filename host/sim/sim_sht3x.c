@@ -0,0 +1,279 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_sht3x.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT3x model: single shot without clock stretching,
+ *                      periodic measurement and fetch, break, heater,
+ *                      status register, CRC
+ *******************************************************************************/
+
+#include "sim.h"
+#include "sim_sensors.h"
+
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SIM_SHT3X_ADDR          0x44
+
+#define SIM_SHT3X_FETCH         0xE000
+#define SIM_SHT3X_BREAK         0x3093
+#define SIM_SHT3X_SOFT_RESET    0x30A2
+#define SIM_SHT3X_HEATER_ON     0x306D
+#define SIM_SHT3X_HEATER_OFF    0x3066
+#define SIM_SHT3X_READ_STATUS   0xF32D
+#define SIM_SHT3X_CLEAR_STATUS  0x3041
+
+#define SIM_SHT3X_STATUS_HEATER 0x2000
+#define SIM_SHT3X_STATUS_RESET  0x0010
+
+/* Period of the 0.5 mps periodic mode */
+#define SIM_SHT3X_PERIOD        SIM_S(2)
+
+/* Commands by repeatability, typical conversion time (us) */
+static const struct {
+    uint16_t single;
+    uint16_t periodic;
+    uint32_t conv_us;
+} sim_sht3x_rep[] = {
+    { 0x2400, 0x2032, 12500 },  // high
+    { 0x240B, 0x2024,  4500 },  // medium
+    { 0x2416, 0x202F,  2500 },  // low
+};
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum {
+    SIM_SHT3X_IDLE,
+    SIM_SHT3X_SINGLE,       // single shot conversion
+    SIM_SHT3X_PERIODIC,     // measuring every SIM_SHT3X_PERIOD
+} sim_sht3x_mode_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static int32_t sim_sht3x_temp = 2500;
+static int32_t sim_sht3x_humi = 5000;
+
+static sim_sht3x_mode_t sim_sht3x_mode;
+static uint64_t sim_sht3x_ready;        // end of the conversion
+static uint16_t sim_sht3x_status = SIM_SHT3X_STATUS_RESET;
+
+static uint8_t sim_sht3x_cmd[2];
+static uint8_t sim_sht3x_cmd_len;
+static uint8_t sim_sht3x_out[6];        // bytes a read returns
+static uint8_t sim_sht3x_out_len;
+static uint8_t sim_sht3x_idx;
+static uint8_t sim_sht3x_result[6];
+static uint8_t sim_sht3x_result_valid;  // a result not yet read
+
+static uint32_t sim_sht3x_meas_count;
+static uint32_t sim_sht3x_fetch_count;
+
+/*********************************************************************
+ * DEVICE
+ */
+
+static uint8_t sim_sht3x_crc(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0xFF;
+
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void sim_sht3x_word(uint8_t *p, int64_t raw)
+{
+    raw = raw < 0 ? 0 : raw > 0xFFFF ? 0xFFFF : raw;
+    p[0] = raw >> 8;
+    p[1] = raw & 0xFF;
+    p[2] = sim_sht3x_crc(p, 2);
+}
+
+/* Inverse of the datasheet formulas */
+static void sim_sht3x_convert(void)
+{
+    sim_sht3x_word(&sim_sht3x_result[0], ((int64_t)sim_sht3x_temp + 4500) * 65535 / 17500);
+    sim_sht3x_word(&sim_sht3x_result[3], (int64_t)sim_sht3x_humi * 65535 / 10000);
+    sim_sht3x_result_valid = 1;
+    sim_sht3x_meas_count++;
+}
+
+/* Complete the conversions due by now */
+static void sim_sht3x_sync(void)
+{
+    while (sim_sht3x_mode != SIM_SHT3X_IDLE && sim_time() >= sim_sht3x_ready) {
+        sim_sht3x_convert();
+        if (sim_sht3x_mode == SIM_SHT3X_SINGLE) {
+            sim_sht3x_mode = SIM_SHT3X_IDLE;
+        } else {
+            sim_sht3x_ready += SIM_SHT3X_PERIOD;
+        }
+    }
+}
+
+static void sim_sht3x_output(const uint8_t *data, uint8_t len)
+{
+    memcpy(sim_sht3x_out, data, len);
+    sim_sht3x_out_len = len;
+}
+
+/* Complete 16 bit command: 1 if accepted */
+static uint8_t sim_sht3x_command(uint16_t cmd)
+{
+    uint8_t status[3];
+
+    sim_sht3x_out_len = 0;
+    for (uint8_t r = 0; r < sizeof(sim_sht3x_rep) / sizeof(sim_sht3x_rep[0]); r++) {
+        /* measurement commands are ignored while measuring periodically */
+        if (cmd == sim_sht3x_rep[r].single && sim_sht3x_mode != SIM_SHT3X_PERIODIC) {
+            sim_sht3x_mode = SIM_SHT3X_SINGLE;
+            sim_sht3x_ready = sim_time() + SIM_US(sim_sht3x_rep[r].conv_us);
+            sim_sht3x_result_valid = 0;
+            return 1;
+        }
+        if (cmd == sim_sht3x_rep[r].periodic && sim_sht3x_mode != SIM_SHT3X_PERIODIC) {
+            sim_sht3x_mode = SIM_SHT3X_PERIODIC;
+            sim_sht3x_ready = sim_time() + SIM_US(sim_sht3x_rep[r].conv_us);
+            sim_sht3x_result_valid = 0;
+            return 1;
+        }
+    }
+
+    switch (cmd) {
+    case SIM_SHT3X_FETCH:
+        if (sim_sht3x_mode != SIM_SHT3X_PERIODIC) {
+            return 0;
+        }
+        /* no data since the last fetch: the read header is not acknowledged */
+        if (sim_sht3x_result_valid) {
+            sim_sht3x_output(sim_sht3x_result, sizeof(sim_sht3x_result));
+            sim_sht3x_result_valid = 0;
+            sim_sht3x_fetch_count++;
+        }
+        return 1;
+    case SIM_SHT3X_BREAK:
+        if (sim_sht3x_mode == SIM_SHT3X_PERIODIC) {
+            sim_sht3x_mode = SIM_SHT3X_IDLE;
+        }
+        return 1;
+    case SIM_SHT3X_SOFT_RESET:
+        sim_sht3x_mode = SIM_SHT3X_IDLE;
+        sim_sht3x_result_valid = 0;
+        sim_sht3x_status = SIM_SHT3X_STATUS_RESET;
+        return 1;
+    case SIM_SHT3X_HEATER_ON:
+        sim_sht3x_status |= SIM_SHT3X_STATUS_HEATER;
+        return 1;
+    case SIM_SHT3X_HEATER_OFF:
+        sim_sht3x_status &= ~SIM_SHT3X_STATUS_HEATER;
+        return 1;
+    case SIM_SHT3X_READ_STATUS:
+        status[0] = sim_sht3x_status >> 8;
+        status[1] = sim_sht3x_status & 0xFF;
+        status[2] = sim_sht3x_crc(status, 2);
+        sim_sht3x_output(status, sizeof(status));
+        return 1;
+    case SIM_SHT3X_CLEAR_STATUS:
+        sim_sht3x_status &= ~SIM_SHT3X_STATUS_RESET;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static uint8_t sim_sht3x_start(sim_i2c_dev_t *dev, uint8_t read)
+{
+    (void)dev;
+    sim_sht3x_sync();
+    sim_sht3x_idx = 0;
+    if (!read) {
+        sim_sht3x_cmd_len = 0;
+        sim_sht3x_out_len = 0;
+        return 1;
+    }
+    /* single shot result: not acknowledged until the conversion ends */
+    if (!sim_sht3x_out_len && sim_sht3x_mode == SIM_SHT3X_IDLE && sim_sht3x_result_valid) {
+        sim_sht3x_output(sim_sht3x_result, sizeof(sim_sht3x_result));
+        sim_sht3x_result_valid = 0;
+    }
+    return sim_sht3x_out_len != 0;
+}
+
+static uint8_t sim_sht3x_write(sim_i2c_dev_t *dev, uint8_t data)
+{
+    (void)dev;
+    if (sim_sht3x_cmd_len >= sizeof(sim_sht3x_cmd)) {
+        return 0;
+    }
+    sim_sht3x_cmd[sim_sht3x_cmd_len++] = data;
+    if (sim_sht3x_cmd_len < sizeof(sim_sht3x_cmd)) {
+        return 1;
+    }
+    return sim_sht3x_command((uint16_t)sim_sht3x_cmd[0] << 8 | sim_sht3x_cmd[1]);
+}
+
+static uint8_t sim_sht3x_read(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    return sim_sht3x_idx < sim_sht3x_out_len ? sim_sht3x_out[sim_sht3x_idx++] : 0xFF;
+}
+
+/* A read is consumed by the STOP ending it */
+static void sim_sht3x_stop(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    if (sim_sht3x_idx) {
+        sim_sht3x_out_len = 0;
+    }
+}
+
+static sim_i2c_dev_t sim_sht3x_dev = {
+    .addr = SIM_SHT3X_ADDR,
+    .start = sim_sht3x_start,
+    .write = sim_sht3x_write,
+    .read = sim_sht3x_read,
+    .stop = sim_sht3x_stop,
+};
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+sim_i2c_dev_t *sim_sht3x(void)
+{
+    return &sim_sht3x_dev;
+}
+
+void sim_sht3x_set(int32_t temp, int32_t humi)
+{
+    sim_sht3x_temp = temp;
+    sim_sht3x_humi = humi;
+}
+
+uint32_t sim_sht3x_measurements(void)
+{
+    sim_sht3x_sync();
+    return sim_sht3x_meas_count;
+}
+
+uint32_t sim_sht3x_fetches(void)
+{
+    return sim_sht3x_fetch_count;
+}
+
+uint8_t sim_sht3x_heater(void)
+{
+    return (sim_sht3x_status & SIM_SHT3X_STATUS_HEATER) != 0;
+}
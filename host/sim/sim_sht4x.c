@@ -0,0 +1,205 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_sht4x.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : SHT4x model: measurements by precision, heater pulses
+ *                      followed by a measurement, serial number, CRC
+ *******************************************************************************/
+
+#include "sim.h"
+#include "sim_sensors.h"
+
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SIM_SHT4X_ADDR          0x44
+#define SIM_SHT4X_SERIAL        0x1D2C3B4AUL
+
+#define SIM_SHT4X_READ_SERIAL   0x89
+#define SIM_SHT4X_SOFT_RESET    0x94
+
+/* A heated measurement reads this much warmer (0.01C) */
+#define SIM_SHT4X_HEATER_BIAS   1500
+
+/* Typical conversion time (us) of a high precision measurement */
+#define SIM_SHT4X_HIGH_US       6900
+
+/* Commands and their typical duration (us): measurements by precision,
+ * then heater pulses, which end with a high precision measurement */
+static const struct {
+    uint8_t cmd;
+    uint8_t heated;
+    uint32_t us;
+} sim_sht4x_cmds[] = {
+    { 0xFD, 0, SIM_SHT4X_HIGH_US },
+    { 0xF6, 0, 3700 },
+    { 0xE0, 0, 1300 },
+    { 0x39, 1, 1000000 + SIM_SHT4X_HIGH_US },
+    { 0x32, 1, 100000 + SIM_SHT4X_HIGH_US },
+    { 0x2F, 1, 1000000 + SIM_SHT4X_HIGH_US },
+    { 0x24, 1, 100000 + SIM_SHT4X_HIGH_US },
+    { 0x1E, 1, 1000000 + SIM_SHT4X_HIGH_US },
+    { 0x15, 1, 100000 + SIM_SHT4X_HIGH_US },
+};
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static int32_t sim_sht4x_temp = 2500;
+static int32_t sim_sht4x_humi = 5000;
+
+static uint8_t sim_sht4x_measuring;     // 0, or 1 + index in sim_sht4x_cmds
+static uint64_t sim_sht4x_ready;        // end of the conversion
+static uint8_t sim_sht4x_first;         // next written byte is a command
+static uint8_t sim_sht4x_out[6];        // bytes the next read returns
+static uint8_t sim_sht4x_out_len;
+static uint8_t sim_sht4x_idx;
+
+static uint32_t sim_sht4x_meas_count;
+static uint32_t sim_sht4x_heater_count;
+
+/*********************************************************************
+ * DEVICE
+ */
+
+static uint8_t sim_sht4x_crc(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0xFF;
+
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void sim_sht4x_word(uint8_t *p, int64_t raw)
+{
+    raw = raw < 0 ? 0 : raw > 0xFFFF ? 0xFFFF : raw;
+    p[0] = raw >> 8;
+    p[1] = raw & 0xFF;
+    p[2] = sim_sht4x_crc(p, 2);
+}
+
+/* Inverse of the datasheet formulas, RH = -6 + 125 * raw / 65535 */
+static void sim_sht4x_convert(uint8_t heated)
+{
+    int32_t temp = sim_sht4x_temp + (heated ? SIM_SHT4X_HEATER_BIAS : 0);
+
+    sim_sht4x_word(&sim_sht4x_out[0], ((int64_t)temp + 4500) * 65535 / 17500);
+    sim_sht4x_word(&sim_sht4x_out[3], ((int64_t)sim_sht4x_humi + 600) * 65535 / 12500);
+    sim_sht4x_out_len = sizeof(sim_sht4x_out);
+    sim_sht4x_meas_count++;
+    sim_sht4x_heater_count += heated;
+}
+
+static uint8_t sim_sht4x_busy(void)
+{
+    if (sim_sht4x_measuring && sim_time() >= sim_sht4x_ready) {
+        sim_sht4x_convert(sim_sht4x_cmds[sim_sht4x_measuring - 1].heated);
+        sim_sht4x_measuring = 0;
+    }
+    return sim_sht4x_measuring != 0;
+}
+
+static uint8_t sim_sht4x_start(sim_i2c_dev_t *dev, uint8_t read)
+{
+    (void)dev;
+
+    /* the address is not acknowledged while measuring */
+    if (sim_sht4x_busy()) {
+        return 0;
+    }
+    sim_sht4x_idx = 0;
+    if (!read) {
+        sim_sht4x_first = 1;
+        return 1;
+    }
+    return sim_sht4x_out_len != 0;
+}
+
+static uint8_t sim_sht4x_write(sim_i2c_dev_t *dev, uint8_t data)
+{
+    (void)dev;
+    if (!sim_sht4x_first) {
+        return 0;
+    }
+    sim_sht4x_first = 0;
+    sim_sht4x_out_len = 0;
+
+    for (uint8_t i = 0; i < sizeof(sim_sht4x_cmds) / sizeof(sim_sht4x_cmds[0]); i++) {
+        if (data == sim_sht4x_cmds[i].cmd) {
+            sim_sht4x_measuring = i + 1;
+            sim_sht4x_ready = sim_time() + SIM_US(sim_sht4x_cmds[i].us);
+            return 1;
+        }
+    }
+    switch (data) {
+    case SIM_SHT4X_READ_SERIAL:
+        sim_sht4x_word(&sim_sht4x_out[0], SIM_SHT4X_SERIAL >> 16);
+        sim_sht4x_word(&sim_sht4x_out[3], SIM_SHT4X_SERIAL & 0xFFFF);
+        sim_sht4x_out_len = sizeof(sim_sht4x_out);
+        return 1;
+    case SIM_SHT4X_SOFT_RESET:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static uint8_t sim_sht4x_read(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    return sim_sht4x_idx < sim_sht4x_out_len ? sim_sht4x_out[sim_sht4x_idx++] : 0xFF;
+}
+
+/* Data is read once */
+static void sim_sht4x_stop(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    if (sim_sht4x_idx) {
+        sim_sht4x_out_len = 0;
+    }
+}
+
+static sim_i2c_dev_t sim_sht4x_dev = {
+    .addr = SIM_SHT4X_ADDR,
+    .start = sim_sht4x_start,
+    .write = sim_sht4x_write,
+    .read = sim_sht4x_read,
+    .stop = sim_sht4x_stop,
+};
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+sim_i2c_dev_t *sim_sht4x(void)
+{
+    return &sim_sht4x_dev;
+}
+
+void sim_sht4x_set(int32_t temp, int32_t humi)
+{
+    sim_sht4x_temp = temp;
+    sim_sht4x_humi = humi;
+}
+
+uint32_t sim_sht4x_measurements(void)
+{
+    sim_sht4x_busy();
+    return sim_sht4x_meas_count;
+}
+
+uint32_t sim_sht4x_heater_pulses(void)
+{
+    sim_sht4x_busy();
+    return sim_sht4x_heater_count;
+}
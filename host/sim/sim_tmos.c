@@ -0,0 +1,344 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_tmos.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Fake TMOS: task events, timers in simulated time,
+ *                      messages and the idle callback of the BLE library
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "sim.h"
+#include "sim_ble.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SIM_TMOS_TASKS          16
+#define SIM_TMOS_TICK_NS        (SYSTEM_TIME_MICROSEN * 1000ULL)
+
+/* Messages outstanding at once before the run is taken as leaking */
+#define SIM_TMOS_MSGS_MAX       64
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct sim_msg {
+    struct sim_msg *link;
+    tmosTaskID task;
+    uint16_t len;
+} sim_msg_t;
+
+typedef struct {
+    pTaskEventHandlerFn handler;
+    tmosEvents events;
+    uint64_t expiry[16];        // per event bit, 0 if the timer is not running
+    uint64_t reload[16];        // reload period (ns), 0 for one shot timers
+} sim_task_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static sim_task_t sim_tasks[SIM_TMOS_TASKS];
+static uint8_t sim_task_num;
+static sim_msg_t *sim_msg_queue;
+static uint32_t sim_msg_count;
+static pfnIdleCB sim_idle_cb;
+static pfnGetSysClock sim_clock_cb;
+
+const uint8_t VER_LIB[] = VER_FILE;
+
+/*********************************************************************
+ * TASKS AND TIMERS
+ */
+
+static sim_task_t *sim_task(tmosTaskID taskID)
+{
+    if (taskID >= sim_task_num) {
+        sim_fatal("TMOS task %d not registered", taskID);
+    }
+    return &sim_tasks[taskID];
+}
+
+tmosTaskID TMOS_ProcessEventRegister(pTaskEventHandlerFn eventCb)
+{
+    if (sim_task_num >= SIM_TMOS_TASKS) {
+        return INVALID_TASK_ID;
+    }
+    sim_tasks[sim_task_num].handler = eventCb;
+    return sim_task_num++;
+}
+
+bStatus_t tmos_set_event(tmosTaskID taskID, tmosEvents event)
+{
+    sim_task(taskID)->events |= event;
+    return SUCCESS;
+}
+
+bStatus_t tmos_clear_event(tmosTaskID taskID, tmosEvents event)
+{
+    sim_task(taskID)->events &= ~event;
+    return SUCCESS;
+}
+
+static void sim_timer_start(tmosTaskID taskID, tmosEvents event, tmosTimer time, uint8_t reload)
+{
+    sim_task_t *task = sim_task(taskID);
+
+    for (uint8_t bit = 0; bit < 16; bit++) {
+        if (event & (1 << bit)) {
+            task->expiry[bit] = sim_time() + time * SIM_TMOS_TICK_NS;
+            task->reload[bit] = reload ? time * SIM_TMOS_TICK_NS : 0;
+        }
+    }
+}
+
+BOOL tmos_start_task(tmosTaskID taskID, tmosEvents event, tmosTimer time)
+{
+    if (time == 0) {
+        tmos_stop_task(taskID, event);
+        tmos_set_event(taskID, event);
+        return TRUE;
+    }
+    sim_timer_start(taskID, event, time, FALSE);
+    return TRUE;
+}
+
+bStatus_t tmos_start_reload_task(tmosTaskID taskID, tmosEvents event, tmosTimer time)
+{
+    if (time == 0) {
+        return FAILURE;
+    }
+    sim_timer_start(taskID, event, time, TRUE);
+    return SUCCESS;
+}
+
+bStatus_t tmos_stop_task(tmosTaskID taskID, tmosEvents event)
+{
+    sim_task_t *task = sim_task(taskID);
+
+    for (uint8_t bit = 0; bit < 16; bit++) {
+        if (event & (1 << bit)) {
+            task->expiry[bit] = 0;
+        }
+    }
+    return SUCCESS;
+}
+
+tmosTimer tmos_get_task_timer(tmosTaskID taskID, tmosEvents event)
+{
+    sim_task_t *task = sim_task(taskID);
+
+    for (uint8_t bit = 0; bit < 16; bit++) {
+        if ((event & (1 << bit)) && task->expiry[bit]) {
+            uint64_t now = sim_time();
+
+            return task->expiry[bit] > now ? (task->expiry[bit] - now) / SIM_TMOS_TICK_NS : 0;
+        }
+    }
+    return 0;
+}
+
+/* Set the events of the expired timers, returns the next expiry */
+static uint64_t sim_timers_fire(void)
+{
+    uint64_t now = sim_time(), next = UINT64_MAX;
+
+    for (uint8_t i = 0; i < sim_task_num; i++) {
+        sim_task_t *task = &sim_tasks[i];
+
+        for (uint8_t bit = 0; bit < 16; bit++) {
+            if (!task->expiry[bit]) {
+                continue;
+            }
+            if (task->expiry[bit] <= now) {
+                task->events |= 1 << bit;
+                task->expiry[bit] = task->reload[bit] ? task->expiry[bit] + task->reload[bit] : 0;
+            }
+            if (task->expiry[bit] && task->expiry[bit] < next) {
+                next = task->expiry[bit];
+            }
+        }
+    }
+    return next;
+}
+
+/* Run the first task with pending events, 0 if there is none */
+static uint8_t sim_tasks_run(void)
+{
+    for (uint8_t i = 0; i < sim_task_num; i++) {
+        sim_task_t *task = &sim_tasks[i];
+
+        if (task->events) {
+            tmosEvents events = task->events;
+
+            task->events = 0;
+            events = task->handler(i, events);
+            task->events |= events;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t TMOS_GetSystemClock(void)
+{
+    return (uint32_t)(sim_time() / SIM_TMOS_TICK_NS);
+}
+
+bStatus_t TMOS_TimerInit(bleClockConfig_t *pClockConfig)
+{
+    if (pClockConfig->ClockFrequency != CAB_LSIFQ || !pClockConfig->getClockValue) {
+        return FAILURE;
+    }
+    sim_clock_cb = pClockConfig->getClockValue;
+    return SUCCESS;
+}
+
+void TMOS_SystemProcess(void)
+{
+    uint64_t next, limit;
+
+    sim_main_yield();
+    sim_io();
+
+    next = sim_timers_fire();
+    if (sim_tasks_run()) {
+        return;
+    }
+
+    /* Nothing to do: the library sleeps until its next timer through the
+     * idle callback, and waits out what is left of a short one */
+    if (sim_idle_cb && next != UINT64_MAX && sim_clock_cb) {
+        sim_clock_cb();
+        sim_idle_cb((uint32_t)((next * CAB_LSIFQ / 1000000000ULL) % RTC_MAX_COUNT));
+        next = sim_timers_fire();
+        for (uint8_t i = 0; i < sim_task_num; i++) {
+            if (sim_tasks[i].events) {
+                return;
+            }
+        }
+    }
+    limit = sim_run_limit_get();
+    sim_wait_irq(next < limit ? next : limit);
+}
+
+/*********************************************************************
+ * MESSAGES
+ */
+
+uint8_t *tmos_msg_allocate(uint16_t len)
+{
+    sim_msg_t *msg;
+
+    if (sim_msg_count >= SIM_TMOS_MSGS_MAX) {
+        sim_fatal("%u TMOS messages outstanding, not deallocated?", sim_msg_count);
+    }
+    msg = calloc(1, sizeof(sim_msg_t) + len);
+    if (!msg) {
+        return NULL;
+    }
+    msg->len = len;
+    sim_msg_count++;
+    return (uint8_t *)(msg + 1);
+}
+
+bStatus_t tmos_msg_deallocate(uint8_t *msg_ptr)
+{
+    if (!msg_ptr) {
+        return FAILURE;
+    }
+    free((sim_msg_t *)msg_ptr - 1);
+    sim_msg_count--;
+    return SUCCESS;
+}
+
+bStatus_t tmos_msg_send(tmosTaskID taskID, uint8_t *msg_ptr)
+{
+    sim_msg_t *msg = (sim_msg_t *)msg_ptr - 1, **p = &sim_msg_queue;
+
+    if (taskID >= sim_task_num) {
+        tmos_msg_deallocate(msg_ptr);
+        return FAILURE;
+    }
+    msg->task = taskID;
+    msg->link = NULL;
+    while (*p) {
+        p = &(*p)->link;
+    }
+    *p = msg;
+    tmos_set_event(taskID, SYS_EVENT_MSG);
+    return SUCCESS;
+}
+
+uint8_t *tmos_msg_receive(tmosTaskID taskID)
+{
+    sim_msg_t **p, *msg = NULL;
+
+    for (p = &sim_msg_queue; *p; p = &(*p)->link) {
+        if ((*p)->task == taskID) {
+            msg = *p;
+            *p = msg->link;
+            break;
+        }
+    }
+    /* the event stays set while more messages are queued */
+    for (sim_msg_t *m = sim_msg_queue; m; m = m->link) {
+        if (m->task == taskID) {
+            tmos_set_event(taskID, SYS_EVENT_MSG);
+            break;
+        }
+    }
+    return msg ? (uint8_t *)(msg + 1) : NULL;
+}
+
+uint32_t sim_tmos_msgs(void)
+{
+    return sim_msg_count;
+}
+
+/*********************************************************************
+ * LIBRARY
+ */
+
+bStatus_t BLE_LibInit(bleConfig_t *pCfg)
+{
+    if (!pCfg->MEMAddr || pCfg->MEMLen < 4 * 1024) {
+        return FAILURE;
+    }
+    sim_idle_cb = pCfg->idleCB;
+    if (pCfg->srandCB) {
+        srand(pCfg->srandCB());
+    }
+    return SUCCESS;
+}
+
+void LLE_IRQLibHandler(void)
+{
+}
+
+uint32_t tmos_rand(void)
+{
+    return (uint32_t)rand();
+}
+
+BOOL tmos_memcmp(const void *src1, const void *src2, uint32_t len)
+{
+    return memcmp(src1, src2, len) == 0;
+}
+
+void tmos_memcpy(void *dst, const void *src, uint32_t len)
+{
+    memcpy(dst, src, len);
+}
+
+void tmos_memset(void *pDst, uint8_t Value, uint32_t len)
+{
+    memset(pDst, Value, len);
+}
@@ -0,0 +1,270 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_aes_ccm.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : AES-128 and AES-CCM against known answers: the FIPS-197
+ *                      block, the encrypted example of the BTHome v2 format
+ *                      and CCM cases generated with OpenSSL (EVP aes-128-ccm),
+ *                      cipher text and MIC compared byte for byte
+ *******************************************************************************/
+
+#include "aes_ccm.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+static int test_failures;
+
+/* Print the first byte that differs */
+static void test_compare(const char *name, const char *what, const uint8_t *got,
+                         const uint8_t *want, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++) {
+        CHECK(got[i] == want[i], "%s: %s byte %u is %02X, expected %02X", name, what, i,
+              got[i], want[i]);
+        if (got[i] != want[i]) {
+            return;
+        }
+    }
+}
+
+/*********************************************************************
+ * VECTORS
+ */
+
+typedef struct {
+    const char *name;
+    uint8_t key[16];
+    uint8_t nonce_len;
+    uint8_t nonce[13];
+    uint8_t len;
+    uint8_t plain[32];
+    uint8_t cipher[32];
+    uint8_t mic_len;
+    uint8_t mic[16];
+} test_ccm_t;
+
+static const test_ccm_t test_ccm[] = {
+    /* BTHome v2 encryption example: bindkey 231d39c1d7cc1ab1aee224cd096db932,
+     * MAC 54:48:E6:8F:80:A5, counter 0x00112233, temperature 25.06 C and
+     * humidity 50.55 %, service data 41 a4 72 66 c9 5f 73 00 11 22 33 78 23 72 14 */
+    {
+        .name = "BTHome v2 example",
+        .key = {
+            0x23, 0x1D, 0x39, 0xC1, 0xD7, 0xCC, 0x1A, 0xB1,
+            0xAE, 0xE2, 0x24, 0xCD, 0x09, 0x6D, 0xB9, 0x32,
+        },
+        .nonce_len = 13,
+        .nonce = { 0x54, 0x48, 0xE6, 0x8F, 0x80, 0xA5, 0xD2, 0xFC, 0x41, 0x00, 0x11, 0x22, 0x33 },
+        .len = 6,
+        .plain = { 0x02, 0xCA, 0x09, 0x03, 0xBF, 0x13 },
+        .cipher = { 0xA4, 0x72, 0x66, 0xC9, 0x5F, 0x73 },
+        .mic_len = 4,
+        .mic = { 0x78, 0x23, 0x72, 0x14 },
+    },
+    /* OpenSSL, whole and partial blocks and every nonce and MIC length class */
+    {
+        .name = "nonce 13, 16 bytes, MIC 4",
+        .key = {
+            0x3D, 0x4C, 0x44, 0x3E, 0xA2, 0xD3, 0xF8, 0xF1,
+            0x5A, 0xE1, 0xBF, 0x4C, 0xC8, 0x9F, 0x82, 0xA6,
+        },
+        .nonce_len = 13,
+        .nonce = { 0x76, 0xC6, 0x22, 0x0A, 0xAF, 0x10, 0x7D, 0x7A, 0xDE, 0x62, 0x1F, 0x07, 0xA5 },
+        .len = 16,
+        .plain = {
+            0xB6, 0xC8, 0x92, 0xBD, 0xCA, 0xA2, 0x5F, 0x90,
+            0x8A, 0x3F, 0x5F, 0x98, 0x3E, 0x54, 0x3A, 0x75,
+        },
+        .cipher = {
+            0x6F, 0xFD, 0xEC, 0xD2, 0x0E, 0x8F, 0x62, 0x53,
+            0x9D, 0xE3, 0x27, 0x00, 0x7F, 0xDA, 0xA8, 0xCF,
+        },
+        .mic_len = 4,
+        .mic = { 0xA3, 0xF3, 0x1B, 0xAA },
+    },
+    {
+        .name = "nonce 13, 23 bytes, MIC 4",
+        .key = {
+            0x73, 0x37, 0x1E, 0xD1, 0xAB, 0x1A, 0x4A, 0xF4,
+            0xC4, 0x05, 0x59, 0x26, 0x28, 0x95, 0x4F, 0xC8,
+        },
+        .nonce_len = 13,
+        .nonce = { 0xBA, 0x76, 0x65, 0x31, 0x7C, 0xA1, 0x94, 0x49, 0x00, 0x56, 0xE3, 0xE8, 0x94 },
+        .len = 23,
+        .plain = {
+            0xD9, 0x71, 0xEC, 0x2D, 0xEC, 0x42, 0x1C, 0x0F,
+            0x0F, 0xC9, 0xC0, 0x42, 0x7A, 0x39, 0xFC, 0xB5,
+            0xD7, 0x8C, 0xF0, 0x2E, 0xC0, 0x50, 0x91,
+        },
+        .cipher = {
+            0x94, 0x15, 0xDC, 0x65, 0x71, 0xF7, 0xC7, 0x0A,
+            0xA6, 0x70, 0xCD, 0xA0, 0x65, 0x72, 0x7A, 0xA6,
+            0x62, 0x05, 0x83, 0x9B, 0x2E, 0xB6, 0x96,
+        },
+        .mic_len = 4,
+        .mic = { 0x4D, 0x40, 0x39, 0x8D },
+    },
+    {
+        .name = "nonce 11, 1 bytes, MIC 8",
+        .key = {
+            0xF9, 0xFB, 0x34, 0x46, 0x4D, 0x77, 0x56, 0x42,
+            0x7C, 0x05, 0x4A, 0xA4, 0xE3, 0xD8, 0xEA, 0x50,
+        },
+        .nonce_len = 11,
+        .nonce = { 0x8C, 0xBB, 0xE0, 0x8B, 0xA3, 0x14, 0xF4, 0x59, 0x9F, 0x9C, 0x16 },
+        .len = 1,
+        .plain = { 0x96 },
+        .cipher = { 0x3C },
+        .mic_len = 8,
+        .mic = { 0x7B, 0x9F, 0x0F, 0x42, 0xCE, 0xD3, 0x0D, 0xAF },
+    },
+    {
+        .name = "nonce 7, 31 bytes, MIC 16",
+        .key = {
+            0x2C, 0xDC, 0x2B, 0xD7, 0xDA, 0x66, 0x98, 0xFE,
+            0x88, 0xD9, 0x8F, 0x9F, 0x8E, 0x92, 0x1C, 0x16,
+        },
+        .nonce_len = 7,
+        .nonce = { 0xAD, 0x32, 0xEE, 0x64, 0xB8, 0xD4, 0xE6 },
+        .len = 31,
+        .plain = {
+            0xCE, 0xFF, 0x0B, 0x61, 0x34, 0x7E, 0x9E, 0x46,
+            0x32, 0xCA, 0x03, 0xCE, 0xF8, 0xB7, 0x9C, 0x16,
+            0xE9, 0xCA, 0xB3, 0x66, 0xF6, 0x62, 0x37, 0x3F,
+            0xB9, 0xA5, 0x34, 0x26, 0x51, 0x2B, 0x14,
+        },
+        .cipher = {
+            0x5E, 0x32, 0x02, 0x1F, 0x13, 0x70, 0x13, 0x70,
+            0x45, 0x3B, 0x48, 0x99, 0x2F, 0xB7, 0x6E, 0x32,
+            0x17, 0x94, 0x27, 0xF3, 0xA8, 0xA3, 0xB1, 0x2B,
+            0xAB, 0x37, 0x38, 0x4C, 0xB3, 0x9F, 0x2E,
+        },
+        .mic_len = 16,
+        .mic = {
+            0xC0, 0x1F, 0xC5, 0xC3, 0xA8, 0xEA, 0xC3, 0x4F,
+            0x07, 0x56, 0x86, 0x32, 0x15, 0x19, 0x90, 0xB7,
+        },
+    },
+    {
+        .name = "nonce 12, 20 bytes, MIC 6",
+        .key = {
+            0x33, 0x00, 0x6D, 0x97, 0x58, 0x86, 0xEC, 0x94,
+            0x72, 0x3B, 0x21, 0x6D, 0x12, 0xEE, 0x28, 0x53,
+        },
+        .nonce_len = 12,
+        .nonce = { 0x08, 0x80, 0x2B, 0x3F, 0xB3, 0x40, 0x8F, 0xAB, 0x0B, 0x05, 0xE1, 0x14 },
+        .len = 20,
+        .plain = {
+            0x6B, 0x0E, 0x7F, 0x31, 0x1F, 0x9A, 0x06, 0xF0,
+            0xB2, 0x46, 0x7F, 0x35, 0xF4, 0x29, 0x48, 0x52,
+            0xCD, 0xB0, 0xC4, 0x44,
+        },
+        .cipher = {
+            0x04, 0xBA, 0x39, 0x31, 0x97, 0x2B, 0xEB, 0x76,
+            0xA8, 0x12, 0x83, 0xB0, 0xC3, 0x6D, 0x7A, 0x60,
+            0xB4, 0x0B, 0x00, 0x05,
+        },
+        .mic_len = 6,
+        .mic = { 0x44, 0xD8, 0x98, 0x94, 0xAD, 0x09 },
+    },
+};
+
+/*********************************************************************
+ * SCENARIOS
+ */
+
+/* FIPS-197 appendix C.1 */
+static void test_aes128(void)
+{
+    static const uint8_t key[16] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    };
+    static const uint8_t plain[16] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF,
+    };
+    static const uint8_t cipher[16] = {
+        0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30,
+        0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A,
+    };
+    aes128_ctx_t ctx;
+    uint8_t out[16];
+
+    aes128_init(&ctx, key);
+    aes128_encrypt(&ctx, plain, out);
+    test_compare("FIPS-197 C.1", "cipher", out, cipher, sizeof(out));
+
+    /* in place */
+    memcpy(out, plain, sizeof(out));
+    aes128_encrypt(&ctx, out, out);
+    test_compare("FIPS-197 C.1 in place", "cipher", out, cipher, sizeof(out));
+}
+
+static void test_ccm_vector(const test_ccm_t *v)
+{
+    aes128_ctx_t ctx;
+    uint8_t out[32], mic[16];
+    int ret;
+
+    aes128_init(&ctx, v->key);
+    memset(out, 0, sizeof(out));
+    memset(mic, 0, sizeof(mic));
+    ret = aes_ccm_encrypt(&ctx, v->nonce, v->nonce_len, v->plain, v->len, out, mic, v->mic_len);
+    CHECK(ret == 0, "%s: returned %d", v->name, ret);
+    test_compare(v->name, "cipher", out, v->cipher, v->len);
+    test_compare(v->name, "MIC", mic, v->mic, v->mic_len);
+
+    /* the advert encrypts its object block in place */
+    memcpy(out, v->plain, v->len);
+    memset(mic, 0, sizeof(mic));
+    aes_ccm_encrypt(&ctx, v->nonce, v->nonce_len, out, v->len, out, mic, v->mic_len);
+    test_compare(v->name, "in place cipher", out, v->cipher, v->len);
+    test_compare(v->name, "in place MIC", mic, v->mic, v->mic_len);
+}
+
+static void test_ccm_params(void)
+{
+    const test_ccm_t *v = &test_ccm[0];
+    aes128_ctx_t ctx;
+    uint8_t out[32], mic[16];
+
+    aes128_init(&ctx, v->key);
+    CHECK(aes_ccm_encrypt(&ctx, v->nonce, 6, v->plain, v->len, out, mic, 4) < 0, "nonce 6 accepted");
+    CHECK(aes_ccm_encrypt(&ctx, v->nonce, 14, v->plain, v->len, out, mic, 4) < 0, "nonce 14 accepted");
+    CHECK(aes_ccm_encrypt(&ctx, v->nonce, 13, v->plain, v->len, out, mic, 2) < 0, "MIC 2 accepted");
+    CHECK(aes_ccm_encrypt(&ctx, v->nonce, 13, v->plain, v->len, out, mic, 5) < 0, "MIC 5 accepted");
+    CHECK(aes_ccm_encrypt(&ctx, v->nonce, 13, v->plain, v->len, out, mic, 18) < 0, "MIC 18 accepted");
+}
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    test_aes128();
+    for (uint8_t i = 0; i < sizeof(test_ccm) / sizeof(test_ccm[0]); i++) {
+        test_ccm_vector(&test_ccm[i]);
+    }
+    test_ccm_params();
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_bme280.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : BME280 integer compensation: the datasheet example,
+ *                      then the operating range against the floating point
+ *                      compensation the model inverts
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "sensor_bme280.h"
+#include "sim.h"
+#include "sim_sensors.h"
+
+#include <stdio.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Datasheet example (BMP280 section 3.12) */
+#define TEST_ADC_T              519888
+#define TEST_ADC_P              415148
+#define TEST_T_FINE             128422
+#define TEST_TEMP               2508        // 25.08C
+#define TEST_PRES               100656      // Pa, 100653.27 in floating point
+
+/* Integer against floating point compensation over the operating range */
+#define TEST_TEMP_TOL           1           // 0.01C
+#define TEST_PRES_TOL           8           // Pa
+#define TEST_HUMI_TOL           2           // 0.01%RH
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+static int test_failures;
+
+static int32_t abs32(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+/* Trimming parameters of the model as the driver parses them */
+static void test_calib(bme280_calib_t *c)
+{
+    const sim_bme280_calib_t *m = sim_bme280_calib();
+
+    c->t1 = m->t[0];
+    c->t2 = m->t[1];
+    c->t3 = m->t[2];
+    c->p1 = m->p[0];
+    c->p2 = m->p[1];
+    c->p3 = m->p[2];
+    c->p4 = m->p[3];
+    c->p5 = m->p[4];
+    c->p6 = m->p[5];
+    c->p7 = m->p[6];
+    c->p8 = m->p[7];
+    c->p9 = m->p[8];
+    c->h1 = m->h[0];
+    c->h2 = m->h[1];
+    c->h3 = m->h[2];
+    c->h4 = m->h[3];
+    c->h5 = m->h[4];
+    c->h6 = m->h[5];
+}
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    bme280_calib_t c;
+    int32_t t_fine, temp, humi, adc_t, adc_p, adc_h;
+    int32_t err_t = 0, err_p = 0, err_h = 0;
+    uint32_t pres;
+
+    test_calib(&c);
+
+    temp = bme280_compensate_t(&c, TEST_ADC_T, &t_fine);
+    pres = bme280_compensate_p(&c, TEST_ADC_P, t_fine);
+    CHECK(t_fine == TEST_T_FINE, "t_fine %d", (int)t_fine);
+    CHECK(temp == TEST_TEMP, "temperature %d", (int)temp);
+    CHECK(pres == TEST_PRES, "pressure %u", (unsigned)pres);
+    printf("datasheet example: T %d (0.01C), P %u Pa\n", (int)temp, (unsigned)pres);
+
+    /* -40..85C, 300..1100 hPa, 0..100 %RH */
+    for (int32_t t = -4000; t <= 8500; t += 500) {
+        for (uint32_t p = 30000; p <= 110000; p += 5000) {
+            for (int32_t h = 0; h <= 10000; h += 1000) {
+                sim_bme280_raw(t, h, p, &adc_t, &adc_p, &adc_h);
+                temp = bme280_compensate_t(&c, adc_t, &t_fine);
+                pres = bme280_compensate_p(&c, adc_p, t_fine);
+                humi = (int32_t)((bme280_compensate_h(&c, adc_h, t_fine) * 100) >> 10);
+
+                err_t = abs32(temp - t) > err_t ? abs32(temp - t) : err_t;
+                err_p = abs32((int32_t)pres - (int32_t)p) > err_p ? abs32((int32_t)pres - (int32_t)p) : err_p;
+                err_h = abs32(humi - h) > err_h ? abs32(humi - h) : err_h;
+            }
+        }
+    }
+    CHECK(err_t <= TEST_TEMP_TOL, "temperature off by %d", (int)err_t);
+    CHECK(err_p <= TEST_PRES_TOL, "pressure off by %d Pa", (int)err_p);
+    CHECK(err_h <= TEST_HUMI_TOL, "humidity off by %d", (int)err_h);
+    printf("operating range: T within %d (0.01C), P within %d Pa, RH within %d (0.01%%)\n",
+           (int)err_t, (int)err_p, (int)err_h);
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,184 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_broadcaster.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : The whole application on the host: main(),
+ *                      Broadcaster_Init, periodic samples of the SHT20 and
+ *                      the battery, BTHome advert updates, interval policy
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "app_i2c.h"
+#include "bthome.h"
+#include "sensor_cfg.h"
+#include "sim.h"
+#include "sim_ble.h"
+#include "sim_sensors.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+static int test_failures;
+
+int app_main(void);
+
+typedef struct {
+    uint8_t found;
+    uint8_t info;
+    uint8_t pid;
+    uint8_t battery;
+    int16_t temp;
+    uint16_t humid;
+} test_bthome_t;
+
+/* Service data 0xFCD2 of the advert on air, plain objects only */
+static test_bthome_t test_bthome_parse(void)
+{
+    test_bthome_t r = { 0 };
+    uint16_t len, i = 0;
+    const uint8_t *d = sim_gap_adv_data(&len);
+
+    while (i + 1 < len && d[i]) {
+        uint8_t ad_len = d[i], ad_type = d[i + 1];
+
+        if (ad_type == GAP_ADTYPE_SERVICE_DATA && ad_len >= 4 &&
+            d[i + 2] == BTHOME_UUID_LO && d[i + 3] == BTHOME_UUID_HI) {
+            uint16_t p = i + 5, end = i + 1 + ad_len;
+
+            r.found = 1;
+            r.info = d[i + 4];
+            while (p < end) {
+                uint8_t id = d[p++];
+
+                switch (id) {
+                case BTHOME_ID_PACKET_ID:
+                    r.pid = d[p];
+                    p += 1;
+                    break;
+                case BTHOME_ID_BATTERY:
+                    r.battery = d[p];
+                    p += 1;
+                    break;
+                case BTHOME_ID_TEMPERATURE:
+                    r.temp = (int16_t)(d[p] | d[p + 1] << 8);
+                    p += 2;
+                    break;
+                case BTHOME_ID_HUMIDITY:
+                    r.humid = d[p] | d[p + 1] << 8;
+                    p += 2;
+                    break;
+                default:
+                    p += 2;
+                    break;
+                }
+            }
+        }
+        i += ad_len + 1;
+    }
+    return r;
+}
+
+static double test_wall(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int abs32(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    test_bthome_t adv;
+    i2c_stats_t stats;
+    uint32_t updates, samples;
+    double wall = test_wall(), sleep_pct;
+
+    sim_i2c_attach(sim_sht20());
+    sim_sht20_set(2345, 4560);
+    sim_adc_set_battery_mv(3300);
+    sim_adc_set_chip_temp(2500);
+
+    sim_main_start(app_main);
+
+    /* first sample 3.8s after start, then every 10s while readings move */
+    sim_main_run(SIM_S(30));
+    adv = test_bthome_parse();
+    CHECK(adv.found, "no BTHome service data");
+    CHECK(adv.info == BTHOME_DEVICE_INFO_PLAIN, "device info 0x%02X", adv.info);
+    CHECK(abs32(adv.temp - 2345) <= 2, "temperature %d", adv.temp);
+    CHECK(abs32(adv.humid - 4560) <= 5, "humidity %d", adv.humid);
+    CHECK(adv.battery == 25, "battery %d%%", adv.battery);
+    CHECK(sim_gap_state() == GAPROLE_ADVERTISING, "role state %u", sim_gap_state());
+    CHECK(sim_gap_adv_interval() == 1600, "interval %u after the first reading", sim_gap_adv_interval());
+    CHECK(sim_sht20_reg_writes() == 1, "%u user register writes", sim_sht20_reg_writes());
+    CHECK(sim_sht20_measurements() >= 2 * 2, "%u SHT20 measurements", sim_sht20_measurements());
+    printf("30 s: T %d, RH %d, bat %d%%, pid %d, interval %u, %u adv events\n", adv.temp,
+           adv.humid, adv.battery, adv.pid, sim_gap_adv_interval(), sim_gap_adv_events());
+
+    /* a step in temperature reaches the advert through the filter */
+    updates = sim_gap_updates();
+    sim_sht20_set(2600, 4560);
+    sim_main_run(SIM_S(120));
+    adv = test_bthome_parse();
+    CHECK(abs32(adv.temp - 2600) <= 2 * SENSOR_DEADBAND_TEMP, "temperature %d after the step", adv.temp);
+    CHECK(sim_gap_updates() > updates, "advert not updated after the step");
+    printf("150 s: T %d, RH %d, interval %u\n", adv.temp, adv.humid, sim_gap_adv_interval());
+
+    /* stable readings lengthen the intervals level by level, the advert
+     * keeps the last value that moved past the deadband */
+    samples = sim_sht20_measurements();
+    sim_main_run(SIM_S(1800));
+    CHECK(sim_gap_adv_interval() == 16000, "interval %u after 30 min stable", sim_gap_adv_interval());
+    CHECK(sim_sht20_measurements() > samples, "sampling stopped");
+    adv = test_bthome_parse();
+    CHECK(abs32(adv.temp - 2600) <= SENSOR_DEADBAND_TEMP, "temperature %d settled", adv.temp);
+
+    /* below 3.1V the battery reads 0%, not the wrapped difference */
+    sim_adc_set_battery_mv(3000);
+    sim_main_run(SIM_S(600));
+    adv = test_bthome_parse();
+    CHECK(adv.battery == 0, "battery %d%% at 3000 mV", adv.battery);
+
+    i2c_stats_get(&stats);
+    for (uint8_t i = 0; i < I2C_ERROR_MAX; i++) {
+        CHECK(stats.errors[i] == 0, "%u I2C errors of type %d", stats.errors[i], i);
+    }
+    CHECK(stats.recoveries == 0, "%u bus recoveries", stats.recoveries);
+    CHECK(R32_SLEEP_CONTROL & ((uint32_t)RB_SLP_CLK_I2C << 8), "I2C clock not gated between samples");
+    CHECK(sim_tmos_msgs() == 0, "%u TMOS messages not freed", sim_tmos_msgs());
+
+    sleep_pct = 100.0 * sim_sleep_time() / sim_time();
+    CHECK(sleep_pct > 95, "asleep %.1f%% of the time", sleep_pct);
+
+    wall = test_wall() - wall;
+    printf("%.0f s simulated in %.2f s (x%.0f), asleep %.2f%%, %u samples, %u adv events, %u updates\n",
+           sim_time() / 1e9, wall, sim_time() / 1e9 / wall, sleep_pct, sim_sht20_measurements() / 2,
+           sim_gap_adv_events(), sim_gap_updates());
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,465 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_i2c_isr.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : I2C driver against the register level model: every
+ *                      path of I2C_IRQHandler as master and slave, repeated
+ *                      starts, NACKs, bus errors and a stuck bus, checked on
+ *                      the bus trace, with the instructions per interrupt
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "app_i2c.h"
+#include "sim.h"
+#include "sim_ble.h"
+#include "sim_i2c.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TEST_OWN_ADDR           0x33    // the CH592 as slave
+#define TEST_DEV_ADDR           0x50    // register map device on the bus
+#define TEST_NONE_ADDR          0x51    // nobody there
+
+#define TEST_DEV_SIZE           8
+
+/* Bus settles after a call: STOP and the bus free time */
+#define TEST_SETTLE             SIM_US(50)
+
+/* Instructions per interrupt: no path may wait for the bus */
+#define TEST_INSNS_MAX          400
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+#define CHECK_TRACE(expect)                                     \
+    do {                                                        \
+        sim_advance(TEST_SETTLE);                               \
+        CHECK(!strcmp(sim_i2c_trace(), expect), "bus \"%s\", expected \"%s\"", \
+              sim_i2c_trace(), expect);                         \
+        sim_i2c_trace_clear();                                  \
+    } while (0)
+
+static int test_failures;
+
+static const char *const test_path_name[I2C_PATH_MAX] = {
+    "none", "m start", "m tx data", "m tx stop", "m tx restart", "m tx nack",
+    "m rx addr", "m rx data", "m rx stop", "m rx restart", "m rx nack",
+    "s tx addr", "s tx data", "s tx nack", "s rx addr", "s rx data", "s rx stop",
+    "error",
+};
+
+/*********************************************************************
+ * REGISTER MAP DEVICE
+ */
+
+/* First byte written sets the register pointer, then bytes are stored
+ * or read with auto increment; writes past the end are not acknowledged */
+static uint8_t test_dev_mem[TEST_DEV_SIZE];
+static uint8_t test_dev_ptr;
+static uint8_t test_dev_ptr_set;
+
+static uint8_t test_dev_start(sim_i2c_dev_t *dev, uint8_t read)
+{
+    (void)dev;
+    if (!read) {
+        test_dev_ptr_set = 0;
+    }
+    return 1;
+}
+
+static uint8_t test_dev_write(sim_i2c_dev_t *dev, uint8_t data)
+{
+    (void)dev;
+    if (!test_dev_ptr_set) {
+        test_dev_ptr = data;
+        test_dev_ptr_set = 1;
+        return 1;
+    }
+    if (test_dev_ptr >= TEST_DEV_SIZE) {
+        return 0;
+    }
+    test_dev_mem[test_dev_ptr++] = data;
+    return 1;
+}
+
+static uint8_t test_dev_read(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+    return test_dev_ptr < TEST_DEV_SIZE ? test_dev_mem[test_dev_ptr++] : 0xFF;
+}
+
+static void test_dev_stop(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+}
+
+static sim_i2c_dev_t test_dev = {
+    .addr = TEST_DEV_ADDR,
+    .start = test_dev_start,
+    .write = test_dev_write,
+    .read = test_dev_read,
+    .stop = test_dev_stop,
+};
+
+/*********************************************************************
+ * SLAVE CALLBACKS
+ */
+
+static uint8_t test_rx_data[I2C_BUFFER_LENGTH];
+static uint8_t test_rx_len;
+static uint8_t test_rx_calls;
+
+static void test_on_receive(uint8_t *data, uint8_t len)
+{
+    memcpy(test_rx_data, data, len);
+    test_rx_len = len;
+    test_rx_calls++;
+}
+
+static void test_on_transmit(uint8_t *data, uint8_t *len)
+{
+    data[0] = 0xC0;
+    data[1] = 0xC1;
+    *len = 2;
+}
+
+static struct i2c_slave_cb test_slave_cb = {
+    .on_transmit = test_on_transmit,
+    .on_receive = test_on_receive,
+};
+
+/*********************************************************************
+ * ASYNC COMPLETION
+ */
+
+static tmosTaskID test_task_id;
+static i2c_xfer_t *test_done_xfer;
+static uint8_t test_done_status;
+
+static tmosEvents test_process_event(tmosTaskID task_id, tmosEvents events)
+{
+    if (events & SYS_EVENT_MSG) {
+        uint8_t *msg;
+
+        while ((msg = tmos_msg_receive(task_id)) != NULL) {
+            i2c_done_msg_t *done = (i2c_done_msg_t *)msg;
+
+            if (done->hdr.event == I2C_XFER_DONE_MSG) {
+                test_done_xfer = done->xfer;
+                test_done_status = done->hdr.status;
+            }
+            tmos_msg_deallocate(msg);
+        }
+        return (events ^ SYS_EVENT_MSG);
+    }
+    return 0;
+}
+
+/*********************************************************************
+ * INSTRUCTIONS PER INTERRUPT
+ */
+
+static i2c_isr_profile_t test_profile;
+static uint32_t test_insns_max[I2C_PATH_MAX];
+
+/* Charge the count to the path whose hits went up */
+static void test_icount_done(uint8_t irq, uint32_t count)
+{
+    i2c_isr_profile_t now;
+
+    (void)irq;
+    i2c_isr_profile_get(&now);
+    for (uint8_t i = 0; i < I2C_PATH_MAX; i++) {
+        if (now.hits[i] != test_profile.hits[i] && count > test_insns_max[i]) {
+            test_insns_max[i] = count;
+        }
+    }
+    test_profile = now;
+}
+
+/*********************************************************************
+ * SCENARIOS
+ */
+
+static void test_master_blocking(void)
+{
+    static const uint8_t wr[] = { 0x02, 0xAA, 0xBB };
+    uint8_t reg = 0x02, rd[2] = { 0 };
+    int ret;
+
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == 0, "write returned %d", ret);
+    CHECK_TRACE("S W50+ 02+ AA+ BB+ P");
+    CHECK(test_dev_mem[2] == 0xAA && test_dev_mem[3] == 0xBB, "device got %02X %02X",
+          test_dev_mem[2], test_dev_mem[3]);
+
+    /* register address, repeated START left pending, read */
+    ret = i2c_write_to(TEST_DEV_ADDR, &reg, 1, 1, 0);
+    CHECK(ret == 0, "write without STOP returned %d", ret);
+    ret = i2c_read_from(TEST_DEV_ADDR, rd, sizeof(rd), 1, 10);
+    CHECK(ret == 2, "read returned %d", ret);
+    CHECK(rd[0] == 0xAA && rd[1] == 0xBB, "read %02X %02X", rd[0], rd[1]);
+    CHECK_TRACE("S W50+ 02+ Sr R50+ AA+ BB- P");
+
+    /* read without STOP, repeated START, write */
+    ret = i2c_read_from(TEST_DEV_ADDR, rd, 1, 0, 10);
+    CHECK(ret == 1, "read without STOP returned %d", ret);
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == 0, "write after the read returned %d", ret);
+    CHECK_TRACE("S R50+ 00- Sr W50+ 02+ AA+ BB+ P");
+}
+
+static void test_master_transfer(void)
+{
+    uint8_t w1[] = { 0x04, 0x10, 0x11 }, w2[] = { 0x06, 0x20, 0x21 };
+    uint8_t reg = 0x04, rd[4] = { 0 }, one = 0;
+    struct i2c_msg ww[] = {
+        { TEST_DEV_ADDR, 0, sizeof(w1), w1 },
+        { TEST_DEV_ADDR, 0, sizeof(w2), w2 },
+    };
+    struct i2c_msg wr[] = {
+        { TEST_DEV_ADDR, 0, 1, &reg },
+        { TEST_DEV_ADDR, I2C_M_RD, sizeof(rd), rd },
+    };
+    struct i2c_msg rw[] = {
+        { TEST_DEV_ADDR, I2C_M_RD, 1, &one },
+        { TEST_DEV_ADDR, 0, sizeof(w1), w1 },
+    };
+    int ret;
+
+    /* write, repeated START, write: no byte may go out ahead of the address */
+    ret = i2c_transfer(ww, 2);
+    CHECK(ret == 2, "write-write returned %d", ret);
+    CHECK_TRACE("S W50+ 04+ 10+ 11+ Sr W50+ 06+ 20+ 21+ P");
+
+    ret = i2c_transfer(wr, 2);
+    CHECK(ret == 2, "write-read returned %d", ret);
+    CHECK(!memcmp(rd, "\x10\x11\x20\x21", 4), "read %02X %02X %02X %02X", rd[0], rd[1], rd[2], rd[3]);
+    CHECK_TRACE("S W50+ 04+ Sr R50+ 10+ 11+ 20+ 21- P");
+
+    /* one byte read past the end of the map, repeated START, write */
+    ret = i2c_transfer(rw, 2);
+    CHECK(ret == 2, "read-write returned %d", ret);
+    CHECK(one == 0xFF, "read %02X", one);
+    CHECK_TRACE("S R50+ FF- Sr W50+ 04+ 10+ 11+ P");
+}
+
+static void test_master_async(void)
+{
+    uint8_t reg = 0x02, rd[2] = { 0 };
+    struct i2c_msg msgs[] = {
+        { TEST_DEV_ADDR, 0, 1, &reg },
+        { TEST_DEV_ADDR, I2C_M_RD, sizeof(rd), rd },
+    };
+    i2c_xfer_t xfer = { .msgs = msgs, .num = 2, .task_id = test_task_id };
+    int ret;
+
+    test_done_xfer = NULL;
+    ret = i2c_submit(&xfer);
+    CHECK(ret == 0, "submit returned %d", ret);
+    sim_tmos_run(SIM_MS(5));
+    CHECK(test_done_xfer == &xfer, "no completion message");
+    CHECK(test_done_status == 0 && xfer.done == 2, "status %u, %u messages done",
+          test_done_status, xfer.done);
+    CHECK(rd[0] == 0xAA && rd[1] == 0xBB, "read %02X %02X", rd[0], rd[1]);
+    CHECK_TRACE("S W50+ 02+ Sr R50+ AA+ BB- P");
+}
+
+static void test_master_nack(void)
+{
+    static const uint8_t wr[] = { 0x06, 0x01, 0x02, 0x03, 0x04 };
+    uint8_t rd[2];
+    int ret;
+
+    ret = i2c_write_to(TEST_NONE_ADDR, wr, 1, 1, 1);
+    CHECK(ret == -I2C_MT_NACK, "write to nobody returned %d", ret);
+    CHECK_TRACE("S W51- P");
+
+    ret = i2c_read_from(TEST_NONE_ADDR, rd, sizeof(rd), 1, 10);
+    CHECK(ret == 0, "read from nobody returned %d", ret);
+    CHECK_TRACE("S R51- P");
+
+    /* the device takes two bytes at 6, the third is not acknowledged; the
+     * driver does not wait for the ACK of the last byte, NACK one before */
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == -I2C_MT_NACK, "write past the end returned %d", ret);
+    CHECK_TRACE("S W50+ 06+ 01+ 02+ 03- P");
+}
+
+static void test_slave(void)
+{
+    static const uint8_t wr[] = { 0x01, 0x02, 0x03 };
+    uint8_t rd[3] = { 0 }, reg = 0x01, ok = 0x5A;
+    int ret;
+
+    i2c_slave_cb_register(&test_slave_cb);
+
+    ret = sim_i2c_host_write(TEST_OWN_ADDR, wr, sizeof(wr), 1);
+    CHECK(ret == 3, "host write acknowledged %d bytes", ret);
+    CHECK(test_rx_calls == 1 && test_rx_len == 3 && !memcmp(test_rx_data, wr, 3),
+          "%u receive callbacks, %u bytes", test_rx_calls, test_rx_len);
+    CHECK_TRACE("S W33+ 01+ 02+ 03+ P");
+
+    /* back to master after serving the host */
+    ret = i2c_write_to(TEST_DEV_ADDR, &ok, 1, 1, 1);
+    CHECK(ret == 0, "write after the host write returned %d", ret);
+    CHECK_TRACE("S W50+ 5A+ P");
+
+    ret = sim_i2c_host_read(TEST_OWN_ADDR, rd, sizeof(rd));
+    CHECK(ret == 3, "host read returned %d", ret);
+    CHECK(rd[0] == 0xC0 && rd[1] == 0xC1 && rd[2] == 0xFF, "host read %02X %02X %02X",
+          rd[0], rd[1], rd[2]);
+    CHECK_TRACE("S R33+ C0+ C1+ FF- P");
+
+    ret = i2c_write_to(TEST_DEV_ADDR, &ok, 1, 1, 1);
+    CHECK(ret == 0, "write after the host read returned %d", ret);
+    CHECK_TRACE("S W50+ 5A+ P");
+
+    /* a transfer submitted during a host access starts after its STOP */
+    {
+        uint8_t val[] = { 0x03, 0x5B };
+        struct i2c_msg msg = { TEST_DEV_ADDR, 0, sizeof(val), val };
+        i2c_xfer_t xfer = { .msgs = &msg, .num = 1, .task_id = test_task_id };
+
+        ret = sim_i2c_host_write(TEST_OWN_ADDR, &reg, 1, 0);
+        CHECK(ret == 1, "register address acknowledged %d", ret);
+        test_done_xfer = NULL;
+        ret = i2c_submit(&xfer);
+        CHECK(ret == 0, "submit during the host access returned %d", ret);
+        ret = sim_i2c_host_read(TEST_OWN_ADDR, rd, 1);
+        CHECK(ret == 1 && rd[0] == 0xC0, "host read returned %d, %02X", ret, rd[0]);
+        sim_tmos_run(SIM_MS(5));
+        CHECK(test_done_xfer == &xfer && test_done_status == 0, "queued transfer not done");
+        CHECK(test_dev_mem[3] == 0x5B, "device got %02X", test_dev_mem[3]);
+        CHECK_TRACE("S W33+ 01+ Sr R33+ C0- P S W50+ 03+ 5B+ P");
+    }
+
+    i2c_slave_cb_register(NULL);
+
+    /* exported register map: register address, repeated START, read */
+    {
+        static uint8_t map[2][4] = { { 0 }, { 0 } };
+        i2c_export_t exp = { .buf = { map[0], map[1] }, .len = 4 };
+        uint8_t *back;
+
+        ret = i2c_export_enable(&exp);
+        CHECK(ret == 0, "export returned %d", ret);
+        back = i2c_export_begin();
+        memcpy(back, "\xE0\xE1\xE2\xE3", 4);
+        i2c_export_publish();
+
+        ret = sim_i2c_host_write(TEST_OWN_ADDR, &reg, 1, 0);
+        CHECK(ret == 1, "register address acknowledged %d", ret);
+        ret = sim_i2c_host_read(TEST_OWN_ADDR, rd, sizeof(rd));
+        CHECK(rd[0] == 0xE1 && rd[1] == 0xE2 && rd[2] == 0xE3, "exported %02X %02X %02X",
+              rd[0], rd[1], rd[2]);
+        CHECK_TRACE("S W33+ 01+ Sr R33+ E1+ E2+ E3- P");
+        i2c_export_enable(NULL);
+    }
+}
+
+static void test_bus_errors(void)
+{
+    static const uint8_t wr[] = { 0x00, 0x01 };
+    i2c_stats_t before, after;
+    int ret;
+
+    i2c_stats_get(&before);
+
+    /* another master wins on the address, ours waits for its STOP */
+    sim_i2c_inject(RB_I2C_ARLO);
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == -I2C_ARB_LOST, "write with lost arbitration returned %d", ret);
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == 0, "write after lost arbitration returned %d", ret);
+    CHECK_TRACE("S ARLO P S W50+ 00+ 01+ P");
+
+    sim_i2c_inject(RB_I2C_BERR);
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == -I2C_BUS_ERROR, "write with bus error returned %d", ret);
+    CHECK_TRACE("S BERR P");
+
+    /* reported, the transfer goes on */
+    sim_i2c_inject(RB_I2C_OVR);
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == -I2C_OVR, "write with overrun returned %d", ret);
+    CHECK_TRACE("S W50+ 00+ 01+ P");
+
+    /* a device holds SDA: the deadline expires and the bus is recovered */
+    sim_i2c_stick_sda(3);
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == -I2C_TIMEOUT, "write on a stuck bus returned %d", ret);
+    ret = i2c_write_to(TEST_DEV_ADDR, wr, sizeof(wr), 1, 1);
+    CHECK(ret == 0, "write after the recovery returned %d", ret);
+    CHECK_TRACE("SDA- SDA+ S W50+ 00+ 01+ P");
+
+    i2c_stats_get(&after);
+    CHECK(after.errors[I2C_ARB_LOST] == before.errors[I2C_ARB_LOST] + 1, "ARLO not counted");
+    CHECK(after.errors[I2C_BUS_ERROR] == before.errors[I2C_BUS_ERROR] + 1, "BERR not counted");
+    CHECK(after.errors[I2C_OVR] == before.errors[I2C_OVR] + 1, "OVR not counted");
+    CHECK(after.errors[I2C_TIMEOUT] == before.errors[I2C_TIMEOUT] + 1, "timeout not counted");
+    CHECK(after.recoveries == before.recoveries + 1, "%u recoveries", after.recoveries);
+}
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    i2c_isr_profile_t profile;
+
+    SetSysClock(CLK_SOURCE_PLL_60MHz);
+    sim_i2c_attach(&test_dev);
+    test_task_id = TMOS_ProcessEventRegister(test_process_event);
+    i2c_app_init(TEST_OWN_ADDR << 1);
+    CHECK(sim_i2c_bit_ns() == 2500, "bit time %u ns", sim_i2c_bit_ns());
+
+    i2c_isr_profile_reset();
+    sim_icount_irq(I2C_IRQn, test_icount_done);
+
+    test_master_blocking();
+    test_master_transfer();
+    test_master_async();
+    test_master_nack();
+    test_slave();
+    test_bus_errors();
+
+    sim_icount_irq(I2C_IRQn, NULL);
+    CHECK(sim_tmos_msgs() == 0, "%u TMOS messages not freed", sim_tmos_msgs());
+
+    /* every path taken, with its worst case */
+    i2c_isr_profile_get(&profile);
+    printf("%-13s %6s %10s %10s\n", "path", "hits", "max insns", "max cycles");
+    for (uint8_t i = 0; i < I2C_PATH_MAX; i++) {
+        if (i != I2C_PATH_NONE) {
+            CHECK(profile.hits[i] > 0, "path \"%s\" never taken", test_path_name[i]);
+        }
+        CHECK(test_insns_max[i] <= TEST_INSNS_MAX, "path \"%s\" took %u instructions",
+              test_path_name[i], test_insns_max[i]);
+        if (profile.hits[i]) {
+            printf("%-13s %6u %10u %10u\n", test_path_name[i], profile.hits[i],
+                   test_insns_max[i], profile.cycles_max[i]);
+        }
+    }
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_i2c_sched.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : I2C measurement scheduler against devices that NACK
+ *                      a readout before their conversion ends: each job set
+ *                      is planned with i2c_sched_plan() and run with
+ *                      i2c_sched_run(), the run must follow the plan
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "HAL.h"
+#include "i2c_sched.h"
+#include "sim.h"
+#include "sim_ble.h"
+#include "sim_i2c.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TEST_OWN_ADDR           0x33
+
+/* Measured readout against the plan: the TMOS clock rounds each
+ * conversion up by one to two 625us ticks, the bus time is estimated */
+#define TEST_LATE_US            1500
+#define TEST_EARLY_US           200
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+static int test_failures;
+
+/*********************************************************************
+ * SENSORS
+ */
+
+/* A write starting with a trigger command starts a conversion, a read
+ * before it ends is not acknowledged; other writes (register address,
+ * fetch command) just precede a read */
+typedef struct {
+    sim_i2c_dev_t dev;
+    uint8_t trig[2];                // trigger commands, first byte
+    uint16_t conv_ms[2];            // their conversion time
+    uint8_t first;                  // next byte written is the first of the write
+    uint64_t ready_at;
+    uint32_t nacks;                 // readouts before the conversion ended
+} test_sensor_t;
+
+static uint8_t test_sensor_start(sim_i2c_dev_t *dev, uint8_t read)
+{
+    test_sensor_t *s = (test_sensor_t *)dev;
+
+    if (read && sim_time() < s->ready_at) {
+        s->nacks++;
+        return 0;
+    }
+    s->first = !read;
+    return 1;
+}
+
+static uint8_t test_sensor_write(sim_i2c_dev_t *dev, uint8_t data)
+{
+    test_sensor_t *s = (test_sensor_t *)dev;
+
+    if (s->first) {
+        for (uint8_t i = 0; i < 2; i++) {
+            if (s->conv_ms[i] && data == s->trig[i]) {
+                s->ready_at = sim_time() + SIM_MS(s->conv_ms[i]);
+            }
+        }
+        s->first = 0;
+    }
+    return 1;
+}
+
+static uint8_t test_sensor_read(sim_i2c_dev_t *dev)
+{
+    return dev->addr;
+}
+
+static void test_sensor_stop(sim_i2c_dev_t *dev)
+{
+    (void)dev;
+}
+
+#define TEST_SENSOR(a, t0, c0, t1, c1) {                        \
+    .dev = { .addr = (a), .start = test_sensor_start, .write = test_sensor_write, \
+             .read = test_sensor_read, .stop = test_sensor_stop }, \
+    .trig = { (t0), (t1) }, .conv_ms = { (c0), (c1) },          \
+}
+
+/* SHT20 T and RH, SHT3x single shot or periodic, BME280 forced mode */
+static test_sensor_t test_sht20 = TEST_SENSOR(0x40, 0xF3, 85, 0xF5, 29);
+static test_sensor_t test_sht3x = TEST_SENSOR(0x44, 0x24, 16, 0, 0);
+static test_sensor_t test_bme280 = TEST_SENSOR(0x76, 0xF4, 10, 0, 0);
+
+/*********************************************************************
+ * JOB SETS
+ */
+
+static uint8_t test_rx[I2C_SCHED_JOBS_MAX][8];
+
+#define TEST_JOB(a, fl, len, c0, c1, conv, reg, rxlen) \
+    { .addr = (a), .flags = (fl), .cmd_len = (len), .cmd = { (c0), (c1) }, \
+      .conv_ms = (conv), .rd_reg = (reg), .rx_len = (rxlen) }
+
+typedef struct {
+    const char *name;
+    uint8_t num;
+    i2c_sched_job_t jobs[I2C_SCHED_JOBS_MAX];
+} test_set_t;
+
+static test_set_t test_sets[] = {
+    { "SHT20 T then RH", 2, {
+        TEST_JOB(0x40, 0, 1, 0xF3, 0, 85, 0, 3),
+        TEST_JOB(0x40, 0, 1, 0xF5, 0, 29, 0, 3),
+    } },
+    { "SHT3x single shot", 1, {
+        TEST_JOB(0x44, 0, 2, 0x24, 0x00, 16, 0, 6),
+    } },
+    { "SHT3x periodic fetch", 1, {
+        TEST_JOB(0x44, I2C_SCHED_FETCH, 2, 0xE0, 0x00, 0, 0, 6),
+    } },
+    { "BME280 forced x1", 1, {
+        TEST_JOB(0x76, I2C_SCHED_RD_REG, 2, 0xF4, 0x25, 10, 0xF7, 8),
+    } },
+    /* conversions overlap, the SHT3x and BME280 readouts share a wake */
+    { "SHT20 + SHT3x + BME280", 4, {
+        TEST_JOB(0x40, 0, 1, 0xF3, 0, 85, 0, 3),
+        TEST_JOB(0x40, 0, 1, 0xF5, 0, 29, 0, 3),
+        TEST_JOB(0x44, 0, 2, 0x24, 0x00, 16, 0, 6),
+        TEST_JOB(0x76, I2C_SCHED_RD_REG, 2, 0xF4, 0x25, 15, 0xF7, 8),
+    } },
+};
+
+/*********************************************************************
+ * COMPLETION
+ */
+
+static tmosTaskID test_task_id;
+static i2c_sched_t *test_done_sched;
+static uint8_t test_done_status;
+
+static tmosEvents test_process_event(tmosTaskID task_id, tmosEvents events)
+{
+    if (events & SYS_EVENT_MSG) {
+        uint8_t *msg;
+
+        while ((msg = tmos_msg_receive(task_id)) != NULL) {
+            i2c_sched_done_msg_t *done = (i2c_sched_done_msg_t *)msg;
+
+            if (done->hdr.event == I2C_SCHED_DONE_MSG) {
+                test_done_sched = done->sched;
+                test_done_status = done->hdr.status;
+            }
+            tmos_msg_deallocate(msg);
+        }
+        return (events ^ SYS_EVENT_MSG);
+    }
+    return 0;
+}
+
+/*********************************************************************
+ * SCENARIOS
+ */
+
+static uint32_t test_rtc_to_us(uint32_t ticks)
+{
+    return (uint32_t)((uint64_t)ticks * 1000000 / FREQ_RTC);
+}
+
+/* Plan the set, run it and compare every readout with its planned time */
+static void test_run_set(test_set_t *set)
+{
+    i2c_sched_t sched = { .jobs = set->jobs, .num = set->num };
+    i2c_sched_plan_t plan;
+    uint32_t nacks = test_sht20.nacks + test_sht3x.nacks + test_bme280.nacks;
+    uint32_t prev_us = 0;
+    int ret;
+
+    for (uint8_t i = 0; i < set->num; i++) {
+        set->jobs[i].rx = test_rx[i];
+        set->jobs[i].tag = i;
+    }
+    i2c_sched_plan(&sched, &plan);
+    printf("%-24s cycle %6u us (serial %6u us), %u wakes, awake ~%u us\n", set->name,
+           plan.cycle_us, plan.serial_us, plan.wakes, plan.awake_us);
+
+    test_done_sched = NULL;
+    ret = i2c_sched_run(&sched, test_task_id);
+    CHECK(ret == 0, "%s: run returned %d", set->name, ret);
+    sim_tmos_run(SIM_US(plan.cycle_us) + SIM_MS(10));
+
+    CHECK(test_done_sched == &sched && test_done_status == 0, "%s: no completion, status %u",
+          set->name, test_done_status);
+    CHECK(sched.wakes == plan.wakes, "%s: %u wakes, planned %u", set->name, sched.wakes, plan.wakes);
+    CHECK(test_sht20.nacks + test_sht3x.nacks + test_bme280.nacks == nacks,
+          "%s: readout before the conversion ended", set->name);
+
+    /* bus operations in the planned order, each close to its planned time */
+    for (uint8_t s = 0; s < plan.steps; s++) {
+        const i2c_sched_step_t *step = &plan.step[s];
+        const i2c_sched_job_t *job = &set->jobs[step->job];
+        uint32_t t_us = test_rtc_to_us(step->read ? job->t_read : job->t_trig);
+
+        CHECK(job->status == 0, "%s: job %u status %u", set->name, step->job, job->status);
+        CHECK(t_us + TEST_EARLY_US >= step->t_us && t_us <= step->t_us + TEST_LATE_US,
+              "%s: job %u %s at %u us, planned %u us", set->name, step->job,
+              step->read ? "read" : "trigger", t_us, step->t_us);
+        CHECK(t_us >= prev_us, "%s: job %u %s out of order", set->name, step->job,
+              step->read ? "read" : "trigger");
+        prev_us = t_us;
+    }
+}
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    SetSysClock(CLK_SOURCE_PLL_60MHz);
+    sim_i2c_attach(&test_sht20.dev);
+    sim_i2c_attach(&test_sht3x.dev);
+    sim_i2c_attach(&test_bme280.dev);
+    test_task_id = TMOS_ProcessEventRegister(test_process_event);
+    i2c_app_init(TEST_OWN_ADDR << 1);
+    i2c_sched_init();
+
+    for (uint8_t i = 0; i < sizeof(test_sets) / sizeof(test_sets[0]); i++) {
+        test_run_set(&test_sets[i]);
+    }
+    CHECK(sim_tmos_msgs() == 0, "%u TMOS messages not freed", sim_tmos_msgs());
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_sensor_derived.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Dew point, absolute humidity and VPD of the fixed point
+ *                      sensor_derive() against the Magnus formula in double
+ *                      precision over the table range, and the host time
+ *                      per call of both
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "sensor_derived.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Magnus coefficients of the table */
+#define TEST_MAGNUS_E0          611.2
+#define TEST_MAGNUS_A           17.62
+#define TEST_MAGNUS_B           243.12
+
+/* M/R of water vapour (g*K/J) */
+#define TEST_AH_COEF            2.1668
+
+/* Grid of the comparison (0.01 units), the steps avoid the table points */
+#define TEST_T_STEP             37
+#define TEST_RH_MIN             100
+#define TEST_RH_STEP            49
+
+/* Largest errors allowed: everywhere, and over 0..50C at 20..100%RH */
+#define TEST_DEW_TOL            0.025       // C
+#define TEST_DEW_TOL_INDOOR     0.02        // C
+#define TEST_AH_TOL             0.1         // g/m3
+#define TEST_VPD_TOL            12.0        // Pa
+
+#define TEST_CALLS              1000000
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+static int test_failures;
+
+typedef struct {
+    double dew_point;       // C
+    double abs_humid;       // g/m3
+    double vpd;             // Pa
+} test_ref_t;
+
+/* Reference in double precision */
+static void test_reference(double t, double rh, test_ref_t *ref)
+{
+    double es = TEST_MAGNUS_E0 * exp(TEST_MAGNUS_A * t / (TEST_MAGNUS_B + t));
+    double e = es * rh / 100.0;
+    double g = log(e / TEST_MAGNUS_E0);
+
+    ref->dew_point = TEST_MAGNUS_B * g / (TEST_MAGNUS_A - g);
+    ref->abs_humid = TEST_AH_COEF * e / (t + 273.15);
+    ref->vpd = es - e;
+}
+
+static double test_max(double worst, double err)
+{
+    err = fabs(err);
+    return err > worst ? err : worst;
+}
+
+static double test_ns(struct timespec *t0, struct timespec *t1)
+{
+    return ((t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec)) / TEST_CALLS;
+}
+
+/*********************************************************************
+ * SCENARIOS
+ */
+
+static void test_accuracy(void)
+{
+    double dew = 0, dew_indoor = 0, ah = 0, vpd = 0;
+    sensor_derived_t out;
+    test_ref_t ref;
+    int ret;
+
+    for (int32_t t = SENSOR_DERIVED_T_MIN; t <= SENSOR_DERIVED_T_MAX; t += TEST_T_STEP) {
+        for (int32_t rh = TEST_RH_MIN; rh <= 10000; rh += TEST_RH_STEP) {
+            ret = sensor_derive(t, rh, &out);
+            CHECK(ret == 0, "T %d RH %d: returned %d", (int)t, (int)rh, ret);
+            test_reference(t / 100.0, rh / 100.0, &ref);
+
+            /* below the table the dew point is clamped */
+            if (ref.dew_point >= SENSOR_DERIVED_T_MIN / 100.0) {
+                dew = test_max(dew, out.dew_point / 100.0 - ref.dew_point);
+                if (t >= 0 && t <= 5000 && rh >= 2000) {
+                    dew_indoor = test_max(dew_indoor, out.dew_point / 100.0 - ref.dew_point);
+                }
+            } else {
+                CHECK(out.dew_point == SENSOR_DERIVED_T_MIN, "T %d RH %d: dew point %d",
+                      (int)t, (int)rh, (int)out.dew_point);
+            }
+            ah = test_max(ah, out.abs_humid / 100.0 - ref.abs_humid);
+            vpd = test_max(vpd, out.vpd - ref.vpd);
+        }
+    }
+
+    printf("max error: dew point %.3f C (%.3f C over 0..50 C, 20..100 %%RH), "
+           "absolute humidity %.3f g/m3, VPD %.1f Pa\n", dew, dew_indoor, ah, vpd);
+    CHECK(dew <= TEST_DEW_TOL, "dew point off by %.3f C", dew);
+    CHECK(dew_indoor <= TEST_DEW_TOL_INDOOR, "dew point off by %.3f C indoors", dew_indoor);
+    CHECK(ah <= TEST_AH_TOL, "absolute humidity off by %.3f g/m3", ah);
+    CHECK(vpd <= TEST_VPD_TOL, "VPD off by %.1f Pa", vpd);
+
+    /* out of range inputs */
+    CHECK(sensor_derive(SENSOR_DERIVED_T_MIN - 1, 5000, &out) == -1, "below the table accepted");
+    CHECK(sensor_derive(SENSOR_DERIVED_T_MAX + 1, 5000, &out) == -1, "above the table accepted");
+    CHECK(sensor_derive(2500, -1, &out) == -1, "negative humidity accepted");
+    CHECK(sensor_derive(2500, 10001, &out) == -1, "humidity above 100 %% accepted");
+}
+
+static void test_cost(void)
+{
+    struct timespec t0, t1, t2;
+    volatile int32_t sink_i;
+    volatile double sink_d;
+    sensor_derived_t out;
+    test_ref_t ref;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t n = 0; n < TEST_CALLS; n++) {
+        sensor_derive(-4000 + (int32_t)(n % 12500), 2000 + (int32_t)(n % 8000), &out);
+        sink_i = out.dew_point;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (uint32_t n = 0; n < TEST_CALLS; n++) {
+        test_reference((-4000 + (int32_t)(n % 12500)) / 100.0, (2000 + (int32_t)(n % 8000)) / 100.0, &ref);
+        sink_d = ref.dew_point;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    (void)sink_i;
+    (void)sink_d;
+
+    printf("cost: %.1f ns per call, %.1f ns in double precision with libm (host)\n",
+           test_ns(&t0, &t1), test_ns(&t1, &t2));
+}
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    test_accuracy();
+    test_cost();
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
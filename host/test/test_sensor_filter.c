@@ -0,0 +1,227 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_sensor_filter.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : Sensor filter: seeding, spike rejection, step response,
+ *                      then error and deadband crossings on synthetic
+ *                      SHT20-like readings against the unfiltered values,
+ *                      and the host time per sample
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "sensor.h"
+#include "sensor_filter.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TEST_SAMPLES            100000
+
+/* Synthetic readings (0.01 units): noise, spikes of 1 sample in 100 on
+ * the temperature, drift over a period of TEST_DRIFT_PERIOD samples */
+#define TEST_TEMP_BASE          2300
+#define TEST_TEMP_NOISE         4
+#define TEST_TEMP_SPIKE         60
+#define TEST_HUMI_BASE          5000
+#define TEST_HUMI_NOISE         25
+#define TEST_DRIFT              100
+#define TEST_DRIFT_PERIOD       20000
+
+/* Samples for a step to settle within one unit */
+#define TEST_STEP_SAMPLES       (SENSOR_FILTER_MEDIAN + 8 * SENSOR_FILTER_EMA_SHIFT + 8)
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+static int test_failures;
+
+static uint32_t test_rand_state = 12345;
+
+/* xorshift32, the same sequence on every run */
+static uint32_t test_rand(void)
+{
+    test_rand_state ^= test_rand_state << 13;
+    test_rand_state ^= test_rand_state >> 17;
+    test_rand_state ^= test_rand_state << 5;
+    return test_rand_state;
+}
+
+/* Roughly normal noise of standard deviation sigma: sum of 12 uniforms */
+static int32_t test_noise(int32_t sigma)
+{
+    int32_t sum = 0;
+
+    for (uint8_t i = 0; i < 12; i++) {
+        sum += test_rand() & 0xFFFF;
+    }
+    return (int32_t)(((int64_t)sum - 6 * 0x10000) * sigma / 0x10000);
+}
+
+/* Slow triangle around the base */
+static int32_t test_drift(uint32_t n)
+{
+    int32_t phase = n % TEST_DRIFT_PERIOD;
+    int32_t half = TEST_DRIFT_PERIOD / 2;
+
+    return (phase < half ? phase : TEST_DRIFT_PERIOD - phase) * 2 * TEST_DRIFT / half - TEST_DRIFT;
+}
+
+static uint32_t test_isqrt(uint64_t v)
+{
+    uint64_t r = 0;
+
+    for (uint64_t bit = 1ULL << 62; bit; bit >>= 2) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return (uint32_t)r;
+}
+
+/* Error against the true value and advert updates of one channel */
+typedef struct {
+    uint64_t sq_sum;
+    int32_t adv;                // last value that crossed the deadband
+    uint32_t crossings;
+} test_stats_t;
+
+static void test_account(test_stats_t *s, int32_t value, int32_t truth, int32_t deadband, uint32_t n)
+{
+    int64_t err = value - truth;
+
+    s->sq_sum += err * err;
+    if (n == 0 || value - s->adv >= deadband || s->adv - value >= deadband) {
+        s->adv = value;
+        s->crossings += (n != 0);
+    }
+}
+
+/* RMS error in 0.1 of the unit */
+static uint32_t test_rms10(const test_stats_t *s)
+{
+    return test_isqrt(s->sq_sum * 100 / TEST_SAMPLES);
+}
+
+/*********************************************************************
+ * SCENARIOS
+ */
+
+static void test_basic(void)
+{
+    int32_t v;
+
+    /* the first sample seeds the filter, constants pass unchanged */
+    sensor_filter_reset(SENSOR_OBJ_TEMP);
+    CHECK(sensor_filter_apply(SENSOR_OBJ_TEMP, -567) == -567, "first sample");
+    for (uint8_t i = 0; i < 10; i++) {
+        v = sensor_filter_apply(SENSOR_OBJ_TEMP, -567);
+        CHECK(v == -567, "constant -567 filtered to %d", (int)v);
+    }
+
+#if (SENSOR_FILTER_MEDIAN >= 3)
+    /* a single spike does not get past the median */
+    sensor_filter_reset(SENSOR_OBJ_TEMP);
+    for (uint8_t i = 0; i < 10; i++) {
+        v = sensor_filter_apply(SENSOR_OBJ_TEMP, (i == 5) ? 3100 : 2500);
+        CHECK(v == 2500, "sample %u filtered to %d", i, (int)v);
+    }
+#endif
+
+    /* a step settles, rising without overshoot */
+    sensor_filter_reset(SENSOR_OBJ_HUMID);
+    sensor_filter_apply(SENSOR_OBJ_HUMID, 4000);
+    v = 4000;
+    for (uint8_t i = 0; i < TEST_STEP_SAMPLES; i++) {
+        int32_t next = sensor_filter_apply(SENSOR_OBJ_HUMID, 6000);
+
+        CHECK(next >= v && next <= 6000, "step sample %u: %d after %d", i, (int)next, (int)v);
+        v = next;
+    }
+    CHECK(v >= 5999, "step settled at %d", (int)v);
+}
+
+/* Synthetic readings through the filter, against the raw readings */
+static void test_synthetic(void)
+{
+    test_stats_t raw_t = { 0 }, raw_h = { 0 }, flt_t = { 0 }, flt_h = { 0 };
+
+    sensor_filter_reset(SENSOR_OBJ_TEMP);
+    sensor_filter_reset(SENSOR_OBJ_HUMID);
+    for (uint32_t n = 0; n < TEST_SAMPLES; n++) {
+        int32_t true_t = TEST_TEMP_BASE + test_drift(n);
+        int32_t true_h = TEST_HUMI_BASE - test_drift(n);
+        int32_t t = true_t + test_noise(TEST_TEMP_NOISE);
+        int32_t h = true_h + test_noise(TEST_HUMI_NOISE);
+
+        if (test_rand() % 100 == 0) {
+            t += TEST_TEMP_SPIKE;
+        }
+        test_account(&raw_t, t, true_t, SENSOR_DEADBAND_TEMP, n);
+        test_account(&raw_h, h, true_h, SENSOR_DEADBAND_HUMID, n);
+        test_account(&flt_t, sensor_filter_apply(SENSOR_OBJ_TEMP, t), true_t, SENSOR_DEADBAND_TEMP, n);
+        test_account(&flt_h, sensor_filter_apply(SENSOR_OBJ_HUMID, h), true_h, SENSOR_DEADBAND_HUMID, n);
+    }
+
+    printf("temperature: rms error %u.%u -> %u.%u (0.01C), deadband crossings %u -> %u\n",
+           test_rms10(&raw_t) / 10, test_rms10(&raw_t) % 10, test_rms10(&flt_t) / 10,
+           test_rms10(&flt_t) % 10, raw_t.crossings, flt_t.crossings);
+    printf("humidity:    rms error %u.%u -> %u.%u (0.01%%RH), deadband crossings %u -> %u\n",
+           test_rms10(&raw_h) / 10, test_rms10(&raw_h) % 10, test_rms10(&flt_h) / 10,
+           test_rms10(&flt_h) % 10, raw_h.crossings, flt_h.crossings);
+
+    CHECK(2 * test_rms10(&flt_t) <= test_rms10(&raw_t), "temperature error not halved");
+    CHECK(2 * test_rms10(&flt_h) <= test_rms10(&raw_h), "humidity error not halved");
+    CHECK(10 * flt_t.crossings <= raw_t.crossings, "temperature crossings not cut tenfold");
+    CHECK(10 * flt_h.crossings <= raw_h.crossings, "humidity crossings not cut tenfold");
+}
+
+static void test_cost(void)
+{
+    struct timespec t0, t1;
+    volatile int32_t sink;
+    double ns;
+
+    sensor_filter_reset(SENSOR_OBJ_TEMP);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t n = 0; n < TEST_SAMPLES; n++) {
+        sink = sensor_filter_apply(SENSOR_OBJ_TEMP, TEST_TEMP_BASE + (int32_t)(n & 0x3F));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void)sink;
+
+    ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / TEST_SAMPLES;
+    printf("cost: %.1f ns per sample (host)\n", ns);
+}
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    test_basic();
+    test_synthetic();
+    test_cost();
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,293 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_sensors.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/10/16
+ * Description        : The whole application with the sensor selected in
+ *                      sensor_cfg.h, built once per configuration (see
+ *                      SENSOR_CFGS in the Makefile): readings reach the
+ *                      advert, the sample follows its plan, and the plan
+ *                      of each configuration is printed for comparison
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "app_i2c.h"
+#include "bthome.h"
+#include "sensor.h"
+#include "sensor_derived.h"
+#include "sensor_sht4x.h"
+#include "sim.h"
+#include "sim_ble.h"
+#include "sim_sensors.h"
+
+#include <stdio.h>
+
+/*********************************************************************
+ * MODEL
+ */
+
+#if (SENSOR_SHT3X == TRUE)
+#define TEST_MODEL              "SHT3x"
+#define TEST_PERIODIC           (SHT3X_MODE == SENSOR_MODE_PERIODIC)
+#define test_model              sim_sht3x
+#define test_model_set          sim_sht3x_set
+#define test_model_measurements sim_sht3x_measurements
+#elif (SENSOR_SHT4X == TRUE)
+#define TEST_MODEL              "SHT4x"
+#define TEST_PERIODIC           (SHT4X_MODE == SENSOR_MODE_PERIODIC)
+#define test_model              sim_sht4x
+#define test_model_set          sim_sht4x_set
+#define test_model_measurements sim_sht4x_measurements
+#elif (SENSOR_BME280 == TRUE) && defined(TEST_BMP280)
+#define TEST_MODEL              "BMP280"
+#define TEST_PERIODIC           0
+#define test_model              sim_bme280
+#define test_model_set(t, h)    sim_bme280_set(t, h, TEST_PRES)
+#define test_model_measurements sim_bme280_measurements
+#elif (SENSOR_BME280 == TRUE)
+#define TEST_MODEL              "BME280"
+#define TEST_PERIODIC           0
+#define test_model              sim_bme280
+#define test_model_set(t, h)    sim_bme280_set(t, h, TEST_PRES)
+#define test_model_measurements sim_bme280_measurements
+#else
+#define TEST_MODEL              "SHT20"
+#define TEST_PERIODIC           0
+#define test_model              sim_sht20
+#define test_model_set          sim_sht20_set
+#define test_model_measurements sim_sht20_measurements
+#endif
+
+/* Rounding of the raw words and of the conversion */
+#define TEST_TEMP_TOL           3
+#define TEST_HUMID_TOL          5
+#define TEST_PRES_TOL           8
+
+#define TEST_PRES               101325      // Pa
+
+/*********************************************************************
+ * HELPERS
+ */
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+static int test_failures;
+
+int app_main(void);
+
+typedef struct {
+    uint8_t found;
+    int16_t temp;
+    uint16_t humid;
+    uint32_t pres;
+    int16_t dew;
+} test_bthome_t;
+
+/* Temperature and humidity in the service data of the advert on air */
+static test_bthome_t test_bthome_parse(void)
+{
+    test_bthome_t r = { 0 };
+    uint16_t len, i = 0;
+    const uint8_t *d = sim_gap_adv_data(&len);
+
+    while (i + 1 < len && d[i]) {
+        uint8_t ad_len = d[i], ad_type = d[i + 1];
+
+        if (ad_type == GAP_ADTYPE_SERVICE_DATA && ad_len >= 4 &&
+            d[i + 2] == BTHOME_UUID_LO && d[i + 3] == BTHOME_UUID_HI) {
+            uint16_t p = i + 5, end = i + 1 + ad_len;
+
+            r.found = 1;
+            while (p < end) {
+                uint8_t id = d[p++];
+
+                switch (id) {
+                case BTHOME_ID_PACKET_ID:
+                case BTHOME_ID_BATTERY:
+                    p += 1;
+                    break;
+                case BTHOME_ID_TEMPERATURE:
+                    r.temp = (int16_t)(d[p] | d[p + 1] << 8);
+                    p += 2;
+                    break;
+                case BTHOME_ID_HUMIDITY:
+                    r.humid = d[p] | d[p + 1] << 8;
+                    p += 2;
+                    break;
+                case BTHOME_ID_DEWPOINT:
+                    r.dew = (int16_t)(d[p] | d[p + 1] << 8);
+                    p += 2;
+                    break;
+                case BTHOME_ID_PRESSURE:
+                    r.pres = d[p] | d[p + 1] << 8 | (uint32_t)d[p + 2] << 16;
+                    p += 3;
+                    break;
+                default:
+                    p += 2;
+                    break;
+                }
+            }
+        }
+        i += ad_len + 1;
+    }
+    return r;
+}
+
+static int abs32(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+/* Advert against the conditions, with the deadband the advert may lag by */
+static void test_check_advert(const char *when, int32_t temp, int32_t humid, int32_t lag)
+{
+    test_bthome_t adv = test_bthome_parse();
+
+    CHECK(adv.found, "%s: no BTHome service data", when);
+    CHECK(abs32(adv.temp - temp) <= TEST_TEMP_TOL + lag * SENSOR_DEADBAND_TEMP,
+          "%s: temperature %d, expected %d", when, adv.temp, (int)temp);
+#if defined(TEST_BMP280)
+    (void)humid;
+    CHECK(adv.humid == bthome_invalid(BTHOME_ID_HUMIDITY, 2), "%s: humidity %d from a BMP280",
+          when, adv.humid);
+#else
+    CHECK(abs32(adv.humid - humid) <= TEST_HUMID_TOL + lag * SENSOR_DEADBAND_HUMID,
+          "%s: humidity %d, expected %d", when, adv.humid, (int)humid);
+#endif
+#if (SENSOR_BME280 == TRUE)
+    CHECK(abs32(adv.pres - TEST_PRES) <= TEST_PRES_TOL + lag * SENSOR_DEADBAND_PRES,
+          "%s: pressure %u, expected %u", when, adv.pres, TEST_PRES);
+#endif
+#if (SENSOR_DEW_POINT == TRUE)
+    {
+        sensor_derived_t ref;
+
+        /* derived from the values advertised with it */
+        sensor_derive(adv.temp, adv.humid, &ref);
+        CHECK(abs32(adv.dew - ref.dew_point) <= 1, "%s: dew point %d, %d from T and RH", when,
+              adv.dew, (int)ref.dew_point);
+    }
+#endif
+#if (SENSOR_BME280 == TRUE)
+    printf("%s: T %d, RH %d, P %u\n", when, adv.temp, adv.humid, adv.pres);
+#elif (SENSOR_DEW_POINT == TRUE)
+    printf("%s: T %d, RH %d, dew point %d\n", when, adv.temp, adv.humid, adv.dew);
+#else
+    printf("%s: T %d, RH %d\n", when, adv.temp, adv.humid);
+#endif
+}
+
+#if (SENSOR_SHT4X == TRUE)
+/* Run one second, largest advertised temperature error so far */
+static int32_t test_run_watch(int32_t temp, int32_t worst)
+{
+    int32_t err;
+
+    sim_main_run(SIM_S(1));
+    err = abs32(test_bthome_parse().temp - temp);
+    return err > worst ? err : worst;
+}
+
+/* Two heater pulses in a row: two heated readouts out of three would pass
+ * the median filter, they must be discarded by the driver. The pre-triggered
+ * mode reads a pulse at the sample after it, up to 120 s later. */
+static void test_sht4x_heater(int32_t temp)
+{
+    uint32_t pulses = sim_sht4x_heater_pulses();
+    int32_t worst = 0;
+    uint16_t s;
+
+    for (uint8_t n = 0; n < 2; n++) {
+        sht4x_heater_request(SHT4X_HEATER_20MW_100MS);
+        for (s = 0; s < 300 && sim_sht4x_heater_pulses() == pulses + n; s++) {
+            worst = test_run_watch(temp, worst);
+        }
+    }
+    for (s = 0; s < 300; s++) {
+        worst = test_run_watch(temp, worst);
+    }
+    CHECK(sim_sht4x_heater_pulses() == pulses + 2, "%u heater pulses",
+          sim_sht4x_heater_pulses() - pulses);
+    CHECK(worst <= TEST_TEMP_TOL + SENSOR_DEADBAND_TEMP, "heated temperature advertised, %d off",
+          (int)worst);
+}
+#endif
+
+/*********************************************************************
+ * TEST
+ */
+
+int main(void)
+{
+    i2c_sched_plan_t plan;
+    i2c_stats_t stats;
+    uint32_t measurements, charge;
+    double sleep_pct;
+
+    sim_i2c_attach(test_model());
+#if defined(TEST_BMP280)
+    sim_bme280_chip(SIM_BME280_CHIP_BMP280);
+#endif
+    test_model_set(2345, 4560);
+    sim_adc_set_battery_mv(3300);
+    sim_adc_set_chip_temp(2500);
+
+    sim_main_start(app_main);
+
+    sim_main_run(SIM_S(60));
+    test_check_advert("60 s", 2345, 4560, 0);
+
+    /* a step reaches the advert through the filter */
+    test_model_set(2600, 6000);
+    sim_main_run(SIM_S(300));
+    test_check_advert("360 s", 2600, 6000, 1);
+
+    /* stable readings lengthen the sample period, sampling goes on */
+    measurements = test_model_measurements();
+    sim_main_run(SIM_S(1800));
+    CHECK(test_model_measurements() > measurements, "sampling stopped");
+    test_check_advert("2160 s", 2600, 6000, 1);
+
+#if (SENSOR_SHT4X == TRUE)
+    test_sht4x_heater(2600);
+#endif
+
+    /* a sample of a periodic mode is a single readout */
+    charge = sensor_plan(&plan);
+#if (TEST_PERIODIC)
+    CHECK(plan.wakes == 1, "%u wakes per sample", plan.wakes);
+#endif
+#if (SENSOR_SHT3X == TRUE) && (TEST_PERIODIC)
+    CHECK(sim_sht3x_fetches() > 0 && sim_sht3x_fetches() < sim_sht3x_measurements(),
+          "%u fetches of %u measurements", sim_sht3x_fetches(), sim_sht3x_measurements());
+#endif
+#if (SENSOR_BME280 == TRUE)
+    CHECK(sim_bme280_early_reads() == 0, "%u readouts before the conversion ended",
+          sim_bme280_early_reads());
+#endif
+
+    i2c_stats_get(&stats);
+    for (uint8_t i = 0; i < I2C_ERROR_MAX; i++) {
+        CHECK(stats.errors[i] == 0, "%u I2C errors of type %d", stats.errors[i], i);
+    }
+    CHECK(stats.recoveries == 0, "%u bus recoveries", stats.recoveries);
+    CHECK(sim_tmos_msgs() == 0, "%u TMOS messages not freed", sim_tmos_msgs());
+
+    sleep_pct = 100.0 * sim_sleep_time() / sim_time();
+    CHECK(sleep_pct > 95, "asleep %.1f%% of the time", sleep_pct);
+
+    printf("%s %s: cycle %u us, awake %u us, %u wakes, %u nC per sample, %u measurements\n",
+           TEST_MODEL, TEST_PERIODIC ? "periodic" : "single shot", plan.cycle_us, plan.awake_us,
+           plan.wakes, charge, test_model_measurements());
+
+    printf("%s\n", test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}
@@ -5,19 +5,52 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../APP/adc_calib.c \
+../APP/adv_policy.c \
+../APP/aes_ccm.c \
 ../APP/app_i2c.c \
 ../APP/broadcaster.c \
-../APP/broadcaster_main.c 
+../APP/broadcaster_main.c \
+../APP/i2c_sched.c \
+../APP/sensor.c \
+../APP/sensor_bme280.c \
+../APP/sensor_derived.c \
+../APP/sensor_filter.c \
+../APP/sensor_sht20.c \
+../APP/sensor_sht3x.c \
+../APP/sensor_sht4x.c 
 
 OBJS += \
+./APP/adc_calib.o \
+./APP/adv_policy.o \
+./APP/aes_ccm.o \
 ./APP/app_i2c.o \
 ./APP/broadcaster.o \
-./APP/broadcaster_main.o 
+./APP/broadcaster_main.o \
+./APP/i2c_sched.o \
+./APP/sensor.o \
+./APP/sensor_bme280.o \
+./APP/sensor_derived.o \
+./APP/sensor_filter.o \
+./APP/sensor_sht20.o \
+./APP/sensor_sht3x.o \
+./APP/sensor_sht4x.o 
 
 C_DEPS += \
+./APP/adc_calib.d \
+./APP/adv_policy.d \
+./APP/aes_ccm.d \
 ./APP/app_i2c.d \
 ./APP/broadcaster.d \
-./APP/broadcaster_main.d 
+./APP/broadcaster_main.d \
+./APP/i2c_sched.d \
+./APP/sensor.d \
+./APP/sensor_bme280.d \
+./APP/sensor_derived.d \
+./APP/sensor_filter.d \
+./APP/sensor_sht20.d \
+./APP/sensor_sht3x.d \
+./APP/sensor_sht4x.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes